@@ -0,0 +1,183 @@
+// AsyncRequests.cpp
+#include "AsyncRequests.h"
+
+// Handle layout: slot index in the low byte, the slot's generation (bumped on every reuse) in the
+// high byte, so a handle kept after take()/release() no longer matches.
+#define HANDLE_INDEX(handle) ((uint8_t)((handle) & 0xFF))
+#define HANDLE_GENERATION(handle) ((uint8_t)((handle) >> 8))
+
+AsyncRequestQueue::AsyncRequestQueue(Communication& comm)
+    : _comm(comm), _nextSequence(0), _onWire(-1) {
+    for (uint8_t i = 0; i < ASYNC_REQUEST_SLOTS; i++) {
+        _slots[i].state = SLOT_FREE;
+        _slots[i].generation = 0;
+    }
+}
+
+int8_t AsyncRequestQueue::allocate() {
+    for (uint8_t i = 0; i < ASYNC_REQUEST_SLOTS; i++) {
+        if (_slots[i].state == SLOT_FREE) {
+            _slots[i].state = SLOT_QUEUED; // reserved; enqueue() fills in the rest
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+AsyncRequestHandle AsyncRequestQueue::enqueue(int8_t index, uint32_t timeoutMs, AsyncRequestCallback callback,
+                                              void* context) {
+    Slot& slot = _slots[index];
+    slot.generation++;
+    slot.state = SLOT_QUEUED;
+    slot.released = false;
+    slot.sequence = _nextSequence++;
+    slot.timeoutMs = timeoutMs;
+    slot.sentAt = 0;
+    slot.callback = callback;
+    slot.context = context;
+    slot.error = COMMUNICATION_ERROR_REQUEST_PENDING;
+    slot.responseSize = 0;
+    return handleOf(index);
+}
+
+AsyncRequestHandle AsyncRequestQueue::handleOf(int8_t index) const {
+    return (AsyncRequestHandle)(((uint16_t)_slots[index].generation << 8) | (uint8_t)index);
+}
+
+AsyncRequestQueue::Slot* AsyncRequestQueue::find(AsyncRequestHandle handle) {
+    const uint8_t index = HANDLE_INDEX(handle);
+    if (handle == ASYNC_REQUEST_INVALID_HANDLE || index >= ASYNC_REQUEST_SLOTS) {
+        return nullptr;
+    }
+    Slot& slot = _slots[index];
+    if (slot.state == SLOT_FREE || slot.released || slot.generation != HANDLE_GENERATION(handle)) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+const AsyncRequestQueue::Slot* AsyncRequestQueue::find(AsyncRequestHandle handle) const {
+    return const_cast<AsyncRequestQueue*>(this)->find(handle);
+}
+
+void AsyncRequestQueue::startNext() {
+    int8_t next = -1;
+    for (uint8_t i = 0; i < ASYNC_REQUEST_SLOTS; i++) {
+        if (_slots[i].state == SLOT_QUEUED && (next < 0 || _slots[i].sequence - _slots[next].sequence > 0x80000000u)) {
+            next = (int8_t)i;
+        }
+    }
+    if (next < 0) {
+        return;
+    }
+    Slot& slot = _slots[next];
+    _receiver.begin(_rxFrame, sizeof(_rxFrame));
+    _comm.sendFrame(slot.requestFrame, slot.requestFrameSize);
+    slot.state = SLOT_SENT;
+    slot.sentAt = millis();
+    _onWire = next;
+}
+
+void AsyncRequestQueue::complete(int8_t index, int error, const uint8_t* payload, uint16_t payloadSize) {
+    Slot& slot = _slots[index];
+    if (_onWire == index) {
+        _onWire = -1;
+    }
+    if (slot.released) {
+        slot.state = SLOT_FREE;
+        return;
+    }
+    slot.state = SLOT_DONE;
+    slot.error = error;
+    slot.responseSize = 0;
+    if (error == COMMUNICATION_SUCCESS && payloadSize != 0) {
+        memcpy(slot.response, payload, payloadSize);
+        slot.responseSize = payloadSize;
+    }
+    if (slot.callback != nullptr) {
+        slot.callback(slot.context, handleOf(index), error, slot.response, slot.responseSize);
+        slot.state = SLOT_FREE;
+    }
+}
+
+uint8_t AsyncRequestQueue::poll() {
+    if (_onWire >= 0) {
+        Slot& slot = _slots[_onWire];
+        if (_comm.pollFrame(_receiver)) {
+            int error = _receiver.error();
+            ResponseView view;
+            view.payload = nullptr;
+            view.payloadSize = 0;
+            if (error == COMMUNICATION_SUCCESS) {
+                error = parseResponse(_rxFrame, _receiver.frameSize(), &view);
+                _comm.recordResponse(error);
+            }
+            if (error == COMMUNICATION_SUCCESS && view.payloadSize != slot.expectedResponseSize) {
+                error = COMMUNICATION_ERROR_DATA_WRONG_SIZE;
+            }
+            complete(_onWire, error, view.payload, error == COMMUNICATION_SUCCESS ? view.payloadSize : 0);
+        } else if (millis() - slot.sentAt > slot.timeoutMs) {
+            // Anything of this response that turns up later must not be taken for the next one
+            _comm.flush();
+            _comm.recordResponse(COMMUNICATION_ERROR_TIMEOUT);
+            complete(_onWire, COMMUNICATION_ERROR_TIMEOUT, nullptr, 0);
+        }
+    }
+    if (_onWire < 0) {
+        startNext();
+    }
+    return pending();
+}
+
+int AsyncRequestQueue::wait(AsyncRequestHandle handle) {
+    const Slot* slot = find(handle);
+    if (slot == nullptr) {
+        return COMMUNICATION_ERROR_INVALID_HANDLE;
+    }
+    if (slot->callback != nullptr) {
+        // The slot is freed as soon as the callback has run; report through the callback only
+        while (find(handle) != nullptr) {
+            poll();
+        }
+        return COMMUNICATION_SUCCESS;
+    }
+    while (slot->state != SLOT_DONE) {
+        poll();
+    }
+    return slot->error;
+}
+
+bool AsyncRequestQueue::isDone(AsyncRequestHandle handle) const {
+    const Slot* slot = find(handle);
+    return slot != nullptr && slot->state == SLOT_DONE;
+}
+
+int AsyncRequestQueue::error(AsyncRequestHandle handle) const {
+    const Slot* slot = find(handle);
+    if (slot == nullptr) {
+        return COMMUNICATION_ERROR_INVALID_HANDLE;
+    }
+    return slot->state == SLOT_DONE ? slot->error : COMMUNICATION_ERROR_REQUEST_PENDING;
+}
+
+void AsyncRequestQueue::release(AsyncRequestHandle handle) {
+    Slot* slot = find(handle);
+    if (slot == nullptr) {
+        return;
+    }
+    if (slot->state == SLOT_SENT) {
+        slot->released = true; // freed by complete() once the response is in or timed out
+    } else {
+        slot->state = SLOT_FREE;
+    }
+}
+
+uint8_t AsyncRequestQueue::pending() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < ASYNC_REQUEST_SLOTS; i++) {
+        if (_slots[i].state == SLOT_QUEUED || _slots[i].state == SLOT_SENT) {
+            count++;
+        }
+    }
+    return count;
+}
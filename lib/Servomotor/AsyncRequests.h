@@ -0,0 +1,163 @@
+// AsyncRequests.h
+#ifndef ASYNC_REQUESTS_H
+#define ASYNC_REQUESTS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "Communication.h"
+#include "CommandCodec.h"
+
+// Non-blocking request/response on one RS485 bus.
+//
+// submit() encodes a request into a free slot and returns a handle straight away; poll() does the
+// rest without blocking: it puts the oldest queued request on the wire, collects response bytes as
+// they arrive, and completes the request (or times it out after its own timeout, counted from when
+// its frame went out). Call poll() from the main loop between other work, or wait() to block on one
+// handle.
+//
+// Requests to different devices can be outstanding at the same time, but the bus is half duplex
+// and the protocol has no request tags, so only one request is on the wire at any moment; the rest
+// wait in submission order. Broadcasts that draw several responses (DETECT_DEVICES to ALL_ALIAS)
+// are not supported here.
+//
+// Completion: with a callback, it is called once from poll() and the slot is freed after it
+// returns; without one the request stays done until take() or release().
+//
+// Memory is static: ASYNC_REQUEST_SLOTS slots, each holding one request frame and one response.
+
+#ifndef ASYNC_REQUEST_SLOTS
+#define ASYNC_REQUEST_SLOTS 8
+#endif
+#ifndef ASYNC_REQUEST_MAX_REQUEST_FRAME_SIZE
+#define ASYNC_REQUEST_MAX_REQUEST_FRAME_SIZE COMMUNICATION_TX_FRAME_BUFFER_SIZE
+#endif
+// Largest fixed-size response payload (GET_DEBUG_VALUES is 112 bytes)
+#ifndef ASYNC_REQUEST_MAX_RESPONSE_SIZE
+#define ASYNC_REQUEST_MAX_RESPONSE_SIZE 128
+#endif
+#ifndef ASYNC_REQUEST_DEFAULT_TIMEOUT_MS
+#define ASYNC_REQUEST_DEFAULT_TIMEOUT_MS 1000
+#endif
+
+typedef uint16_t AsyncRequestHandle;
+#define ASYNC_REQUEST_INVALID_HANDLE 0xFFFF
+
+// error is COMMUNICATION_SUCCESS, a COMMUNICATION_ERROR_* code or the device's error code. payload
+// (payloadSize bytes, the response struct for the command) is only valid during the call.
+typedef void (*AsyncRequestCallback)(void* context, AsyncRequestHandle handle, int error, const uint8_t* payload,
+                                     uint16_t payloadSize);
+
+class AsyncRequestQueue {
+public:
+    explicit AsyncRequestQueue(Communication& comm);
+
+    // Queues a request; returns ASYNC_REQUEST_INVALID_HANDLE if all slots are taken or the frame
+    // does not fit ASYNC_REQUEST_MAX_REQUEST_FRAME_SIZE. request may be nullptr for commands
+    // without a payload.
+    template <uint8_t CommandID>
+    AsyncRequestHandle submit(bool isExtendedAddress, uint64_t addressValue,
+                              const typename CommandTraits<CommandID>::Request* request,
+                              uint32_t timeoutMs = ASYNC_REQUEST_DEFAULT_TIMEOUT_MS,
+                              AsyncRequestCallback callback = nullptr, void* context = nullptr) {
+        typedef CommandTraits<CommandID> Traits;
+        static_assert(!Traits::kVariableResponse, "variable-length responses: use Communication::getResponseStream()");
+        static_assert(Traits::kResponseSize <= ASYNC_REQUEST_MAX_RESPONSE_SIZE,
+                      "response larger than ASYNC_REQUEST_MAX_RESPONSE_SIZE");
+        const int8_t index = allocate();
+        if (index < 0) {
+            return ASYNC_REQUEST_INVALID_HANDLE;
+        }
+        Slot& slot = _slots[index];
+        slot.requestFrameSize = encodeCommand<CommandID>(slot.requestFrame, sizeof(slot.requestFrame), isExtendedAddress,
+                                                         addressValue, request, _comm.isCRC32Enabled());
+        if (slot.requestFrameSize == 0) {
+            slot.state = SLOT_FREE;
+            return ASYNC_REQUEST_INVALID_HANDLE;
+        }
+        slot.expectedResponseSize = (uint16_t)Traits::kResponseSize;
+        return enqueue(index, timeoutMs, callback, context);
+    }
+
+    // Sends, receives and completes without blocking. Returns the number of requests not yet done.
+    uint8_t poll();
+
+    // Blocks (polling) until handle is done; returns its error without releasing it.
+    int wait(AsyncRequestHandle handle);
+
+    bool isDone(AsyncRequestHandle handle) const;
+    // Error of a done request; COMMUNICATION_ERROR_REQUEST_PENDING while it is not done yet,
+    // COMMUNICATION_ERROR_INVALID_HANDLE for a released or unknown handle
+    int error(AsyncRequestHandle handle) const;
+
+    // Copies the response of a done request (response may be nullptr) and frees the slot.
+    // Returns its error; a request that is not done yet is left alone (see error()).
+    template <uint8_t CommandID>
+    int take(AsyncRequestHandle handle, typename CommandTraits<CommandID>::Response* response) {
+        Slot* slot = find(handle);
+        if (slot == nullptr) {
+            return COMMUNICATION_ERROR_INVALID_HANDLE;
+        }
+        if (slot->state != SLOT_DONE) {
+            return COMMUNICATION_ERROR_REQUEST_PENDING;
+        }
+        const int result = slot->error;
+        if (result == COMMUNICATION_SUCCESS && response != nullptr && CommandTraits<CommandID>::kResponseSize != 0) {
+            if (slot->responseSize != sizeof(*response)) {
+                slot->state = SLOT_FREE;
+                return COMMUNICATION_ERROR_DATA_WRONG_SIZE;
+            }
+            memcpy((void*)response, slot->response, sizeof(*response));
+        }
+        slot->state = SLOT_FREE;
+        return result;
+    }
+
+    // Gives up on a request: a queued one is never sent, one on the wire has its response read and
+    // dropped, a done one is freed. The handle is invalid afterwards.
+    void release(AsyncRequestHandle handle);
+
+    // Requests submitted and not yet done (queued + on the wire)
+    uint8_t pending() const;
+
+private:
+    enum SlotState {
+        SLOT_FREE = 0,
+        SLOT_QUEUED,
+        SLOT_SENT,
+        SLOT_DONE,
+    };
+
+    struct Slot {
+        uint8_t state;
+        uint8_t generation;
+        bool released;                      // on the wire, but nobody wants the answer
+        uint32_t sequence;                  // submission order
+        uint32_t timeoutMs;
+        uint32_t sentAt;
+        AsyncRequestCallback callback;
+        void* context;
+        int error;
+        uint16_t requestFrameSize;
+        uint16_t expectedResponseSize;
+        uint16_t responseSize;
+        uint8_t requestFrame[ASYNC_REQUEST_MAX_REQUEST_FRAME_SIZE];
+        uint8_t response[ASYNC_REQUEST_MAX_RESPONSE_SIZE];
+    };
+
+    int8_t allocate();
+    AsyncRequestHandle enqueue(int8_t index, uint32_t timeoutMs, AsyncRequestCallback callback, void* context);
+    Slot* find(AsyncRequestHandle handle);
+    const Slot* find(AsyncRequestHandle handle) const;
+    AsyncRequestHandle handleOf(int8_t index) const;
+    void startNext();
+    void complete(int8_t index, int error, const uint8_t* payload, uint16_t payloadSize);
+
+    Communication& _comm;
+    Slot _slots[ASYNC_REQUEST_SLOTS];
+    uint32_t _nextSequence;
+    int8_t _onWire;                         // slot index, -1 if the bus is idle
+    FrameReceiver _receiver;
+    uint8_t _rxFrame[FRAME_MAX_SIZE_BYTES + 2 + ASYNC_REQUEST_MAX_RESPONSE_SIZE + FRAME_CRC32_BYTES];
+};
+
+#endif // ASYNC_REQUESTS_H
@@ -6,329 +6,228 @@
 
 float convertTime(float value, TimeUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case TimeUnit::TIMESTEPS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            case TimeUnit::SECONDS:
-                result = value * CONVERSION_FACTOR_SECONDS;
-                break;
-            case TimeUnit::MILLISECONDS:
-                result = value * CONVERSION_FACTOR_MILLISECONDS;
-                break;
-            case TimeUnit::MINUTES:
-                result = value * CONVERSION_FACTOR_MINUTES;
-                break;
-            case TimeUnit::MICROSECONDS:
-                result = value * CONVERSION_FACTOR_MICROSECONDS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case TimeUnit::TIMESTEPS:
+            return toInternal ? Units::Timesteps::toInternal(value) : Units::Timesteps::fromInternal(value);
+        case TimeUnit::SECONDS:
+            return toInternal ? Units::Seconds::toInternal(value) : Units::Seconds::fromInternal(value);
+        case TimeUnit::MILLISECONDS:
+            return toInternal ? Units::Milliseconds::toInternal(value) : Units::Milliseconds::fromInternal(value);
+        case TimeUnit::MINUTES:
+            return toInternal ? Units::Minutes::toInternal(value) : Units::Minutes::fromInternal(value);
+        case TimeUnit::MICROSECONDS:
+            return toInternal ? Units::Microseconds::toInternal(value) : Units::Microseconds::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case TimeUnit::TIMESTEPS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            case TimeUnit::SECONDS:
-                result = value / CONVERSION_FACTOR_SECONDS;
-                break;
-            case TimeUnit::MILLISECONDS:
-                result = value / CONVERSION_FACTOR_MILLISECONDS;
-                break;
-            case TimeUnit::MINUTES:
-                result = value / CONVERSION_FACTOR_MINUTES;
-                break;
-            case TimeUnit::MICROSECONDS:
-                result = value / CONVERSION_FACTOR_MICROSECONDS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+}
+
+float timeToInternalFactor(TimeUnit unit)
+{
+    switch (unit) {
+        case TimeUnit::TIMESTEPS:
+            return 1.0f;
+        case TimeUnit::SECONDS:
+            return CONVERSION_FACTOR_SECONDS;
+        case TimeUnit::MILLISECONDS:
+            return CONVERSION_FACTOR_MILLISECONDS;
+        case TimeUnit::MINUTES:
+            return CONVERSION_FACTOR_MINUTES;
+        case TimeUnit::MICROSECONDS:
+            return CONVERSION_FACTOR_MICROSECONDS;
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
 
 float convertPosition(float value, PositionUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case PositionUnit::SHAFT_ROTATIONS:
-                result = value * CONVERSION_FACTOR_SHAFT_ROTATIONS;
-                break;
-            case PositionUnit::DEGREES:
-                result = value * CONVERSION_FACTOR_DEGREES;
-                break;
-            case PositionUnit::RADIANS:
-                result = value * CONVERSION_FACTOR_RADIANS;
-                break;
-            case PositionUnit::ENCODER_COUNTS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case PositionUnit::SHAFT_ROTATIONS:
+            return toInternal ? Units::ShaftRotations::toInternal(value) : Units::ShaftRotations::fromInternal(value);
+        case PositionUnit::DEGREES:
+            return toInternal ? Units::Degrees::toInternal(value) : Units::Degrees::fromInternal(value);
+        case PositionUnit::RADIANS:
+            return toInternal ? Units::Radians::toInternal(value) : Units::Radians::fromInternal(value);
+        case PositionUnit::ENCODER_COUNTS:
+            return toInternal ? Units::EncoderCounts::toInternal(value) : Units::EncoderCounts::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case PositionUnit::SHAFT_ROTATIONS:
-                result = value / CONVERSION_FACTOR_SHAFT_ROTATIONS;
-                break;
-            case PositionUnit::DEGREES:
-                result = value / CONVERSION_FACTOR_DEGREES;
-                break;
-            case PositionUnit::RADIANS:
-                result = value / CONVERSION_FACTOR_RADIANS;
-                break;
-            case PositionUnit::ENCODER_COUNTS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+}
+
+float positionToInternalFactor(PositionUnit unit)
+{
+    switch (unit) {
+        case PositionUnit::SHAFT_ROTATIONS:
+            return CONVERSION_FACTOR_SHAFT_ROTATIONS;
+        case PositionUnit::DEGREES:
+            return CONVERSION_FACTOR_DEGREES;
+        case PositionUnit::RADIANS:
+            return CONVERSION_FACTOR_RADIANS;
+        case PositionUnit::ENCODER_COUNTS:
+            return 1.0f;
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
 
 float convertVelocity(float value, VelocityUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case VelocityUnit::ROTATIONS_PER_SECOND:
-                result = value * CONVERSION_FACTOR_ROTATIONS_PER_SECOND;
-                break;
-            case VelocityUnit::RPM:
-                result = value * CONVERSION_FACTOR_RPM;
-                break;
-            case VelocityUnit::DEGREES_PER_SECOND:
-                result = value * CONVERSION_FACTOR_DEGREES_PER_SECOND;
-                break;
-            case VelocityUnit::RADIANS_PER_SECOND:
-                result = value * CONVERSION_FACTOR_RADIANS_PER_SECOND;
-                break;
-            case VelocityUnit::COUNTS_PER_SECOND:
-                result = value * CONVERSION_FACTOR_COUNTS_PER_SECOND;
-                break;
-            case VelocityUnit::COUNTS_PER_TIMESTEP:
-                result = value * CONVERSION_FACTOR_COUNTS_PER_TIMESTEP;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case VelocityUnit::ROTATIONS_PER_SECOND:
+            return toInternal ? Units::RotationsPerSecond::toInternal(value) : Units::RotationsPerSecond::fromInternal(value);
+        case VelocityUnit::RPM:
+            return toInternal ? Units::Rpm::toInternal(value) : Units::Rpm::fromInternal(value);
+        case VelocityUnit::DEGREES_PER_SECOND:
+            return toInternal ? Units::DegreesPerSecond::toInternal(value) : Units::DegreesPerSecond::fromInternal(value);
+        case VelocityUnit::RADIANS_PER_SECOND:
+            return toInternal ? Units::RadiansPerSecond::toInternal(value) : Units::RadiansPerSecond::fromInternal(value);
+        case VelocityUnit::COUNTS_PER_SECOND:
+            return toInternal ? Units::CountsPerSecond::toInternal(value) : Units::CountsPerSecond::fromInternal(value);
+        case VelocityUnit::COUNTS_PER_TIMESTEP:
+            return toInternal ? Units::CountsPerTimestep::toInternal(value) : Units::CountsPerTimestep::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case VelocityUnit::ROTATIONS_PER_SECOND:
-                result = value / CONVERSION_FACTOR_ROTATIONS_PER_SECOND;
-                break;
-            case VelocityUnit::RPM:
-                result = value / CONVERSION_FACTOR_RPM;
-                break;
-            case VelocityUnit::DEGREES_PER_SECOND:
-                result = value / CONVERSION_FACTOR_DEGREES_PER_SECOND;
-                break;
-            case VelocityUnit::RADIANS_PER_SECOND:
-                result = value / CONVERSION_FACTOR_RADIANS_PER_SECOND;
-                break;
-            case VelocityUnit::COUNTS_PER_SECOND:
-                result = value / CONVERSION_FACTOR_COUNTS_PER_SECOND;
-                break;
-            case VelocityUnit::COUNTS_PER_TIMESTEP:
-                result = value / CONVERSION_FACTOR_COUNTS_PER_TIMESTEP;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+}
+
+float velocityToInternalFactor(VelocityUnit unit)
+{
+    switch (unit) {
+        case VelocityUnit::ROTATIONS_PER_SECOND:
+            return CONVERSION_FACTOR_ROTATIONS_PER_SECOND;
+        case VelocityUnit::RPM:
+            return CONVERSION_FACTOR_RPM;
+        case VelocityUnit::DEGREES_PER_SECOND:
+            return CONVERSION_FACTOR_DEGREES_PER_SECOND;
+        case VelocityUnit::RADIANS_PER_SECOND:
+            return CONVERSION_FACTOR_RADIANS_PER_SECOND;
+        case VelocityUnit::COUNTS_PER_SECOND:
+            return CONVERSION_FACTOR_COUNTS_PER_SECOND;
+        case VelocityUnit::COUNTS_PER_TIMESTEP:
+            return CONVERSION_FACTOR_COUNTS_PER_TIMESTEP;
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
 
 float convertAcceleration(float value, AccelerationUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case AccelerationUnit::ROTATIONS_PER_SECOND_SQUARED:
-                result = value * CONVERSION_FACTOR_ROTATIONS_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::RPM_PER_SECOND:
-                result = value * CONVERSION_FACTOR_RPM_PER_SECOND;
-                break;
-            case AccelerationUnit::DEGREES_PER_SECOND_SQUARED:
-                result = value * CONVERSION_FACTOR_DEGREES_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::RADIANS_PER_SECOND_SQUARED:
-                result = value * CONVERSION_FACTOR_RADIANS_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::COUNTS_PER_SECOND_SQUARED:
-                result = value * CONVERSION_FACTOR_COUNTS_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::COUNTS_PER_TIMESTEP_SQUARED:
-                result = value * CONVERSION_FACTOR_COUNTS_PER_TIMESTEP_SQUARED;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case AccelerationUnit::ROTATIONS_PER_SECOND_SQUARED:
+            return toInternal ? Units::RotationsPerSecondSquared::toInternal(value) : Units::RotationsPerSecondSquared::fromInternal(value);
+        case AccelerationUnit::RPM_PER_SECOND:
+            return toInternal ? Units::RpmPerSecond::toInternal(value) : Units::RpmPerSecond::fromInternal(value);
+        case AccelerationUnit::DEGREES_PER_SECOND_SQUARED:
+            return toInternal ? Units::DegreesPerSecondSquared::toInternal(value) : Units::DegreesPerSecondSquared::fromInternal(value);
+        case AccelerationUnit::RADIANS_PER_SECOND_SQUARED:
+            return toInternal ? Units::RadiansPerSecondSquared::toInternal(value) : Units::RadiansPerSecondSquared::fromInternal(value);
+        case AccelerationUnit::COUNTS_PER_SECOND_SQUARED:
+            return toInternal ? Units::CountsPerSecondSquared::toInternal(value) : Units::CountsPerSecondSquared::fromInternal(value);
+        case AccelerationUnit::COUNTS_PER_TIMESTEP_SQUARED:
+            return toInternal ? Units::CountsPerTimestepSquared::toInternal(value) : Units::CountsPerTimestepSquared::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case AccelerationUnit::ROTATIONS_PER_SECOND_SQUARED:
-                result = value / CONVERSION_FACTOR_ROTATIONS_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::RPM_PER_SECOND:
-                result = value / CONVERSION_FACTOR_RPM_PER_SECOND;
-                break;
-            case AccelerationUnit::DEGREES_PER_SECOND_SQUARED:
-                result = value / CONVERSION_FACTOR_DEGREES_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::RADIANS_PER_SECOND_SQUARED:
-                result = value / CONVERSION_FACTOR_RADIANS_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::COUNTS_PER_SECOND_SQUARED:
-                result = value / CONVERSION_FACTOR_COUNTS_PER_SECOND_SQUARED;
-                break;
-            case AccelerationUnit::COUNTS_PER_TIMESTEP_SQUARED:
-                result = value / CONVERSION_FACTOR_COUNTS_PER_TIMESTEP_SQUARED;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+}
+
+float accelerationToInternalFactor(AccelerationUnit unit)
+{
+    switch (unit) {
+        case AccelerationUnit::ROTATIONS_PER_SECOND_SQUARED:
+            return CONVERSION_FACTOR_ROTATIONS_PER_SECOND_SQUARED;
+        case AccelerationUnit::RPM_PER_SECOND:
+            return CONVERSION_FACTOR_RPM_PER_SECOND;
+        case AccelerationUnit::DEGREES_PER_SECOND_SQUARED:
+            return CONVERSION_FACTOR_DEGREES_PER_SECOND_SQUARED;
+        case AccelerationUnit::RADIANS_PER_SECOND_SQUARED:
+            return CONVERSION_FACTOR_RADIANS_PER_SECOND_SQUARED;
+        case AccelerationUnit::COUNTS_PER_SECOND_SQUARED:
+            return CONVERSION_FACTOR_COUNTS_PER_SECOND_SQUARED;
+        case AccelerationUnit::COUNTS_PER_TIMESTEP_SQUARED:
+            return CONVERSION_FACTOR_COUNTS_PER_TIMESTEP_SQUARED;
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
 
 float convertCurrent(float value, CurrentUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case CurrentUnit::INTERNAL_CURRENT_UNITS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            case CurrentUnit::MILLIAMPS:
-                result = value * CONVERSION_FACTOR_MILLIAMPS;
-                break;
-            case CurrentUnit::AMPS:
-                result = value * CONVERSION_FACTOR_AMPS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case CurrentUnit::INTERNAL_CURRENT_UNITS:
+            return toInternal ? Units::InternalCurrentUnits::toInternal(value) : Units::InternalCurrentUnits::fromInternal(value);
+        case CurrentUnit::MILLIAMPS:
+            return toInternal ? Units::Milliamps::toInternal(value) : Units::Milliamps::fromInternal(value);
+        case CurrentUnit::AMPS:
+            return toInternal ? Units::Amps::toInternal(value) : Units::Amps::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case CurrentUnit::INTERNAL_CURRENT_UNITS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            case CurrentUnit::MILLIAMPS:
-                result = value / CONVERSION_FACTOR_MILLIAMPS;
-                break;
-            case CurrentUnit::AMPS:
-                result = value / CONVERSION_FACTOR_AMPS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+}
+
+float currentToInternalFactor(CurrentUnit unit)
+{
+    switch (unit) {
+        case CurrentUnit::INTERNAL_CURRENT_UNITS:
+            return 1.0f;
+        case CurrentUnit::MILLIAMPS:
+            return CONVERSION_FACTOR_MILLIAMPS;
+        case CurrentUnit::AMPS:
+            return CONVERSION_FACTOR_AMPS;
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
 
 float convertVoltage(float value, VoltageUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case VoltageUnit::MILLIVOLTS:
-                result = value * CONVERSION_FACTOR_MILLIVOLTS;
-                break;
-            case VoltageUnit::VOLTS:
-                result = value * CONVERSION_FACTOR_VOLTS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case VoltageUnit::MILLIVOLTS:
+            return toInternal ? Units::Millivolts::toInternal(value) : Units::Millivolts::fromInternal(value);
+        case VoltageUnit::VOLTS:
+            return toInternal ? Units::Volts::toInternal(value) : Units::Volts::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case VoltageUnit::MILLIVOLTS:
-                result = value / CONVERSION_FACTOR_MILLIVOLTS;
-                break;
-            case VoltageUnit::VOLTS:
-                result = value / CONVERSION_FACTOR_VOLTS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+}
+
+float voltageToInternalFactor(VoltageUnit unit)
+{
+    switch (unit) {
+        case VoltageUnit::MILLIVOLTS:
+            return CONVERSION_FACTOR_MILLIVOLTS;
+        case VoltageUnit::VOLTS:
+            return CONVERSION_FACTOR_VOLTS;
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
 
 float convertTemperature(float value, TemperatureUnit unit, ConversionDirection direction)
 {
-    // Handle both simple conversions (multiplication/division) and complex conversions (with offsets)
-    float result = 0.0f;
-
-    // Step 1: Convert from user unit to internal unit if needed
-    if (direction == ConversionDirection::TO_INTERNAL) {
-        switch (unit) {
-            case TemperatureUnit::CELSIUS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            case TemperatureUnit::FAHRENHEIT:
-                result = (value + CONVERSION_OFFSET_FAHRENHEIT_TO_CELSIUS) * CONVERSION_FACTOR_FAHRENHEIT;
-                break;
-            case TemperatureUnit::KELVIN:
-                result = value + CONVERSION_OFFSET_KELVIN_TO_CELSIUS;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
-    }
-    // Step 2: Convert from internal unit to user unit if needed
-    else { // direction == ConversionDirection::FROM_INTERNAL
-        switch (unit) {
-            case TemperatureUnit::CELSIUS:
-                result = value; // Factor is 1.0, no conversion needed
-                break;
-            case TemperatureUnit::FAHRENHEIT:
-                result = (value / CONVERSION_FACTOR_FAHRENHEIT) + CONVERSION_OFFSET_CELSIUS_TO_FAHRENHEIT;
-                break;
-            case TemperatureUnit::KELVIN:
-                result = value + CONVERSION_OFFSET_CELSIUS_TO_KELVIN;
-                break;
-            default:
-                return 0.0f; // Invalid unit
-        }
+    // Dispatch the runtime unit to its compile-time tag (Units::*)
+    const bool toInternal = (direction == ConversionDirection::TO_INTERNAL);
+    switch (unit) {
+        case TemperatureUnit::CELSIUS:
+            return toInternal ? Units::Celsius::toInternal(value) : Units::Celsius::fromInternal(value);
+        case TemperatureUnit::FAHRENHEIT:
+            return toInternal ? Units::Fahrenheit::toInternal(value) : Units::Fahrenheit::fromInternal(value);
+        case TemperatureUnit::KELVIN:
+            return toInternal ? Units::Kelvin::toInternal(value) : Units::Kelvin::fromInternal(value);
+        default:
+            return 0.0f; // Invalid unit
     }
-    return result;
 }
-
@@ -57,6 +57,15 @@
 #define CONVERSION_OFFSET_KELVIN_TO_CELSIUS -273.150000000f
 #define CONVERSION_OFFSET_CELSIUS_TO_KELVIN 273.150000000f
 
+// Every unit exists twice: as an enumerator of its quantity's enum (runtime unit, e.g.
+// PositionUnit::DEGREES, used by convertPosition()) and as a tag type in namespace Units (compile-time
+// unit, e.g. Units::Degrees). A tag's toInternal()/fromInternal() are constexpr and inline to a
+// single multiply or divide (temperature units with an offset: one multiply-add), so loops that
+// know their units at compile time skip the per-value switch. The convert*() functions are thin
+// wrappers that dispatch the runtime unit to its tag; both paths give identical results.
+// *ToInternalFactor() return the same factor at runtime for the linear quantities so per-item loops
+// can look the unit up once.
+
 // Enum to specify the direction of unit conversion
 enum class ConversionDirection {
     TO_INTERNAL,    // Convert from user unit to internal unit
@@ -72,6 +81,40 @@ enum class TimeUnit {
 };
 
 float convertTime(float value, TimeUnit unit, ConversionDirection direction);
+float timeToInternalFactor(TimeUnit unit);
+
+namespace Units {
+struct Timesteps {
+    typedef TimeUnit Quantity;
+    static constexpr TimeUnit unit = TimeUnit::TIMESTEPS;
+    static constexpr float toInternal(float value) { return value; }
+    static constexpr float fromInternal(float value) { return value; }
+};
+struct Seconds {
+    typedef TimeUnit Quantity;
+    static constexpr TimeUnit unit = TimeUnit::SECONDS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_SECONDS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_SECONDS; }
+};
+struct Milliseconds {
+    typedef TimeUnit Quantity;
+    static constexpr TimeUnit unit = TimeUnit::MILLISECONDS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_MILLISECONDS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_MILLISECONDS; }
+};
+struct Minutes {
+    typedef TimeUnit Quantity;
+    static constexpr TimeUnit unit = TimeUnit::MINUTES;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_MINUTES; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_MINUTES; }
+};
+struct Microseconds {
+    typedef TimeUnit Quantity;
+    static constexpr TimeUnit unit = TimeUnit::MICROSECONDS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_MICROSECONDS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_MICROSECONDS; }
+};
+} // namespace Units
 
 enum class PositionUnit {
     SHAFT_ROTATIONS,
@@ -81,6 +124,34 @@ enum class PositionUnit {
 };
 
 float convertPosition(float value, PositionUnit unit, ConversionDirection direction);
+float positionToInternalFactor(PositionUnit unit);
+
+namespace Units {
+struct ShaftRotations {
+    typedef PositionUnit Quantity;
+    static constexpr PositionUnit unit = PositionUnit::SHAFT_ROTATIONS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_SHAFT_ROTATIONS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_SHAFT_ROTATIONS; }
+};
+struct Degrees {
+    typedef PositionUnit Quantity;
+    static constexpr PositionUnit unit = PositionUnit::DEGREES;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_DEGREES; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_DEGREES; }
+};
+struct Radians {
+    typedef PositionUnit Quantity;
+    static constexpr PositionUnit unit = PositionUnit::RADIANS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_RADIANS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_RADIANS; }
+};
+struct EncoderCounts {
+    typedef PositionUnit Quantity;
+    static constexpr PositionUnit unit = PositionUnit::ENCODER_COUNTS;
+    static constexpr float toInternal(float value) { return value; }
+    static constexpr float fromInternal(float value) { return value; }
+};
+} // namespace Units
 
 enum class VelocityUnit {
     ROTATIONS_PER_SECOND,
@@ -92,6 +163,46 @@ enum class VelocityUnit {
 };
 
 float convertVelocity(float value, VelocityUnit unit, ConversionDirection direction);
+float velocityToInternalFactor(VelocityUnit unit);
+
+namespace Units {
+struct RotationsPerSecond {
+    typedef VelocityUnit Quantity;
+    static constexpr VelocityUnit unit = VelocityUnit::ROTATIONS_PER_SECOND;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_ROTATIONS_PER_SECOND; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_ROTATIONS_PER_SECOND; }
+};
+struct Rpm {
+    typedef VelocityUnit Quantity;
+    static constexpr VelocityUnit unit = VelocityUnit::RPM;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_RPM; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_RPM; }
+};
+struct DegreesPerSecond {
+    typedef VelocityUnit Quantity;
+    static constexpr VelocityUnit unit = VelocityUnit::DEGREES_PER_SECOND;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_DEGREES_PER_SECOND; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_DEGREES_PER_SECOND; }
+};
+struct RadiansPerSecond {
+    typedef VelocityUnit Quantity;
+    static constexpr VelocityUnit unit = VelocityUnit::RADIANS_PER_SECOND;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_RADIANS_PER_SECOND; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_RADIANS_PER_SECOND; }
+};
+struct CountsPerSecond {
+    typedef VelocityUnit Quantity;
+    static constexpr VelocityUnit unit = VelocityUnit::COUNTS_PER_SECOND;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_COUNTS_PER_SECOND; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_COUNTS_PER_SECOND; }
+};
+struct CountsPerTimestep {
+    typedef VelocityUnit Quantity;
+    static constexpr VelocityUnit unit = VelocityUnit::COUNTS_PER_TIMESTEP;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_COUNTS_PER_TIMESTEP; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_COUNTS_PER_TIMESTEP; }
+};
+} // namespace Units
 
 enum class AccelerationUnit {
     ROTATIONS_PER_SECOND_SQUARED,
@@ -103,6 +214,46 @@ enum class AccelerationUnit {
 };
 
 float convertAcceleration(float value, AccelerationUnit unit, ConversionDirection direction);
+float accelerationToInternalFactor(AccelerationUnit unit);
+
+namespace Units {
+struct RotationsPerSecondSquared {
+    typedef AccelerationUnit Quantity;
+    static constexpr AccelerationUnit unit = AccelerationUnit::ROTATIONS_PER_SECOND_SQUARED;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_ROTATIONS_PER_SECOND_SQUARED; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_ROTATIONS_PER_SECOND_SQUARED; }
+};
+struct RpmPerSecond {
+    typedef AccelerationUnit Quantity;
+    static constexpr AccelerationUnit unit = AccelerationUnit::RPM_PER_SECOND;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_RPM_PER_SECOND; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_RPM_PER_SECOND; }
+};
+struct DegreesPerSecondSquared {
+    typedef AccelerationUnit Quantity;
+    static constexpr AccelerationUnit unit = AccelerationUnit::DEGREES_PER_SECOND_SQUARED;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_DEGREES_PER_SECOND_SQUARED; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_DEGREES_PER_SECOND_SQUARED; }
+};
+struct RadiansPerSecondSquared {
+    typedef AccelerationUnit Quantity;
+    static constexpr AccelerationUnit unit = AccelerationUnit::RADIANS_PER_SECOND_SQUARED;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_RADIANS_PER_SECOND_SQUARED; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_RADIANS_PER_SECOND_SQUARED; }
+};
+struct CountsPerSecondSquared {
+    typedef AccelerationUnit Quantity;
+    static constexpr AccelerationUnit unit = AccelerationUnit::COUNTS_PER_SECOND_SQUARED;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_COUNTS_PER_SECOND_SQUARED; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_COUNTS_PER_SECOND_SQUARED; }
+};
+struct CountsPerTimestepSquared {
+    typedef AccelerationUnit Quantity;
+    static constexpr AccelerationUnit unit = AccelerationUnit::COUNTS_PER_TIMESTEP_SQUARED;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_COUNTS_PER_TIMESTEP_SQUARED; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_COUNTS_PER_TIMESTEP_SQUARED; }
+};
+} // namespace Units
 
 enum class CurrentUnit {
     INTERNAL_CURRENT_UNITS,
@@ -111,6 +262,28 @@ enum class CurrentUnit {
 };
 
 float convertCurrent(float value, CurrentUnit unit, ConversionDirection direction);
+float currentToInternalFactor(CurrentUnit unit);
+
+namespace Units {
+struct InternalCurrentUnits {
+    typedef CurrentUnit Quantity;
+    static constexpr CurrentUnit unit = CurrentUnit::INTERNAL_CURRENT_UNITS;
+    static constexpr float toInternal(float value) { return value; }
+    static constexpr float fromInternal(float value) { return value; }
+};
+struct Milliamps {
+    typedef CurrentUnit Quantity;
+    static constexpr CurrentUnit unit = CurrentUnit::MILLIAMPS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_MILLIAMPS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_MILLIAMPS; }
+};
+struct Amps {
+    typedef CurrentUnit Quantity;
+    static constexpr CurrentUnit unit = CurrentUnit::AMPS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_AMPS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_AMPS; }
+};
+} // namespace Units
 
 enum class VoltageUnit {
     MILLIVOLTS,
@@ -118,6 +291,22 @@ enum class VoltageUnit {
 };
 
 float convertVoltage(float value, VoltageUnit unit, ConversionDirection direction);
+float voltageToInternalFactor(VoltageUnit unit);
+
+namespace Units {
+struct Millivolts {
+    typedef VoltageUnit Quantity;
+    static constexpr VoltageUnit unit = VoltageUnit::MILLIVOLTS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_MILLIVOLTS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_MILLIVOLTS; }
+};
+struct Volts {
+    typedef VoltageUnit Quantity;
+    static constexpr VoltageUnit unit = VoltageUnit::VOLTS;
+    static constexpr float toInternal(float value) { return value * CONVERSION_FACTOR_VOLTS; }
+    static constexpr float fromInternal(float value) { return value / CONVERSION_FACTOR_VOLTS; }
+};
+} // namespace Units
 
 enum class TemperatureUnit {
     CELSIUS,
@@ -127,4 +316,34 @@ enum class TemperatureUnit {
 
 float convertTemperature(float value, TemperatureUnit unit, ConversionDirection direction);
 
+namespace Units {
+struct Celsius {
+    typedef TemperatureUnit Quantity;
+    static constexpr TemperatureUnit unit = TemperatureUnit::CELSIUS;
+    static constexpr float toInternal(float value) { return value; }
+    static constexpr float fromInternal(float value) { return value; }
+};
+struct Fahrenheit {
+    typedef TemperatureUnit Quantity;
+    static constexpr TemperatureUnit unit = TemperatureUnit::FAHRENHEIT;
+    static constexpr float toInternal(float value) { return (value + CONVERSION_OFFSET_FAHRENHEIT_TO_CELSIUS) * CONVERSION_FACTOR_FAHRENHEIT; }
+    static constexpr float fromInternal(float value) { return (value / CONVERSION_FACTOR_FAHRENHEIT) + CONVERSION_OFFSET_CELSIUS_TO_FAHRENHEIT; }
+};
+struct Kelvin {
+    typedef TemperatureUnit Quantity;
+    static constexpr TemperatureUnit unit = TemperatureUnit::KELVIN;
+    static constexpr float toInternal(float value) { return value + CONVERSION_OFFSET_KELVIN_TO_CELSIUS; }
+    static constexpr float fromInternal(float value) { return value + CONVERSION_OFFSET_CELSIUS_TO_KELVIN; }
+};
+} // namespace Units
+namespace Units {
+// SameQuantity<A, B>::value is true when A and B are the same quantity enum; used to reject a tag of
+// the wrong quantity (e.g. Units::Degrees where a velocity unit is expected) at compile time.
+template <typename A, typename B> struct SameQuantity { static constexpr bool value = false; };
+template <typename A> struct SameQuantity<A, A> { static constexpr bool value = true; };
+
+template <typename UnitTag> constexpr float toInternal(float value) { return UnitTag::toInternal(value); }
+template <typename UnitTag> constexpr float fromInternal(float value) { return UnitTag::fromInternal(value); }
+} // namespace Units
+
 #endif // AUTO_GENERATED_UNIT_CONVERSIONS_H
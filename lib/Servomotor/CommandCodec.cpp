@@ -0,0 +1,203 @@
+// CommandCodec.cpp
+#include "CommandCodec.h"
+#include "Communication.h"
+
+FrameWriter::FrameWriter(uint8_t* buffer, uint16_t capacity)
+    : _buffer(buffer), _capacity(capacity), _length(0), _bodyEnd(0), _crc(CRC32_INITIAL_VALUE),
+      _crc32Enabled(false), _ok(false) {
+}
+
+// Writes the size byte(s) for a frame whose body (everything after the size bytes, excluding the
+// CRC32) is bodySize bytes. Same size rules as Communication::sendCommandCore().
+bool FrameWriter::beginFrame(uint16_t bodySize, bool crc32Enabled) {
+    _length = 0;
+    _crc = CRC32_INITIAL_VALUE;
+    _crc32Enabled = crc32Enabled;
+    _ok = true;
+
+    uint32_t totalPacketSize = 1 + (uint32_t)bodySize + (crc32Enabled ? FRAME_CRC32_BYTES : 0);
+    uint16_t sizeBytes = 1;
+    if (totalPacketSize > DECODED_FIRST_BYTE_EXTENDED_SIZE) {
+        totalPacketSize += sizeof(uint16_t);
+        sizeBytes = 3;
+    }
+    if (totalPacketSize > 0xFFFFu || totalPacketSize > _capacity) {
+        _ok = false;
+        return false;
+    }
+    _bodyEnd = (uint16_t)(totalPacketSize - (crc32Enabled ? FRAME_CRC32_BYTES : 0));
+    if (sizeBytes == 1) {
+        const uint8_t sizeByte = encodeFirstByte((uint8_t)totalPacketSize);
+        put(&sizeByte, 1);
+    } else {
+        const uint8_t sizeByte = encodeFirstByte(DECODED_FIRST_BYTE_EXTENDED_SIZE);
+        const uint16_t size16Bit = (uint16_t)totalPacketSize;
+        put(&sizeByte, 1);
+        put(&size16Bit, sizeof(size16Bit));
+    }
+    return true;
+}
+
+bool FrameWriter::beginCommand(bool isExtendedAddress, uint64_t addressValue, uint8_t commandID, uint16_t payloadSize,
+                               bool crc32Enabled) {
+    const uint16_t addressSize = isExtendedAddress ? (sizeof(uint8_t) + sizeof(uint64_t)) : sizeof(uint8_t);
+    if (!beginFrame((uint16_t)(addressSize + sizeof(commandID) + payloadSize), crc32Enabled)) {
+        return false;
+    }
+    if (isExtendedAddress) {
+        const uint8_t extendedAddrByte = EXTENDED_ADDRESSING;
+        put(&extendedAddrByte, sizeof(extendedAddrByte));
+        put(&addressValue, sizeof(addressValue));
+    } else {
+        const uint8_t alias = (uint8_t)addressValue;
+        put(&alias, sizeof(alias));
+    }
+    put(&commandID, sizeof(commandID));
+    return true;
+}
+
+bool FrameWriter::beginResponse(uint8_t errorCode, uint16_t payloadSize, bool crc32Enabled) {
+    if (!beginFrame((uint16_t)(2 + payloadSize), crc32Enabled)) {
+        return false;
+    }
+    const uint8_t responseChar = crc32Enabled ? RESPONSE_CHARACTER_CRC32_ENABLED : RESPONSE_CHARACTER_CRC32_DISABLED;
+    put(&responseChar, sizeof(responseChar));
+    put(&errorCode, sizeof(errorCode));
+    return true;
+}
+
+void FrameWriter::append(const void* data, uint16_t length) {
+    if (length == 0) {
+        return;
+    }
+    if (!_ok || data == nullptr || (uint32_t)_length + length > _bodyEnd) {
+        _ok = false;
+        return;
+    }
+    put(data, length);
+}
+
+uint16_t FrameWriter::finish() {
+    if (!_ok || _length != _bodyEnd) {
+        return 0;
+    }
+    if (_crc32Enabled) {
+        const uint32_t crc = ~_crc;
+        memcpy(_buffer + _length, &crc, sizeof(crc));
+        _length += sizeof(crc);
+    }
+    _ok = false; // one frame per begin*()
+    return _length;
+}
+
+void FrameWriter::put(const void* data, uint16_t length) {
+    memcpy(_buffer + _length, data, length);
+    if (_crc32Enabled) {
+        _crc = crc32_update(_crc, _buffer + _length, length);
+    }
+    _length += length;
+}
+
+uint16_t frameSizeFromHeader(const uint8_t* frame, uint16_t available) {
+    if (available < 1 || !isValidFirstByteFormat(frame[0])) {
+        return 0;
+    }
+    const uint8_t decodedSize = decodeFirstByte(frame[0]);
+    if (decodedSize != DECODED_FIRST_BYTE_EXTENDED_SIZE) {
+        return decodedSize;
+    }
+    if (available < 3) {
+        return 0;
+    }
+    return (uint16_t)(frame[1] | (frame[2] << 8));
+}
+
+// Size header + CRC32 checks shared by both frame directions. On success *bodyStart is the offset of
+// the first byte after the size header.
+static int16_t checkFrame(const uint8_t* frame, uint16_t frameSize, bool hasCrc32, uint16_t* bodyStart) {
+    if (frameSize < 1 || !isValidFirstByteFormat(frame[0])) {
+        return COMMUNICATION_ERROR_BAD_FIRST_BYTE;
+    }
+    const uint16_t sizeByteCount = (decodeFirstByte(frame[0]) == DECODED_FIRST_BYTE_EXTENDED_SIZE) ? 3 : 1;
+    if (frameSize < sizeByteCount) {
+        return COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+    }
+    if (frameSizeFromHeader(frame, frameSize) != frameSize) {
+        return COMMUNICATION_ERROR_DATA_WRONG_SIZE;
+    }
+    if (frameSize < sizeByteCount + 1 + (hasCrc32 ? FRAME_CRC32_BYTES : 0)) {
+        return COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+    }
+    if (hasCrc32) {
+        uint32_t received;
+        memcpy(&received, frame + frameSize - FRAME_CRC32_BYTES, sizeof(received));
+        const uint32_t calculated = ~crc32_update(CRC32_INITIAL_VALUE, frame, frameSize - FRAME_CRC32_BYTES);
+        if (calculated != received) {
+            return COMMUNICATION_ERROR_CRC32_MISMATCH;
+        }
+    }
+    *bodyStart = sizeByteCount;
+    return COMMUNICATION_SUCCESS;
+}
+
+int16_t parseResponse(const uint8_t* frame, uint16_t frameSize, ResponseView* view) {
+    view->errorCode = 0;
+    view->payload = nullptr;
+    view->payloadSize = 0;
+    if (frameSize < 1 || !isValidFirstByteFormat(frame[0])) {
+        return COMMUNICATION_ERROR_BAD_FIRST_BYTE;
+    }
+    // The response character says whether a CRC32 follows
+    const uint16_t sizeByteCount = (decodeFirstByte(frame[0]) == DECODED_FIRST_BYTE_EXTENDED_SIZE) ? 3 : 1;
+    if (frameSize <= sizeByteCount) {
+        return COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+    }
+    const uint8_t responseChar = frame[sizeByteCount];
+    if ((responseChar != RESPONSE_CHARACTER_CRC32_ENABLED) && (responseChar != RESPONSE_CHARACTER_CRC32_DISABLED)) {
+        return COMMUNICATION_ERROR_BAD_RESPONSE_CHAR;
+    }
+    const bool hasCrc32 = (responseChar == RESPONSE_CHARACTER_CRC32_ENABLED);
+    uint16_t bodyStart;
+    const int16_t error = checkFrame(frame, frameSize, hasCrc32, &bodyStart);
+    if (error != COMMUNICATION_SUCCESS) {
+        return error;
+    }
+    uint16_t pos = bodyStart + 1;
+    const uint16_t end = frameSize - (hasCrc32 ? FRAME_CRC32_BYTES : 0);
+    if (pos < end) {
+        view->errorCode = frame[pos++];
+        if (view->errorCode != 0) {
+            return view->errorCode;
+        }
+    }
+    view->payload = frame + pos;
+    view->payloadSize = end - pos;
+    return COMMUNICATION_SUCCESS;
+}
+
+int16_t parseCommand(const uint8_t* frame, uint16_t frameSize, bool crc32Enabled, CommandView* view) {
+    memset(view, 0, sizeof(*view));
+    uint16_t pos;
+    const int16_t error = checkFrame(frame, frameSize, crc32Enabled, &pos);
+    if (error != COMMUNICATION_SUCCESS) {
+        return error;
+    }
+    const uint16_t end = frameSize - (crc32Enabled ? FRAME_CRC32_BYTES : 0);
+    if (frame[pos] == EXTENDED_ADDRESSING) {
+        if (end - pos < 1 + (int)sizeof(uint64_t) + 1) {
+            return COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+        }
+        view->isExtendedAddress = true;
+        memcpy(&view->uniqueId, frame + pos + 1, sizeof(view->uniqueId));
+        pos += 1 + sizeof(uint64_t);
+    } else {
+        if (end - pos < 2) {
+            return COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+        }
+        view->alias = frame[pos++];
+    }
+    view->commandID = frame[pos++];
+    view->payload = frame + pos;
+    view->payloadSize = end - pos;
+    return COMMUNICATION_SUCCESS;
+}
@@ -0,0 +1,223 @@
+// CommandCodec.h
+#ifndef COMMAND_CODEC_H
+#define COMMAND_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Commands.h"
+#include "CommandPayloads.h"
+
+// Typed frame builder/parser for the servomotor protocol.
+//
+// FrameWriter serializes a whole frame (size bytes, address, command ID, payload, CRC32) into one
+// caller-provided buffer and updates the CRC as each piece is appended, so the frame can go out in
+// a single write. parseResponse()/parseCommand() validate a received frame and point into it
+// (no copy); responseAs<CommandID>() reinterprets the payload as the command's response struct.
+//
+// Payload structs are packed and sent as their in-memory bytes, so this path assumes a
+// little-endian host (every supported Arduino target and desktop builds are).
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "CommandCodec.h sends packed payload structs as is and needs a little-endian host"
+#endif
+
+// Placeholder for "no payload" in the command table
+struct NoPayload {};
+
+template <typename T> struct PayloadSize { static constexpr uint16_t value = sizeof(T); };
+template <> struct PayloadSize<NoPayload> { static constexpr uint16_t value = 0; };
+
+// Largest size header (encoded size byte + 16-bit extended size), address (extended addressing flag
+// + unique ID), command/response character, error code and CRC32.
+#define FRAME_MAX_SIZE_BYTES 3
+#define FRAME_MAX_ADDRESS_BYTES 9
+#define FRAME_CRC32_BYTES 4
+
+// Command table: command ID -> request payload, response payload.
+// X(commandID, requestType, responseType)
+#define SERVOMOTOR_COMMAND_TABLE(X) \
+    X(DISABLE_MOSFETS, NoPayload, NoPayload) \
+    X(ENABLE_MOSFETS, NoPayload, NoPayload) \
+    X(TRAPEZOID_MOVE, trapezoidMovePayload, NoPayload) \
+    X(SET_MAXIMUM_VELOCITY, setMaximumVelocityPayload, NoPayload) \
+    X(GO_TO_POSITION, goToPositionPayload, NoPayload) \
+    X(SET_MAXIMUM_ACCELERATION, setMaximumAccelerationPayload, NoPayload) \
+    X(START_CALIBRATION, NoPayload, NoPayload) \
+    X(CAPTURE_HALL_SENSOR_DATA, captureHallSensorDataPayload, captureHallSensorDataResponse) \
+    X(RESET_TIME, NoPayload, NoPayload) \
+    X(GET_CURRENT_TIME, NoPayload, getCurrentTimeResponse) \
+    X(TIME_SYNC, timeSyncPayload, timeSyncResponse) \
+    X(GET_N_QUEUED_ITEMS, NoPayload, getNQueuedItemsResponse) \
+    X(EMERGENCY_STOP, NoPayload, NoPayload) \
+    X(ZERO_POSITION, NoPayload, NoPayload) \
+    X(HOMING, homingPayload, NoPayload) \
+    X(GET_HALL_SENSOR_POSITION, NoPayload, getHallSensorPositionResponse) \
+    X(GET_STATUS, NoPayload, getStatusResponse) \
+    X(GO_TO_CLOSED_LOOP, NoPayload, NoPayload) \
+    X(GET_PRODUCT_SPECS, NoPayload, getProductSpecsResponse) \
+    X(MOVE_WITH_ACCELERATION, moveWithAccelerationPayload, NoPayload) \
+    X(DETECT_DEVICES, NoPayload, detectDevicesResponse) \
+    X(SET_DEVICE_ALIAS, setDeviceAliasPayload, NoPayload) \
+    X(GET_PRODUCT_INFO, NoPayload, getProductInfoResponse) \
+    X(FIRMWARE_UPGRADE, firmwareUpgradePayload, NoPayload) \
+    X(GET_PRODUCT_DESCRIPTION, NoPayload, getProductDescriptionResponse) \
+    X(GET_FIRMWARE_VERSION, NoPayload, getFirmwareVersionResponse) \
+    X(MOVE_WITH_VELOCITY, moveWithVelocityPayload, NoPayload) \
+    X(SYSTEM_RESET, NoPayload, NoPayload) \
+    X(SET_MAXIMUM_MOTOR_CURRENT, setMaximumMotorCurrentPayload, NoPayload) \
+    X(MULTIMOVE, multimovePayload, NoPayload) \
+    X(SET_SAFETY_LIMITS, setSafetyLimitsPayload, NoPayload) \
+    X(PING, pingPayload, pingResponse) \
+    X(CONTROL_HALL_SENSOR_STATISTICS, controlHallSensorStatisticsPayload, NoPayload) \
+    X(GET_HALL_SENSOR_STATISTICS, NoPayload, getHallSensorStatisticsResponse) \
+    X(GET_POSITION, NoPayload, getPositionResponse) \
+    X(READ_MULTIPURPOSE_BUFFER, NoPayload, readMultipurposeBufferResponse) \
+    X(TEST_MODE, testModePayload, NoPayload) \
+    X(GET_COMPREHENSIVE_POSITION, NoPayload, getComprehensivePositionResponse) \
+    X(GET_SUPPLY_VOLTAGE, NoPayload, getSupplyVoltageResponse) \
+    X(GET_MAX_PID_ERROR, NoPayload, getMaxPidErrorResponse) \
+    X(VIBRATE, vibratePayload, NoPayload) \
+    X(IDENTIFY, NoPayload, NoPayload) \
+    X(GET_TEMPERATURE, NoPayload, getTemperatureResponse) \
+    X(SET_PID_CONSTANTS, setPidConstantsPayload, NoPayload) \
+    X(SET_MAX_ALLOWABLE_POSITION_DEVIATION, setMaxAllowablePositionDeviationPayload, NoPayload) \
+    X(GET_DEBUG_VALUES, NoPayload, getDebugValuesResponse) \
+    X(CRC32_CONTROL, crc32ControlPayload, NoPayload) \
+    X(GET_COMMUNICATION_STATISTICS, getCommunicationStatisticsPayload, getCommunicationStatisticsResponse)
+
+// Per-command exceptions to the fixed-size defaults.
+// MULTIMOVE sends only the used entries of moveList.
+template <uint8_t CommandID, typename RequestType> struct CommandRequestSize {
+    static uint16_t get(const RequestType*) { return PayloadSize<RequestType>::value; }
+};
+template <> struct CommandRequestSize<MULTIMOVE, multimovePayload> {
+    static uint16_t get(const multimovePayload* request) {
+        const uint8_t moveCount = (request->moveCount <= 32) ? request->moveCount : 32;
+        return (uint16_t)(sizeof(request->moveCount) + sizeof(request->moveTypes) + moveCount * sizeof(multimoveList_t));
+    }
+};
+// Capture and multipurpose-buffer responses are a variable number of bytes.
+template <uint8_t CommandID> struct CommandVariableResponse { static constexpr bool value = false; };
+template <> struct CommandVariableResponse<CAPTURE_HALL_SENSOR_DATA> { static constexpr bool value = true; };
+template <> struct CommandVariableResponse<READ_MULTIPURPOSE_BUFFER> { static constexpr bool value = true; };
+
+template <uint8_t CommandID, typename RequestType, typename ResponseType>
+struct CommandTraitsBase {
+    typedef RequestType Request;
+    typedef ResponseType Response;
+    static constexpr uint16_t kRequestSize = PayloadSize<RequestType>::value;
+    static constexpr uint16_t kResponseSize = PayloadSize<ResponseType>::value;
+    // Response payload length varies per call (kResponseSize is then the element size)
+    static constexpr bool kVariableResponse = CommandVariableResponse<CommandID>::value;
+    static constexpr uint16_t kMaxRequestFrameSize =
+        FRAME_MAX_SIZE_BYTES + FRAME_MAX_ADDRESS_BYTES + 1 + kRequestSize + FRAME_CRC32_BYTES;
+    static constexpr uint16_t kMaxResponseFrameSize =
+        FRAME_MAX_SIZE_BYTES + 1 + 1 + kResponseSize + FRAME_CRC32_BYTES;
+    // Payload bytes actually sent for this request
+    static uint16_t requestSize(const RequestType* request) { return CommandRequestSize<CommandID, RequestType>::get(request); }
+};
+
+template <uint8_t CommandID> struct CommandTraits;
+
+#define SERVOMOTOR_COMMAND_TRAITS(commandID, requestType, responseType) \
+    template <> struct CommandTraits<commandID> : CommandTraitsBase<commandID, requestType, responseType> {};
+SERVOMOTOR_COMMAND_TABLE(SERVOMOTOR_COMMAND_TRAITS)
+#undef SERVOMOTOR_COMMAND_TRAITS
+
+// Serializes one frame into a caller-provided buffer. The CRC32 (when enabled) is updated as the
+// bytes are appended, so finish() only has to append it.
+//   FrameWriter w(buf, sizeof(buf));
+//   w.beginCommand(false, alias, GET_POSITION, 0, true);
+//   uint16_t n = w.finish();   // 0 on overflow or if the payload length did not match
+class FrameWriter {
+public:
+    FrameWriter(uint8_t* buffer, uint16_t capacity);
+
+    // Host -> device: size byte(s), alias or extended address + unique ID, command ID.
+    // payloadSize is the exact number of bytes that append() will add.
+    bool beginCommand(bool isExtendedAddress, uint64_t addressValue, uint8_t commandID, uint16_t payloadSize,
+                      bool crc32Enabled);
+    // Device -> host: size byte(s), response character, error code byte.
+    bool beginResponse(uint8_t errorCode, uint16_t payloadSize, bool crc32Enabled);
+
+    void append(const void* data, uint16_t length);
+    uint16_t finish();
+
+private:
+    bool beginFrame(uint16_t bodySize, bool crc32Enabled);
+    void put(const void* data, uint16_t length);
+
+    uint8_t* _buffer;
+    uint16_t _capacity;
+    uint16_t _length;
+    uint16_t _bodyEnd;
+    uint32_t _crc;
+    bool _crc32Enabled;
+    bool _ok;
+};
+
+// A validated response frame. payload points into the frame buffer.
+struct ResponseView {
+    uint8_t errorCode;
+    const uint8_t* payload;
+    uint16_t payloadSize;
+};
+
+// A validated command frame as a device sees it. payload points into the frame buffer.
+struct CommandView {
+    bool isExtendedAddress;
+    uint8_t alias;
+    uint64_t uniqueId;
+    uint8_t commandID;
+    const uint8_t* payload;
+    uint16_t payloadSize;
+};
+
+// Total frame length announced by the size byte(s); 0 if the first byte is invalid or more bytes are
+// needed (available < 3 for an extended size).
+uint16_t frameSizeFromHeader(const uint8_t* frame, uint16_t available);
+
+// Validates size, response character, CRC32 (if the response says it carries one) and the error
+// code byte. Returns COMMUNICATION_SUCCESS, a COMMUNICATION_ERROR_* code, or the device's error code
+// (same codes as Communication::getResponse()).
+int16_t parseResponse(const uint8_t* frame, uint16_t frameSize, ResponseView* view);
+
+// Device side: validates size, address and (if crc32Enabled) the CRC32 of a command frame.
+int16_t parseCommand(const uint8_t* frame, uint16_t frameSize, bool crc32Enabled, CommandView* view);
+
+// Builds the command frame for CommandID. request may be nullptr for commands without a payload.
+// Returns the frame length, or 0 if it does not fit.
+template <uint8_t CommandID>
+uint16_t encodeCommand(uint8_t* buffer, uint16_t capacity, bool isExtendedAddress, uint64_t addressValue,
+                       const typename CommandTraits<CommandID>::Request* request, bool crc32Enabled) {
+    typedef CommandTraits<CommandID> Traits;
+    const uint16_t payloadSize = (Traits::kRequestSize != 0 && request != nullptr) ? Traits::requestSize(request) : 0;
+    if (Traits::kRequestSize != 0 && request == nullptr) {
+        return 0;
+    }
+    FrameWriter writer(buffer, capacity);
+    if (!writer.beginCommand(isExtendedAddress, addressValue, CommandID, payloadSize, crc32Enabled)) {
+        return 0;
+    }
+    writer.append(request, payloadSize);
+    return writer.finish();
+}
+
+// The response payload of a parsed frame as CommandID's response struct, in place; nullptr if the
+// size does not match (or the command has no response payload). Variable-length responses must hold
+// at least one element.
+template <uint8_t CommandID>
+const typename CommandTraits<CommandID>::Response* responseAs(const ResponseView& view) {
+    typedef CommandTraits<CommandID> Traits;
+    if (Traits::kResponseSize == 0) {
+        return nullptr;
+    }
+    const bool sizeOk = Traits::kVariableResponse ? (view.payloadSize >= Traits::kResponseSize)
+                                                  : (view.payloadSize == Traits::kResponseSize);
+    if (!sizeOk) {
+        return nullptr;
+    }
+    return reinterpret_cast<const typename CommandTraits<CommandID>::Response*>(view.payload);
+}
+
+#endif // COMMAND_CODEC_H
@@ -0,0 +1,315 @@
+// CommandPayloads.h
+// This file was autogenerated by generate_command_code_new2.py on Dec 28 2025 11:10:46
+// Do not edit manually. If changes are needed, modify the generator program instead.
+
+#ifndef COMMAND_PAYLOADS_H
+#define COMMAND_PAYLOADS_H
+
+#include <stdint.h>
+#include "DataTypes.h"
+#include "MultimoveConversion.h"
+
+// AUTO-GENERATED DATA STRUCTURES
+// (multimoveList_t / multimoveListConverted_t live in MultimoveConversion.h)
+
+// Structure for Trapezoid move command payload
+typedef struct __attribute__((__packed__)) {
+    int32_t displacement;
+    uint32_t duration;
+} trapezoidMovePayload;
+
+// Structure for Set maximum velocity command payload
+typedef struct __attribute__((__packed__)) {
+    uint32_t maximumVelocity;
+} setMaximumVelocityPayload;
+
+// Structure for Go to position command payload
+typedef struct __attribute__((__packed__)) {
+    int32_t position;
+    uint32_t duration;
+} goToPositionPayload;
+
+// Structure for Set maximum acceleration command payload
+typedef struct __attribute__((__packed__)) {
+    uint32_t maximumAcceleration;
+} setMaximumAccelerationPayload;
+
+// Structure for Capture hall sensor data command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t captureType;
+    uint32_t nPointsToRead;
+    uint8_t channelsToCaptureBitmask;
+    uint16_t timeStepsPerSample;
+    uint16_t nSamplesToSum;
+    uint16_t divisionFactor;
+} captureHallSensorDataPayload;
+
+// Structure for Capture hall sensor data command response
+typedef struct __attribute__((__packed__)) {
+    uint8_t data;
+} captureHallSensorDataResponse;
+
+// Structure for Get current time command response
+typedef struct __attribute__((__packed__)) {
+    uint64_t currentTime;
+} getCurrentTimeResponse;
+
+// Structure for Time sync command payload
+typedef struct __attribute__((__packed__)) {
+    uint32_t masterTime;
+} timeSyncPayload;
+
+// Structure for Time sync command response
+typedef struct __attribute__((__packed__)) {
+    int32_t timeError;
+    uint16_t rccIcscr;
+} timeSyncResponse;
+
+// Structure for Get n queued items command response
+typedef struct __attribute__((__packed__)) {
+    uint8_t queueSize;
+} getNQueuedItemsResponse;
+
+// Structure for Homing command payload
+typedef struct __attribute__((__packed__)) {
+    int32_t maxDistance;
+    uint32_t maxDuration;
+} homingPayload;
+
+// Structure for Get hall sensor position command response
+typedef struct __attribute__((__packed__)) {
+    int64_t hallSensorPosition;
+} getHallSensorPositionResponse;
+
+// Structure for Get status command response
+typedef struct __attribute__((__packed__)) {
+    uint16_t statusFlags;
+    uint8_t fatalErrorCode;
+} getStatusResponse;
+
+// Structure for Get product specs command response
+typedef struct __attribute__((__packed__)) {
+    uint32_t updateFrequency;
+    uint32_t countsPerRotation;
+} getProductSpecsResponse;
+
+// Structure for Move with acceleration command payload
+typedef struct __attribute__((__packed__)) {
+    int32_t acceleration;
+    uint32_t timeSteps;
+} moveWithAccelerationPayload;
+
+// Structure for Detect devices command response
+typedef struct __attribute__((__packed__)) {
+    uint64_t uniqueId;
+    uint8_t alias;
+} detectDevicesResponse;
+
+// Structure for Set device alias command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t alias;
+} setDeviceAliasPayload;
+
+// Structure for Get product info command response
+typedef struct __attribute__((__packed__)) {
+    char productCode[8];
+    uint8_t firmwareCompatibility;
+    VersionNumber24 hardwareVersion;
+    uint32_t serialNumber;
+    uint64_t uniqueId;
+    uint32_t reserved;
+} getProductInfoResponse;
+
+// Structure for Firmware upgrade command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t firmwarePage[2058];
+} firmwareUpgradePayload;
+
+// Structure for Get product description command response
+typedef struct __attribute__((__packed__)) {
+    char productDescription[32];
+} getProductDescriptionResponse;
+
+// Structure for Get firmware version command response
+typedef struct __attribute__((__packed__)) {
+    VersionNumber32 firmwareVersion;
+    uint8_t inBootloader;
+} getFirmwareVersionResponse;
+
+// Structure for Move with velocity command payload
+typedef struct __attribute__((__packed__)) {
+    int32_t velocity;
+    uint32_t duration;
+} moveWithVelocityPayload;
+
+// Structure for Set maximum motor current command payload
+typedef struct __attribute__((__packed__)) {
+    uint16_t motorCurrent;
+    uint16_t regenerationCurrent;
+} setMaximumMotorCurrentPayload;
+
+// Structure for Multimove command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t moveCount;
+    uint32_t moveTypes;
+    multimoveList_t moveList[32];
+} multimovePayload;
+
+// Structure for Set safety limits command payload
+typedef struct __attribute__((__packed__)) {
+    int64_t lowerLimit;
+    int64_t upperLimit;
+} setSafetyLimitsPayload;
+
+// Structure for Ping command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t pingData[10];
+} pingPayload;
+
+// Structure for Ping command response
+typedef struct __attribute__((__packed__)) {
+    uint8_t responsePayload[10];
+} pingResponse;
+
+// Structure for Control hall sensor statistics command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t control;
+} controlHallSensorStatisticsPayload;
+
+// Structure for Get hall sensor statistics command response
+typedef struct __attribute__((__packed__)) {
+    uint16_t maxHall1;
+    uint16_t maxHall2;
+    uint16_t maxHall3;
+    uint16_t minHall1;
+    uint16_t minHall2;
+    uint16_t minHall3;
+    uint64_t sumHall1;
+    uint64_t sumHall2;
+    uint64_t sumHall3;
+    uint32_t measurementCount;
+} getHallSensorStatisticsResponse;
+
+// Structure for Get position command response
+typedef struct __attribute__((__packed__)) {
+    int64_t position;
+} getPositionResponse;
+
+// Structure for Read multipurpose buffer command response
+typedef struct __attribute__((__packed__)) {
+    uint8_t bufferData;
+} readMultipurposeBufferResponse;
+
+// Structure for Test mode command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t testMode;
+} testModePayload;
+
+// Structure for Get comprehensive position command response
+typedef struct __attribute__((__packed__)) {
+    int64_t commandedPosition;
+    int64_t hallSensorPosition;
+    int32_t externalEncoderPosition;
+} getComprehensivePositionResponse;
+
+// Structure for converted Get comprehensive position values
+typedef struct {
+    float commandedPosition;
+    float hallSensorPosition;
+    float externalEncoderPosition;
+} getComprehensivePositionResponseConverted;
+
+// Structure for Get supply voltage command response
+typedef struct __attribute__((__packed__)) {
+    uint16_t supplyVoltage;
+} getSupplyVoltageResponse;
+
+// Structure for Get max PID error command response
+typedef struct __attribute__((__packed__)) {
+    int32_t minPidError;
+    int32_t maxPidError;
+} getMaxPidErrorResponse;
+
+// Structure for converted Get max PID error values
+typedef struct {
+    float minPidError;
+    float maxPidError;
+} getMaxPidErrorResponseConverted;
+
+// Structure for Vibrate command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t vibrationLevel;
+} vibratePayload;
+
+// Structure for Get temperature command response
+typedef struct __attribute__((__packed__)) {
+    int16_t temperature;
+} getTemperatureResponse;
+
+// Structure for Set PID constants command payload
+typedef struct __attribute__((__packed__)) {
+    uint32_t kP;
+    uint32_t kI;
+    uint32_t kD;
+} setPidConstantsPayload;
+
+// Structure for Set max allowable position deviation command payload
+typedef struct __attribute__((__packed__)) {
+    int64_t maxAllowablePositionDeviation;
+} setMaxAllowablePositionDeviationPayload;
+
+// Structure for Get debug values command response
+typedef struct __attribute__((__packed__)) {
+    int64_t maxAcceleration;
+    int64_t maxVelocity;
+    int64_t currentVelocity;
+    int32_t measuredVelocity;
+    uint32_t nTimeSteps;
+    int64_t debugValue1;
+    int64_t debugValue2;
+    int64_t debugValue3;
+    int64_t debugValue4;
+    uint16_t allMotorControlCalculationsProfilerTime;
+    uint16_t allMotorControlCalculationsProfilerMaxTime;
+    uint16_t getSensorPositionProfilerTime;
+    uint16_t getSensorPositionProfilerMaxTime;
+    uint16_t computeVelocityProfilerTime;
+    uint16_t computeVelocityProfilerMaxTime;
+    uint16_t motorMovementCalculationsProfilerTime;
+    uint16_t motorMovementCalculationsProfilerMaxTime;
+    uint16_t motorPhaseCalculationsProfilerTime;
+    uint16_t motorPhaseCalculationsProfilerMaxTime;
+    uint16_t motorControlLoopPeriodProfilerTime;
+    uint16_t motorControlLoopPeriodProfilerMaxTime;
+    uint16_t hallSensor1Voltage;
+    uint16_t hallSensor2Voltage;
+    uint16_t hallSensor3Voltage;
+    uint32_t commutationPositionOffset;
+    uint8_t motorPhasesReversed;
+    int32_t maxHallPositionDelta;
+    int32_t minHallPositionDelta;
+    int32_t averageHallPositionDelta;
+    uint8_t motorPwmVoltage;
+} getDebugValuesResponse;
+
+// Structure for CRC32 control command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t enableCrc32;
+} crc32ControlPayload;
+
+// Structure for Get communication statistics command payload
+typedef struct __attribute__((__packed__)) {
+    uint8_t resetCounter;
+} getCommunicationStatisticsPayload;
+
+// Structure for Get communication statistics command response
+typedef struct __attribute__((__packed__)) {
+    uint32_t crc32ErrorCount;
+    uint32_t packetDecodeErrorCount;
+    uint32_t firstBitErrorCount;
+    uint32_t framingErrorCount;
+    uint32_t overrunErrorCount;
+    uint32_t noiseErrorCount;
+} getCommunicationStatisticsResponse;
+
+#endif // COMMAND_PAYLOADS_H
@@ -1,5 +1,6 @@
 // Communication.cpp
 #include "Communication.h"
+#include "CommandCodec.h"
 #include <limits>  // For std::numeric_limits
 
 //#define VERBOSE
@@ -50,14 +51,15 @@ void crc32_init(void)
     crc32_value = 0xFFFFFFFF;
 }
 
-uint32_t calculate_crc32_buffer_without_reinit(const void* data, size_t length)
+uint32_t crc32_update(uint32_t crc, const void* data, size_t length)
 {
+    crc32_table_init();
     const uint8_t* d = (const uint8_t*)data;
     for (size_t i = 0; i < length; i++) {
-        const uint8_t idx = (uint8_t)((crc32_value ^ d[i]) & 0xFFu);
-        crc32_value = (crc32_value >> 8) ^ s_crc32_table[idx];
+        const uint8_t idx = (uint8_t)((crc ^ d[i]) & 0xFFu);
+        crc = (crc >> 8) ^ s_crc32_table[idx];
     }
-    return ~crc32_value;
+    return crc;
 }
 
 #else
@@ -67,24 +69,30 @@ void crc32_init(void)
     crc32_value = 0xFFFFFFFF;
 }
 
-uint32_t calculate_crc32_buffer_without_reinit(const void* data, size_t length)
+uint32_t crc32_update(uint32_t crc, const void* data, size_t length)
 {
     uint32_t i, j;
-    uint8_t *d = (uint8_t *)data;
+    const uint8_t *d = (const uint8_t *)data;
     for (i = 0; i < length; i++) {
-        crc32_value ^= d[i];
+        crc ^= d[i];
         for (j = 0; j < 8; j++) {
-            if (crc32_value & 1)
-                crc32_value = (crc32_value >> 1) ^ CRC32_POLYNOMIAL;
+            if (crc & 1)
+                crc = (crc >> 1) ^ CRC32_POLYNOMIAL;
             else
-                crc32_value = crc32_value >> 1;
+                crc = crc >> 1;
         }
     }
-    return ~crc32_value;
+    return crc;
 }
 
 #endif
 
+uint32_t calculate_crc32_buffer_without_reinit(const void* data, size_t length)
+{
+    crc32_value = crc32_update(crc32_value, data, length);
+    return ~crc32_value;
+}
+
 uint32_t calculate_crc32(const uint8_t* data, size_t length)
 {
     crc32_init();
@@ -101,8 +109,14 @@ Communication::Communication(HardwareSerial& serialPort, uint32_t baud, int8_t r
       _crc32Enabled(true),
       _baud(baud),
       _rxPin(rxPin),
-      _txPin(txPin) {
+      _txPin(txPin),
+      _dePin(-1),
+      _deLeadMicroseconds(0),
+      _deTailMicroseconds(0),
+      _requestSentMicros(0),
+      _awaitingResponse(false) {
     // No initialization needed for direct CRC32 calculation
+    resetStatistics();
 }
 
 void Communication::openSerialPort() {
@@ -110,6 +124,7 @@ void Communication::openSerialPort() {
     // Initialize the RS485 hardware serial port once (even if multiple Servomotor instances exist)
     if (!s_commSerialOpened) {
         #if defined(ESP32)
+        _serial.setRxBufferSize(COMMUNICATION_ESP32_RX_BUFFER_SIZE); // only takes effect before begin()
         if (_rxPin >= 0 && _txPin >= 0) {
             _serial.begin(_baud, SERIAL_8N1, _rxPin, _txPin);
         } else {
@@ -140,74 +155,15 @@ void Communication::sendCommandCore(bool isExtendedAddress, uint64_t addressValu
     // This prevents old/partial responses (or line noise) from being mis-parsed
     // as the next response.
 //    flush();
-    
-    uint8_t sizeByte;
-    bool isExtendedSize = false;
-    uint16_t size16Bit;
-    // Calculate address size
-    const uint16_t addressSize = isExtendedAddress ? (sizeof(uint8_t) + sizeof(uint64_t)) : sizeof(uint8_t); // Extended: 1 byte flag + 8 bytes ID, Standard: 1 byte alias
-    
-    // Calculate total packet size (initial calculation without extended size bytes)
-    uint32_t totalPacketSize = sizeof(sizeByte) + addressSize + sizeof(commandID) + payloadSize;
-    if (_crc32Enabled) {
-        totalPacketSize += sizeof(uint32_t); // Add 4 bytes for CRC32
-    }
-    
-    // Determine the size byte value
-    if (totalPacketSize <= DECODED_FIRST_BYTE_EXTENDED_SIZE) {
-        sizeByte = encodeFirstByte(totalPacketSize);
-        _serial.write(sizeByte);
-    } else {
-        isExtendedSize = true;
-        sizeByte = encodeFirstByte(DECODED_FIRST_BYTE_EXTENDED_SIZE);
-        totalPacketSize += sizeof(uint16_t); // Add 2 bytes for the extended size
-        if (totalPacketSize > std::numeric_limits<uint16_t>::max()) {
-            #ifdef VERBOSE
-            Serial.println("Packet larger than protocol supports. Nothing being transmitted.");
-            #endif
-            return;
-        }
-        size16Bit = (uint16_t)totalPacketSize;
-        _serial.write(sizeByte);
-        _serial.write((uint8_t *)&size16Bit, sizeof(size16Bit));
-    }
-    
-    // Initialize CRC calculation if enabled
-    if (_crc32Enabled) {
-        crc32_init();
-        calculate_crc32_buffer_without_reinit(&sizeByte, sizeof(sizeByte));
-        if (isExtendedSize) {
-            calculate_crc32_buffer_without_reinit(&size16Bit, sizeof(size16Bit));
-        }
-    }
-    
-    // Write address bytes
-    if (isExtendedAddress) {
-        const uint8_t extendedAddrByte = EXTENDED_ADDRESSING;
-        _serial.write(extendedAddrByte);
-        _serial.write((uint8_t *)&addressValue, sizeof(addressValue));
-        if (_crc32Enabled) {
-            calculate_crc32_buffer_without_reinit(&extendedAddrByte, sizeof(extendedAddrByte));
-            calculate_crc32_buffer_without_reinit(&addressValue, sizeof(addressValue));        
-        }
-    }
-    else {
-        const uint8_t alias = (uint8_t)addressValue;
-        _serial.write(alias);
-        
-        // Add to CRC if enabled
-        if (_crc32Enabled) {
-            calculate_crc32_buffer_without_reinit(&alias, sizeof(alias));
-        }
+
+    if (payload == nullptr) {
+        payloadSize = 0;
     }
-    
-    // Write command byte
-    _serial.write(commandID);
-    
+
     #ifdef VERBOSE
+    Serial.print(isExtendedAddress ? "Sending extended command with " : "Sending command with ");
+    Serial.print(_crc32Enabled ? "CRC32 enabled" : "CRC32 disabled");
     if (isExtendedAddress) {
-        Serial.print("Sent extended command with ");
-        Serial.print(_crc32Enabled ? "CRC32 enabled" : "CRC32 disabled");
         Serial.print(", uniqueId: 0x");
         // Print Unique ID in big-endian format for readability
         for (int i = 7; i >= 0; i--) {
@@ -215,65 +171,74 @@ void Communication::sendCommandCore(bool isExtendedAddress, uint64_t addressValu
             if (byte < 0x10) Serial.print("0");
             Serial.print(static_cast<int>(byte), HEX);
         }
-        Serial.print(", command: 0x");
-        if (commandID < 0x10) Serial.print("0");
-        Serial.println(commandID, HEX);
-        Serial.println();
-    }
+    } else {
+        Serial.print(", alias: ");
+        Serial.print((uint8_t)addressValue);
+    }
+    Serial.print(", command: 0x");
+    if (commandID < 0x10) Serial.print("0");
+    Serial.print(commandID, HEX);
+    Serial.print(", payload bytes: ");
+    Serial.println(payloadSize);
     #endif
 
-    // Add command to CRC if enabled
-    if (_crc32Enabled) {
-        calculate_crc32_buffer_without_reinit(&commandID, sizeof(commandID));
+    // Assemble the whole frame first so that it reaches the UART driver in one write(). Writing it
+    // field by field lets every driver call (and the RS485 direction switch) open a gap on the wire.
+    uint8_t frame[COMMUNICATION_TX_FRAME_BUFFER_SIZE];
+    FrameWriter writer(frame, sizeof(frame));
+    if (writer.beginCommand(isExtendedAddress, addressValue, commandID, payloadSize, _crc32Enabled)) {
+        writer.append(payload, payloadSize);
+        sendFrame(frame, writer.finish());
+        return;
     }
-    
-    // Write payload
-    if (payload != nullptr && payloadSize > 0) {
-        _serial.write(payload, payloadSize);
-        
-        // Add payload to CRC if enabled
-        if (_crc32Enabled) {
-            calculate_crc32_buffer_without_reinit(payload, payloadSize);
-        }
-        
-        #ifdef VERBOSE
-        Serial.print("Payload bytes");
-        if (isExtendedAddress) Serial.print(" (extended address)");
-        Serial.print(": ");
-        for (uint16_t i = 0; i < payloadSize; i++) {
-            Serial.print("0x");
-            if (payload[i] < 0x10) Serial.print("0");
-            Serial.print(payload[i], HEX);
-            Serial.print(" ");
+
+    // Larger than the frame buffer: the header (size bytes, address, command) still goes out in one
+    // piece, then the payload and the CRC32, all inside one direction-control window.
+    const uint16_t addressSize = isExtendedAddress ? (sizeof(uint8_t) + sizeof(uint64_t)) : sizeof(uint8_t);
+    uint32_t totalPacketSize = 1 + addressSize + sizeof(commandID) + payloadSize + (_crc32Enabled ? sizeof(uint32_t) : 0);
+    uint8_t header[FRAME_MAX_SIZE_BYTES + FRAME_MAX_ADDRESS_BYTES + 1];
+    uint16_t headerSize = 0;
+    if (totalPacketSize <= DECODED_FIRST_BYTE_EXTENDED_SIZE) {
+        header[headerSize++] = encodeFirstByte(totalPacketSize);
+    } else {
+        totalPacketSize += sizeof(uint16_t); // Add 2 bytes for the extended size
+        if (totalPacketSize > std::numeric_limits<uint16_t>::max()) {
+            #ifdef VERBOSE
+            Serial.println("Packet larger than protocol supports. Nothing being transmitted.");
+            #endif
+            return;
         }
-        Serial.println();
-        #endif
+        header[headerSize++] = encodeFirstByte(DECODED_FIRST_BYTE_EXTENDED_SIZE);
+        header[headerSize++] = (uint8_t)totalPacketSize;
+        header[headerSize++] = (uint8_t)(totalPacketSize >> 8);
     }
-    else {
-        #ifdef VERBOSE
-        Serial.print("No payload");
-        if (isExtendedAddress) Serial.print(" (extended address)");
-        Serial.println();
-        #endif
+    if (isExtendedAddress) {
+        header[headerSize++] = EXTENDED_ADDRESSING;
+        memcpy(header + headerSize, &addressValue, sizeof(addressValue));
+        headerSize += sizeof(addressValue);
+    } else {
+        header[headerSize++] = (uint8_t)addressValue;
     }
-    
-    // Calculate and write CRC32 if enabled
+    header[headerSize++] = commandID;
+
+    beginTransmit();
+    _serial.write(header, headerSize);
+    _serial.write(payload, payloadSize);
     if (_crc32Enabled) {
-        // Get final CRC and write it
-        uint32_t crc = get_crc32();
-        _serial.write((uint8_t*)(&crc), sizeof(crc));
-        
-        #ifdef VERBOSE
-        Serial.print("calculated CRC32 bytes sent");
-        if (isExtendedAddress) Serial.print(" (extended)");
-        Serial.print(": 0x");
-        Serial.print(crc, HEX);
-        Serial.println();
-        #endif
+        const uint32_t crc = ~crc32_update(crc32_update(CRC32_INITIAL_VALUE, header, headerSize), payload, payloadSize);
+        _serial.write((const uint8_t*)&crc, sizeof(crc));
     }
+    endTransmit();
+    countSent(totalPacketSize);
 }
 
 int16_t Communication::getResponse(uint8_t* buffer, uint16_t bufferSize, uint16_t& receivedSize) {
+    const int16_t error = receiveResponse(buffer, bufferSize, receivedSize);
+    recordResponse(error);
+    return error;
+}
+
+int16_t Communication::receiveResponse(uint8_t* buffer, uint16_t bufferSize, uint16_t& receivedSize) {
     uint32_t startTime = millis();
     bool isExtendedSize = false;
     uint8_t sizeBytes[3];
@@ -628,6 +593,288 @@ flush_read_remaining_bytes_and_return_error:
     return error_code;
 }
 
+bool appendToResponseBuffer(void* context, const uint8_t* data, uint16_t size) {
+    ResponseBuffer* buffer = (ResponseBuffer*)context;
+    if (buffer == nullptr || buffer->data == nullptr || (uint32_t)size > buffer->capacity - buffer->size) {
+        return false;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return true;
+}
+
+int16_t Communication::getResponseStream(ResponseChunkHandler onChunk, void* context, uint32_t& receivedSize) {
+    const int16_t error = receiveResponseStream(onChunk, context, receivedSize);
+    recordResponse(error);
+    return error;
+}
+
+int16_t Communication::receiveResponseStream(ResponseChunkHandler onChunk, void* context, uint32_t& receivedSize) {
+    uint8_t header[3];
+    uint16_t sizeByteCount = 1;
+    uint32_t packetSize;
+    int16_t error_code = 0;
+    int32_t bytesLeftToRead = 0;
+    int32_t payloadLeftToRead;
+    uint8_t responseChar;
+    uint8_t remoteErrorCode;
+    uint32_t crc;
+    bool deliver = (onChunk != nullptr);
+    receivedSize = 0;
+
+    if ((error_code = receiveBytes(header, 1, 1, nullptr, TIMEOUT_MS)) != 0) {
+        return error_code;
+    }
+    if (!isValidFirstByteFormat(header[0])) {
+        return COMMUNICATION_ERROR_BAD_FIRST_BYTE;
+    }
+    packetSize = decodeFirstByte(header[0]);
+    if (packetSize == DECODED_FIRST_BYTE_EXTENDED_SIZE) {
+        if ((error_code = receiveBytes(header + 1, 2, 2, nullptr, TIMEOUT_MS)) != 0) {
+            return error_code;
+        }
+        sizeByteCount = 3;
+        packetSize = (uint32_t)header[1] | ((uint32_t)header[2] << 8);
+    }
+    if (packetSize <= sizeByteCount) {
+        return COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+    }
+    bytesLeftToRead = packetSize - sizeByteCount;
+    crc = crc32_update(CRC32_INITIAL_VALUE, header, sizeByteCount);
+
+    if ((error_code = receiveBytes(&responseChar, 1, 1, &bytesLeftToRead, TIMEOUT_MS)) != 0) {
+        goto drain_remaining_bytes_and_return_error;
+    }
+    if ((responseChar != RESPONSE_CHARACTER_CRC32_ENABLED) && (responseChar != RESPONSE_CHARACTER_CRC32_DISABLED)) {
+        error_code = COMMUNICATION_ERROR_BAD_RESPONSE_CHAR;
+        goto drain_remaining_bytes_and_return_error;
+    }
+    crc = crc32_update(crc, &responseChar, sizeof(responseChar));
+    payloadLeftToRead = bytesLeftToRead;
+    if (responseChar == RESPONSE_CHARACTER_CRC32_ENABLED) {
+        if (bytesLeftToRead < 4) {
+            error_code = COMMUNICATION_ERROR_PACKET_TOO_SMALL;
+            goto drain_remaining_bytes_and_return_error;
+        }
+        payloadLeftToRead -= 4;
+    }
+    if (payloadLeftToRead >= 1) {
+        if ((error_code = receiveBytes(&remoteErrorCode, 1, 1, &bytesLeftToRead, TIMEOUT_MS)) != 0) {
+            goto drain_remaining_bytes_and_return_error;
+        }
+        if (remoteErrorCode != 0) {
+            error_code = remoteErrorCode;
+            goto drain_remaining_bytes_and_return_error;
+        }
+        crc = crc32_update(crc, &remoteErrorCode, sizeof(remoteErrorCode));
+        payloadLeftToRead--;
+    }
+
+    // The payload goes straight from the UART to onChunk; only the running CRC32 is kept
+    if ((error_code = streamBytes(payloadLeftToRead, &crc, onChunk, context, &deliver, TIMEOUT_MS)) != 0) {
+        return error_code; // a timeout: nothing left to drain
+    }
+    bytesLeftToRead -= payloadLeftToRead;
+    receivedSize = (uint32_t)payloadLeftToRead;
+
+    if (responseChar == RESPONSE_CHARACTER_CRC32_ENABLED) {
+        uint32_t receivedCrc32 = 0;
+        if ((error_code = receiveBytes(&receivedCrc32, sizeof(receivedCrc32), sizeof(receivedCrc32), &bytesLeftToRead,
+                                       TIMEOUT_MS)) != 0) {
+            return error_code;
+        }
+        if (~crc != receivedCrc32) {
+            #ifdef VERBOSE
+            Serial.print("CRC32 mismatch on streamed response! Calculated: 0x");
+            Serial.print(~crc, HEX);
+            Serial.print(", Received: 0x");
+            Serial.println(receivedCrc32, HEX);
+            #endif
+            return COMMUNICATION_ERROR_CRC32_MISMATCH;
+        }
+    }
+    if (onChunk != nullptr && !deliver) {
+        return COMMUNICATION_ERROR_STREAM_ABORTED;
+    }
+    return COMMUNICATION_SUCCESS;
+
+drain_remaining_bytes_and_return_error:
+    streamBytes(bytesLeftToRead, nullptr, nullptr, nullptr, nullptr, TIMEOUT_MS);
+    return error_code;
+}
+
+int8_t Communication::streamBytes(int32_t numBytes, uint32_t* crc, ResponseChunkHandler onChunk, void* context,
+                                  bool* deliver, int32_t timeout_ms) {
+    uint8_t chunk[COMMUNICATION_RX_CHUNK_SIZE];
+    uint32_t lastByteTime = millis();
+    while (numBytes > 0) {
+        int available = _serial.available();
+        if (available <= 0) {
+            if ((int32_t)(millis() - lastByteTime) > timeout_ms) {
+                #ifdef VERBOSE
+                Serial.println("A timeout error occured while streaming a response");
+                #endif
+                return COMMUNICATION_ERROR_TIMEOUT;
+            }
+            continue;
+        }
+        uint16_t n = (uint16_t)sizeof(chunk);
+        if ((int32_t)n > numBytes) {
+            n = (uint16_t)numBytes;
+        }
+        if ((int)n > available) {
+            n = (uint16_t)available;
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            chunk[i] = (uint8_t)_serial.read();
+        }
+        lastByteTime = millis();
+        numBytes -= n;
+        _statistics.bytesReceived += n;
+        if (crc != nullptr) {
+            *crc = crc32_update(*crc, chunk, n);
+        }
+        if (onChunk != nullptr && deliver != nullptr && *deliver) {
+            *deliver = onChunk(context, chunk, n);
+        }
+    }
+    return COMMUNICATION_SUCCESS;
+}
+
+void Communication::sendFrame(const uint8_t* frame, uint16_t frameSize) {
+    if (frame == nullptr || frameSize == 0) {
+        return;
+    }
+    beginTransmit();
+    _serial.write(frame, frameSize);
+    endTransmit();
+    countSent(frameSize);
+}
+
+void Communication::setDirectionControl(int8_t dePin, uint16_t leadMicroseconds, uint16_t tailMicroseconds) {
+    _dePin = dePin;
+    _deLeadMicroseconds = leadMicroseconds;
+    _deTailMicroseconds = tailMicroseconds;
+    if (_dePin >= 0) {
+        pinMode(_dePin, OUTPUT);
+        digitalWrite(_dePin, LOW); // receive
+    }
+}
+
+void Communication::beginTransmit() {
+    if (_dePin < 0) {
+        return;
+    }
+    digitalWrite(_dePin, HIGH);
+    if (_deLeadMicroseconds) {
+        delayMicroseconds(_deLeadMicroseconds);
+    }
+}
+
+void Communication::endTransmit() {
+    if (_dePin < 0) {
+        return;
+    }
+    _serial.flush(); // returns once the last stop bit is out
+    if (_deTailMicroseconds) {
+        delayMicroseconds(_deTailMicroseconds);
+    }
+    digitalWrite(_dePin, LOW);
+}
+
+FrameReceiver::FrameReceiver()
+    : _buffer(nullptr), _capacity(0), _received(0), _expected(0), _sizeKnown(false), _done(true),
+      _error(COMMUNICATION_ERROR_TIMEOUT) {
+}
+
+void FrameReceiver::begin(uint8_t* buffer, uint16_t capacity) {
+    _buffer = buffer;
+    _capacity = capacity;
+    _received = 0;
+    _expected = 0;
+    _sizeKnown = false;
+    _done = false;
+    _error = COMMUNICATION_SUCCESS;
+    if (buffer == nullptr || capacity < 3) { // room for the largest size header
+        finish(COMMUNICATION_ERROR_BUFFER_TOO_SMALL);
+    }
+}
+
+void FrameReceiver::finish(int16_t error) {
+    _error = error;
+    _done = true;
+}
+
+bool FrameReceiver::poll(HardwareSerial& serial) {
+    while (!_done && serial.available() > 0) {
+        const uint8_t byte = (uint8_t)serial.read();
+        if (_received < _capacity) {
+            _buffer[_received] = byte;
+        }
+        _received++;
+        if (_received == 1) {
+            if (!isValidFirstByteFormat(byte)) {
+                finish(COMMUNICATION_ERROR_BAD_FIRST_BYTE);
+                break;
+            }
+            if (decodeFirstByte(byte) != DECODED_FIRST_BYTE_EXTENDED_SIZE) {
+                _expected = decodeFirstByte(byte);
+                _sizeKnown = true;
+                if (_expected <= 1) {
+                    finish(COMMUNICATION_ERROR_PACKET_TOO_SMALL);
+                    break;
+                }
+            }
+        } else if (_received == 3 && !_sizeKnown) {
+            _expected = (uint32_t)_buffer[1] | ((uint32_t)_buffer[2] << 8);
+            _sizeKnown = true;
+            if (_expected <= 3) {
+                finish(COMMUNICATION_ERROR_PACKET_TOO_SMALL);
+                break;
+            }
+        }
+        if (_sizeKnown && _received >= _expected) {
+            // Oversized frames are read to the end so the next one starts on a frame boundary
+            finish(_expected > _capacity ? COMMUNICATION_ERROR_BUFFER_TOO_SMALL : COMMUNICATION_SUCCESS);
+        }
+    }
+    return _done;
+}
+
+int16_t Communication::receiveFrame(uint8_t* buffer, uint16_t bufferSize, uint16_t& frameSize) {
+    uint32_t startTime = millis();
+    FrameReceiver receiver;
+    receiver.begin(buffer, bufferSize);
+    while (!receiver.poll(_serial)) {
+        if (millis() - startTime > TIMEOUT_MS) {
+            #ifdef VERBOSE
+            Serial.println("A timeout error occured while receiving");
+            #endif
+            _statistics.bytesReceived += receiver.bytesRead();
+            recordResponse(COMMUNICATION_ERROR_TIMEOUT);
+            frameSize = 0;
+            return COMMUNICATION_ERROR_TIMEOUT;
+        }
+    }
+    _statistics.bytesReceived += receiver.bytesRead();
+    if (receiver.error() != COMMUNICATION_SUCCESS) {
+        recordResponse(receiver.error());
+    }
+    frameSize = receiver.frameSize();
+    return receiver.error();
+}
+
+bool Communication::pollFrame(FrameReceiver& receiver) {
+    if (receiver.done() || !receiver.poll(_serial)) {
+        return receiver.done();
+    }
+    _statistics.bytesReceived += receiver.bytesRead();
+    if (receiver.error() != COMMUNICATION_SUCCESS) {
+        recordResponse(receiver.error());
+    }
+    return true;
+}
+
 void Communication::flush() {
     _serial.flush(); // Flush any outgoing data
     while (_serial.available()) {
@@ -660,6 +907,7 @@ int8_t Communication::receiveBytes(void* buffer, uint16_t bufferSize, int32_t nu
     }
 
     // Read all bytes (store in buffer if adequate, otherwise discard)
+    _statistics.bytesReceived += numBytes;
     for (uint16_t i = 0; i < numBytes; i++) {
         uint8_t byte = _serial.read();
         if (buffer != nullptr && !bufferTooSmall) {
@@ -695,3 +943,63 @@ void Communication::disableCRC32() {
 bool Communication::isCRC32Enabled() const {
     return _crc32Enabled;
 }
+
+void Communication::countSent(uint32_t frameSize) {
+    _statistics.framesSent++;
+    _statistics.bytesSent += frameSize;
+    _requestSentMicros = micros();
+    _awaitingResponse = true;
+}
+
+const CommunicationStatistics& Communication::statistics() const {
+    return _statistics;
+}
+
+void Communication::resetStatistics() {
+    memset(&_statistics, 0, sizeof(_statistics));
+    _statistics.startMillis = millis();
+    _awaitingResponse = false;
+}
+
+void Communication::recordResponse(int error) {
+    if (error == COMMUNICATION_SUCCESS || error > 0) {
+        _statistics.framesReceived++;
+        if (error > 0) {
+            _statistics.deviceErrors++;
+        }
+        if (_awaitingResponse) {
+            const uint32_t latency = micros() - _requestSentMicros;
+            uint8_t bucket = 0;
+            while (bucket + 1 < COMMUNICATION_LATENCY_BUCKETS && latency >= communicationLatencyBucketLimit(bucket)) {
+                bucket++;
+            }
+            _statistics.latencyHistogram[bucket]++;
+            if (_statistics.latencySamples == 0 || latency < _statistics.latencyMinMicroseconds) {
+                _statistics.latencyMinMicroseconds = latency;
+            }
+            if (latency > _statistics.latencyMaxMicroseconds) {
+                _statistics.latencyMaxMicroseconds = latency;
+            }
+            _statistics.latencySumMicroseconds += latency;
+            _statistics.latencySamples++;
+        }
+    } else {
+        switch (error) {
+            case COMMUNICATION_ERROR_TIMEOUT: _statistics.timeouts++; break;
+            case COMMUNICATION_ERROR_CRC32_MISMATCH: _statistics.crc32Mismatches++; break;
+            case COMMUNICATION_ERROR_BAD_FIRST_BYTE: _statistics.badFirstByte++; break;
+            case COMMUNICATION_ERROR_BAD_RESPONSE_CHAR: _statistics.badResponseChar++; break;
+            case COMMUNICATION_ERROR_BAD_THIRD_BYTE: _statistics.badThirdByte++; break;
+            default: _statistics.otherErrors++; break;
+        }
+    }
+    _awaitingResponse = false;
+}
+
+uint32_t Communication::bytesPerSecond() const {
+    const uint32_t elapsed = millis() - _statistics.startMillis;
+    if (elapsed == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)_statistics.bytesSent + _statistics.bytesReceived) * 1000u / elapsed);
+}
@@ -17,6 +17,9 @@
 #define COMMUNICATION_ERROR_BAD_FIRST_BYTE  -7
 #define COMMUNICATION_ERROR_BAD_THIRD_BYTE  -8
 #define COMMUNICATION_ERROR_PACKET_TOO_SMALL -9
+#define COMMUNICATION_ERROR_STREAM_ABORTED -10
+#define COMMUNICATION_ERROR_REQUEST_PENDING -11
+#define COMMUNICATION_ERROR_INVALID_HANDLE -12
 #define COMMUNICATION_SUCCESS 0
 
 // First byte encoding constants
@@ -30,6 +33,36 @@
 #define RESPONSE_CHARACTER_CRC32_ENABLED 253    // indicates that the response is coming from the device with CRC32 enabled
 #define RESPONSE_CHARACTER_CRC32_DISABLED 252    // indicates that the response is coming from the device with CRC32 disabled
 
+// Frames up to this size are assembled in a stack buffer and handed to the UART in a single write()
+// by sendCommand()/sendCommandByUniqueId(). The default fits every generated command except
+// FIRMWARE_UPGRADE (which goes through Servomotor::execute<>() in one write anyway); larger frames
+// are written as header, payload and CRC32.
+#ifndef COMMUNICATION_TX_FRAME_BUFFER_SIZE
+#define COMMUNICATION_TX_FRAME_BUFFER_SIZE 300
+#endif
+
+// getResponseStream() reads and hands over payload bytes in chunks of at most this many bytes, so
+// the largest response never needs more than this much RAM on the receive side.
+#ifndef COMMUNICATION_RX_CHUNK_SIZE
+#define COMMUNICATION_RX_CHUNK_SIZE 64
+#endif
+
+// UART receive buffer requested on ESP32 before the port is opened. Streamed responses arrive
+// faster than a slow consumer (e.g. a SPIFFS write) can take them; the driver buffer absorbs that.
+#ifndef COMMUNICATION_ESP32_RX_BUFFER_SIZE
+#define COMMUNICATION_ESP32_RX_BUFFER_SIZE 4096
+#endif
+
+// Link statistics: bucket i of the latency histogram counts responses that were complete less than
+// COMMUNICATION_LATENCY_BUCKET0_MICROSECONDS << i after their request was written; the last bucket
+// takes everything slower (250 us .. 256 ms with the defaults).
+#ifndef COMMUNICATION_LATENCY_BUCKETS
+#define COMMUNICATION_LATENCY_BUCKETS 12
+#endif
+#ifndef COMMUNICATION_LATENCY_BUCKET0_MICROSECONDS
+#define COMMUNICATION_LATENCY_BUCKET0_MICROSECONDS 250
+#endif
+
 // CRC32 control commands
 #define CRC32_ENABLE 1
 #define CRC32_DISABLE 0
@@ -51,6 +84,77 @@ inline bool isValidFirstByteFormat(uint8_t encodedFirstByte) {
 
 // CRC32 calculation function
 uint32_t calculate_crc32(const uint8_t* data, size_t length);
+// Running CRC32 without the shared state used by calculate_crc32(): start from CRC32_INITIAL_VALUE,
+// feed the data in any number of pieces, and complement the result (~crc) at the end.
+#define CRC32_INITIAL_VALUE 0xFFFFFFFFu
+uint32_t crc32_update(uint32_t crc, const void* data, size_t length);
+
+// Receives the payload of a streamed response, chunk by chunk, in order. data is only valid during
+// the call. Return false to stop receiving (the rest of the frame is still read and discarded).
+typedef bool (*ResponseChunkHandler)(void* context, const uint8_t* data, uint16_t size);
+
+// Ready-made handler that appends to caller-owned memory (RAM or PSRAM); context is a
+// ResponseBuffer*. Stops the stream if the data does not fit.
+struct ResponseBuffer {
+    uint8_t* data;
+    uint32_t capacity;
+    uint32_t size;
+};
+bool appendToResponseBuffer(void* context, const uint8_t* data, uint16_t size);
+
+// Counters kept by each Communication object (see Communication::statistics())
+struct CommunicationStatistics {
+    uint32_t framesSent;
+    uint32_t bytesSent;
+    uint32_t framesReceived;        // well-formed responses, including ones carrying a device error code
+    uint32_t bytesReceived;
+    uint32_t deviceErrors;          // responses with a non-zero device error code
+    uint32_t timeouts;
+    uint32_t crc32Mismatches;
+    uint32_t badFirstByte;
+    uint32_t badResponseChar;
+    uint32_t badThirdByte;
+    uint32_t otherErrors;           // wrong size, packet or buffer too small, stream aborted
+    uint32_t latencySamples;
+    uint32_t latencyMinMicroseconds;
+    uint32_t latencyMaxMicroseconds;
+    uint64_t latencySumMicroseconds;
+    uint32_t latencyHistogram[COMMUNICATION_LATENCY_BUCKETS];
+    uint32_t startMillis;           // millis() at the last reset
+};
+
+// Upper bound (exclusive) of latency histogram bucket i; 0 for the last, open-ended bucket
+inline uint32_t communicationLatencyBucketLimit(uint8_t bucket) {
+    return bucket + 1 < COMMUNICATION_LATENCY_BUCKETS ? (uint32_t)COMMUNICATION_LATENCY_BUCKET0_MICROSECONDS << bucket : 0;
+}
+
+// Non-blocking receive of one whole frame (size bytes included) into a caller buffer. poll() takes
+// whatever bytes are already waiting and never blocks; Communication::receiveFrame() loops on it
+// with a timeout, the async request queue (AsyncRequests.h) calls it from its own poll().
+class FrameReceiver {
+public:
+    FrameReceiver();
+    void begin(uint8_t* buffer, uint16_t capacity);
+    // True once the frame is complete or has failed (see error()). A frame larger than the buffer
+    // is read to its end and then reported as COMMUNICATION_ERROR_BUFFER_TOO_SMALL.
+    bool poll(HardwareSerial& serial);
+    bool done() const { return _done; }
+    int16_t error() const { return _error; }
+    uint16_t frameSize() const { return _done && _error == COMMUNICATION_SUCCESS ? (uint16_t)_expected : 0; }
+    // No byte of the frame has arrived yet
+    bool idle() const { return _received == 0; }
+    uint32_t bytesRead() const { return _received; }
+private:
+    void finish(int16_t error);
+
+    uint8_t* _buffer;
+    uint16_t _capacity;
+    uint32_t _received;
+    uint32_t _expected;
+    bool _sizeKnown;
+    bool _done;
+    int16_t _error;
+};
 
 class Communication {
 public:
@@ -66,12 +170,43 @@ public:
     void sendCommandByUniqueId(uint64_t uniqueId, uint8_t commandID, const uint8_t* payload, uint16_t payloadSize);
     
     int16_t getResponse(uint8_t* buffer, uint16_t bufferSize, uint16_t& receivedSize);
+
+    // Streaming variant of getResponse() for responses too large to buffer (hall sensor captures,
+    // the multipurpose buffer): the payload is passed to onChunk as it arrives and the CRC32 is
+    // checked once the whole frame is in. receivedSize counts all payload bytes received. A
+    // non-zero return (CRC32 mismatch, timeout) means the chunks already delivered must be
+    // discarded. The timeout applies to each pause in the data, not to the whole transfer.
+    int16_t getResponseStream(ResponseChunkHandler onChunk, void* context, uint32_t& receivedSize);
+
+    // Frame-level I/O for the typed command path (CommandCodec.h). sendFrame() writes a frame built
+    // by FrameWriter as is. receiveFrame() reads one whole frame (size bytes included) into buffer
+    // without interpreting it; parse it in place with parseResponse().
+    void sendFrame(const uint8_t* frame, uint16_t frameSize);
+    int16_t receiveFrame(uint8_t* buffer, uint16_t bufferSize, uint16_t& frameSize);
+    // One non-blocking step of receiver on this port; true once it is done
+    bool pollFrame(FrameReceiver& receiver);
     void flush();
+
+    // Optional RS485 direction control for transceivers whose DE/RE pins are wired to a GPIO. The pin
+    // goes high leadMicroseconds before the first byte of a frame and low tailMicroseconds after the
+    // UART has shifted out the last one (HardwareSerial::flush()). dePin < 0 turns it off (default).
+    void setDirectionControl(int8_t dePin, uint16_t leadMicroseconds = 0, uint16_t tailMicroseconds = 0);
     
     // CRC32 control
     void enableCRC32();
     void disableCRC32();
     bool isCRC32Enabled() const;
+
+    // Link statistics for this object's traffic since the last reset: frames and bytes both ways,
+    // errors by kind, and the time from writing a request to having its whole response. Responses
+    // read with getResponse()/getResponseStream() and receive errors are counted here; callers that
+    // check a frame themselves (parseResponse() after receiveFrame()/pollFrame()) report the outcome
+    // with recordResponse().
+    const CommunicationStatistics& statistics() const;
+    void resetStatistics();
+    void recordResponse(int error);
+    // Bytes sent and received per second since the last reset
+    uint32_t bytesPerSecond() const;
 protected:
     HardwareSerial& _serial; // Store the reference to the actual serial port
     bool _crc32Enabled; // Flag to track if CRC32 is enabled
@@ -80,11 +215,32 @@ private:
     uint32_t _baud;
     int8_t _rxPin;
     int8_t _txPin;
+    int8_t _dePin;
+    uint16_t _deLeadMicroseconds;
+    uint16_t _deTailMicroseconds;
+    CommunicationStatistics _statistics;
+    uint32_t _requestSentMicros;
+    bool _awaitingResponse;         // a request went out and its response has not been counted yet
 
     // Core function that handles the common logic for both addressing modes
     void sendCommandCore(bool isExtended, uint64_t addressValue, uint8_t commandID,
                          const uint8_t* payload, uint16_t payloadSize);
     
+    // getResponse()/getResponseStream() without the statistics
+    int16_t receiveResponse(uint8_t* buffer, uint16_t bufferSize, uint16_t& receivedSize);
+    int16_t receiveResponseStream(ResponseChunkHandler onChunk, void* context, uint32_t& receivedSize);
+    void countSent(uint32_t frameSize);
+
+    // RS485 driver enable around a frame (no-ops unless setDirectionControl() was given a pin)
+    void beginTransmit();
+    void endTransmit();
+
+    // Reads numBytes as they arrive, at most COMMUNICATION_RX_CHUNK_SIZE at a time, updating *crc
+    // (if not nullptr) and handing them to onChunk while *deliver is true (onChunk may be nullptr to
+    // discard). Times out after timeout_ms without a new byte.
+    int8_t streamBytes(int32_t numBytes, uint32_t* crc, ResponseChunkHandler onChunk, void* context, bool* deliver,
+                       int32_t timeout_ms);
+
     // Helper function to receive bytes with timeout checking
     // If bytesLeftToRead is non-null, this decrements *bytesLeftToRead once per byte read.
     int8_t receiveBytes(void* buffer, uint16_t bufferSize, int32_t numBytes, int32_t *bytesLeftToRead,
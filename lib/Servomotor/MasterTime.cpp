@@ -0,0 +1,30 @@
+// MasterTime.cpp
+#include "MasterTime.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#if defined(ESP32)
+#include <esp_timer.h>
+#endif
+#else
+#include "ArduinoEmulator.h"
+#endif
+
+static uint64_t masterClockMicros() {
+#if defined(ESP32) || !defined(ARDUINO)
+    return (uint64_t)esp_timer_get_time();
+#else
+    static uint32_t last = 0;
+    static uint32_t wraps = 0;
+    const uint32_t now = micros();
+    if (now < last) {
+        wraps++;
+    }
+    last = now;
+    return ((uint64_t)wraps << 32) | now;
+#endif
+}
+
+uint32_t servomotorMasterTime() {
+    return (uint32_t)(masterClockMicros() / MASTER_TIME_MICROSECONDS_PER_STEP);
+}
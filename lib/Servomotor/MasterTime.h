@@ -0,0 +1,19 @@
+// MasterTime.h
+#ifndef MASTER_TIME_H
+#define MASTER_TIME_H
+
+#include <stdint.h>
+
+// Motor time step: 32 us (31250 per second).
+#define MASTER_TIME_MICROSECONDS_PER_STEP 32
+
+// The master's clock for TIME_SYNC: microseconds since boot in motor time steps. It is taken from a
+// 64-bit microsecond clock and truncated to 32 bits after the divide, so it wraps at 2^32 steps
+// (~38 hours). Dividing the 32-bit micros() instead would wrap at 2^27 steps, every ~71.6 minutes,
+// in the middle of a long trajectory.
+//
+// ESP32 (and desktop, via ArduinoEmulator): esp_timer_get_time(). Other boards: micros() extended
+// across its wraps, which needs a call at least every ~71 minutes.
+uint32_t servomotorMasterTime();
+
+#endif // MASTER_TIME_H
@@ -0,0 +1,17 @@
+// MultimoveConversion.cpp
+#include "MultimoveConversion.h"
+
+void convertMultimoveList(uint8_t moveCount, uint32_t moveTypes,
+                          const multimoveListConverted_t* moveList, multimoveList_t* convertedList,
+                          VelocityUnit velocityUnit, AccelerationUnit accelerationUnit, TimeUnit timeUnit) {
+    // All three quantities are linear (no offset), so value * factor is what convert*() computes.
+    const float velocityFactor = velocityToInternalFactor(velocityUnit);
+    const float accelerationFactor = accelerationToInternalFactor(accelerationUnit);
+    const float timeFactor = timeToInternalFactor(timeUnit);
+    for (uint8_t i = 0; i < moveCount; i++) {
+        const bool isVelocity = (moveTypes & (1UL << i)) != 0;
+        const float factor = isVelocity ? velocityFactor : accelerationFactor;
+        convertedList[i].value = (int32_t)(moveList[i].value * factor);
+        convertedList[i].timeSteps = (uint32_t)(moveList[i].duration * timeFactor);
+    }
+}
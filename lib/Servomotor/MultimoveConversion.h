@@ -0,0 +1,50 @@
+// MultimoveConversion.h
+#ifndef MULTIMOVE_CONVERSION_H
+#define MULTIMOVE_CONVERSION_H
+
+#include <stdint.h>
+#include "AutoGeneratedUnitConversions.h"
+
+// Structure for multimove list item with raw internal units
+typedef struct {
+    int32_t value;  // acceleration or velocity value (internal units)
+    uint32_t timeSteps;  // duration in time steps (internal units)
+} multimoveList_t;
+
+// Structure for multimove list item with user-friendly units
+typedef struct {
+    float value;  // velocity or acceleration in user units
+    float duration;  // duration in user units (seconds, milliseconds, etc.)
+} multimoveListConverted_t;
+
+// Converts moveCount items of a multimove list from user units to internal units. Bit i of
+// moveTypes selects velocity (1) or acceleration (0) for item i, as in the MULTIMOVE command.
+//
+// Compile-time units: VelocityTag/AccelerationTag/TimeTag are Units:: tags, so every field is
+// one multiply and there is no unit switch in the loop.
+//   convertMultimoveList<Units::Rpm, Units::RpmPerSecond, Units::Milliseconds>(n, types, in, out);
+template <typename VelocityTag, typename AccelerationTag, typename TimeTag>
+void convertMultimoveList(uint8_t moveCount, uint32_t moveTypes,
+                          const multimoveListConverted_t* moveList, multimoveList_t* convertedList) {
+    static_assert(Units::SameQuantity<typename VelocityTag::Quantity, VelocityUnit>::value,
+                  "VelocityTag must be a velocity unit");
+    static_assert(Units::SameQuantity<typename AccelerationTag::Quantity, AccelerationUnit>::value,
+                  "AccelerationTag must be an acceleration unit");
+    static_assert(Units::SameQuantity<typename TimeTag::Quantity, TimeUnit>::value,
+                  "TimeTag must be a time unit");
+    for (uint8_t i = 0; i < moveCount; i++) {
+        const bool isVelocity = (moveTypes & (1UL << i)) != 0;
+        const float value = moveList[i].value;
+        convertedList[i].value = isVelocity ? (int32_t)VelocityTag::toInternal(value)
+                                            : (int32_t)AccelerationTag::toInternal(value);
+        convertedList[i].timeSteps = (uint32_t)TimeTag::toInternal(moveList[i].duration);
+    }
+}
+
+// Runtime units: the three unit lookups happen once per list instead of once per item. Results
+// match the convertVelocity/convertAcceleration/convertTime per-item path exactly.
+void convertMultimoveList(uint8_t moveCount, uint32_t moveTypes,
+                          const multimoveListConverted_t* moveList, multimoveList_t* convertedList,
+                          VelocityUnit velocityUnit, AccelerationUnit accelerationUnit, TimeUnit timeUnit);
+
+#endif // MULTIMOVE_CONVERSION_H
@@ -13,324 +13,17 @@
 #include "DataTypes.h"
 #include "Utils.h"
 #include "AutoGeneratedUnitConversions.h"
+#include "MultimoveConversion.h"
+#include "CommandPayloads.h"
+#include "CommandCodec.h"
+#include "AsyncRequests.h"
 
 // ============================================================================
 // DATA STRUCTURES
 // ============================================================================
 
 // AUTO-GENERATED DATA STRUCTURES
-// Structure for multimove list item with raw internal units
-typedef struct {
-    int32_t value;  // acceleration or velocity value (internal units)
-    uint32_t timeSteps;  // duration in time steps (internal units)
-} multimoveList_t;
-
-// Structure for multimove list item with user-friendly units
-typedef struct {
-    float value;  // velocity or acceleration in user units
-    float duration;  // duration in user units (seconds, milliseconds, etc.)
-} multimoveListConverted_t;
-
-// Structure for Trapezoid move command payload
-typedef struct __attribute__((__packed__)) {
-    int32_t displacement;
-    uint32_t duration;
-} trapezoidMovePayload;
-
-// Structure for Set maximum velocity command payload
-typedef struct __attribute__((__packed__)) {
-    uint32_t maximumVelocity;
-} setMaximumVelocityPayload;
-
-// Structure for Go to position command payload
-typedef struct __attribute__((__packed__)) {
-    int32_t position;
-    uint32_t duration;
-} goToPositionPayload;
-
-// Structure for Set maximum acceleration command payload
-typedef struct __attribute__((__packed__)) {
-    uint32_t maximumAcceleration;
-} setMaximumAccelerationPayload;
-
-// Structure for Capture hall sensor data command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t captureType;
-    uint32_t nPointsToRead;
-    uint8_t channelsToCaptureBitmask;
-    uint16_t timeStepsPerSample;
-    uint16_t nSamplesToSum;
-    uint16_t divisionFactor;
-} captureHallSensorDataPayload;
-
-// Structure for Capture hall sensor data command response
-typedef struct __attribute__((__packed__)) {
-    uint8_t data;
-} captureHallSensorDataResponse;
-
-// Structure for Get current time command response
-typedef struct __attribute__((__packed__)) {
-    uint64_t currentTime;
-} getCurrentTimeResponse;
-
-// Structure for Time sync command payload
-typedef struct __attribute__((__packed__)) {
-    uint32_t masterTime;
-} timeSyncPayload;
-
-// Structure for Time sync command response
-typedef struct __attribute__((__packed__)) {
-    int32_t timeError;
-    uint16_t rccIcscr;
-} timeSyncResponse;
-
-// Structure for Get n queued items command response
-typedef struct __attribute__((__packed__)) {
-    uint8_t queueSize;
-} getNQueuedItemsResponse;
-
-// Structure for Homing command payload
-typedef struct __attribute__((__packed__)) {
-    int32_t maxDistance;
-    uint32_t maxDuration;
-} homingPayload;
-
-// Structure for Get hall sensor position command response
-typedef struct __attribute__((__packed__)) {
-    int64_t hallSensorPosition;
-} getHallSensorPositionResponse;
-
-// Structure for Get status command response
-typedef struct __attribute__((__packed__)) {
-    uint16_t statusFlags;
-    uint8_t fatalErrorCode;
-} getStatusResponse;
-
-// Structure for Get product specs command response
-typedef struct __attribute__((__packed__)) {
-    uint32_t updateFrequency;
-    uint32_t countsPerRotation;
-} getProductSpecsResponse;
-
-// Structure for Move with acceleration command payload
-typedef struct __attribute__((__packed__)) {
-    int32_t acceleration;
-    uint32_t timeSteps;
-} moveWithAccelerationPayload;
-
-// Structure for Detect devices command response
-typedef struct __attribute__((__packed__)) {
-    uint64_t uniqueId;
-    uint8_t alias;
-} detectDevicesResponse;
-
-// Structure for Set device alias command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t alias;
-} setDeviceAliasPayload;
-
-// Structure for Get product info command response
-typedef struct __attribute__((__packed__)) {
-    char productCode[8];
-    uint8_t firmwareCompatibility;
-    VersionNumber24 hardwareVersion;
-    uint32_t serialNumber;
-    uint64_t uniqueId;
-    uint32_t reserved;
-} getProductInfoResponse;
-
-// Structure for Firmware upgrade command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t firmwarePage[2058];
-} firmwareUpgradePayload;
-
-// Structure for Get product description command response
-typedef struct __attribute__((__packed__)) {
-    char productDescription[32];
-} getProductDescriptionResponse;
-
-// Structure for Get firmware version command response
-typedef struct __attribute__((__packed__)) {
-    VersionNumber32 firmwareVersion;
-    uint8_t inBootloader;
-} getFirmwareVersionResponse;
-
-// Structure for Move with velocity command payload
-typedef struct __attribute__((__packed__)) {
-    int32_t velocity;
-    uint32_t duration;
-} moveWithVelocityPayload;
-
-// Structure for Set maximum motor current command payload
-typedef struct __attribute__((__packed__)) {
-    uint16_t motorCurrent;
-    uint16_t regenerationCurrent;
-} setMaximumMotorCurrentPayload;
-
-// Structure for Multimove command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t moveCount;
-    uint32_t moveTypes;
-    multimoveList_t moveList[32];
-} multimovePayload;
-
-// Structure for Set safety limits command payload
-typedef struct __attribute__((__packed__)) {
-    int64_t lowerLimit;
-    int64_t upperLimit;
-} setSafetyLimitsPayload;
-
-// Structure for Ping command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t pingData[10];
-} pingPayload;
-
-// Structure for Ping command response
-typedef struct __attribute__((__packed__)) {
-    uint8_t responsePayload[10];
-} pingResponse;
-
-// Structure for Control hall sensor statistics command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t control;
-} controlHallSensorStatisticsPayload;
-
-// Structure for Get hall sensor statistics command response
-typedef struct __attribute__((__packed__)) {
-    uint16_t maxHall1;
-    uint16_t maxHall2;
-    uint16_t maxHall3;
-    uint16_t minHall1;
-    uint16_t minHall2;
-    uint16_t minHall3;
-    uint64_t sumHall1;
-    uint64_t sumHall2;
-    uint64_t sumHall3;
-    uint32_t measurementCount;
-} getHallSensorStatisticsResponse;
-
-// Structure for Get position command response
-typedef struct __attribute__((__packed__)) {
-    int64_t position;
-} getPositionResponse;
-
-// Structure for Read multipurpose buffer command response
-typedef struct __attribute__((__packed__)) {
-    uint8_t bufferData;
-} readMultipurposeBufferResponse;
-
-// Structure for Test mode command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t testMode;
-} testModePayload;
-
-// Structure for Get comprehensive position command response
-typedef struct __attribute__((__packed__)) {
-    int64_t commandedPosition;
-    int64_t hallSensorPosition;
-    int32_t externalEncoderPosition;
-} getComprehensivePositionResponse;
-
-// Structure for converted Get comprehensive position values
-typedef struct {
-    float commandedPosition;
-    float hallSensorPosition;
-    float externalEncoderPosition;
-} getComprehensivePositionResponseConverted;
-
-// Structure for Get supply voltage command response
-typedef struct __attribute__((__packed__)) {
-    uint16_t supplyVoltage;
-} getSupplyVoltageResponse;
-
-// Structure for Get max PID error command response
-typedef struct __attribute__((__packed__)) {
-    int32_t minPidError;
-    int32_t maxPidError;
-} getMaxPidErrorResponse;
-
-// Structure for converted Get max PID error values
-typedef struct {
-    float minPidError;
-    float maxPidError;
-} getMaxPidErrorResponseConverted;
-
-// Structure for Vibrate command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t vibrationLevel;
-} vibratePayload;
-
-// Structure for Get temperature command response
-typedef struct __attribute__((__packed__)) {
-    int16_t temperature;
-} getTemperatureResponse;
-
-// Structure for Set PID constants command payload
-typedef struct __attribute__((__packed__)) {
-    uint32_t kP;
-    uint32_t kI;
-    uint32_t kD;
-} setPidConstantsPayload;
-
-// Structure for Set max allowable position deviation command payload
-typedef struct __attribute__((__packed__)) {
-    int64_t maxAllowablePositionDeviation;
-} setMaxAllowablePositionDeviationPayload;
-
-// Structure for Get debug values command response
-typedef struct __attribute__((__packed__)) {
-    int64_t maxAcceleration;
-    int64_t maxVelocity;
-    int64_t currentVelocity;
-    int32_t measuredVelocity;
-    uint32_t nTimeSteps;
-    int64_t debugValue1;
-    int64_t debugValue2;
-    int64_t debugValue3;
-    int64_t debugValue4;
-    uint16_t allMotorControlCalculationsProfilerTime;
-    uint16_t allMotorControlCalculationsProfilerMaxTime;
-    uint16_t getSensorPositionProfilerTime;
-    uint16_t getSensorPositionProfilerMaxTime;
-    uint16_t computeVelocityProfilerTime;
-    uint16_t computeVelocityProfilerMaxTime;
-    uint16_t motorMovementCalculationsProfilerTime;
-    uint16_t motorMovementCalculationsProfilerMaxTime;
-    uint16_t motorPhaseCalculationsProfilerTime;
-    uint16_t motorPhaseCalculationsProfilerMaxTime;
-    uint16_t motorControlLoopPeriodProfilerTime;
-    uint16_t motorControlLoopPeriodProfilerMaxTime;
-    uint16_t hallSensor1Voltage;
-    uint16_t hallSensor2Voltage;
-    uint16_t hallSensor3Voltage;
-    uint32_t commutationPositionOffset;
-    uint8_t motorPhasesReversed;
-    int32_t maxHallPositionDelta;
-    int32_t minHallPositionDelta;
-    int32_t averageHallPositionDelta;
-    uint8_t motorPwmVoltage;
-} getDebugValuesResponse;
-
-// Structure for CRC32 control command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t enableCrc32;
-} crc32ControlPayload;
-
-// Structure for Get communication statistics command payload
-typedef struct __attribute__((__packed__)) {
-    uint8_t resetCounter;
-} getCommunicationStatisticsPayload;
-
-// Structure for Get communication statistics command response
-typedef struct __attribute__((__packed__)) {
-    uint32_t crc32ErrorCount;
-    uint32_t packetDecodeErrorCount;
-    uint32_t firstBitErrorCount;
-    uint32_t framingErrorCount;
-    uint32_t overrunErrorCount;
-    uint32_t noiseErrorCount;
-} getCommunicationStatisticsResponse;
-
+// (command payload and response structures live in CommandPayloads.h)
 
 // These enum-to-string conversion functions are implemented in the cpp file
 // but declared in AutoGeneratedUnitConversions.h
@@ -347,6 +40,47 @@ public:
     
     // Addressing and command methods
     void sendCommand(uint8_t commandID, const uint8_t* payload, uint16_t payloadSize);
+
+    // Typed command path (CommandCodec.h). The request frame is serialized once into a stack buffer
+    // sized for the command, with the CRC32 computed along the way, and written in one call; the
+    // response is read into the same buffer and decoded in place. request may be nullptr for
+    // commands without a payload, response may be nullptr to discard it. Returns getError().
+    //   getPositionResponse position;
+    //   motor.execute<GET_POSITION>(nullptr, &position);
+    template <uint8_t CommandID>
+    int execute(const typename CommandTraits<CommandID>::Request* request,
+                typename CommandTraits<CommandID>::Response* response) {
+        return executeFrame<CommandID>(_useExtendedAddressing, _useExtendedAddressing ? _uniqueId : _alias, request,
+                                       response);
+    }
+    template <uint8_t CommandID>
+    int execute(uint64_t uniqueId, const typename CommandTraits<CommandID>::Request* request,
+                typename CommandTraits<CommandID>::Response* response) {
+        return executeFrame<CommandID>(true, uniqueId, request, response);
+    }
+
+    // Non-blocking counterpart of execute<>() (AsyncRequests.h): queues the request on a queue shared
+    // by all motors on the bus, addressed the way this motor is, and returns at once. The queue's
+    // Communication decides CRC32.
+    //   AsyncRequestQueue bus(motor.communication());
+    //   AsyncRequestHandle h = motor.submit<GET_POSITION>(bus, nullptr, 50);
+    //   ... bus.poll() from the main loop ...
+    //   if (bus.isDone(h)) bus.take<GET_POSITION>(h, &position);
+    template <uint8_t CommandID>
+    AsyncRequestHandle submit(AsyncRequestQueue& queue, const typename CommandTraits<CommandID>::Request* request,
+                              uint32_t timeoutMs = ASYNC_REQUEST_DEFAULT_TIMEOUT_MS,
+                              AsyncRequestCallback callback = nullptr, void* context = nullptr) {
+        return queue.submit<CommandID>(_useExtendedAddressing, _useExtendedAddressing ? _uniqueId : _alias, request,
+                                       timeoutMs, callback, context);
+    }
+    template <uint8_t CommandID>
+    AsyncRequestHandle submit(AsyncRequestQueue& queue, uint64_t uniqueId,
+                              const typename CommandTraits<CommandID>::Request* request,
+                              uint32_t timeoutMs = ASYNC_REQUEST_DEFAULT_TIMEOUT_MS,
+                              AsyncRequestCallback callback = nullptr, void* context = nullptr) {
+        return queue.submit<CommandID>(true, uniqueId, request, timeoutMs, callback, context);
+    }
+    Communication& communication();
     void useAlias(uint8_t alias);
     void useUniqueId(uint64_t uniqueId);
     uint64_t usingThisUniqueId() const;
@@ -361,6 +95,9 @@ public:
     void disableCRC32();
     bool isCRC32Enabled() const;
 
+    // RS485 direction control (see Communication::setDirectionControl())
+    void setDirectionControl(int8_t dePin, uint16_t leadMicroseconds = 0, uint16_t tailMicroseconds = 0);
+
     // Unit settings
     void setPositionUnit(PositionUnit unit);
     void setVelocityUnit(VelocityUnit unit);
@@ -405,6 +142,10 @@ public:
 
     captureHallSensorDataResponse captureHallSensorData(uint8_t captureType, uint32_t nPointsToRead, uint8_t channelsToCaptureBitmask, uint16_t timeStepsPerSample, uint16_t nSamplesToSum, uint16_t divisionFactor);
     captureHallSensorDataResponse captureHallSensorData(uint64_t uniqueId, uint8_t captureType, uint32_t nPointsToRead, uint8_t channelsToCaptureBitmask, uint16_t timeStepsPerSample, uint16_t nSamplesToSum, uint16_t divisionFactor);
+    // Streaming variants for captures larger than one buffer: the response payload goes to onChunk as
+    // it arrives (Communication::getResponseStream()). receivedSize may be nullptr. Returns getError().
+    int captureHallSensorDataStream(uint8_t captureType, uint32_t nPointsToRead, uint8_t channelsToCaptureBitmask, uint16_t timeStepsPerSample, uint16_t nSamplesToSum, uint16_t divisionFactor, ResponseChunkHandler onChunk, void* context, uint32_t* receivedSize = nullptr);
+    int captureHallSensorDataStream(uint64_t uniqueId, uint8_t captureType, uint32_t nPointsToRead, uint8_t channelsToCaptureBitmask, uint16_t timeStepsPerSample, uint16_t nSamplesToSum, uint16_t divisionFactor, ResponseChunkHandler onChunk, void* context, uint32_t* receivedSize = nullptr);
 
     void resetTime();
     void resetTime(uint64_t uniqueId);
@@ -488,6 +229,20 @@ public:
     void multimove(uint8_t moveCount, uint32_t moveTypes, multimoveListConverted_t* moveList);
     void multimove(uint64_t uniqueId, uint8_t moveCount, uint32_t moveTypes, multimoveListConverted_t* moveList);
     void multimoveRaw(uint64_t uniqueId, uint8_t moveCount, uint32_t moveTypes, multimoveList_t* moveList);
+    // Compile-time units (Units:: tags) instead of the set*Unit() settings, e.g.
+    //   motor.multimove<Units::Rpm, Units::RpmPerSecond, Units::Milliseconds>(n, types, list);
+    template <typename VelocityTag, typename AccelerationTag, typename TimeTag>
+    void multimove(uint8_t moveCount, uint32_t moveTypes, const multimoveListConverted_t* moveList) {
+        multimoveList_t convertedList[32];
+        convertMultimoveList<VelocityTag, AccelerationTag, TimeTag>(moveCount, moveTypes, moveList, convertedList);
+        multimoveRaw(moveCount, moveTypes, convertedList);
+    }
+    template <typename VelocityTag, typename AccelerationTag, typename TimeTag>
+    void multimove(uint64_t uniqueId, uint8_t moveCount, uint32_t moveTypes, const multimoveListConverted_t* moveList) {
+        multimoveList_t convertedList[32];
+        convertMultimoveList<VelocityTag, AccelerationTag, TimeTag>(moveCount, moveTypes, moveList, convertedList);
+        multimoveRaw(uniqueId, moveCount, moveTypes, convertedList);
+    }
 
     void setSafetyLimitsRaw(int64_t lowerLimit, int64_t upperLimit);
     void setSafetyLimits(float lowerLimit, float upperLimit);
@@ -510,6 +265,8 @@ public:
 
     readMultipurposeBufferResponse readMultipurposeBuffer();
     readMultipurposeBufferResponse readMultipurposeBuffer(uint64_t uniqueId);
+    int readMultipurposeBufferStream(ResponseChunkHandler onChunk, void* context, uint32_t* receivedSize = nullptr);
+    int readMultipurposeBufferStream(uint64_t uniqueId, ResponseChunkHandler onChunk, void* context, uint32_t* receivedSize = nullptr);
 
     void testMode(uint8_t testMode);
     void testMode(uint64_t uniqueId, uint8_t testMode);
@@ -573,6 +330,71 @@ private:
     TemperatureUnit m_temperatureUnit = TemperatureUnit::CELSIUS;
     VoltageUnit m_voltageUnit = VoltageUnit::VOLTS;
     CurrentUnit m_currentUnit = CurrentUnit::AMPS;
+
+    template <uint8_t CommandID>
+    int executeFrame(bool isExtendedAddress, uint64_t addressValue, const typename CommandTraits<CommandID>::Request* request,
+                     typename CommandTraits<CommandID>::Response* response) {
+        typedef CommandTraits<CommandID> Traits;
+        static_assert(!Traits::kVariableResponse,
+                      "variable-length responses: use streamFrame() (Communication::getResponseStream())");
+        // One buffer for the request and then the response
+        uint8_t frame[Traits::kMaxRequestFrameSize > Traits::kMaxResponseFrameSize ? Traits::kMaxRequestFrameSize
+                                                                                   : Traits::kMaxResponseFrameSize];
+        uint16_t frameSize = encodeCommand<CommandID>(frame, sizeof(frame), isExtendedAddress, addressValue, request,
+                                                      _comm.isCRC32Enabled());
+        if (frameSize == 0) {
+            _errno = COMMUNICATION_ERROR_BUFFER_TOO_SMALL;
+            return _errno;
+        }
+        _comm.sendFrame(frame, frameSize);
+        _errno = _comm.receiveFrame(frame, sizeof(frame), frameSize);
+        if (_errno != 0) {
+            return _errno;
+        }
+        ResponseView view;
+        _errno = parseResponse(frame, frameSize, &view);
+        _comm.recordResponse(_errno);
+        if (_errno != 0) {
+            return _errno;
+        }
+        if (Traits::kResponseSize == 0) {
+            // Nothing expected: a payload means the device and the command table disagree
+            if (view.payloadSize != 0) {
+                _errno = COMMUNICATION_ERROR_DATA_WRONG_SIZE;
+            }
+            return _errno;
+        }
+        const typename Traits::Response* decoded = responseAs<CommandID>(view);
+        if (decoded == nullptr) {
+            _errno = COMMUNICATION_ERROR_DATA_WRONG_SIZE;
+            return _errno;
+        }
+        if (response != nullptr) {
+            memcpy(response, decoded, sizeof(*response));
+        }
+        return _errno;
+    }
+
+    // Sends the request like executeFrame() and streams the (variable-length) response to onChunk
+    template <uint8_t CommandID>
+    int streamFrame(bool isExtendedAddress, uint64_t addressValue, const typename CommandTraits<CommandID>::Request* request,
+                    ResponseChunkHandler onChunk, void* context, uint32_t* receivedSize) {
+        typedef CommandTraits<CommandID> Traits;
+        uint8_t frame[Traits::kMaxRequestFrameSize];
+        const uint16_t frameSize = encodeCommand<CommandID>(frame, sizeof(frame), isExtendedAddress, addressValue, request,
+                                                            _comm.isCRC32Enabled());
+        if (frameSize == 0) {
+            _errno = COMMUNICATION_ERROR_BUFFER_TOO_SMALL;
+            return _errno;
+        }
+        _comm.sendFrame(frame, frameSize);
+        uint32_t received = 0;
+        _errno = _comm.getResponseStream(onChunk, context, received);
+        if (receivedSize != nullptr) {
+            *receivedSize = received;
+        }
+        return _errno;
+    }
 };
 
 #endif // SERVOMOTOR_H
\ No newline at end of file
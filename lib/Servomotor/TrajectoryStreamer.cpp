@@ -0,0 +1,227 @@
+// TrajectoryStreamer.cpp
+#include "TrajectoryStreamer.h"
+#include "MasterTime.h"
+
+TrajectoryStreamer::TrajectoryStreamer(Servomotor& motor)
+    : _motor(motor), _moves(nullptr), _moveCount(0), _source(nullptr), _sourceContext(nullptr), _nextIndex(0),
+      _havePending(false), _sourceEnded(false), _state(TRAJECTORY_IDLE), _startAtMicros(0), _lastPollMs(0),
+      _lastTimeSyncMs(0), _queueWasEmpty(false) {
+    memset(&_pending, 0, sizeof(_pending));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void TrajectoryStreamer::setMoves(const TrajectoryMove* moves, uint32_t moveCount) {
+    _moves = moves;
+    _moveCount = moveCount;
+    _source = nullptr;
+    _sourceContext = nullptr;
+}
+
+void TrajectoryStreamer::setSource(TrajectorySource source, void* context) {
+    _moves = nullptr;
+    _moveCount = 0;
+    _source = source;
+    _sourceContext = context;
+}
+
+bool TrajectoryStreamer::begin(uint32_t startAtMicros) {
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.minQueueDepth = 0xFF;
+    _nextIndex = 0;
+    _havePending = false;
+    _sourceEnded = false;
+    _startAtMicros = startAtMicros;
+    _queueWasEmpty = false;
+    _state = TRAJECTORY_STREAMING;
+    if (!timeSync()) {
+        return false;
+    }
+    _lastPollMs = millis();
+    return true;
+}
+
+bool TrajectoryStreamer::peekMove() {
+    if (_havePending) {
+        return true;
+    }
+    if (_sourceEnded) {
+        return false;
+    }
+    if (_source != nullptr) {
+        _havePending = _source(_sourceContext, _nextIndex, &_pending);
+    } else if (_moves != nullptr && _nextIndex < _moveCount) {
+        _pending = _moves[_nextIndex];
+        _havePending = true;
+    }
+    if (!_havePending) {
+        _sourceEnded = true;
+        return false;
+    }
+    _nextIndex++;
+    return true;
+}
+
+void TrajectoryStreamer::fail(int error) {
+    _stats.lastError = error;
+    _state = TRAJECTORY_FAILED;
+    #ifdef VERBOSE
+    Serial.print("[Trajectory] stopped, error ");
+    Serial.println(error);
+    #endif
+}
+
+bool TrajectoryStreamer::timeSync() {
+    timeSyncPayload payload;
+    payload.masterTime = htole32(servomotorMasterTime());
+    timeSyncResponse response = {};
+    const int error = _motor.execute<TIME_SYNC>(&payload, &response);
+    _lastTimeSyncMs = millis();
+    if (error != 0) {
+        fail(error);
+        return false;
+    }
+    _stats.timeSyncs++;
+    const int32_t timeError = (int32_t)le32toh((uint32_t)response.timeError);
+    const int32_t absTimeError = timeError < 0 ? -timeError : timeError;
+    if (absTimeError > _stats.maxAbsTimeError) {
+        _stats.maxAbsTimeError = absTimeError;
+    }
+    return true;
+}
+
+bool TrajectoryStreamer::pollQueue(uint8_t* queued) {
+    getNQueuedItemsResponse response = {};
+    const int error = _motor.execute<GET_N_QUEUED_ITEMS>(nullptr, &response);
+    if (error != 0) {
+        fail(error);
+        return false;
+    }
+    _stats.queuePolls++;
+    *queued = response.queueSize;
+    return true;
+}
+
+int TrajectoryStreamer::sendChunk(uint8_t freeEntries) {
+    multimovePayload payload;
+    uint8_t count = 0;
+    uint32_t moveTypes = 0;
+    const uint8_t limit = freeEntries < TRAJECTORY_MULTIMOVE_MAX_MOVES ? freeEntries : TRAJECTORY_MULTIMOVE_MAX_MOVES;
+
+    // First frame: hold still until startAtMicros.
+    const bool first = _stats.framesSent == 0;
+    uint32_t holdTimeSteps = 0;
+    if (first && _startAtMicros != 0 && peekMove()) {
+        const int32_t ahead = (int32_t)(_startAtMicros - (uint32_t)micros());
+        if (ahead > 0) {
+            holdTimeSteps = (uint32_t)ahead / MASTER_TIME_MICROSECONDS_PER_STEP;
+        } else {
+            _stats.startLateMicros = (uint32_t)-ahead;
+        }
+        if (holdTimeSteps != 0) {
+            moveTypes |= 1UL;
+            payload.moveList[0].value = 0;
+            payload.moveList[0].timeSteps = htole32(holdTimeSteps);
+            count = 1;
+        }
+    }
+
+    const uint8_t holdEntries = count;
+    while (count < limit && peekMove()) {
+        if (_pending.isVelocity) {
+            moveTypes |= 1UL << count;
+        }
+        payload.moveList[count].value = htole32(_pending.value);
+        payload.moveList[count].timeSteps = htole32(_pending.timeSteps);
+        _havePending = false;
+        count++;
+    }
+    if (count == holdEntries) {
+        return 0; // nothing left to send
+    }
+
+    payload.moveCount = count;
+    payload.moveTypes = htole32(moveTypes);
+    const int error = _motor.execute<MULTIMOVE>(&payload, nullptr);
+    if (error != 0) {
+        fail(error);
+        return -1;
+    }
+    _stats.framesSent++;
+    _stats.movesSent += count - holdEntries;
+    _stats.startHoldTimeSteps += holdTimeSteps;
+    return count;
+}
+
+bool TrajectoryStreamer::service() {
+    if (_state != TRAJECTORY_STREAMING && _state != TRAJECTORY_DRAINING) {
+        return false;
+    }
+    const uint32_t now = millis();
+    if (now - _lastTimeSyncMs >= TRAJECTORY_TIME_SYNC_INTERVAL_MS && !timeSync()) {
+        return false;
+    }
+    if (_stats.queuePolls != 0 && now - _lastPollMs < TRAJECTORY_POLL_INTERVAL_MS) {
+        return true;
+    }
+    _lastPollMs = now;
+
+    uint8_t queued;
+    if (!pollQueue(&queued)) {
+        return false;
+    }
+    if (_state == TRAJECTORY_DRAINING) {
+        if (queued == 0) {
+            _state = TRAJECTORY_DONE;
+            return false;
+        }
+        return true;
+    }
+
+    if (_stats.framesSent != 0) {
+        _stats.depthSamples++;
+        _stats.queueDepthSum += queued;
+        if (queued < _stats.minQueueDepth) {
+            _stats.minQueueDepth = queued;
+        }
+        if (queued > _stats.maxQueueDepth) {
+            _stats.maxQueueDepth = queued;
+        }
+        if (queued == 0 && !_queueWasEmpty) {
+            _stats.underruns++;
+            #ifdef VERBOSE
+            Serial.print("[Trajectory] queue underrun after move ");
+            Serial.println(_stats.movesSent);
+            #endif
+        }
+        _queueWasEmpty = queued == 0;
+    }
+
+    uint8_t freeEntries = queued < TRAJECTORY_MOTOR_QUEUE_SIZE ? (uint8_t)(TRAJECTORY_MOTOR_QUEUE_SIZE - queued) : 0;
+    const uint8_t minChunk = TRAJECTORY_MIN_CHUNK_MOVES < TRAJECTORY_MOTOR_QUEUE_SIZE ? TRAJECTORY_MIN_CHUNK_MOVES
+                                                                                      : TRAJECTORY_MOTOR_QUEUE_SIZE;
+    while (freeEntries >= minChunk) {
+        const int used = sendChunk(freeEntries);
+        if (used < 0) {
+            return false;
+        }
+        if (used == 0) {
+            break;
+        }
+        freeEntries -= (uint8_t)used;
+        _queueWasEmpty = false;
+    }
+    if (!peekMove()) {
+        _state = TRAJECTORY_DRAINING;
+    }
+    return true;
+}
+
+bool TrajectoryStreamer::run(uint32_t startAtMicros) {
+    if (!begin(startAtMicros)) {
+        return false;
+    }
+    while (service()) {
+        delay(1);
+    }
+    return _state == TRAJECTORY_DONE;
+}
@@ -0,0 +1,125 @@
+// TrajectoryStreamer.h
+#ifndef TRAJECTORY_STREAMER_H
+#define TRAJECTORY_STREAMER_H
+
+#include <stdint.h>
+#include "Servomotor.h"
+
+// Streams a move list of any length to one motor as MULTIMOVE frames, keeping the motor's movement
+// queue topped up.
+//
+// service() polls GET_N_QUEUED_ITEMS every TRAJECTORY_POLL_INTERVAL_MS and, once at least
+// TRAJECTORY_MIN_CHUNK_MOVES queue entries are free, sends the next moves (up to 32 per frame, never
+// more than fit). The queue depth seen by each poll while the trajectory is still being sent is
+// recorded; a poll that finds the queue empty before the last move went out is an underrun (the
+// motor stops with a fatal error if it was moving).
+//
+// Time sync: begin() and every TRAJECTORY_TIME_SYNC_INTERVAL_MS afterwards send TIME_SYNC with the
+// master time (servomotorMasterTime(), see MasterTime.h), so the motor's clock, and with it every
+// move duration, runs at the master's rate. To start several motors together, give their
+// streamers the same startAtMicros: the first frame to each motor is prefixed with a zero-velocity
+// hold lasting until that master time.
+//
+// Moves come from an array (setMoves) or a callback (setSource) that is asked for one move at a
+// time, so endurance trajectories need not be held in memory. Values are in internal units (see
+// convertMultimoveList()).
+//
+// Any communication or device error stops the stream (state TRAJECTORY_FAILED, stats().lastError);
+// what was already queued keeps running on the motor.
+
+#ifndef TRAJECTORY_MOTOR_QUEUE_SIZE
+#define TRAJECTORY_MOTOR_QUEUE_SIZE 32 // movement queue length of the motor firmware
+#endif
+#ifndef TRAJECTORY_MIN_CHUNK_MOVES
+#define TRAJECTORY_MIN_CHUNK_MOVES 8
+#endif
+#ifndef TRAJECTORY_POLL_INTERVAL_MS
+#define TRAJECTORY_POLL_INTERVAL_MS 10
+#endif
+#ifndef TRAJECTORY_TIME_SYNC_INTERVAL_MS
+#define TRAJECTORY_TIME_SYNC_INTERVAL_MS 100
+#endif
+
+#define TRAJECTORY_MULTIMOVE_MAX_MOVES 32
+
+typedef struct {
+    bool isVelocity;     // velocity move (else acceleration), bit i of MULTIMOVE moveTypes
+    int32_t value;       // velocity or acceleration (internal units)
+    uint32_t timeSteps;  // duration (internal units)
+} TrajectoryMove;
+
+// Fills *move with move number index (0, 1, 2, ...); returns false when the trajectory has ended.
+typedef bool (*TrajectorySource)(void* context, uint32_t index, TrajectoryMove* move);
+
+enum TrajectoryState {
+    TRAJECTORY_IDLE = 0,
+    TRAJECTORY_STREAMING,   // moves left to send
+    TRAJECTORY_DRAINING,    // all sent, waiting for the motor's queue to empty
+    TRAJECTORY_DONE,
+    TRAJECTORY_FAILED,
+};
+
+typedef struct {
+    uint32_t movesSent;
+    uint32_t framesSent;
+    uint32_t queuePolls;
+    // Queue depth at the polls made while streaming, after the first frame
+    uint32_t depthSamples;
+    uint8_t minQueueDepth;
+    uint8_t maxQueueDepth;
+    uint32_t queueDepthSum;         // mean = queueDepthSum / depthSamples
+    uint32_t underruns;             // times the queue was found empty while streaming
+    uint32_t timeSyncs;
+    int32_t maxAbsTimeError;        // largest |timeError| reported by TIME_SYNC
+    uint32_t startHoldTimeSteps;    // zero-velocity hold put in front of the first move
+    uint32_t startLateMicros;       // first frame went out this long after startAtMicros
+    int lastError;                  // error that stopped the stream
+} TrajectoryStats;
+
+class TrajectoryStreamer {
+public:
+    explicit TrajectoryStreamer(Servomotor& motor);
+
+    void setMoves(const TrajectoryMove* moves, uint32_t moveCount);
+    void setSource(TrajectorySource source, void* context);
+
+    // Resets the stats and syncs the motor's time. startAtMicros (a micros() value, at most ~35 minutes
+    // ahead) is when the first move should begin; 0 starts as soon as the first frame is sent.
+    // Returns false if TIME_SYNC fails.
+    bool begin(uint32_t startAtMicros = 0);
+
+    // Does whatever is due (poll, send, time sync) and returns. Returns true while the stream is
+    // running (streaming or draining).
+    bool service();
+
+    // begin() and service() until done; returns true if the whole trajectory ran.
+    bool run(uint32_t startAtMicros = 0);
+
+    TrajectoryState state() const { return _state; }
+    const TrajectoryStats& stats() const { return _stats; }
+
+private:
+    bool peekMove();
+    bool pollQueue(uint8_t* queued);
+    int sendChunk(uint8_t freeEntries);
+    bool timeSync();
+    void fail(int error);
+
+    Servomotor& _motor;
+    const TrajectoryMove* _moves;
+    uint32_t _moveCount;
+    TrajectorySource _source;
+    void* _sourceContext;
+    uint32_t _nextIndex;
+    bool _havePending;
+    bool _sourceEnded;
+    TrajectoryMove _pending;        // fetched but not sent yet
+    TrajectoryState _state;
+    uint32_t _startAtMicros;
+    uint32_t _lastPollMs;
+    uint32_t _lastTimeSyncMs;
+    bool _queueWasEmpty;
+    TrajectoryStats _stats;
+};
+
+#endif // TRAJECTORY_STREAMER_H
@@ -6,7 +6,9 @@
 #include <stddef.h>
 
 // Detect endianness at compile time
-#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#if defined(htole16)
+    // Already provided by the C library (glibc <endian.h>, host builds)
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
     // Little-endian definitions
     #define htole16(x) (x)
     #define htole32(x) (x)
@@ -28,20 +28,35 @@ void delay(unsigned long ms);
 void delayMicroseconds(unsigned int us);
 
 unsigned long millis();
+unsigned long micros();
 
-// Minimal Serial shim used by the firmware code.
-class SerialShim {
+// Minimal Arduino `Print` base class (the firmware routes its logging through
+// `Print &` sinks such as tee_log::out()).
+class Print {
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+
+  size_t println();
+  size_t println(const char *s);
+  size_t print(const char *s);
+  size_t print(char c);
+
+  // Arduino's Print::printf returns size_t; we'll just return int.
+  int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Minimal Serial shim used by the firmware code (writes to stdout).
+class SerialShim final : public Print {
 public:
   void begin(unsigned long) {}
   explicit operator bool() const { return true; }
 
-  void println() const;
-  void println(const char *s) const;
-  void print(const char *s) const;
-  void print(char c) const;
-
-  // Arduino's Serial.printf returns size_t; we'll just return int.
-  int printf(const char *fmt, ...) const __attribute__((format(printf, 2, 3)));
+  using Print::write;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
 };
 
 extern SerialShim Serial;
@@ -4,58 +4,29 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <memory>
 #include <string>
 
-#include "../gpio_model.h"
-#include "../logger.h"
-#include "../stm32_swd_target.h"
+#include "../runtime.h"
 #include "../sim_api.h"
 
-// Simulator compatibility note:
-// The ESP32 firmware now sources the STM32 image from a filesystem file.
-// For simulations we keep a tiny embedded payload to seed the simulated target.
-#include <cstdint>
-
 namespace sim {
 
-struct Runtime {
-  uint64_t t_ns = 0;
-
-  int swclk_pin = 35;
-  int swdio_pin = 36;
-  int nrst_pin  = 37;
-
-  GpioModel gpio;
-  std::unique_ptr<CsvLogger> logger;
-  Stm32SwdTarget target;
-
-  uint8_t last_swclk_level = 0;
-
-  // Visualization: log target state-machine transitions as STEP_* markers.
-  std::string last_target_phase_label;
-
-  bool swdio_input_pullup_seen = false;
-  bool target_drove_swdio_seen = false;
-  bool target_voltage_logged_seen = false;
-
-  Runtime() : logger(std::make_unique<CsvLogger>("signals.csv")) {
-    target.reset();
-    // Default simulated flash contents: tiny placeholder image.
-    // This enables read-flash simulations without requiring a separate programming step.
-    static const uint8_t firmware_bin_8[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xCA, 0xFE, 0xBA, 0xBE};
-    target.load_flash_image(firmware_bin_8, (unsigned)sizeof(firmware_bin_8));
-  }
-};
+static thread_local Runtime *t_current = nullptr;
 
 Runtime &rt() {
+  if (t_current) return *t_current;
   // Function-local static so destructors run at program exit.
   static Runtime r;
   return r;
 }
 
+ScopedRuntime::ScopedRuntime(Runtime &r) : prev_(t_current) { t_current = &r; }
+
+ScopedRuntime::~ScopedRuntime() { t_current = prev_; }
+
 static void log_all() {
   auto &r = rt();
+  if (!r.logger->enabled()) return;
 
   // SWCLK
   const double v_swclk = r.gpio.resolve_host_pin_voltage(r.swclk_pin);
@@ -73,6 +44,15 @@ static void log_all() {
   r.logger->log_voltage_change(r.t_ns, "NRST", v_nrst);
 }
 
+static void update_target_nrst() {
+  // NRST has an external pull-up on the target: a released (input) pin reads HIGH.
+  auto &r = rt();
+  const sim::PinState st = r.gpio.host_state(r.nrst_pin);
+  const bool high = (st.dir == sim::PinDir::Output) ? (st.out != 0) : true;
+  r.target.set_time_ns(r.t_ns);
+  r.target.set_nrst_level(high);
+}
+
 static void maybe_clock_edge_update() {
   auto &r = rt();
   const sim::PinState st = r.gpio.host_state(r.swclk_pin);
@@ -179,6 +159,7 @@ bool target_voltage_logged_seen() {
 void log_step(const char *name) {
   auto &r = rt();
   if (!name || !name[0]) return;
+  r.trace_phase = name;
   // Use a constant y-value slightly above the visible SWDIO range.
   // The viewer will render these as point markers.
   r.logger->log_event(r.t_ns, name, 3.55, 0.0);
@@ -194,8 +175,27 @@ void set_log_path(const char *path) {
   log_all();
 }
 
+void set_waveform_logging(bool enabled) {
+  rt().logger->set_enabled(enabled);
+}
+
+void set_console_output(bool enabled) {
+  rt().console_output = enabled;
+}
+
+void set_console_capture(std::string *sink) {
+  rt().console_capture = sink;
+}
+
+uint64_t now_ns() {
+  return rt().t_ns;
+}
+
 } // namespace sim
 
+// swd_min is built with SWD_MIN_EXTERNAL_CONTEXT: its state lives in the current Runtime.
+swd_min::Context &swd_min::context() { return sim::rt().swd; }
+
 // ===== Arduino API implementation =====
 
 void pinMode(int pin, int mode) {
@@ -249,6 +249,7 @@ void pinMode(int pin, int mode) {
       }
     }
   }
+  if (pin == r.nrst_pin) sim::update_target_nrst();
   sim::log_all();
 }
 
@@ -261,6 +262,7 @@ void digitalWrite(int pin, int value) {
   if (pin == r.swclk_pin) {
     sim::maybe_clock_edge_update();
   }
+  if (pin == r.nrst_pin) sim::update_target_nrst();
 }
 
 int digitalRead(int pin) {
@@ -301,30 +303,74 @@ unsigned long millis() {
   return (unsigned long)(r.t_ns / 1000000ull);
 }
 
-// ===== Serial shim =====
+unsigned long micros() {
+  auto &r = sim::rt();
+  return (unsigned long)(r.t_ns / 1000ull);
+}
 
-SerialShim Serial;
+// ===== Print + Serial shim =====
 
-void SerialShim::println() const {
-  std::printf("\n");
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  for (size_t i = 0; i < size; i++) n += write(buffer[i]);
+  return n;
 }
 
-void SerialShim::println(const char *s) const {
-  std::printf("%s\n", s ? s : "(null)");
+size_t Print::println() {
+  return print('\n');
 }
 
-void SerialShim::print(const char *s) const {
-  std::printf("%s", s ? s : "(null)");
+size_t Print::println(const char *s) {
+  return print(s) + println();
 }
 
-void SerialShim::print(char c) const {
-  std::printf("%c", c);
+size_t Print::print(const char *s) {
+  if (!s) s = "(null)";
+  return write(reinterpret_cast<const uint8_t *>(s), std::strlen(s));
 }
 
-int SerialShim::printf(const char *fmt, ...) const {
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+int Print::printf(const char *fmt, ...) {
+  char stack_buf[256];
   va_list args;
   va_start(args, fmt);
-  const int n = std::vprintf(fmt, args);
+  const int n = std::vsnprintf(stack_buf, sizeof(stack_buf), fmt, args);
+  va_end(args);
+  if (n < 0) return n;
+  if ((size_t)n < sizeof(stack_buf)) {
+    write(reinterpret_cast<const uint8_t *>(stack_buf), (size_t)n);
+    return n;
+  }
+
+  std::string big((size_t)n + 1, '\0');
+  va_start(args, fmt);
+  std::vsnprintf(&big[0], big.size(), fmt, args);
   va_end(args);
+  write(reinterpret_cast<const uint8_t *>(big.data()), (size_t)n);
   return n;
 }
+
+SerialShim Serial;
+
+size_t SerialShim::write(uint8_t b) {
+  auto &r = sim::rt();
+  if (r.console_capture) {
+    r.console_capture->push_back((char)b);
+    return 1;
+  }
+  if (!r.console_output) return 1;
+  return (std::fputc(b, stdout) == EOF) ? 0 : 1;
+}
+
+size_t SerialShim::write(const uint8_t *buffer, size_t size) {
+  auto &r = sim::rt();
+  if (r.console_capture) {
+    r.console_capture->append(reinterpret_cast<const char *>(buffer), size);
+    return size;
+  }
+  if (!r.console_output) return size;
+  return std::fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,28 @@
+// Host-side stand-in for src/tee_log.cpp.
+//
+// The firmware tees its console output into a RAM ring buffer (src/ram_log.cpp),
+// which depends on FreeRTOS primitives. The simulator has no RAM log viewer, so
+// everything simply goes to the Serial shim (stdout).
+
+#include "tee_log.h"
+
+#include "../runtime.h"
+
+namespace tee_log {
+
+void begin() {}
+
+Print &out() { return Serial; }
+
+void set_capture_enabled(bool enabled) { sim::rt().tee_capture_enabled = enabled; }
+
+bool capture_enabled() { return sim::rt().tee_capture_enabled; }
+
+ScopedCaptureSuspend::ScopedCaptureSuspend() {
+  prev_ = sim::rt().tee_capture_enabled;
+  sim::rt().tee_capture_enabled = false;
+}
+
+ScopedCaptureSuspend::~ScopedCaptureSuspend() { sim::rt().tee_capture_enabled = prev_; }
+
+}  // namespace tee_log
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "stm32g0_prog.h"
+#include "swd_min.h"
+
+#include "runtime.h"
+#include "sim_api.h"
+#include "swd_txn_backend.h"
+
+// Connect-under-reset window sweep (transaction-level backend).
+//
+// The target model's user firmware repurposes SWCLK/SWDIO after it has run for X us past NRST
+// release, unless a DHCSR halt lands first (Stm32SwdTarget::FaultConfig::early_swd_disable).
+// For every connect strategy this sweeps X and reports the boundary:
+//   fails up to X = a us, succeeds from X = b us on.
+// Success means the strategy returned true AND the simulated core is really halted.
+// Returning true without a halted core is counted as "unhalted". connect_and_halt() does that
+// by design ("core did not report HALT; continuing anyway") when its halt write races the pin
+// remap; for the under-reset strategies it is a FALSE PASS (exit code 2).
+//
+// Each row is run twice: with the halt request armed under reset lost at NRST release
+// (default, worst case: only the post-release DHCSR write counts) and with it surviving.
+//
+// CMake builds one binary per SWD_HALF_PERIOD_US value (connect_window_sweep_hp<N>); it is
+// installed as the Runtime's half period (sim::txn::Timing).
+//
+// Usage: connect_window_sweep_hp<N> [max_us=10000] [step_us=1]
+
+#ifndef SWD_HALF_PERIOD_US
+#define SWD_HALF_PERIOD_US 1
+#endif
+
+namespace {
+
+struct Strategy {
+  const char *name;
+  bool (*run)();
+  bool must_halt;  // returning true without a halted core is a false pass
+};
+
+bool run_connect_and_halt() { return stm32g0_prog::connect_and_halt(); }
+bool run_connect_recovery() { return stm32g0_prog::connect_and_halt_under_reset_recovery(); }
+bool run_mass_erase_under_reset() { return stm32g0_prog::flash_mass_erase_under_reset(); }
+
+struct Outcome {
+  bool returned_ok = false;
+  bool halted = false;
+};
+
+Outcome run_once(const Strategy &s, uint64_t window_ns, bool survives_reset) {
+  auto &t = sim::rt().target;
+  t.reset();
+  static const uint8_t image[8] = {0xDE, 0xAD, 0xBE, 0xEF, 0xCA, 0xFE, 0xBA, 0xBE};
+  t.load_flash_image(image, sizeof(image));
+  t.set_halt_request_survives_reset(survives_reset);
+
+  sim::Stm32SwdTarget::FaultConfig cfg;
+  cfg.early_swd_disable = true;
+  cfg.early_swd_disable_after_ns = window_ns;
+  t.set_faults(cfg);
+
+  Outcome o;
+  o.returned_ok = s.run();
+  o.halted = t.core_halted();
+  return o;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const uint32_t max_us = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 0) : 10000u;
+  uint32_t step_us = (argc > 2) ? (uint32_t)std::strtoul(argv[2], nullptr, 0) : 1u;
+  if (step_us == 0) step_us = 1;
+
+  sim::set_log_path("connect_window_sweep.csv");
+  sim::set_waveform_logging(false);
+  sim::set_console_output(false);
+  sim::txn::timing().half_period_us = SWD_HALF_PERIOD_US;
+
+  static const swd_min::Pins pins(35, 36, 37);
+  swd_min::begin(pins);
+  swd_min::set_verbose(false);
+
+  static const Strategy strategies[] = {
+      {"connect_and_halt", run_connect_and_halt, false},
+      {"connect_recovery", run_connect_recovery, true},
+      {"mass_erase_under_reset", run_mass_erase_under_reset, true},
+  };
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  std::printf("connect_window_sweep: SWD_HALF_PERIOD_US=%u X=0..%u us step=%u us\n", (unsigned)SWD_HALF_PERIOD_US,
+              max_us, step_us);
+  std::printf("%-24s %-10s %12s %12s %9s %6s\n", "strategy", "halt_arm", "fails_to_us", "ok_from_us", "monotonic",
+              "unhalted");
+
+  uint32_t false_total = 0;
+  for (const Strategy &s : strategies) {
+    for (int survives = 0; survives < 2; survives++) {
+      long last_fail = -1;
+      bool seen_ok = false;
+      bool monotonic = true;
+      uint32_t unhalted = 0;
+      for (uint32_t x = 0; x <= max_us; x += step_us) {
+        const Outcome o = run_once(s, (uint64_t)x * 1000ull, survives != 0);
+        if (o.returned_ok && !o.halted) {
+          unhalted++;
+          if (s.must_halt) std::fprintf(stderr, "FALSE PASS: %s X=%u us (core not halted)\n", s.name, x);
+        }
+        const bool ok = o.returned_ok && o.halted;
+        if (ok) {
+          seen_ok = true;
+        } else {
+          if (seen_ok) monotonic = false;
+          last_fail = (long)x;
+        }
+      }
+      if (s.must_halt) false_total += unhalted;
+
+      char fails_buf[24];
+      char ok_buf[24];
+      if (last_fail < 0) std::snprintf(fails_buf, sizeof(fails_buf), "-");
+      else std::snprintf(fails_buf, sizeof(fails_buf), "%ld", last_fail);
+      // "ok_from" is the smallest X from which every sampled window succeeded.
+      if (last_fail < 0) std::snprintf(ok_buf, sizeof(ok_buf), "0");
+      else if (last_fail + (long)step_us > (long)max_us) std::snprintf(ok_buf, sizeof(ok_buf), "never");
+      else std::snprintf(ok_buf, sizeof(ok_buf), "%ld", last_fail + (long)step_us);
+
+      std::printf("%-24s %-10s %12s %12s %9s %6u\n", s.name, survives ? "survives" : "lost", fails_buf, ok_buf,
+                  monotonic ? "yes" : "NO", unhalted);
+    }
+  }
+
+  const double wall_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  std::printf("wall time: %.2f s\n", wall_s);
+  return false_total ? 2 : 0;
+}
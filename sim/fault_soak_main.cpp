@@ -0,0 +1,278 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "stm32g0_prog.h"
+#include "swd_min.h"
+
+#include "runtime.h"
+#include "sim_api.h"
+#include "swd_txn_backend.h"
+
+// Fault-injection soak runner (transaction-level backend).
+//
+// For each scenario, programs a series of randomized images with the production sequence
+// (connect+halt recovery -> mass erase -> program -> fast verify) while the target model
+// injects faults (see Stm32SwdTarget::FaultConfig). A failed attempt is retried from scratch,
+// the way an operator re-runs the jig, up to k_max_attempts times.
+//
+// Reported per scenario:
+// - first-try passes, passes after retry, hard failures
+// - simulated time per image and its overhead relative to the fault-free baseline
+//   (= the throughput cost of whatever recovery path the fault forces)
+// - FALSE PASSES: production reported success but the simulated flash array does not hold
+//   the image. Any false pass (or a failing baseline) makes the runner exit non-zero.
+//
+// Usage: fault_soak [images_per_scenario=40] [seed=1]
+
+namespace {
+
+static constexpr uint32_t k_max_attempts = 3;
+static constexpr uint32_t k_max_image_bytes = 16u * 1024u;
+
+using FaultConfig = sim::Stm32SwdTarget::FaultConfig;
+
+struct Scenario {
+  const char *name;
+  // Builds the fault config for one image; `rng` is the scenario's image-level RNG.
+  std::function<FaultConfig(std::mt19937 &rng, uint32_t image_len)> make;
+};
+
+struct Result {
+  uint32_t images = 0;
+  uint32_t pass_first = 0;
+  uint32_t pass_retry = 0;
+  uint32_t hard_fail = 0;
+  uint32_t false_pass = 0;
+  uint32_t attempts = 0;
+  uint64_t bytes = 0;
+  uint64_t sim_ns = 0;
+  uint64_t non_ok_acks = 0;
+  sim::Stm32SwdTarget::FaultStats faults;
+};
+
+bool attempt(const std::vector<uint8_t> &padded) {
+  if (!stm32g0_prog::connect_and_halt_under_reset_recovery()) return false;
+  if (!stm32g0_prog::flash_mass_erase()) return false;
+  if (!stm32g0_prog::flash_program(stm32g0_prog::FLASH_BASE, padded.data(), (uint32_t)padded.size())) return false;
+  uint32_t mismatches = 0;
+  return stm32g0_prog::flash_verify_fast(stm32g0_prog::FLASH_BASE, padded.data(), (uint32_t)padded.size(),
+                                         &mismatches, /*max_report=*/0);
+}
+
+bool flash_holds(const std::vector<uint8_t> &padded) {
+  const std::vector<uint8_t> &flash = sim::rt().target.flash_contents();
+  for (size_t i = 0; i < flash.size(); i++) {
+    const uint8_t exp = (i < padded.size()) ? padded[i] : 0xFF;
+    if (flash[i] != exp) return false;
+  }
+  return true;
+}
+
+void accumulate(sim::Stm32SwdTarget::FaultStats &dst, const sim::Stm32SwdTarget::FaultStats &s) {
+  dst.ap_accesses += s.ap_accesses;
+  dst.waits += s.waits;
+  dst.faults += s.faults;
+  dst.sticky_faults += s.sticky_faults;
+  dst.read_parity_errors += s.read_parity_errors;
+  dst.write_parity_errors += s.write_parity_errors;
+  dst.bsy_stalls += s.bsy_stalls;
+  dst.ignored_requests += s.ignored_requests;
+  dst.lost_writes += s.lost_writes;
+  dst.sticky_clears += s.sticky_clears;
+}
+
+Result run_scenario(const Scenario &sc, uint32_t scenario_index, uint32_t images, uint32_t seed) {
+  Result res;
+  // Same image sequence for every scenario (so overheads are comparable); separate fault RNG.
+  std::mt19937 image_rng(seed);
+  std::mt19937 fault_rng(seed * 1000003u + scenario_index);
+  std::uniform_int_distribution<uint32_t> len_dist(1u, k_max_image_bytes);
+  std::uniform_int_distribution<uint32_t> byte_dist(0u, 255u);
+
+  for (uint32_t i = 0; i < images; i++) {
+    std::vector<uint8_t> image(len_dist(image_rng));
+    for (auto &b : image) b = (uint8_t)byte_dist(image_rng);
+    std::vector<uint8_t> padded(image);
+    padded.resize((image.size() + 7u) & ~static_cast<size_t>(7u), 0xFF);
+
+    FaultConfig cfg = sc.make(fault_rng, (uint32_t)image.size());
+    cfg.seed = fault_rng();
+    sim::rt().target.set_faults(cfg);
+    const uint64_t acks_before = sim::txn::stats().non_ok_acks;
+    const uint64_t t0 = sim::now_ns();
+
+    bool passed = false;
+    uint32_t n = 0;
+    while (!passed && n < k_max_attempts) {
+      n++;
+      passed = attempt(padded);
+    }
+
+    res.images++;
+    res.attempts += n;
+    res.sim_ns += sim::now_ns() - t0;
+    res.non_ok_acks += sim::txn::stats().non_ok_acks - acks_before;
+    accumulate(res.faults, sim::rt().target.fault_stats());
+
+    if (!passed) {
+      res.hard_fail++;
+      continue;
+    }
+    res.bytes += image.size();
+    if (n == 1) res.pass_first++;
+    else res.pass_retry++;
+
+    if (!flash_holds(padded)) {
+      res.false_pass++;
+      std::fprintf(stderr, "FALSE PASS: scenario=%s image=%u len=%zu attempts=%u\n", sc.name, i, image.size(), n);
+    }
+  }
+
+  // Leave the target fault-free for the next scenario.
+  sim::rt().target.set_faults(FaultConfig{});
+  return res;
+}
+
+std::vector<Scenario> scenarios() {
+  using stm32g0_prog::FLASH_BASE;
+  std::vector<Scenario> v;
+
+  v.push_back({"baseline", [](std::mt19937 &, uint32_t) { return FaultConfig{}; }});
+
+  // Single WAIT somewhere in the run (connect/erase/program/verify alike).
+  v.push_back({"wait_once", [](std::mt19937 &rng, uint32_t len) {
+                 FaultConfig c;
+                 c.wait_on_ap_access = 1u + rng() % (len / 2u + 64u);
+                 return c;
+               }});
+
+  // Bursts of 4 WAITs every 5000 AP accesses.
+  v.push_back({"wait_burst_periodic", [](std::mt19937 &rng, uint32_t) {
+                 FaultConfig c;
+                 c.wait_on_ap_access = 1u + rng() % 5000u;
+                 c.wait_burst = 4;
+                 c.wait_period = 5000;
+                 return c;
+               }});
+
+  // One AHB FAULT on a random word of the image (sticky until ABORT.STKERRCLR).
+  v.push_back({"fault_once", [](std::mt19937 &rng, uint32_t len) {
+                 FaultConfig c;
+                 c.fault_addr_lo = FLASH_BASE + ((rng() % len) & ~3u);
+                 c.fault_addr_hi = c.fault_addr_lo + 4u;
+                 c.fault_addr_hits = 1;
+                 return c;
+               }});
+
+  // Permanently faulting word: every image that covers it must fail.
+  v.push_back({"fault_persistent", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.fault_addr_lo = FLASH_BASE + 0x100u;
+                 c.fault_addr_hi = FLASH_BASE + 0x104u;
+                 return c;
+               }});
+
+  v.push_back({"parity_1e-5", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.parity_error_rate = 1e-5;
+                 return c;
+               }});
+  v.push_back({"parity_1e-4", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.parity_error_rate = 1e-4;
+                 return c;
+               }});
+
+  // Stall shorter than the 10ms per-doubleword timeout: polling absorbs it.
+  v.push_back({"bsy_stall_5ms_1pct", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.bsy_stall_rate = 0.01;
+                 c.bsy_stall_ns = 5ull * 1000ull * 1000ull;
+                 return c;
+               }});
+
+  // Stall longer than the per-doubleword timeout: the attempt must fail.
+  v.push_back({"bsy_stall_20ms_0.1pct", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.bsy_stall_rate = 0.001;
+                 c.bsy_stall_ns = 20ull * 1000ull * 1000ull;
+                 return c;
+               }});
+
+  // User firmware repurposes the SWD pins after running for X us past NRST release unless the
+  // critical-window halt write lands first (see connect_window_sweep for the boundary).
+  v.push_back({"early_swd_disable_500us", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.early_swd_disable = true;
+                 c.early_swd_disable_after_ns = 500ull * 1000ull;
+                 return c;
+               }});
+  v.push_back({"early_swd_disable_50us", [](std::mt19937 &, uint32_t) {
+                 FaultConfig c;
+                 c.early_swd_disable = true;
+                 c.early_swd_disable_after_ns = 50ull * 1000ull;
+                 return c;
+               }});
+
+  return v;
+}
+
+double ms(uint64_t ns) { return (double)ns / 1e6; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const uint32_t images = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 0) : 40u;
+  const uint32_t seed = (argc > 2) ? (uint32_t)std::strtoul(argv[2], nullptr, 0) : 1u;
+
+  sim::set_log_path("fault_soak.csv");
+  sim::set_waveform_logging(false);
+  sim::set_console_output(false);
+
+  static const swd_min::Pins pins(35, 36, 37);
+  swd_min::begin(pins);
+  swd_min::set_verbose(false);
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  const std::vector<Scenario> list = scenarios();
+
+  std::printf("fault_soak: images/scenario=%u seed=%u max_attempts=%u\n", images, seed, k_max_attempts);
+  std::printf("%-24s %5s %5s %5s %5s %6s %9s %9s %8s %8s  %s\n", "scenario", "first", "retry", "fail", "FALSE",
+              "tries", "ms/image", "KiB/s", "overhead", "nonOK", "injected");
+
+  bool ok = true;
+  double baseline_ns_per_image = 0.0;
+  for (uint32_t s = 0; s < list.size(); s++) {
+    const Result r = run_scenario(list[s], s, images, seed);
+    const double ns_per_image = r.images ? (double)r.sim_ns / r.images : 0.0;
+    if (s == 0) {
+      baseline_ns_per_image = ns_per_image;
+      if (r.pass_first != r.images) {
+        std::fprintf(stderr, "baseline scenario did not pass every image on the first try\n");
+        ok = false;
+      }
+    }
+    if (r.false_pass) ok = false;
+
+    const double kibps = r.sim_ns ? (r.bytes / 1024.0) / (r.sim_ns / 1e9) : 0.0;
+    const double overhead = baseline_ns_per_image > 0 ? 100.0 * (ns_per_image / baseline_ns_per_image - 1.0) : 0.0;
+    const sim::Stm32SwdTarget::FaultStats &f = r.faults;
+    std::printf("%-24s %5u %5u %5u %5u %6u %9.1f %9.2f %7.1f%% %8llu  wait=%llu fault=%llu sticky=%llu par_r=%llu "
+                "par_w=%llu bsy=%llu ignored=%llu\n",
+                list[s].name, r.pass_first, r.pass_retry, r.hard_fail, r.false_pass, r.attempts,
+                ms((uint64_t)ns_per_image), kibps, overhead, (unsigned long long)r.non_ok_acks,
+                (unsigned long long)f.waits, (unsigned long long)f.faults, (unsigned long long)f.sticky_faults,
+                (unsigned long long)f.read_parity_errors, (unsigned long long)f.write_parity_errors,
+                (unsigned long long)f.bsy_stalls, (unsigned long long)f.ignored_requests);
+  }
+
+  const double wall_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  std::printf("wall time: %.2f s\n", wall_s);
+  std::printf("%s\n", ok ? "RESULT: OK (no false passes)" : "RESULT: FAIL");
+  return ok ? 0 : 2;
+}
@@ -4,13 +4,19 @@
 
 namespace sim {
 
-CsvLogger::CsvLogger(const std::string &path) : out_(path) {
+CsvLogger::CsvLogger(const std::string &path) {
+  if (path.empty()) {
+    enabled_ = false;
+    return;
+  }
+  out_.open(path);
   out_ << "t_ns,signal,voltage,value\n";
   out_.setf(std::ios::fixed);
   out_ << std::setprecision(3);
 }
 
 void CsvLogger::log_voltage_change(uint64_t t_ns, const std::string &signal, double voltage) {
+  if (!enabled_) return;
   auto it = last_v_.find(signal);
   if (it != last_v_.end()) {
     if (it->second == voltage) return;
@@ -24,6 +30,7 @@ void CsvLogger::log_voltage_change(uint64_t t_ns, const std::string &signal, dou
 }
 
 void CsvLogger::log_event(uint64_t t_ns, const std::string &signal, double voltage, double value) {
+  if (!enabled_) return;
   out_ << t_ns << "," << signal << "," << voltage << "," << value << "\n";
 }
 
@@ -9,6 +9,7 @@ namespace sim {
 
 class CsvLogger {
 public:
+  // An empty `path` creates a logger without a file; it starts (and stays) disabled.
   explicit CsvLogger(const std::string &path);
 
   // Logs a value only if it changed since the last time this signal was logged.
@@ -19,8 +20,14 @@ public:
   // `voltage` is plotted on the y-axis; `value` is optional metadata for text labels.
   void log_event(uint64_t t_ns, const std::string &signal, double voltage, double value);
 
+  // When disabled, both log_* calls return immediately (used by long regression runs
+  // where nobody will look at the waveform).
+  void set_enabled(bool enabled) { enabled_ = enabled && out_.is_open(); }
+  bool enabled() const { return enabled_; }
+
 private:
   std::ofstream out_;
+  bool enabled_ = true;
   std::unordered_map<std::string, double> last_v_;
 };
 
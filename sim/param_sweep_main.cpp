@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "stm32g0_prog.h"
+#include "swd_min.h"
+
+#include "runtime.h"
+#include "sim_api.h"
+#include "swd_txn_backend.h"
+
+// Parallel timing-parameter sweep (transaction-level backend).
+//
+// Runs the production sequence (connect+halt recovery -> mass erase -> program -> fast verify)
+// once per configuration of
+//   SWD_HALF_PERIOD_US x SWD_POST_IDLE_LOW_CYCLES x SWD_REQ_IDLE_LOW_BITS x flash BSY timing x image size
+// Every configuration gets its own sim::Runtime (no CSV file) on a worker thread, so one
+// binary replaces the per-variant builds (e.g. the *_idle2 / *_idle10 waveform runs) when
+// only timing and pass/fail matter.
+//
+// Reported per configuration: simulated time of each phase, throughput, and PASS/FAIL.
+// PASS needs every phase to succeed AND the simulated flash array to hold the image.
+// BSY profiles whose per-doubleword busy time exceeds flash_program()'s 10ms poll timeout
+// are expected to FAIL; any other outcome than expected makes the runner exit non-zero.
+//
+// Usage: param_sweep [threads=0 (= hardware concurrency)] [csv_out]
+
+namespace {
+
+struct BsyProfile {
+  const char *name;
+  uint64_t mass_erase_ns;
+  uint64_t program32_ns;
+  bool expect_pass;
+};
+
+// "model" is the target model's default; "fast" is close to the STM32G0 datasheet typicals.
+static const BsyProfile k_bsy_profiles[] = {
+    {"fast", 22ull * 1000ull * 1000ull, 85ull * 1000ull, true},
+    {"model", 50ull * 1000ull * 1000ull, 200ull * 1000ull, true},
+    {"prog_12ms", 50ull * 1000ull * 1000ull, 12ull * 1000ull * 1000ull, false},
+};
+
+static const uint32_t k_half_periods_us[] = {1, 2, 5};
+static const uint32_t k_post_idle_cycles[] = {2, 8, 10};
+static const uint32_t k_req_idle_bits[] = {0, 2};
+// Small, unaligned tail, whole flash.
+static const uint32_t k_image_bytes[] = {1024, 16u * 1024u + 3u, 64u * 1024u};
+
+struct Config {
+  sim::txn::Timing timing;
+  const BsyProfile *bsy;
+  uint32_t image_bytes;
+};
+
+enum Phase { kConnect, kErase, kProgram, kVerify, kPhaseCount };
+static const char *const k_phase_names[kPhaseCount] = {"connect", "erase", "program", "verify"};
+
+struct Row {
+  uint64_t phase_ns[kPhaseCount] = {};
+  int failed_phase = -1;  // -1: every phase returned true
+  bool flash_ok = false;
+  uint64_t transactions = 0;
+
+  bool passed() const { return failed_phase < 0 && flash_ok; }
+};
+
+std::vector<uint8_t> make_image(uint32_t len) {
+  // Same image for every configuration of a given size.
+  std::mt19937 rng(len);
+  std::vector<uint8_t> image(len);
+  for (auto &b : image) b = (uint8_t)rng();
+  image.resize((len + 7u) & ~7u, 0xFF);
+  return image;
+}
+
+bool run_phase(Phase p, const std::vector<uint8_t> &padded) {
+  switch (p) {
+  case kConnect:
+    return stm32g0_prog::connect_and_halt_under_reset_recovery();
+  case kErase:
+    return stm32g0_prog::flash_mass_erase();
+  case kProgram:
+    return stm32g0_prog::flash_program(stm32g0_prog::FLASH_BASE, padded.data(), (uint32_t)padded.size());
+  case kVerify: {
+    uint32_t mismatches = 0;
+    return stm32g0_prog::flash_verify_fast(stm32g0_prog::FLASH_BASE, padded.data(), (uint32_t)padded.size(),
+                                           &mismatches, /*max_report=*/0);
+  }
+  default:
+    return false;
+  }
+}
+
+Row run_config(const Config &c) {
+  sim::Runtime r(/*log_path=*/nullptr);
+  sim::ScopedRuntime scope(r);
+  sim::set_console_output(false);
+  r.txn_timing = c.timing;
+  r.target.set_flash_busy_times(c.bsy->mass_erase_ns, c.bsy->program32_ns);
+
+  static const swd_min::Pins pins(35, 36, 37);
+  swd_min::begin(pins);
+  swd_min::set_verbose(false);
+
+  const std::vector<uint8_t> padded = make_image(c.image_bytes);
+  Row row;
+  for (int p = 0; p < kPhaseCount; p++) {
+    const uint64_t t0 = sim::now_ns();
+    const bool ok = run_phase((Phase)p, padded);
+    row.phase_ns[p] = sim::now_ns() - t0;
+    if (!ok) {
+      row.failed_phase = p;
+      break;
+    }
+  }
+
+  const std::vector<uint8_t> &flash = r.target.flash_contents();
+  row.flash_ok = true;
+  for (size_t i = 0; i < flash.size(); i++) {
+    const uint8_t exp = (i < padded.size()) ? padded[i] : 0xFF;
+    if (flash[i] != exp) {
+      row.flash_ok = false;
+      break;
+    }
+  }
+  row.transactions = r.txn_stats.transactions();
+  return row;
+}
+
+std::vector<Config> make_grid() {
+  std::vector<Config> v;
+  for (uint32_t hp : k_half_periods_us)
+    for (uint32_t post : k_post_idle_cycles)
+      for (uint32_t req : k_req_idle_bits)
+        for (const BsyProfile &bsy : k_bsy_profiles)
+          for (uint32_t len : k_image_bytes) {
+            Config c;
+            c.timing.half_period_us = hp;
+            c.timing.post_idle_low_cycles = post;
+            c.timing.req_idle_low_bits = req;
+            c.bsy = &bsy;
+            c.image_bytes = len;
+            v.push_back(c);
+          }
+  return v;
+}
+
+double ms(uint64_t ns) { return (double)ns / 1e6; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t threads = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 0) : 0u;
+  const char *csv_path = (argc > 2) ? argv[2] : nullptr;
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  const std::vector<Config> grid = make_grid();
+  std::vector<Row> rows(grid.size());
+  threads = std::min<uint32_t>(threads, (uint32_t)grid.size());
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  // Only the workers' Runtimes are driven; the default one (and signals.csv) is never touched.
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> pool;
+  for (uint32_t i = 0; i < threads; i++) {
+    pool.emplace_back([&]() {
+      for (size_t k = next++; k < grid.size(); k = next++) rows[k] = run_config(grid[k]);
+    });
+  }
+  for (auto &t : pool) t.join();
+  const double wall_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+  std::FILE *csv = csv_path ? std::fopen(csv_path, "w") : nullptr;
+  if (csv_path && !csv) std::fprintf(stderr, "cannot open %s\n", csv_path);
+  if (csv) {
+    std::fprintf(csv, "half_period_us,post_idle_low_cycles,req_idle_low_bits,bsy,image_bytes,connect_ns,erase_ns,"
+                      "program_ns,verify_ns,transactions,result,expected\n");
+  }
+
+  std::printf("param_sweep: %zu configurations, %u threads\n", grid.size(), threads);
+  std::printf("%3s %4s %3s %-9s %6s %9s %9s %9s %9s %9s %8s  %s\n", "hp", "post", "req", "bsy", "bytes", "connect",
+              "erase", "program", "verify", "total_ms", "KiB/s", "result");
+
+  uint32_t passed = 0;
+  uint32_t unexpected = 0;
+  for (size_t k = 0; k < grid.size(); k++) {
+    const Config &c = grid[k];
+    const Row &r = rows[k];
+    uint64_t total_ns = 0;
+    for (uint64_t ns : r.phase_ns) total_ns += ns;
+    const bool pass = r.passed();
+    if (pass) passed++;
+    if (pass != c.bsy->expect_pass) unexpected++;
+
+    char result[32];
+    if (pass) std::snprintf(result, sizeof(result), "PASS");
+    else if (r.failed_phase >= 0) std::snprintf(result, sizeof(result), "FAIL(%s)", k_phase_names[r.failed_phase]);
+    else std::snprintf(result, sizeof(result), "FAIL(flash)");
+
+    const double kibps = (pass && total_ns) ? (c.image_bytes / 1024.0) / (total_ns / 1e9) : 0.0;
+    std::printf("%3u %4u %3u %-9s %6u %9.2f %9.2f %9.2f %9.2f %9.2f %8.2f  %s%s\n", c.timing.half_period_us,
+                c.timing.post_idle_low_cycles, c.timing.req_idle_low_bits, c.bsy->name, c.image_bytes,
+                ms(r.phase_ns[kConnect]), ms(r.phase_ns[kErase]), ms(r.phase_ns[kProgram]), ms(r.phase_ns[kVerify]),
+                ms(total_ns), kibps, result, (pass != c.bsy->expect_pass) ? "  UNEXPECTED" : "");
+    if (csv) {
+      std::fprintf(csv, "%u,%u,%u,%s,%u,%llu,%llu,%llu,%llu,%llu,%s,%s\n", c.timing.half_period_us,
+                   c.timing.post_idle_low_cycles, c.timing.req_idle_low_bits, c.bsy->name, c.image_bytes,
+                   (unsigned long long)r.phase_ns[kConnect], (unsigned long long)r.phase_ns[kErase],
+                   (unsigned long long)r.phase_ns[kProgram], (unsigned long long)r.phase_ns[kVerify],
+                   (unsigned long long)r.transactions, result, c.bsy->expect_pass ? "PASS" : "FAIL");
+    }
+  }
+  if (csv) std::fclose(csv);
+
+  std::printf("passed %u/%zu, unexpected %u\n", passed, grid.size(), unexpected);
+  std::printf("wall time: %.2f s\n", wall_s);
+  std::printf("%s\n", unexpected ? "RESULT: FAIL" : "RESULT: OK");
+  return unexpected ? 2 : 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "gpio_model.h"
+#include "logger.h"
+#include "stm32_swd_target.h"
+#include "swd_txn_backend.h"
+#include "swd_min.h"
+
+namespace sim {
+
+// Simulation context: the whole state of one simulated jig (clock, pins, target, logger and
+// swd_min's driver state), shared by the Arduino shim and the simulator backends through rt().
+// Normal executables use the process-wide default instance; tests and sweep runners create
+// their own and install them with ScopedRuntime, any number per process.
+struct Runtime {
+  uint64_t t_ns = 0;
+
+  int swclk_pin = 35;
+  int swdio_pin = 36;
+  int nrst_pin  = 37;
+
+  GpioModel gpio;
+  std::unique_ptr<CsvLogger> logger;
+  Stm32SwdTarget target;
+
+  uint8_t last_swclk_level = 0;
+
+  // Visualization: log target state-machine transitions as STEP_* markers.
+  std::string last_target_phase_label;
+
+  bool swdio_input_pullup_seen = false;
+  bool target_drove_swdio_seen = false;
+  bool target_voltage_logged_seen = false;
+
+  // Serial shim stdout output (sim::set_console_output()).
+  bool console_output = true;
+  // When set, Serial shim output is appended here instead (sim::set_console_capture()).
+  std::string *console_capture = nullptr;
+  // tee_log capture flag (sim/arduino_compat/tee_log_sim.cpp).
+  bool tee_capture_enabled = true;
+
+  // swd_min's driver state (swd_min::context(); built with SWD_MIN_EXTERNAL_CONTEXT).
+  swd_min::Context swd;
+
+  // Transaction-level backend accounting and swd_min timing knobs (swd_txn_backend.h).
+  txn::Stats txn_stats;
+  txn::Timing txn_timing;
+
+  // Decoded transaction trace (sim::set_trace_path(); sim/swd_trace.cpp) and the phase
+  // column it is tagged with (last sim::log_step() marker).
+  std::unique_ptr<std::ofstream> trace_out;
+  std::string trace_phase;
+
+  // `log_path` == nullptr: no CSV file at all (waveform logging disabled).
+  explicit Runtime(const char *log_path = "signals.csv")
+      : logger(std::make_unique<CsvLogger>(log_path ? log_path : "")) {
+    target.reset();
+    // Simulator compatibility note:
+    // The ESP32 firmware now sources the STM32 image from a filesystem file.
+    // For simulations we keep a tiny embedded payload to seed the simulated target.
+    // This enables read-flash simulations without requiring a separate programming step.
+    static const uint8_t firmware_bin_8[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xCA, 0xFE, 0xBA, 0xBE};
+    target.load_flash_image(firmware_bin_8, (unsigned)sizeof(firmware_bin_8));
+  }
+};
+
+// Implemented in sim/arduino_compat/arduino_compat.cpp.
+// Returns the Runtime installed on the calling thread, or the process-wide default.
+Runtime &rt();
+
+// Installs `r` as the calling thread's Runtime for the lifetime of the scope.
+// Each Runtime must only be driven by one thread at a time.
+class ScopedRuntime {
+public:
+  explicit ScopedRuntime(Runtime &r);
+  ~ScopedRuntime();
+  ScopedRuntime(const ScopedRuntime &) = delete;
+  ScopedRuntime &operator=(const ScopedRuntime &) = delete;
+
+private:
+  Runtime *prev_;
+};
+
+} // namespace sim
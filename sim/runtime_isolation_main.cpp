@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "stm32g0_prog.h"
+#include "swd_min.h"
+
+#include "runtime.h"
+#include "sim_api.h"
+
+// Runtime isolation check (edge-level backend, libswd_sim).
+//
+// Runs the read_flash_simulation sequence (attach + IDCODE + flash_read_bytes) in many
+// sim::Runtime instances inside one process:
+// - sequentially, each Runtime seeded with its own flash image,
+// - interleaved step by step across all of them (every Runtime alive at once),
+// and checks that every run reads its own image, ends at the same simulated time as a
+// reference run, and that swd_min's driver state (verbose flag, pins, NRST banner state)
+// does not leak from one Runtime into another. The process-wide default Runtime is never
+// used, so no signals.csv is written.
+//
+// Usage: runtime_isolation [runtimes=16]
+
+namespace {
+
+struct Outcome {
+  bool id_ok = false;
+  uint32_t idcode = 0;
+  bool read_ok = false;
+  uint8_t bytes[8] = {};
+  uint64_t t_ns = 0;
+};
+
+void seed(sim::Runtime &r, uint32_t n) {
+  uint8_t image[8];
+  for (uint32_t i = 0; i < sizeof(image); i++) image[i] = (uint8_t)(n * 8u + i);
+  r.target.load_flash_image(image, sizeof(image));
+}
+
+void attach(sim::Runtime &r, Outcome &o) {
+  sim::ScopedRuntime scope(r);
+  sim::set_console_output(false);
+  static const swd_min::Pins pins(35, 36, 37);
+  swd_min::begin(pins);
+  swd_min::reset_and_switch_to_swd();
+  uint8_t ack = 0;
+  o.id_ok = swd_min::read_idcode(&o.idcode, &ack);
+}
+
+void read_flash(sim::Runtime &r, Outcome &o) {
+  sim::ScopedRuntime scope(r);
+  uint32_t optr = 0;
+  o.read_ok = stm32g0_prog::flash_read_bytes(stm32g0_prog::FLASH_BASE, o.bytes, sizeof(o.bytes), &optr);
+  o.t_ns = sim::now_ns();
+}
+
+bool check(const char *what, uint32_t n, const Outcome &o, const Outcome &ref) {
+  bool ok = o.id_ok && o.read_ok && o.idcode == ref.idcode && o.t_ns == ref.t_ns;
+  for (uint32_t i = 0; i < sizeof(o.bytes); i++) ok = ok && o.bytes[i] == (uint8_t)(n * 8u + i);
+  if (!ok) {
+    std::fprintf(stderr, "%s #%u: id_ok=%d idcode=0x%08X read_ok=%d byte0=0x%02X t_ns=%llu (ref %llu)\n", what, n,
+                 o.id_ok ? 1 : 0, o.idcode, o.read_ok ? 1 : 0, o.bytes[0], (unsigned long long)o.t_ns,
+                 (unsigned long long)ref.t_ns);
+  }
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const uint32_t count = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 0) : 16u;
+  uint32_t failures = 0;
+
+  // Reference run.
+  Outcome ref;
+  {
+    sim::Runtime r(/*log_path=*/nullptr);
+    seed(r, 0);
+    attach(r, ref);
+    read_flash(r, ref);
+  }
+  std::printf("reference: idcode=0x%08X read_ok=%d t=%.3f ms\n", ref.idcode, ref.read_ok ? 1 : 0, ref.t_ns / 1e6);
+  if (!ref.id_ok || !ref.read_ok) failures++;
+
+  // Sequential: fresh Runtime per run.
+  for (uint32_t n = 1; n <= count; n++) {
+    sim::Runtime r(/*log_path=*/nullptr);
+    seed(r, n);
+    Outcome o;
+    attach(r, o);
+    read_flash(r, o);
+    if (!check("sequential", n, o, ref)) failures++;
+  }
+
+  // Interleaved: every Runtime is alive at once; steps alternate between them.
+  std::vector<std::unique_ptr<sim::Runtime>> jigs;
+  std::vector<Outcome> outs(count);
+  for (uint32_t n = 0; n < count; n++) {
+    jigs.push_back(std::make_unique<sim::Runtime>(/*log_path=*/nullptr));
+    seed(*jigs[n], n + 1);
+  }
+  for (uint32_t n = 0; n < count; n++) attach(*jigs[n], outs[n]);
+  // Driver state is per Runtime: quieting one jig must not quiet the others.
+  {
+    sim::ScopedRuntime scope(*jigs[0]);
+    swd_min::set_verbose(false);
+  }
+  for (uint32_t n = 1; n < count; n++) {
+    sim::ScopedRuntime scope(*jigs[n]);
+    if (!swd_min::verbose_enabled()) {
+      std::fprintf(stderr, "interleaved #%u: verbose flag leaked from another Runtime\n", n + 1);
+      failures++;
+    }
+  }
+  for (uint32_t n = count; n-- > 0;) read_flash(*jigs[n], outs[n]);
+  for (uint32_t n = 0; n < count; n++) {
+    if (!check("interleaved", n + 1, outs[n], ref)) failures++;
+  }
+
+  std::printf("runtimes: %u sequential + %u interleaved, failures: %u\n", count, count, failures);
+  std::printf("%s\n", failures ? "RESULT: FAIL" : "RESULT: OK");
+  return failures ? 2 : 0;
+}
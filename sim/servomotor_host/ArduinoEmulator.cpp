@@ -0,0 +1,198 @@
+#include "ArduinoEmulator.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+ConsoleSerial Serial;
+HardwareSerial Serial1;
+
+static bool s_console_output = true;
+static bool s_virtual_time = false;
+static uint64_t s_virtual_now_us = 0;
+static std::function<void(uint8_t, uint8_t)> s_pin_write_handler;
+static uint8_t s_pin_levels[256];
+
+namespace arduino_emulator {
+void set_console_output(bool enabled) { s_console_output = enabled; }
+void set_pin_write_handler(std::function<void(uint8_t pin, uint8_t value)> handler) {
+  s_pin_write_handler = std::move(handler);
+}
+}  // namespace arduino_emulator
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  s_pin_levels[pin] = value ? HIGH : LOW;
+  if (s_pin_write_handler) s_pin_write_handler(pin, s_pin_levels[pin]);
+}
+
+int digitalRead(uint8_t pin) { return s_pin_levels[pin]; }
+
+static std::chrono::steady_clock::time_point start_time() {
+  static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  return t0;
+}
+
+static uint64_t real_now_us() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                         start_time())
+      .count();
+}
+
+namespace arduino_emulator {
+void set_virtual_time(bool enabled) {
+  if (enabled && !s_virtual_time) s_virtual_now_us = real_now_us();
+  s_virtual_time = enabled;
+}
+
+bool virtual_time() { return s_virtual_time; }
+
+uint64_t now_us() { return s_virtual_time ? s_virtual_now_us : real_now_us(); }
+
+void advance_time_us(uint64_t us) {
+  if (s_virtual_time) s_virtual_now_us += us;
+}
+}  // namespace arduino_emulator
+
+unsigned long millis() { return (unsigned long)(arduino_emulator::now_us() / 1000u); }
+
+unsigned long micros() { return (unsigned long)(uint32_t)arduino_emulator::now_us(); }
+
+int64_t esp_timer_get_time() { return (int64_t)arduino_emulator::now_us(); }
+
+void delay(unsigned long ms) {
+  if (s_virtual_time) {
+    s_virtual_now_us += (uint64_t)ms * 1000u;
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (s_virtual_time) {
+    s_virtual_now_us += us;
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  for (size_t i = 0; i < size; i++) n += write(buffer[i]);
+  return n;
+}
+
+size_t Print::print(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+
+size_t Print::print(char c) { return write((uint8_t)c); }
+
+size_t Print::print(long long v, int base) {
+  if (v < 0 && base == DEC) return print('-') + print((unsigned long long)(-(v + 1)) + 1, base);
+  return print((unsigned long long)v, base);
+}
+
+size_t Print::print(unsigned long long v, int base) {
+  char buf[65];
+  int i = (int)sizeof(buf) - 1;
+  buf[i] = '\0';
+  if (base < 2) base = DEC;
+  do {
+    const unsigned d = (unsigned)(v % (unsigned)base);
+    buf[--i] = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    v /= (unsigned)base;
+  } while (v);
+  return print(&buf[i]);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return print(buf);
+}
+
+size_t Print::printf(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  const int n = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (n < 0) return 0;
+  if ((size_t)n < sizeof(buf)) return write((const uint8_t *)buf, (size_t)n);
+  std::string long_buf((size_t)n + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&long_buf[0], long_buf.size(), format, args);
+  va_end(args);
+  return write((const uint8_t *)long_buf.data(), (size_t)n);
+}
+
+size_t Print::println() { return print("\r\n"); }
+
+size_t ConsoleSerial::write(uint8_t b) { return write(&b, 1); }
+
+size_t ConsoleSerial::write(const uint8_t *buffer, size_t size) {
+  if (s_console_output) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+// Idle poll step of the simulated clock while waiting for a byte.
+static constexpr uint64_t k_rx_idle_step_us = 20;
+
+size_t HardwareSerial::ready() {
+  const uint64_t now = arduino_emulator::now_us();
+  while (ready_ < rx_.size() && rx_[ready_].due_us <= now) ready_++;
+  return ready_;
+}
+
+int HardwareSerial::available() {
+  const size_t n = ready();
+  if (s_virtual_time && (n == 0 || n == polled_)) {
+    // Waiting for (more) data: let the simulated time pass, up to the next byte.
+    uint64_t step = k_rx_idle_step_us;
+    if (n < rx_.size() && rx_[n].due_us - s_virtual_now_us < step) step = rx_[n].due_us - s_virtual_now_us;
+    s_virtual_now_us += step;
+  }
+  polled_ = ready();
+  return (int)polled_;
+}
+
+int HardwareSerial::read() {
+  if (ready() == 0) return -1;
+  const uint8_t b = rx_.front().value;
+  rx_.pop_front();
+  ready_--;
+  polled_ = SIZE_MAX;
+  return b;
+}
+
+void HardwareSerial::flush() {
+  if (s_virtual_time && tx_done_us_ > s_virtual_now_us) s_virtual_now_us = tx_done_us_;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  write_calls_++;
+  bytes_written_ += size;
+  const uint64_t now = arduino_emulator::now_us();
+  tx_done_us_ = (tx_done_us_ > now ? tx_done_us_ : now) + (uint64_t)(byte_time_us() * (double)size + 0.5);
+  if (on_transmit_) on_transmit_(buffer, size);
+  return size;
+}
+
+void HardwareSerial::inject_rx(const uint8_t *data, size_t size) {
+  const uint64_t due = rx_.empty() ? 0 : rx_.back().due_us;
+  for (size_t i = 0; i < size; i++) rx_.push_back(RxByte{due, data[i]});
+}
+
+void HardwareSerial::inject_rx_at(uint64_t at_us, const uint8_t *data, size_t size) {
+  const uint64_t start = (!rx_.empty() && rx_.back().due_us > at_us) ? rx_.back().due_us : at_us;
+  const double byte_us = byte_time_us();
+  // A byte can be read once its stop bit is in.
+  for (size_t i = 0; i < size; i++) rx_.push_back(RxByte{start + (uint64_t)(byte_us * (double)(i + 1) + 0.5), data[i]});
+}
+
+void HardwareSerial::reset_counters() {
+  write_calls_ = 0;
+  bytes_written_ = 0;
+}
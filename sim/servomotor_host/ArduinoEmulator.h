@@ -0,0 +1,157 @@
+#pragma once
+
+// Desktop stand-in for the Arduino API used by lib/Servomotor (Communication.h includes
+// "ArduinoEmulator.h" when ARDUINO is not defined). Only implements what the library needs.
+//
+// HardwareSerial is a host-side byte pipe: bytes the library writes go to a transmit handler (a
+// fake device), and the fake device queues its replies with inject_rx(), or with inject_rx_at() to
+// have them arrive at wire speed from a given time. Serial is the console.
+//
+// Time is real (steady clock) unless arduino_emulator::set_virtual_time() switches to a simulated
+// clock. That clock only moves while the code waits: delay(), delayMicroseconds(), flush() until
+// the last byte is out, and available() finding nothing to read. Transfers, device delays and
+// timeouts then take no wall time.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <stdarg.h>
+
+#include <deque>
+#include <functional>
+
+#define HEX 16
+#define DEC 10
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+unsigned long millis();
+// Wraps at 2^32 like the 32-bit cores' micros() (ESP32: every ~71.6 minutes).
+unsigned long micros();
+// ESP-IDF's 64-bit microsecond clock (esp_timer.h); does not wrap.
+int64_t esp_timer_get_time();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// GPIO: levels are only remembered (and reported to the pin write handler below).
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+class Print {
+ public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+
+  size_t print(const char *s);
+  size_t print(char c);
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long long)v, base); }
+  size_t print(long v, int base = DEC) { return print((long long)v, base); }
+  size_t print(unsigned long v, int base = DEC) { return print((unsigned long long)v, base); }
+  size_t print(long long v, int base = DEC);
+  size_t print(unsigned long long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t println();
+  template <typename T>
+  size_t println(T v) {
+    const size_t n = print(v);
+    return n + println();
+  }
+  template <typename T>
+  size_t println(T v, int format) {
+    const size_t n = print(v, format);
+    return n + println();
+  }
+};
+
+// Console (Serial): stdout, can be muted for tests.
+class ConsoleSerial final : public Print {
+ public:
+  void begin(unsigned long) {}
+  explicit operator bool() const { return true; }
+
+  using Print::write;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+class HardwareSerial : public Print {
+ public:
+  using TransmitHandler = std::function<void(const uint8_t *data, size_t size)>;
+
+  void begin(unsigned long baud) { baud_ = baud; }
+  unsigned long baud() const { return baud_; }
+
+  int available();
+  int read();
+  // Returns once the last byte written is on the wire (virtual time only; a no-op in real time).
+  void flush();
+
+  using Print::write;
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override;
+
+  // Host side.
+  void set_transmit_handler(TransmitHandler handler) { on_transmit_ = std::move(handler); }
+  void inject_rx(const uint8_t *data, size_t size);
+  // Bytes arrive one after the other at the current baud (8N1) starting at at_us (emulator time,
+  // arduino_emulator::now_us()), but never before bytes already queued.
+  void inject_rx_at(uint64_t at_us, const uint8_t *data, size_t size);
+  // When the last byte written so far has left the UART (emulator time); bytes take 10 bit times.
+  uint64_t tx_done_us() const { return tx_done_us_; }
+  // Time of one byte on the wire at the current baud, 0 before begin().
+  double byte_time_us() const { return baud_ ? 10.0e6 / (double)baud_ : 0.0; }
+  // write() calls (each one a separate UART driver call on hardware) and bytes since reset_counters().
+  size_t write_calls() const { return write_calls_; }
+  size_t bytes_written() const { return bytes_written_; }
+  void reset_counters();
+  void clear_rx() {
+    rx_.clear();
+    ready_ = 0;
+    polled_ = SIZE_MAX;
+  }
+
+ private:
+  struct RxByte {
+    uint64_t due_us;
+    uint8_t value;
+  };
+  size_t ready();
+
+  unsigned long baud_ = 0;
+  std::deque<RxByte> rx_;
+  size_t ready_ = 0;  // leading bytes of rx_ already due
+  size_t polled_ = SIZE_MAX;  // what available() last returned, SIZE_MAX after a read()
+  uint64_t tx_done_us_ = 0;
+  TransmitHandler on_transmit_;
+  size_t write_calls_ = 0;
+  size_t bytes_written_ = 0;
+};
+
+extern ConsoleSerial Serial;
+extern HardwareSerial Serial1;
+
+namespace arduino_emulator {
+// Console output from Serial (default on).
+void set_console_output(bool enabled);
+// Called on every digitalWrite() (e.g. to see RS485 DE/RE edges relative to serial writes).
+void set_pin_write_handler(std::function<void(uint8_t pin, uint8_t value)> handler);
+// Simulated clock (see the top of this file). Switching it on continues from the current time.
+void set_virtual_time(bool enabled);
+bool virtual_time();
+// Emulator time in microseconds since start; millis()/micros() are derived from it.
+uint64_t now_us();
+// Moves the simulated clock forward (no-op in real time).
+void advance_time_us(uint64_t us);
+}  // namespace arduino_emulator
@@ -0,0 +1,313 @@
+#include "ServomotorBusEmulator.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+static uint32_t load_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static constexpr uint32_t k_application_base = k_emulated_first_application_page * k_emulated_flash_page_size;
+static constexpr uint32_t k_application_area =
+    (k_emulated_last_application_page - k_emulated_first_application_page + 1) * k_emulated_flash_page_size;
+
+EmulatedServomotor::EmulatedServomotor(const EmulatedDeviceConfig &config)
+    : config_(config),
+      flash_((size_t)k_emulated_flash_pages * k_emulated_flash_page_size, 0xFF),
+      crc32_enabled_(config.crc32_enabled) {
+  if (config_.application_valid) {
+    // Smallest image the bootloader accepts: size word, one word of code, CRC32.
+    uint8_t *app = flash_.data() + k_application_base;
+    store_le32(app, 1);
+    store_le32(app + 4, 0x12345678u);
+    store_le32(app + 8, calculate_crc32(app + 4, 4));
+  } else {
+    state_ = State::kBootloader;
+    bootloader_deadline_us_ = arduino_emulator::now_us() + config_.bootloader_timeout_us;
+  }
+}
+
+bool EmulatedServomotor::application_valid() const {
+  const uint8_t *app = flash_.data() + k_application_base;
+  const uint32_t size_words = load_le32(app);
+  if (size_words == 0 || size_words > (k_application_area - 8) / 4) return false;
+  return calculate_crc32(app + 4, size_words * 4u) == load_le32(app + 4 + size_words * 4u);
+}
+
+void EmulatedServomotor::update(uint64_t now_us) {
+  if (state_ == State::kResetting && now_us >= reset_done_us_) {
+    state_ = State::kBootloader;
+    bootloader_deadline_us_ = reset_done_us_ + config_.bootloader_timeout_us;
+    stay_in_bootloader_ = false;
+  }
+  if (state_ == State::kBootloader && !stay_in_bootloader_ && now_us >= bootloader_deadline_us_ &&
+      application_valid()) {
+    state_ = State::kApplication;
+  }
+}
+
+EmulatedServomotor::State EmulatedServomotor::state() {
+  update(arduino_emulator::now_us());
+  return state_;
+}
+
+void EmulatedServomotor::reset_at(uint64_t start_us) {
+  state_ = State::kResetting;
+  reset_done_us_ = start_us + config_.reset_us;
+  busy_until_us_ = 0;
+  crc32_enabled_ = config_.crc32_enabled;
+  resets_++;
+}
+
+void EmulatedServomotor::respond(uint8_t error, const void *payload, uint16_t payload_size,
+                                 std::vector<uint8_t> *reply) {
+  reply->resize((size_t)payload_size + 16);
+  FrameWriter w(reply->data(), (uint16_t)reply->size());
+  w.beginResponse(error, payload_size, crc32_enabled_);
+  w.append(payload, payload_size);
+  reply->resize(w.finish());
+}
+
+uint8_t EmulatedServomotor::write_page(const uint8_t *payload, uint16_t size, uint64_t end_us, uint32_t *busy_us) {
+  *busy_us = 0;
+  if (size != sizeof(firmwareUpgradePayload)) return EMULATED_ERROR_BAD_PAYLOAD;
+  // model code (8), firmware compatibility, page number, page data
+  if (memcmp(payload, config_.product_code, sizeof(config_.product_code)) != 0 ||
+      payload[8] != config_.firmware_compatibility) {
+    return EMULATED_ERROR_WRONG_MODEL;
+  }
+  const uint8_t page = payload[9];
+  if (page < k_emulated_first_application_page || page > k_emulated_last_application_page) {
+    return EMULATED_ERROR_BAD_PAGE;
+  }
+  memcpy(flash_.data() + (size_t)page * k_emulated_flash_page_size, payload + 10, k_emulated_flash_page_size);
+  pages_written_++;
+  *busy_us = config_.page_erase_us + config_.page_program_us;
+  busy_until_us_ = end_us + *busy_us;
+  return 0;
+}
+
+bool EmulatedServomotor::handle(const uint8_t *frame, uint16_t size, uint64_t end_us, std::mt19937 &rng,
+                                std::vector<uint8_t> *reply, uint64_t *reply_at_us) {
+  if (!present_) return false;
+  update(end_us);
+  if (state_ == State::kResetting) return false;
+  if (end_us < busy_until_us_) {
+    // Flash erase/program stalls the CPU; the UART overruns
+    counters_.overrunErrorCount++;
+    return false;
+  }
+  CommandView cmd;
+  const int16_t err = parseCommand(frame, size, crc32_enabled_, &cmd);
+  if (err == COMMUNICATION_ERROR_CRC32_MISMATCH) {
+    counters_.crc32ErrorCount++;
+    return false;
+  }
+  if (err != COMMUNICATION_SUCCESS) {
+    counters_.packetDecodeErrorCount++;
+    return false;
+  }
+  const bool broadcast = !cmd.isExtendedAddress && cmd.alias == ALL_ALIAS;
+  if (cmd.isExtendedAddress ? cmd.uniqueId != config_.unique_id : (!broadcast && cmd.alias != config_.alias)) {
+    return false;
+  }
+
+  const bool bootloader = state_ == State::kBootloader;
+  uint32_t work_us = 0;  // before the reply, on top of response_delay_us
+  bool reset = false;
+  switch (cmd.commandID) {
+    case DETECT_DEVICES: {
+      detectDevicesResponse r;
+      r.uniqueId = config_.unique_id;
+      r.alias = config_.alias;
+      respond(0, &r, sizeof(r), reply);
+      work_us = config_.detect_window_us ? (uint32_t)(rng() % config_.detect_window_us) : 0;
+      // The only command every device answers when broadcast
+      *reply_at_us = end_us + config_.response_delay_us + work_us;
+      return true;
+    }
+    case GET_PRODUCT_INFO: {
+      getProductInfoResponse r;
+      memset(&r, 0, sizeof(r));
+      memcpy(r.productCode, config_.product_code, sizeof(r.productCode));
+      r.firmwareCompatibility = config_.firmware_compatibility;
+      r.hardwareVersion = config_.hardware_version;
+      r.serialNumber = config_.serial_number;
+      r.uniqueId = config_.unique_id;
+      respond(0, &r, sizeof(r), reply);
+      break;
+    }
+    case GET_FIRMWARE_VERSION: {
+      getFirmwareVersionResponse r;
+      r.firmwareVersion = config_.firmware_version;
+      r.inBootloader = bootloader ? 1 : 0;
+      respond(0, &r, sizeof(r), reply);
+      break;
+    }
+    case SYSTEM_RESET:
+      respond(cmd.payloadSize == 0 ? 0 : EMULATED_ERROR_BAD_PAYLOAD, nullptr, 0, reply);
+      reset = cmd.payloadSize == 0;
+      break;
+    case FIRMWARE_UPGRADE:
+      if (!bootloader) {
+        respond(EMULATED_ERROR_NOT_IN_BOOTLOADER, nullptr, 0, reply);
+      } else {
+        stay_in_bootloader_ = true;
+        respond(write_page(cmd.payload, cmd.payloadSize, end_us, &work_us), nullptr, 0, reply);
+      }
+      break;
+    default:
+      // The bootloader only knows the commands above and ignores the rest
+      if (bootloader) return false;
+      switch (cmd.commandID) {
+        case SET_DEVICE_ALIAS:
+          if (cmd.payloadSize != sizeof(setDeviceAliasPayload)) {
+            respond(EMULATED_ERROR_BAD_PAYLOAD, nullptr, 0, reply);
+          } else {
+            config_.alias = cmd.payload[0];
+            respond(0, nullptr, 0, reply);
+          }
+          break;
+        case PING:
+          if (cmd.payloadSize != sizeof(pingPayload)) {
+            respond(EMULATED_ERROR_BAD_PAYLOAD, nullptr, 0, reply);
+          } else {
+            respond(0, cmd.payload, cmd.payloadSize, reply);
+          }
+          break;
+        case CRC32_CONTROL:
+          if (cmd.payloadSize != sizeof(crc32ControlPayload)) {
+            respond(EMULATED_ERROR_BAD_PAYLOAD, nullptr, 0, reply);
+          } else {
+            // Acknowledged under the new setting
+            crc32_enabled_ = cmd.payload[0] != 0;
+            respond(0, nullptr, 0, reply);
+          }
+          break;
+        case GET_COMMUNICATION_STATISTICS: {
+          const getCommunicationStatisticsResponse r = counters_;
+          respond(0, &r, sizeof(r), reply);
+          if (cmd.payloadSize == sizeof(getCommunicationStatisticsPayload) && cmd.payload[0] != 0) {
+            memset(&counters_, 0, sizeof(counters_));
+          }
+          break;
+        }
+        case GET_STATUS: {
+          getStatusResponse r;
+          memset(&r, 0, sizeof(r));
+          respond(0, &r, sizeof(r), reply);
+          break;
+        }
+        case ENABLE_MOSFETS:
+        case DISABLE_MOSFETS:
+          respond(0, nullptr, 0, reply);
+          break;
+        default:
+          respond(EMULATED_ERROR_NOT_EMULATED, nullptr, 0, reply);
+          break;
+      }
+      break;
+  }
+
+  *reply_at_us = end_us + config_.response_delay_us + work_us;
+  if (reset) {
+    // Resets once the acknowledgement has been handed to the UART
+    reset_at(broadcast ? end_us : *reply_at_us);
+  }
+  return !broadcast;
+}
+
+ServomotorBusEmulator::ServomotorBusEmulator(HardwareSerial &port, uint32_t seed) : port_(port), rng_(seed) {
+  // Host builds do not open the port (Communication::openSerialPort() is ARDUINO-only); the wire
+  // timing needs a baud, so use the Servomotor default
+  if (port_.baud() == 0) port_.begin(230400);
+  port_.set_transmit_handler([this](const uint8_t *data, size_t size) { on_bytes(data, size); });
+}
+
+ServomotorBusEmulator::~ServomotorBusEmulator() { port_.set_transmit_handler(nullptr); }
+
+EmulatedServomotor &ServomotorBusEmulator::add_device(const EmulatedDeviceConfig &config) {
+  devices_.emplace_back(new EmulatedServomotor(config));
+  return *devices_.back();
+}
+
+EmulatedServomotor *ServomotorBusEmulator::find(uint64_t unique_id) {
+  for (auto &d : devices_) {
+    if (d->config().unique_id == unique_id) return d.get();
+  }
+  return nullptr;
+}
+
+void ServomotorBusEmulator::on_bytes(const uint8_t *data, size_t size) {
+  const double byte_us = port_.byte_time_us();
+  stats_.host_bytes += (uint32_t)size;
+  stats_.busy_us += (uint64_t)(byte_us * (double)size + 0.5);
+  pending_.insert(pending_.end(), data, data + size);
+  while (!pending_.empty()) {
+    const uint16_t available = (uint16_t)std::min<size_t>(pending_.size(), 0xFFFF);
+    const uint16_t n = frameSizeFromHeader(pending_.data(), available);
+    if (n == 0 && isValidFirstByteFormat(pending_[0])) break;  // size not complete yet
+    if (n < 3) {
+      // Not the start of a frame: devices resynchronise on the next byte
+      pending_.erase(pending_.begin());
+      stats_.discarded_bytes++;
+      continue;
+    }
+    if (pending_.size() < n) break;
+    // Bytes after this frame are from the current write and still on their way
+    const uint64_t end_us = port_.tx_done_us() - (uint64_t)(byte_us * (double)(pending_.size() - n) + 0.5);
+    deliver(pending_.data(), n, end_us);
+    pending_.erase(pending_.begin(), pending_.begin() + n);
+  }
+}
+
+void ServomotorBusEmulator::deliver(const uint8_t *frame, uint16_t size, uint64_t end_us) {
+  stats_.host_frames++;
+  std::vector<Reply> replies;
+  for (auto &d : devices_) {
+    Reply r;
+    if (d->handle(frame, size, end_us, rng_, &r.bytes, &r.at_us)) replies.push_back(std::move(r));
+  }
+  put_on_wire(replies);
+}
+
+void ServomotorBusEmulator::put_on_wire(std::vector<Reply> &replies) {
+  const double byte_us = port_.byte_time_us();
+  std::sort(replies.begin(), replies.end(), [](const Reply &a, const Reply &b) { return a.at_us < b.at_us; });
+  // Replies that overlap in time are merged into one garbled stream: the wire carries the AND of
+  // the bytes driven at the same time (good enough to fail the framing or CRC32 check).
+  std::vector<Reply> wire;
+  for (Reply &r : replies) {
+    stats_.replies++;
+    stats_.reply_bytes += (uint32_t)r.bytes.size();
+    if (!wire.empty() && byte_us > 0) {
+      Reply &w = wire.back();
+      const uint64_t w_end = w.at_us + (uint64_t)(byte_us * (double)w.bytes.size() + 0.5);
+      if (r.at_us < w_end) {
+        stats_.collisions++;
+        const size_t offset = (size_t)((double)(r.at_us - w.at_us) / byte_us);
+        if (w.bytes.size() < offset + r.bytes.size()) w.bytes.resize(offset + r.bytes.size(), 0xFF);
+        for (size_t i = 0; i < r.bytes.size(); i++) w.bytes[offset + i] &= r.bytes[i];
+        continue;
+      }
+    }
+    wire.push_back(std::move(r));
+  }
+  for (const Reply &w : wire) {
+    // Overlaps a reply to an earlier request (DETECT_DEVICES still answering): counted as a
+    // collision; the port delivers it after the earlier one
+    if (w.at_us < line_free_us_) stats_.collisions++;
+    port_.inject_rx_at(w.at_us, w.bytes.data(), w.bytes.size());
+    const uint64_t start = std::max(w.at_us, line_free_us_);
+    line_free_us_ = start + (uint64_t)(byte_us * (double)w.bytes.size() + 0.5);
+    stats_.busy_us += (uint64_t)(byte_us * (double)w.bytes.size() + 0.5);
+  }
+}
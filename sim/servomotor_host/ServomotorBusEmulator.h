@@ -0,0 +1,155 @@
+#pragma once
+
+// Host-side emulation of Servomotor devices on one RS485 bus, for exercising lib/Servomotor and the
+// upgrade code without hardware.
+//
+// ServomotorBusEmulator installs itself as the transmit handler of a HardwareSerial (Serial1). Every
+// device sees every frame the host writes and answers like the firmware would: protocol framing,
+// CRC32 (per device, CRC32_CONTROL), alias / unique-ID / broadcast addressing, DETECT_DEVICES at a
+// random time, SYSTEM_RESET into the bootloader, and FIRMWARE_UPGRADE pages written into an
+// emulated flash with the erase/program time of the part. Replies are put on the port with
+// HardwareSerial::inject_rx_at(), i.e. at wire speed after the device's own delay; replies that
+// overlap on the bus garble each other. With arduino_emulator::set_virtual_time(true) all of this
+// runs as fast as the host can compute it.
+//
+// Device error codes used here are the emulator's own (EMULATED_ERROR_*); the firmware's numbering
+// is not part of this tree.
+
+#include <stdint.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ArduinoEmulator.h"
+#include "CommandCodec.h"
+#include "Communication.h"
+
+#define EMULATED_ERROR_NOT_EMULATED 200     // command not implemented by the emulator
+#define EMULATED_ERROR_BAD_PAYLOAD 201      // payload size does not match the command
+#define EMULATED_ERROR_NOT_IN_BOOTLOADER 202  // FIRMWARE_UPGRADE sent to the application
+#define EMULATED_ERROR_WRONG_MODEL 203      // page model code or firmware compatibility mismatch
+#define EMULATED_ERROR_BAD_PAGE 204         // page number outside the application area
+
+// STM32G0 flash as used by the servomotor: 2 KB pages, bootloader in pages 0..4, application in
+// pages 5..30 (starting with its size word and ending with its CRC32), settings in page 31.
+static constexpr uint32_t k_emulated_flash_page_size = 2048;
+static constexpr uint8_t k_emulated_flash_pages = 32;
+static constexpr uint8_t k_emulated_first_application_page = 5;
+static constexpr uint8_t k_emulated_last_application_page = 30;
+
+struct EmulatedDeviceConfig {
+  uint64_t unique_id = 0;
+  uint8_t alias = 0;
+  char product_code[8] = {'M', '1', '7', 0, 0, 0, 0, 0};  // FIRMWARE_UPGRADE pages must carry it
+  uint8_t firmware_compatibility = 1;
+  VersionNumber24 hardware_version = {0, 5, 1};
+  uint32_t serial_number = 0;
+  VersionNumber32 firmware_version = {0, 0, 1, 0};
+  bool crc32_enabled = true;
+  bool application_valid = true;  // flash holds a runnable application at power-up
+
+  // Timing, in microseconds
+  uint32_t response_delay_us = 150;         // end of a request to the start of the reply
+  uint32_t detect_window_us = 1000000;      // DETECT_DEVICES: reply at a random time within this
+  uint32_t reset_us = 20000;                // SYSTEM_RESET: deaf until the bootloader runs
+  uint32_t bootloader_timeout_us = 500000;  // bootloader starts a valid application after this
+  uint32_t page_erase_us = 22000;           // one 2 KB page
+  uint32_t page_program_us = 22000;         // 256 double words at ~85 us
+};
+
+class EmulatedServomotor {
+ public:
+  enum class State { kApplication, kResetting, kBootloader };
+
+  explicit EmulatedServomotor(const EmulatedDeviceConfig &config);
+
+  const EmulatedDeviceConfig &config() const { return config_; }
+  uint8_t alias() const { return config_.alias; }
+  bool crc32_enabled() const { return crc32_enabled_; }  // CRC32_CONTROL; back to the config on reset
+
+  // State at the current emulator time (the bootloader hands over to a valid application once
+  // its timeout has passed without a FIRMWARE_UPGRADE).
+  State state();
+  // Whether the application area holds an image whose CRC32 matches (what the bootloader checks).
+  bool application_valid() const;
+  const std::vector<uint8_t> &flash() const { return flash_; }
+
+  // A device that is unplugged sees nothing and never answers.
+  void set_present(bool present) { present_ = present; }
+
+  uint32_t resets() const { return resets_; }
+  uint32_t pages_written() const { return pages_written_; }
+  const getCommunicationStatisticsResponse &counters() const { return counters_; }
+
+  // Handles a frame whose last byte reached the device at end_us. Returns true with the reply and
+  // the time it starts on the wire if the device answers.
+  bool handle(const uint8_t *frame, uint16_t size, uint64_t end_us, std::mt19937 &rng, std::vector<uint8_t> *reply,
+              uint64_t *reply_at_us);
+
+ private:
+  void update(uint64_t now_us);
+  void reset_at(uint64_t start_us);
+  void respond(uint8_t error, const void *payload, uint16_t payload_size, std::vector<uint8_t> *reply);
+  // Writes a FIRMWARE_UPGRADE page received at end_us. Returns the error code (0: written) and how
+  // long the device is busy erasing and programming.
+  uint8_t write_page(const uint8_t *payload, uint16_t size, uint64_t end_us, uint32_t *busy_us);
+
+  EmulatedDeviceConfig config_;
+  std::vector<uint8_t> flash_;
+  bool crc32_enabled_;
+  State state_ = State::kApplication;
+  uint64_t reset_done_us_ = 0;
+  uint64_t bootloader_deadline_us_ = 0;
+  bool stay_in_bootloader_ = false;
+  uint64_t busy_until_us_ = 0;
+  bool present_ = true;
+  uint32_t resets_ = 0;
+  uint32_t pages_written_ = 0;
+  getCommunicationStatisticsResponse counters_ = {};
+};
+
+class ServomotorBusEmulator {
+ public:
+  struct Stats {
+    uint32_t host_frames = 0;     // complete frames written by the host
+    uint32_t host_bytes = 0;
+    uint32_t discarded_bytes = 0;  // host bytes that did not start a valid frame
+    uint32_t replies = 0;
+    uint32_t reply_bytes = 0;
+    uint32_t collisions = 0;      // replies that overlapped another one on the wire
+    uint64_t busy_us = 0;         // time the wire carried host frames or replies
+  };
+
+  // Attaches to `port` (replacing its transmit handler, and opening it at 230400 baud unless it is
+  // open already); `seed` drives DETECT_DEVICES timing.
+  explicit ServomotorBusEmulator(HardwareSerial &port, uint32_t seed = 1);
+  ~ServomotorBusEmulator();
+  ServomotorBusEmulator(const ServomotorBusEmulator &) = delete;
+  ServomotorBusEmulator &operator=(const ServomotorBusEmulator &) = delete;
+
+  EmulatedServomotor &add_device(const EmulatedDeviceConfig &config);
+  EmulatedServomotor *find(uint64_t unique_id);
+  size_t size() const { return devices_.size(); }
+  EmulatedServomotor &device(size_t i) { return *devices_[i]; }
+
+  const Stats &stats() const { return stats_; }
+  void reset_stats() { stats_ = Stats(); }
+
+ private:
+  struct Reply {
+    uint64_t at_us;
+    std::vector<uint8_t> bytes;
+  };
+
+  void on_bytes(const uint8_t *data, size_t size);
+  void deliver(const uint8_t *frame, uint16_t size, uint64_t end_us);
+  void put_on_wire(std::vector<Reply> &replies);
+
+  HardwareSerial &port_;
+  std::mt19937 rng_;
+  std::vector<std::unique_ptr<EmulatedServomotor>> devices_;
+  std::vector<uint8_t> pending_;
+  uint64_t line_free_us_ = 0;  // end of the last reply put on the wire
+  Stats stats_;
+};
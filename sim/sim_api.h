@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 namespace sim {
 
 // Simulator-only helpers exposed for the host executable.
@@ -9,7 +12,8 @@ bool target_drove_swdio_seen();
 bool target_voltage_logged_seen();
 
 // Log a point-event into signals.csv at the current simulated time.
-// Intended for high-level step markers (shown in the waveform viewer).
+// Intended for high-level step markers (shown in the waveform viewer); it also becomes the
+// phase of subsequent transaction-trace rows (set_trace_path()).
 // Example name: "STEP_IDCODE_BEGIN".
 void log_step(const char *name);
 
@@ -17,4 +21,23 @@ void log_step(const char *name);
 // Sets the CSV output path for the current simulation executable.
 void set_log_path(const char *path);
 
+// Enable/disable CSV waveform logging entirely (default: enabled).
+// Regression runners disable it; nobody looks at the waveform of image #4711.
+void set_waveform_logging(bool enabled);
+
+// Enable/disable the Serial shim's stdout output (default: enabled).
+void set_console_output(bool enabled);
+
+// Append the Serial shim's output to `*sink` instead of stdout (nullptr: back to stdout).
+// Takes precedence over set_console_output(). Used by tests that check printed reports.
+void set_console_capture(std::string *sink);
+
+// Write a decoded SWD transaction trace (one CSV row per DP/AP transfer) to `path`;
+// nullptr or "" stops tracing. Rows are tagged with the last log_step() marker.
+// Summarize the file with swd_trace_analyze.
+void set_trace_path(const char *path);
+
+// Current simulated time in nanoseconds.
+uint64_t now_ns();
+
 } // namespace sim
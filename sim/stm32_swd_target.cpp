@@ -2,23 +2,28 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iterator>
 
 namespace sim {
 
 // Address constants (subset)
 static constexpr uint32_t FLASH_BASE = 0x08000000u;
-static constexpr uint32_t FLASH_SIZE_BYTES = 0x10000u;
+static constexpr uint32_t SRAM_BASE = 0x20000000u;
 
 static constexpr uint32_t FLASH_REG_BASE = 0x40022000u;
 static constexpr uint32_t FLASH_KEYR = FLASH_REG_BASE + 0x08u;
+static constexpr uint32_t FLASH_OPTKEYR = FLASH_REG_BASE + 0x0Cu;
 static constexpr uint32_t FLASH_SR = FLASH_REG_BASE + 0x10u;
 static constexpr uint32_t FLASH_CR = FLASH_REG_BASE + 0x14u;
 static constexpr uint32_t FLASH_OPTR = FLASH_REG_BASE + 0x20u;
 
 static constexpr uint32_t FLASH_KEY1 = 0x45670123u;
 static constexpr uint32_t FLASH_KEY2 = 0xCDEF89ABu;
+static constexpr uint32_t FLASH_OPTKEY1 = 0x08192A3Bu;
+static constexpr uint32_t FLASH_OPTKEY2 = 0x4C5D6E7Fu;
 
-static constexpr uint32_t FLASH_SR_BSY = (1u << 16);
+static constexpr uint32_t FLASH_SR_BSY = stm32g0_devices::FLASH_SR_BSY1;
+static constexpr uint32_t FLASH_SR_BSY_ANY = stm32g0_devices::FLASH_SR_BSY1 | stm32g0_devices::FLASH_SR_BSY2;
 static constexpr uint32_t FLASH_SR_EOP = (1u << 0);
 
 // Error flags (subset used by firmware). Bit positions match [`FLASH_ERASE.md`](FLASH_ERASE.md:95).
@@ -37,13 +42,26 @@ static constexpr uint32_t FLASH_SR_ALL_ERRORS =
     FLASH_SR_MISERR | FLASH_SR_FASTERR | FLASH_SR_RDERR | FLASH_SR_OPTVERR;
 
 static constexpr uint32_t FLASH_CR_PG = (1u << 0);
-static constexpr uint32_t FLASH_CR_MER1 = (1u << 2);
+static constexpr uint32_t FLASH_CR_MER1 = stm32g0_devices::FLASH_CR_MER1;
+static constexpr uint32_t FLASH_CR_MER2 = stm32g0_devices::FLASH_CR_MER2;
 static constexpr uint32_t FLASH_CR_STRT = (1u << 16);
+static constexpr uint32_t FLASH_CR_OPTSTRT = (1u << 17);
+static constexpr uint32_t FLASH_CR_OBL_LAUNCH = (1u << 27);
+static constexpr uint32_t FLASH_CR_OPTLOCK = (1u << 30);
 static constexpr uint32_t FLASH_CR_LOCK = (1u << 31);
+// LOCK/OPTLOCK are set by writing 1 (LOCK sets both) and cleared only by the key sequences.
+static constexpr uint32_t FLASH_CR_LOCKS = FLASH_CR_LOCK | FLASH_CR_OPTLOCK;
 
 // RDP option-byte values from ST HAL header (implementation-ready, matches STM32G0 series).
 // See: OB_RDP_LEVEL_* in [`docs/stm32g0xx_hal_flash.h`](docs/stm32g0xx_hal_flash.h:320)
 static constexpr uint32_t OB_RDP_LEVEL_0 = 0x000000AAu;
+static constexpr uint32_t OB_RDP_LEVEL_2 = 0x000000CCu;
+static constexpr uint32_t OPTR_RDP_MASK = 0xFFu;
+
+static bool rdp_level_1(uint32_t optr) {
+  const uint32_t rdp = optr & OPTR_RDP_MASK;
+  return rdp != OB_RDP_LEVEL_0 && rdp != OB_RDP_LEVEL_2;
+}
 
 // DP registers (addr bits [3:2] in request select these byte addresses)
 static constexpr uint8_t DP_ADDR_IDCODE = 0x00;
@@ -52,12 +70,51 @@ static constexpr uint8_t DP_ADDR_CTRLSTAT = 0x04;
 static constexpr uint8_t DP_ADDR_SELECT = 0x08;
 static constexpr uint8_t DP_ADDR_RDBUFF = 0x0C;
 
-// AP registers (bank 0)
+// CTRL/STAT sticky flags and the matching ABORT clear bits.
+static constexpr uint32_t CTRLSTAT_STICKYERR = (1u << 5);
+static constexpr uint32_t CTRLSTAT_WDATAERR = (1u << 7);
+static constexpr uint32_t ABORT_STKERRCLR = (1u << 2);
+static constexpr uint32_t ABORT_WDERRCLR = (1u << 3);
+
+// Cortex-M0+ debug registers (subset).
+static constexpr uint32_t DHCSR = 0xE000EDF0u;
+static constexpr uint32_t DCRSR = 0xE000EDF4u;
+static constexpr uint32_t DCRDR = 0xE000EDF8u;
+static constexpr uint32_t DEMCR = 0xE000EDFCu;
+static constexpr uint32_t DHCSR_DBGKEY = 0xA05F0000u;
+static constexpr uint32_t DHCSR_C_DEBUGEN = (1u << 0);
+static constexpr uint32_t DHCSR_C_HALT = (1u << 1);
+static constexpr uint32_t DHCSR_S_HALT = (1u << 17);
+static constexpr uint32_t DHCSR_S_REGRDY = (1u << 16);
+static constexpr uint32_t DCRSR_REGWNR = (1u << 16);
+static constexpr uint8_t REGSEL_SP = 13;
+static constexpr uint8_t REGSEL_PC = 15;
+static constexpr uint8_t REGSEL_XPSR = 16;
+static constexpr uint8_t REGSEL_MSP = 17;
+static constexpr uint8_t REGSEL_PSP = 18;
+static constexpr uint8_t REGSEL_CONTROL_PRIMASK = 20;
+static constexpr uint32_t CONTROL_SPSEL = (1u << 25);     // CONTROL[1] in the REGSEL 20 word
+static constexpr uint32_t CONTROL_PRIMASK_MASK = 0x03000001u;  // nPRIV, SPSEL, PRIMASK
+static constexpr uint32_t DEMCR_VC_CORERESET = (1u << 0);
+
+static constexpr uint8_t ACK_OK = 0b001;
+static constexpr uint8_t ACK_WAIT = 0b010;
+static constexpr uint8_t ACK_FAULT = 0b100;
+static constexpr uint8_t ACK_NONE = 0b111;  // nobody drives SWDIO; host reads the pull-up
+
+// AP registers (bank 0, then the banked data registers in bank 1)
 static constexpr uint8_t AP_ADDR_CSW = 0x00;
 static constexpr uint8_t AP_ADDR_TAR = 0x04;
 static constexpr uint8_t AP_ADDR_DRW = 0x0C;
+static constexpr uint8_t AP_ADDR_BD0 = 0x10;
+static constexpr uint8_t AP_ADDR_BD3 = 0x1C;
 static constexpr uint8_t AP_ADDR_IDR = 0xFC;
 
+// CSW fields
+static constexpr uint32_t CSW_SIZE_MASK = 0x7u;
+static constexpr uint32_t CSW_ADDRINC_MASK = 0x3u << 4;
+static constexpr uint32_t CSW_ADDRINC_PACKED = 0x2u << 4;
+
   uint8_t Stm32SwdTarget::parity_u32(uint32_t v) {
   uint8_t p = 0;
   while (v) {
@@ -67,15 +124,38 @@ static constexpr uint8_t AP_ADDR_IDR = 0xFC;
   return p;
 }
 
+void Stm32SwdTarget::set_device(const stm32g0_devices::Device &device, uint32_t flash_size, uint16_t rev_id) {
+  device_ = device;
+  flash_size_ = flash_size ? flash_size : device.flash_max_bytes;
+  rev_id_ = rev_id;
+  flash_reset();
+  sram_reset();
+}
+
+bool Stm32SwdTarget::in_flash(uint32_t addr, uint32_t n) const {
+  return addr >= FLASH_BASE && addr - FLASH_BASE <= flash_size_ && n <= flash_size_ - (addr - FLASH_BASE);
+}
+
+bool Stm32SwdTarget::in_sram(uint32_t addr, uint32_t n) const {
+  return addr >= SRAM_BASE && addr - SRAM_BASE <= device_.sram_bytes && n <= device_.sram_bytes - (addr - SRAM_BASE);
+}
+
 void Stm32SwdTarget::flash_reset() {
-  flash_.assign(FLASH_SIZE_BYTES, 0xFF);
+  flash_.assign(flash_size_, 0xFF);
   flash_keyr_last_ = 0;
+  flash_optkeyr_last_ = 0;
   flash_sr_ = 0;
-  flash_cr_ = FLASH_CR_LOCK;
+  flash_cr_ = FLASH_CR_LOCKS;
   flash_optr_ = OB_RDP_LEVEL_0; // default to RDP0 (debug reads permitted)
+  ob_stored_ = ob_loaded_ = flash_optr_;
+  option_reloads_ = 0;
   flash_bsy_clear_time_ns_ = 0;
 }
 
+void Stm32SwdTarget::load_option_bytes(uint32_t optr) { flash_optr_ = ob_stored_ = ob_loaded_ = optr; }
+
+void Stm32SwdTarget::sram_reset() { sram_.assign(device_.sram_bytes, 0x00); }
+
 void Stm32SwdTarget::load_flash_image(const uint8_t *data, size_t len) {
   if (!data || len == 0) return;
   if (flash_.empty()) {
@@ -87,18 +167,22 @@ void Stm32SwdTarget::load_flash_image(const uint8_t *data, size_t len) {
   std::memcpy(flash_.data(), data, n);
 }
 
-void Stm32SwdTarget::flash_start_busy(uint64_t duration_ns) {
-  flash_sr_ |= FLASH_SR_BSY;
+void Stm32SwdTarget::flash_start_busy(uint64_t duration_ns, uint32_t busy_bits) {
+  if (roll(faults_.bsy_stall_rate)) {
+    duration_ns += faults_.bsy_stall_ns;
+    fault_stats_.bsy_stalls++;
+  }
+  flash_sr_ |= busy_bits;
   flash_bsy_clear_time_ns_ = t_ns_ + duration_ns;
 }
 
 void Stm32SwdTarget::flash_update_busy() {
-  if ((flash_sr_ & FLASH_SR_BSY) && t_ns_ >= flash_bsy_clear_time_ns_) {
-    flash_sr_ &= ~FLASH_SR_BSY;
+  if ((flash_sr_ & FLASH_SR_BSY_ANY) && t_ns_ >= flash_bsy_clear_time_ns_) {
+    flash_sr_ &= ~FLASH_SR_BSY_ANY;
     flash_bsy_clear_time_ns_ = 0;
 
-    // If an erase completed, clear MER1/STRT bits (hardware typically clears STRT)
-    flash_cr_ &= ~(FLASH_CR_MER1 | FLASH_CR_STRT);
+    // If an erase completed, clear MERx/STRT bits (hardware typically clears STRT)
+    flash_cr_ &= ~(FLASH_CR_MER1 | FLASH_CR_MER2 | FLASH_CR_STRT | FLASH_CR_OPTSTRT);
 
     // Mark end-of-operation as successful unless error flags were raised.
     if ((flash_sr_ & FLASH_SR_ALL_ERRORS) == 0) {
@@ -125,15 +209,91 @@ void Stm32SwdTarget::flash_try_unlock(uint32_t key) {
   flash_keyr_last_ = 0;
 }
 
+void Stm32SwdTarget::flash_try_option_unlock(uint32_t key) {
+  if ((flash_cr_ & FLASH_CR_LOCK) || !(flash_cr_ & FLASH_CR_OPTLOCK)) return;
+
+  if (flash_optkeyr_last_ == 0 && key == FLASH_OPTKEY1) {
+    flash_optkeyr_last_ = FLASH_OPTKEY1;
+    return;
+  }
+  if (flash_optkeyr_last_ == FLASH_OPTKEY1 && key == FLASH_OPTKEY2) {
+    flash_cr_ &= ~FLASH_CR_OPTLOCK;
+    flash_optkeyr_last_ = 0;
+    return;
+  }
+  flash_optkeyr_last_ = 0;
+}
+
+void Stm32SwdTarget::flash_start_option_program() {
+  if ((flash_cr_ & FLASH_CR_LOCKS) || (flash_sr_ & FLASH_SR_BSY_ANY)) return;
+
+  // Store OPTR in the option area. Leaving RDP level 1 for level 0 mass-erases the flash.
+  uint64_t busy_ns = option_program_busy_ns_;
+  if (rdp_level_1(ob_loaded_) && (flash_optr_ & OPTR_RDP_MASK) == OB_RDP_LEVEL_0) {
+    std::fill(flash_.begin(), flash_.end(), 0xFF);
+    busy_ns += mass_erase_busy_ns_;
+  }
+  ob_stored_ = flash_optr_;
+  flash_sr_ &= ~FLASH_SR_EOP;
+  flash_start_busy(busy_ns, FLASH_SR_BSY);
+}
+
+void Stm32SwdTarget::option_reload() {
+  // OBL_LAUNCH: load the stored options and reset the system. The debug port goes with it, so
+  // the host has to redo the line reset + JTAG-to-SWD switch before anything answers.
+  ob_loaded_ = ob_stored_;
+  option_reloads_++;
+  flash_keyr_last_ = 0;
+  flash_optkeyr_last_ = 0;
+  flash_sr_ = 0;
+  flash_cr_ = FLASH_CR_LOCKS;
+  flash_optr_ = ob_loaded_;
+  flash_bsy_clear_time_ns_ = 0;
+
+  phase_ = Phase::AwaitResetOrSeq;
+  swd_enabled_ = false;
+  after_jtag_to_swd_ = false;
+  line_reset_seen_ = false;
+  req_kind_ = ReqKind::None;
+  dp_ctrlstat_ = 0;
+  dp_select_ = 0;
+  dp_rdbuff_ = 0;
+  dp_sticky_ = 0;
+  ap_csw_ = 0;
+  ap_tar_ = 0;
+
+  // The core restarts into user firmware like after an NRST pulse.
+  core_halted_ = false;
+  halt_requested_in_reset_ = false;
+  core_ran_ns_ = 0;
+  core_run_since_ns_ = t_ns_;
+  core_registers_reset();
+}
+
 void Stm32SwdTarget::flash_start_mass_erase() {
   // Only if unlocked.
   if (flash_cr_ & FLASH_CR_LOCK) return;
 
-  // Erase simulated by setting all bytes to 0xFF.
-  std::fill(flash_.begin(), flash_.end(), 0xFF);
+  // Erase simulated by setting the selected bank(s) to 0xFF. Single-bank parts have no MER2.
+  const uint32_t mer = flash_cr_ & device_.mass_erase_cr;
+  const size_t half = flash_.size() / 2;
+  uint32_t busy = 0;
+  if (device_.banks < 2) {
+    std::fill(flash_.begin(), flash_.end(), 0xFF);
+    busy = FLASH_SR_BSY;
+  } else {
+    if (mer & FLASH_CR_MER1) {
+      std::fill(flash_.begin(), flash_.begin() + half, 0xFF);
+      busy |= stm32g0_devices::FLASH_SR_BSY1;
+    }
+    if (mer & FLASH_CR_MER2) {
+      std::fill(flash_.begin() + half, flash_.end(), 0xFF);
+      busy |= stm32g0_devices::FLASH_SR_BSY2;
+    }
+  }
 
   // Busy for a while to exercise wait loops.
-  flash_start_busy(50ull * 1000ull * 1000ull); // 50ms
+  flash_start_busy(mass_erase_busy_ns_, busy);
 }
 
 void Stm32SwdTarget::flash_program32(uint32_t addr, uint32_t v) {
@@ -141,22 +301,23 @@ void Stm32SwdTarget::flash_program32(uint32_t addr, uint32_t v) {
   if (!(flash_cr_ & FLASH_CR_PG)) return;
 
   // Program can only change 1->0 in real flash; simulate by AND.
-  if (addr < FLASH_BASE || addr + 4 > FLASH_BASE + FLASH_SIZE_BYTES) return;
+  if (!in_flash(addr, 4)) return;
   const uint32_t off = addr - FLASH_BASE;
   for (uint32_t i = 0; i < 4; i++) {
     const uint8_t b = (uint8_t)((v >> (8 * i)) & 0xFF);
     flash_[off + i] = (uint8_t)(flash_[off + i] & b);
   }
 
-  // Short busy to exercise polling.
-  flash_start_busy(200ull * 1000ull); // 200us
+  // Short busy to exercise polling (BSY2 for the upper bank of a dual-bank part).
+  const bool bank2 = device_.banks > 1 && off >= flash_.size() / 2;
+  flash_start_busy(program32_busy_ns_, bank2 ? stm32g0_devices::FLASH_SR_BSY2 : FLASH_SR_BSY);
 }
 
 bool Stm32SwdTarget::mem_read32(uint32_t addr, uint32_t &out) {
   flash_update_busy();
 
   // Flash array
-  if (addr >= FLASH_BASE && addr + 4 <= FLASH_BASE + FLASH_SIZE_BYTES) {
+  if (in_flash(addr, 4)) {
     const uint32_t off = addr - FLASH_BASE;
     out = (uint32_t)flash_[off + 0] |
           ((uint32_t)flash_[off + 1] << 8) |
@@ -165,6 +326,13 @@ bool Stm32SwdTarget::mem_read32(uint32_t addr, uint32_t &out) {
     return true;
   }
 
+  if (in_sram(addr, 4)) {
+    const uint32_t off = addr - SRAM_BASE;
+    out = (uint32_t)sram_[off + 0] | ((uint32_t)sram_[off + 1] << 8) | ((uint32_t)sram_[off + 2] << 16) |
+          ((uint32_t)sram_[off + 3] << 24);
+    return true;
+  }
+
   // Flash regs
   if (addr == FLASH_SR) {
     out = flash_sr_;
@@ -179,9 +347,25 @@ bool Stm32SwdTarget::mem_read32(uint32_t addr, uint32_t &out) {
     return true;
   }
 
-  // DHCSR (just claim halted; this keeps connect_and_halt happy)
-  if (addr == 0xE000EDF0u) {
-    out = (1u << 17);
+  // Part identification
+  if (addr == stm32g0_devices::DBGMCU_IDCODE) {
+    out = ((uint32_t)rev_id_ << 16) | device_.dev_id;
+    return true;
+  }
+  if (addr == stm32g0_devices::FLASHSIZE) {
+    out = 0xFFFF0000u | (flash_size_ / 1024u);
+    return true;
+  }
+
+  // DHCSR: only S_HALT and S_REGRDY are modeled.
+  if (addr == DHCSR) {
+    core_reg_update();
+    out = (core_halted_ ? DHCSR_S_HALT : 0u) | (core_reg_pending_ ? 0u : DHCSR_S_REGRDY);
+    return true;
+  }
+  if (addr == DCRDR) {
+    core_reg_update();
+    out = dcrdr_;
     return true;
   }
 
@@ -190,6 +374,18 @@ bool Stm32SwdTarget::mem_read32(uint32_t addr, uint32_t &out) {
   return true;
 }
 
+bool Stm32SwdTarget::mem_write_lanes(uint32_t addr, uint32_t v, uint32_t bytes) {
+  // Only SRAM takes 8/16-bit writes; everything else here is word-only (flash programming
+  // included), so narrow writes elsewhere are dropped like an unsupported bus access.
+  if (bytes == 4 && !in_sram(addr, 1)) return mem_write32(addr, v);
+  if (!in_sram(addr, bytes)) return true;
+  for (uint32_t i = 0; i < bytes; i++) {
+    const uint32_t a = addr + i;
+    sram_[a - SRAM_BASE] = (uint8_t)(v >> (8u * (a & 3u)));
+  }
+  return true;
+}
+
 bool Stm32SwdTarget::mem_write32(uint32_t addr, uint32_t v) {
   flash_update_busy();
 
@@ -207,11 +403,34 @@ bool Stm32SwdTarget::mem_write32(uint32_t addr, uint32_t v) {
     return true;
   }
 
+  if (addr == FLASH_OPTKEYR) {
+    flash_try_option_unlock(v);
+    return true;
+  }
+
+  if (addr == FLASH_OPTR) {
+    // Takes effect only after OPTSTRT + OBL_LAUNCH; until then it just reads back.
+    if (!(flash_cr_ & FLASH_CR_LOCKS)) flash_optr_ = v;
+    return true;
+  }
+
   if (addr == FLASH_CR) {
-    flash_cr_ = v;
+    const bool options_unlocked = !(flash_cr_ & FLASH_CR_LOCKS);
+    uint32_t locks = (flash_cr_ | v) & FLASH_CR_LOCKS;
+    if (v & FLASH_CR_LOCK) locks |= FLASH_CR_OPTLOCK;
+    flash_cr_ = (v & ~(FLASH_CR_LOCKS | FLASH_CR_OBL_LAUNCH)) | locks;
+
+    if ((v & FLASH_CR_OBL_LAUNCH) && options_unlocked && !(flash_sr_ & FLASH_SR_BSY_ANY)) {
+      option_reload();
+      return true;
+    }
+    if ((flash_cr_ & FLASH_CR_OPTSTRT) && options_unlocked) {
+      flash_start_option_program();
+      return true;
+    }
 
-    // If MER1|STRT is set, start mass erase.
-    if ((flash_cr_ & FLASH_CR_MER1) && (flash_cr_ & FLASH_CR_STRT)) {
+    // If MERx|STRT is set, start mass erase.
+    if ((flash_cr_ & device_.mass_erase_cr) && (flash_cr_ & FLASH_CR_STRT)) {
       // Starting a new operation clears previous EOP (matches typical flow where firmware clears SR flags).
       flash_sr_ &= ~FLASH_SR_EOP;
       flash_start_mass_erase();
@@ -220,13 +439,35 @@ bool Stm32SwdTarget::mem_write32(uint32_t addr, uint32_t v) {
   }
 
   // Flash programming: if within flash and PG set, treat as program.
-  if (addr >= FLASH_BASE && addr + 4 <= FLASH_BASE + FLASH_SIZE_BYTES) {
+  if (in_flash(addr, 4)) {
     flash_program32(addr, v);
     return true;
   }
 
-  // DHCSR write: ignore.
-  if (addr == 0xE000EDF0u) return true;
+  if (in_sram(addr, 1)) {
+    mem_write_lanes(addr, v, 4);
+    return true;
+  }
+
+  if (addr == DHCSR) {
+    dhcsr_write(v);
+    return true;
+  }
+  if (addr == DEMCR) {
+    if (!nrst_high_ && (v & DEMCR_VC_CORERESET)) halt_requested_in_reset_ = true;
+    return true;
+  }
+  if (addr == DCRSR) {
+    core_reg_update();
+    dcrsr_ = v;
+    core_reg_pending_ = true;
+    core_reg_ready_ns_ = t_ns_ + core_reg_latency_ns_;
+    return true;
+  }
+  if (addr == DCRDR) {
+    dcrdr_ = v;
+    return true;
+  }
 
   // Default: ignore.
   return true;
@@ -246,7 +487,7 @@ uint32_t Stm32SwdTarget::dp_read_reg(uint8_t addr) {
         if (sys_req) v |= (1u << 31);
         if (dbg_req) v |= (1u << 29);
         dp_ctrlstat_ = v;
-        return v;
+        return v | dp_sticky_;
       }
     case DP_ADDR_SELECT:
       return dp_select_;
@@ -260,8 +501,10 @@ uint32_t Stm32SwdTarget::dp_read_reg(uint8_t addr) {
 void Stm32SwdTarget::dp_write_reg(uint8_t addr, uint32_t v) {
   switch (addr) {
     case DP_ADDR_ABORT:
-      // Clear sticky errors etc (ignored)
-      (void)v;
+      // Only the sticky-flag clears are modeled (DAPABORT etc. are ignored).
+      if (dp_sticky_ && (v & (ABORT_STKERRCLR | ABORT_WDERRCLR))) fault_stats_.sticky_clears++;
+      if (v & ABORT_STKERRCLR) dp_sticky_ &= ~CTRLSTAT_STICKYERR;
+      if (v & ABORT_WDERRCLR) dp_sticky_ &= ~CTRLSTAT_WDATAERR;
       return;
     case DP_ADDR_CTRLSTAT:
       dp_ctrlstat_ = v;
@@ -274,8 +517,27 @@ void Stm32SwdTarget::dp_write_reg(uint8_t addr, uint32_t v) {
   }
 }
 
+bool Stm32SwdTarget::ap_mem_addr(uint8_t addr, uint32_t *mem_addr) const {
+  if (addr == AP_ADDR_DRW) {
+    *mem_addr = ap_tar_;
+    return true;
+  }
+  if (addr >= AP_ADDR_BD0 && addr <= AP_ADDR_BD3) {
+    // BDn: TAR[31:4] + 4*n, without using or moving TAR[3:0].
+    *mem_addr = (ap_tar_ & ~0xFu) + (addr - AP_ADDR_BD0);
+    return true;
+  }
+  return false;
+}
+
 uint32_t Stm32SwdTarget::ap_read_reg(uint8_t addr) {
-  // Only AHB-AP bank 0.
+  addr = ap_bank_addr(addr);
+  uint32_t mem_addr = 0;
+  if (addr != AP_ADDR_DRW && ap_mem_addr(addr, &mem_addr)) {
+    uint32_t v = 0;
+    (void)mem_read32(mem_addr, v);
+    return v;
+  }
   if (addr == AP_ADDR_CSW) return ap_csw_;
   if (addr == AP_ADDR_TAR) return ap_tar_;
 
@@ -285,11 +547,11 @@ uint32_t Stm32SwdTarget::ap_read_reg(uint8_t addr) {
   }
 
   if (addr == AP_ADDR_DRW) {
+    // Reads always fetch the whole word; a 8/16-bit access only guarantees the byte lanes
+    // of its address, which the host picks out.
     uint32_t v = 0;
-    (void)mem_read32(ap_tar_, v);
-
-    // Auto-increment for SIZE=32 + AddrInc=single (this matches swd_min usage)
-    ap_tar_ += 4;
+    (void)mem_read32(ap_tar_ & ~0x3u, v);
+    ap_advance_tar();
     return v;
   }
 
@@ -297,7 +559,15 @@ uint32_t Stm32SwdTarget::ap_read_reg(uint8_t addr) {
 }
 
 void Stm32SwdTarget::ap_write_reg(uint8_t addr, uint32_t v) {
+  addr = ap_bank_addr(addr);
+  uint32_t mem_addr = 0;
+  if (addr != AP_ADDR_DRW && ap_mem_addr(addr, &mem_addr)) {
+    (void)mem_write32(mem_addr, v);
+    return;
+  }
   if (addr == AP_ADDR_CSW) {
+    // Without packed-transfer support AddrInc=packed is not accepted and reads back as off.
+    if ((v & CSW_ADDRINC_MASK) == CSW_ADDRINC_PACKED && !packed_transfers_) v &= ~CSW_ADDRINC_MASK;
     ap_csw_ = v;
     return;
   }
@@ -306,10 +576,283 @@ void Stm32SwdTarget::ap_write_reg(uint8_t addr, uint32_t v) {
     return;
   }
   if (addr == AP_ADDR_DRW) {
-    (void)mem_write32(ap_tar_, v);
-    ap_tar_ += 4;
+    const uint32_t size = 1u << (ap_csw_ & CSW_SIZE_MASK);
+    if (size >= 4) {
+      (void)mem_write32(ap_tar_, v);
+    } else if ((ap_csw_ & CSW_ADDRINC_MASK) == CSW_ADDRINC_PACKED) {
+      // Packed: one DRW write carries 4/size consecutive transfers (word-aligned TAR).
+      for (uint32_t i = 0; i < 4; i += size) (void)mem_write_lanes((ap_tar_ & ~0x3u) + i, v, size);
+    } else {
+      (void)mem_write_lanes(ap_tar_, v, size);
+    }
+    ap_advance_tar();
+    return;
+  }
+}
+
+void Stm32SwdTarget::ap_advance_tar() {
+  // CSW.AddrInc: off, single (by Size) or packed (by 4). Like most AHB-APs, the
+  // increment wraps within the current 1KB block (TAR[9:0]).
+  uint32_t step = 0;
+  const uint32_t inc = ap_csw_ & CSW_ADDRINC_MASK;
+  if (inc == (0x1u << 4)) step = 1u << (ap_csw_ & CSW_SIZE_MASK);
+  if (inc == CSW_ADDRINC_PACKED) step = 4;
+  ap_tar_ = (ap_tar_ & ~0x3FFu) | ((ap_tar_ + step) & 0x3FFu);
+}
+
+void Stm32SwdTarget::set_faults(const FaultConfig &cfg) {
+  faults_ = cfg;
+  fault_stats_ = FaultStats{};
+  fault_rng_.seed(cfg.seed);
+  fault_addr_hit_count_ = 0;
+}
+
+void Stm32SwdTarget::set_nrst_level(bool high) {
+  if (high == nrst_high_) return;
+  nrst_high_ = high;
+  core_ran_ns_ = 0;
+  core_run_since_ns_ = t_ns_;
+  if (!high) {
+    // System reset: the core stops running; a new halt request must be armed.
+    core_halted_ = false;
+    halt_requested_in_reset_ = false;
+    return;
+  }
+  core_halted_ = halt_requested_in_reset_ && halt_request_survives_reset_;
+  core_registers_reset();
+}
+
+void Stm32SwdTarget::core_registers_reset() {
+  // Cortex-M0+ reset: MSP and PC from the vector table, Thumb state, everything else 0.
+  std::fill(std::begin(core_regs_), std::end(core_regs_), 0u);
+  uint32_t msp = 0, reset_vector = 0;
+  (void)mem_read32(FLASH_BASE, msp);
+  (void)mem_read32(FLASH_BASE + 4u, reset_vector);
+  core_regs_[REGSEL_MSP] = msp & ~0x3u;
+  core_regs_[REGSEL_PC] = reset_vector & ~0x1u;
+  core_regs_[REGSEL_XPSR] = 0x01000000u;
+  core_regs_[14] = 0xFFFFFFFFu;
+  core_reg_pending_ = false;
+}
+
+void Stm32SwdTarget::core_reg_update() {
+  if (!core_reg_pending_ || !core_halted_ || t_ns_ < core_reg_ready_ns_) return;
+  const uint8_t regsel = (uint8_t)(dcrsr_ & 0x1Fu);
+  if (dcrsr_ & DCRSR_REGWNR) {
+    set_core_register(regsel, dcrdr_);
+  } else {
+    dcrdr_ = core_register(regsel);
+  }
+  core_reg_pending_ = false;
+}
+
+uint32_t Stm32SwdTarget::core_register(uint8_t regsel) const {
+  if (regsel == REGSEL_SP) {
+    return core_regs_[(core_regs_[REGSEL_CONTROL_PRIMASK] & CONTROL_SPSEL) ? REGSEL_PSP : REGSEL_MSP];
+  }
+  if (regsel >= 21 || regsel == 19) return 0;
+  return core_regs_[regsel];
+}
+
+void Stm32SwdTarget::set_core_register(uint8_t regsel, uint32_t v) {
+  if (regsel == REGSEL_SP) regsel = (core_regs_[REGSEL_CONTROL_PRIMASK] & CONTROL_SPSEL) ? REGSEL_PSP : REGSEL_MSP;
+  if (regsel >= 21 || regsel == 19) return;
+  if (regsel == REGSEL_MSP || regsel == REGSEL_PSP) v &= ~0x3u;
+  if (regsel == REGSEL_CONTROL_PRIMASK) v &= CONTROL_PRIMASK_MASK;
+  core_regs_[regsel] = v;
+}
+
+void Stm32SwdTarget::dhcsr_write(uint32_t v) {
+  if ((v & 0xFFFF0000u) != DHCSR_DBGKEY) return;  // writes without the key are ignored
+  const bool halt = (v & (DHCSR_C_DEBUGEN | DHCSR_C_HALT)) == (DHCSR_C_DEBUGEN | DHCSR_C_HALT);
+  if (!nrst_high_) {
+    halt_requested_in_reset_ = halt;
+    return;
+  }
+  if (halt && !core_halted_) {
+    core_ran_ns_ = firmware_run_ns();
+    core_halted_ = true;
+  } else if (!halt && core_halted_) {
+    core_halted_ = false;
+    core_run_since_ns_ = t_ns_;
+  }
+}
+
+uint64_t Stm32SwdTarget::firmware_run_ns() const {
+  if (!nrst_high_) return 0;
+  if (core_halted_) return core_ran_ns_;
+  return core_ran_ns_ + (t_ns_ - core_run_since_ns_);
+}
+
+bool Stm32SwdTarget::roll(double p) {
+  if (p <= 0.0) return false;
+  return std::uniform_real_distribution<double>(0.0, 1.0)(fault_rng_) < p;
+}
+
+bool Stm32SwdTarget::roll_data_error() {
+  if (roll(faults_.parity_error_rate)) return true;
+  if (swclk_half_period_ns_ < faults_.si_min_half_period_ns && roll(faults_.si_error_rate)) {
+    fault_stats_.si_errors++;
+    return true;
+  }
+  return false;
+}
+
+bool Stm32SwdTarget::swd_disabled_by_firmware() const {
+  // While NRST is held LOW the pins are in their reset (SWD) function, and a halted core
+  // never reaches the code that repurposes them.
+  if (!faults_.early_swd_disable || !nrst_high_) return false;
+  return firmware_run_ns() > faults_.early_swd_disable_after_ns;
+}
+
+uint8_t Stm32SwdTarget::respond_ack(ReqKind kind, uint8_t addr) {
+  if (swd_disabled_by_firmware()) {
+    fault_stats_.ignored_requests++;
+    return ACK_NONE;
+  }
+
+  // ADIv5: with a sticky flag set, everything except IDCODE/CTRL/STAT reads, CTRL/STAT
+  // writes and ABORT writes is FAULTed.
+  if (dp_sticky_) {
+    const bool allowed = (kind == ReqKind::DpRead && (addr == DP_ADDR_IDCODE || addr == DP_ADDR_CTRLSTAT)) ||
+                         (kind == ReqKind::DpWrite && (addr == DP_ADDR_ABORT || addr == DP_ADDR_CTRLSTAT));
+    if (!allowed) {
+      fault_stats_.sticky_faults++;
+      return ACK_FAULT;
+    }
+  }
+
+  if (kind != ReqKind::ApRead && kind != ReqKind::ApWrite) return ACK_OK;
+
+  const uint64_t n = ++fault_stats_.ap_accesses;
+  if (faults_.wait_on_ap_access != 0 && n >= faults_.wait_on_ap_access) {
+    uint64_t rel = n - faults_.wait_on_ap_access;
+    if (faults_.wait_period != 0) rel %= faults_.wait_period;
+    if (rel < faults_.wait_burst) {
+      fault_stats_.waits++;
+      return ACK_WAIT;
+    }
+  }
+
+  uint32_t mem_addr = 0;
+  const bool mem_access = ap_mem_addr(ap_bank_addr(addr), &mem_addr);
+  if (mem_access && rdp_level_1(ob_loaded_) && in_flash(mem_addr, 1)) {
+    // RDP level 1: the flash array is closed to the debugger (the bus error surfaces as FAULT).
+    fault_stats_.rdp_faults++;
+    dp_sticky_ |= CTRLSTAT_STICKYERR;
+    return ACK_FAULT;
+  }
+  if (mem_access && mem_addr >= faults_.fault_addr_lo && mem_addr < faults_.fault_addr_hi &&
+      (faults_.fault_addr_hits == 0 || fault_addr_hit_count_ < faults_.fault_addr_hits)) {
+    fault_addr_hit_count_++;
+    fault_stats_.faults++;
+    dp_sticky_ |= CTRLSTAT_STICKYERR;
+    return ACK_FAULT;
+  }
+
+  return ACK_OK;
+}
+
+uint8_t Stm32SwdTarget::read_parity_out(uint32_t v) {
+  uint8_t p = parity_u32(v);
+  if (roll_data_error()) {
+    p ^= 1u;
+    fault_stats_.read_parity_errors++;
+  }
+  return p;
+}
+
+void Stm32SwdTarget::complete_write(ReqKind kind, uint8_t addr, uint32_t v, uint8_t parity_rx) {
+  // Firmware repurposed the pins while the host was still clocking the data phase.
+  if (swd_disabled_by_firmware()) {
+    fault_stats_.lost_writes++;
     return;
   }
+
+  if (roll_data_error()) {
+    parity_rx ^= 1u;
+    fault_stats_.write_parity_errors++;
+  }
+  if (parity_u32(v) != parity_rx) {
+    // The write was already ACKed OK; the error surfaces as FAULT on the next access.
+    dp_sticky_ |= CTRLSTAT_WDATAERR;
+    return;
+  }
+  apply_write(kind, addr, v);
+}
+
+uint32_t Stm32SwdTarget::read_request_value(ReqKind kind, uint8_t addr) {
+  if (kind == ReqKind::DpRead) return dp_read_reg(addr);
+  if (kind != ReqKind::ApRead) return 0;
+
+  // Posted read semantics: return stale buffer, then update dp_rdbuff with actual.
+  const uint32_t actual = ap_read_reg(addr);
+  const uint32_t stale = dp_rdbuff_;
+  dp_rdbuff_ = actual;
+  return stale;
+}
+
+void Stm32SwdTarget::apply_write(ReqKind kind, uint8_t addr, uint32_t v) {
+  if (kind == ReqKind::DpWrite) {
+    dp_write_reg(addr, v);
+  } else if (kind == ReqKind::ApWrite) {
+    ap_write_reg(addr, v);
+  }
+}
+
+void Stm32SwdTarget::txn_line_reset() {
+  // Same outcome as >=50 host-driven high cycles in on_swclk_rising_edge().
+  consecutive_high_cycles_ = 0;
+  line_reset_seen_ = true;
+  post_reset_high_cycles_ = 0;
+  drive_en_ = false;
+  req_shift_ = 0;
+  req_bits_ = 0;
+  phase_ = after_jtag_to_swd_ ? Phase::CollectRequest : Phase::AwaitResetOrSeq;
+}
+
+void Stm32SwdTarget::txn_jtag_to_swd() {
+  // The edge model only recognizes 0xE79E right after a line reset.
+  if (!line_reset_seen_ && !after_jtag_to_swd_) return;
+  swd_enabled_ = true;
+  after_jtag_to_swd_ = true;
+  line_reset_seen_ = false;
+  phase_ = Phase::CollectRequest;
+}
+
+uint8_t Stm32SwdTarget::txn_read(bool apndp, uint8_t addr, uint32_t *data_out, uint8_t *parity_out) {
+  // No response before the SWD switch: SWDIO floats high (pull-up) for all ACK bits.
+  if (!swd_enabled_) return ACK_NONE;
+  const ReqKind kind = apndp ? ReqKind::ApRead : ReqKind::DpRead;
+  const uint8_t ack = respond_ack(kind, addr);
+  if (ack == ACK_NONE) return ack;
+  line_reset_seen_ = false;
+  if (ack != ACK_OK) return ack;
+
+  const uint32_t v = read_request_value(kind, addr);
+  if (data_out) *data_out = v;
+  if (parity_out) *parity_out = read_parity_out(v);
+  return ack;
+}
+
+uint8_t Stm32SwdTarget::txn_write_request(bool apndp, uint8_t addr) {
+  req_kind_ = ReqKind::None;
+  if (!swd_enabled_) return ACK_NONE;
+  const ReqKind kind = apndp ? ReqKind::ApWrite : ReqKind::DpWrite;
+  const uint8_t ack = respond_ack(kind, addr);
+  if (ack == ACK_NONE) return ack;
+  line_reset_seen_ = false;
+  if (ack == ACK_OK) {
+    req_kind_ = kind;
+    req_addr_ = addr;
+  }
+  return ack;
+}
+
+void Stm32SwdTarget::txn_write_data(uint32_t data, uint8_t parity) {
+  if (req_kind_ != ReqKind::DpWrite && req_kind_ != ReqKind::ApWrite) return;
+  complete_write(req_kind_, req_addr_, data, parity);
+  req_kind_ = ReqKind::None;
 }
 
 void Stm32SwdTarget::reset() {
@@ -326,6 +869,7 @@ void Stm32SwdTarget::reset() {
   after_jtag_to_swd_ = false;
   req_kind_ = ReqKind::None;
   req_addr_ = 0;
+  ack_ = ACK_OK;
   read_data_ = 0;
   read_parity_ = 0;
   bit_idx_ = 0;
@@ -343,10 +887,24 @@ void Stm32SwdTarget::reset() {
   dp_ctrlstat_ = 0;
   dp_select_ = 0;
   dp_rdbuff_ = 0;
+  dp_sticky_ = 0;
   ap_csw_ = 0;
   ap_tar_ = 0;
+  swclk_half_period_ns_ = 0;
+  last_rise_ns_ = 0;
+
+  // Power-on: NRST high, core running user firmware from t=0.
+  nrst_high_ = true;
+  core_halted_ = false;
+  halt_requested_in_reset_ = false;
+  core_run_since_ns_ = 0;
+  core_ran_ns_ = 0;
 
   flash_reset();
+  sram_reset();
+  dcrdr_ = 0;
+  dcrsr_ = 0;
+  core_registers_reset();
 }
 
 bool Stm32SwdTarget::consume_sampled_host_bit_flag() {
@@ -463,6 +1021,10 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
   // can still expose which target-driven bit is being *presented* on this rising edge.
   last_host_sample_bit_index_ = 0;
 
+  // SWCLK half period as the target sees it (signal-integrity fault).
+  swclk_half_period_ns_ = (t_ns_ - last_rise_ns_) / 2u;
+  last_rise_ns_ = t_ns_;
+
   // Detect line reset: consecutive cycles where host drives SWDIO high.
   if (host_driving && host_level == 1) {
     consecutive_high_cycles_++;
@@ -596,17 +1158,20 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
         else if (apndp == 1u && rnw == 1u) req_kind_ = ReqKind::ApRead;
         else req_kind_ = ReqKind::ApWrite;
 
+        ack_ = respond_ack(req_kind_, req_addr_);
+        if (ack_ == ACK_NONE) {
+          // Pins repurposed by firmware: nobody answers.
+          req_shift_ = 0;
+          req_bits_ = 0;
+          return;
+        }
+
         if (req_kind_ == ReqKind::DpRead || req_kind_ == ReqKind::ApRead) {
-          // Prepare read value.
-          if (req_kind_ == ReqKind::DpRead) {
-            read_data_ = dp_read_reg(req_addr_);
-          } else {
-            // Posted read semantics: return stale buffer, then update dp_rdbuff with actual.
-            const uint32_t actual = ap_read_reg(req_addr_);
-            read_data_ = dp_rdbuff_;
-            dp_rdbuff_ = actual;
+          // Prepare read value (only an OK transfer has a data phase / side effects).
+          if (ack_ == ACK_OK) {
+            read_data_ = read_request_value(req_kind_, req_addr_);
+            read_parity_ = read_parity_out(read_data_);
           }
-          read_parity_ = parity_u32(read_data_);
 
           phase_ = Phase::TurnaroundToTarget_Read;
           bit_idx_ = 0;
@@ -628,9 +1193,8 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
     // ===== Read response =====
     case Phase::TurnaroundToTarget_Read: {
       // Present ACK bit0 on this edge (matching host code's timing).
-      const uint8_t ack_ok = 0b001;
       drive_en_ = true;
-      drive_level_ = (ack_ok >> 0) & 1u;
+      drive_level_ = (ack_ >> 0) & 1u;
       last_host_sample_bit_index_ = 1;
       phase_ = Phase::SendAck_Read;
       bit_idx_ = 1;
@@ -638,12 +1202,12 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
     }
 
     case Phase::SendAck_Read: {
-      const uint8_t ack_ok = 0b001;
-      drive_level_ = (ack_ok >> bit_idx_) & 1u;
+      drive_level_ = (ack_ >> bit_idx_) & 1u;
       last_host_sample_bit_index_ = (uint8_t)(bit_idx_ + 1);
       bit_idx_++;
       if (bit_idx_ >= 3) {
-        phase_ = Phase::SendData_Read;
+        // WAIT/FAULT: no data phase; release the line on the next edge.
+        phase_ = (ack_ == ACK_OK) ? Phase::SendData_Read : Phase::TurnaroundToHost_Read;
         bit_idx_ = 0;
       }
       return;
@@ -673,9 +1237,8 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
     // ===== Write transaction =====
     case Phase::TurnaroundToTarget_Write: {
       // For writes, the target drives ACK during the turnaround period.
-      const uint8_t ack_ok = 0b001;
       drive_en_ = true;
-      drive_level_ = (ack_ok >> 0) & 1u;
+      drive_level_ = (ack_ >> 0) & 1u;
       last_host_sample_bit_index_ = 1;
       phase_ = Phase::SendAck_Write;
       bit_idx_ = 1;
@@ -683,8 +1246,7 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
     }
 
     case Phase::SendAck_Write: {
-      const uint8_t ack_ok = 0b001;
-      drive_level_ = (ack_ok >> bit_idx_) & 1u;
+      drive_level_ = (ack_ >> bit_idx_) & 1u;
       last_host_sample_bit_index_ = (uint8_t)(bit_idx_ + 1);
       bit_idx_++;
       if (bit_idx_ >= 3) {
@@ -699,8 +1261,9 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
     case Phase::TurnaroundToHost_Write:
       // Target releases line ownership on this rising edge.
       // Host will begin driving later (in host code this corresponds to its extra turnaround clocks).
+      // After WAIT/FAULT there is no data phase.
       drive_en_ = false;
-      phase_ = Phase::RecvData_Write;
+      phase_ = (ack_ == ACK_OK) ? Phase::RecvData_Write : Phase::CollectRequest;
       return;
 
     case Phase::RecvData_Write: {
@@ -725,20 +1288,13 @@ void Stm32SwdTarget::on_swclk_rising_edge(bool host_driving, uint8_t host_level)
     }
 
     case Phase::Complete_Write: {
-      // Apply write if parity OK.
-      const uint8_t p = parity_u32(write_data_);
-      if (p == write_parity_rx_) {
-        if (req_kind_ == ReqKind::DpWrite) {
-          dp_write_reg(req_addr_, write_data_);
-        } else if (req_kind_ == ReqKind::ApWrite) {
-          ap_write_reg(req_addr_, write_data_);
-        }
-      }
+      // Apply write if parity OK (otherwise WDATAERR is latched).
+      complete_write(req_kind_, req_addr_, write_data_, write_parity_rx_);
 
       // Target does not drive anything for writes (no data response, only ACK in real SWD).
-      // However the host implementation ignores WAIT/FAULT and just assumes OK.
-      // For simplicity, we just go back to collecting requests.
-      phase_ = Phase::CollectRequest;
+      // For simplicity, we just go back to collecting requests (unless the write was an
+      // OBL_LAUNCH that took the debug port down).
+      phase_ = swd_enabled_ ? Phase::CollectRequest : Phase::AwaitResetOrSeq;
       return;
     }
 
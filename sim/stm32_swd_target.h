@@ -2,8 +2,11 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <random>
 #include <vector>
 
+#include "src/stm32g0_devices.h"
+
 namespace sim {
 
 // SWD target model:
@@ -65,6 +68,162 @@ class Stm32SwdTarget {
   // Config
   void set_idcode(uint32_t idcode) { dp_idcode_ = idcode; }
 
+  // Which STM32G0 part this is (default: stm32g0_devices::k_devices[k_default_device] with
+  // its largest flash). DBGMCU_IDCODE reads back (rev_id << 16) | dev_id and FLASHSIZE
+  // `flash_size` in KB; flash and SRAM are resized to match and cleared as by reset(), which
+  // keeps the device. `flash_size` 0 means the line's largest. On dual-bank parts MER1 erases
+  // the lower half of flash and MER2 the upper half (BSY1/BSY2 each); single-bank parts
+  // ignore MER2. A `dev_id` outside the table is fine here (the host should refuse it).
+  void set_device(const stm32g0_devices::Device &device, uint32_t flash_size = 0, uint16_t rev_id = 0x1000);
+  const stm32g0_devices::Device &device() const { return device_; }
+
+  // NRST level as seen by the target (host-driven LOW, or released/driven HIGH).
+  // Reported by the simulator shim whenever the host changes the NRST pin; time must be
+  // current (set_time_ns) so reset-relative faults below are timed correctly.
+  void set_nrst_level(bool high);
+
+  // Core run state (simulator ground truth, independent of what the host reads back).
+  // While NRST is HIGH the core runs user firmware until a DHCSR write with
+  // DBGKEY|C_DEBUGEN|C_HALT lands; it resumes on a DHCSR write without C_HALT. Asserting
+  // NRST resets the core (not halted). DHCSR reads report S_HALT only while halted.
+  //
+  // A halt request written while NRST is LOW (DHCSR C_HALT or DEMCR.VC_CORERESET) makes
+  // the core come out of reset halted only if set_halt_request_survives_reset(true); by
+  // default it is lost, so the first post-release DHCSR write is what wins the race.
+  bool core_halted() const { return core_halted_; }
+  void set_halt_request_survives_reset(bool v) { halt_request_survives_reset_ = v; }
+
+  // Core registers, numbered as DCRSR.REGSEL: 0-12 R0-R12, 13 SP (MSP or PSP per
+  // CONTROL.SPSEL), 14 LR, 15 PC, 16 xPSR, 17 MSP, 18 PSP, 20 CONTROL[31:24]/PRIMASK[0].
+  // A DCRSR write clears DHCSR.S_REGRDY; the transfer to/from DCRDR lands `latency_ns`
+  // later (default 0), and only while the core is halted. NRST release loads MSP and PC
+  // from the vector table at the start of flash. reset() leaves the latency alone.
+  uint32_t core_register(uint8_t regsel) const;
+  void set_core_register(uint8_t regsel, uint32_t v);
+  void set_core_register_latency_ns(uint64_t ns) { core_reg_latency_ns_ = ns; }
+
+  // AHB-AP CSW: 8/16/32-bit sizes are always accepted; packed transfers (AddrInc=packed)
+  // only when enabled (default off, like the Cortex-M0+ AHB-AP). reset() leaves it alone.
+  void set_packed_transfers_supported(bool v) { packed_transfers_ = v; }
+
+  // FLASH_SR.BSY durations: mass erase (default 50ms) and each 32-bit program (default
+  // 200us). Like the fault config, reset() leaves them alone.
+  void set_flash_busy_times(uint64_t mass_erase_ns, uint64_t program32_ns) {
+    mass_erase_busy_ns_ = mass_erase_ns;
+    program32_busy_ns_ = program32_ns;
+  }
+
+  // Option bytes. FLASH_OPTR reads back the loaded options until the host, with flash and
+  // options unlocked (KEYR, then OPTKEYR), writes it; OPTSTRT stores the written value (BSY
+  // for `option_program_ns`, default 25ms, plus a mass erase when it takes RDP from level 1
+  // back to 0) and OBL_LAUNCH loads it. That reload is a system reset that also takes the
+  // debug port down: nothing answers until a line reset + JTAG-to-SWD switch, the core runs
+  // user firmware, and the flash controller is locked again. NRST does not reload options.
+  // While the loaded RDP is level 1, AP accesses to the flash array FAULT (STICKYERR; counted
+  // in FaultStats::rdp_faults). reset() restores RDP level 0 and leaves the timing alone.
+  uint32_t option_bytes() const { return ob_loaded_; }
+  uint32_t option_reloads() const { return option_reloads_; }
+  // A part that already has `optr` loaded (e.g. a unit coming back with RDP level 1).
+  void load_option_bytes(uint32_t optr);
+  void set_option_program_time_ns(uint64_t ns) { option_program_busy_ns_ = ns; }
+
+  // --- Fault injection ---
+  // Every fault is off by default, in which case the model behaves exactly as without
+  // fault injection (every request ACKs OK, deterministic BSY timing).
+  //
+  // Random decisions draw from a private std::mt19937 seeded with `seed` on set_faults(),
+  // so the same config + the same host transaction sequence always reproduces the same
+  // faults. reset() does not touch the fault config.
+  struct FaultConfig {
+    uint32_t seed = 1;
+
+    // WAIT: AP access number `wait_on_ap_access` (1-based, counted from set_faults(); 0 = off)
+    // and the `wait_burst - 1` AP accesses after it ACK WAIT with no side effect.
+    // A non-zero `wait_period` repeats the pattern every `wait_period` AP accesses.
+    uint32_t wait_on_ap_access = 0;
+    uint32_t wait_burst = 1;
+    uint32_t wait_period = 0;
+
+    // FAULT: an AP DRW access whose TAR lies in [fault_addr_lo, fault_addr_hi) ACKs FAULT
+    // and sets CTRL/STAT.STICKYERR. `fault_addr_hits` limits how often (0 = every time).
+    uint32_t fault_addr_lo = 0;
+    uint32_t fault_addr_hi = 0;
+    uint32_t fault_addr_hits = 0;
+
+    // Parity corruption probability per data phase.
+    // Reads: the host sees a bad parity bit. Writes: the target drops the data and sets
+    // CTRL/STAT.WDATAERR (the ACK has already gone out as OK).
+    double parity_error_rate = 0.0;
+
+    // Stalled BSY: with probability `bsy_stall_rate`, a program/erase operation stays
+    // busy for an extra `bsy_stall_ns`.
+    double bsy_stall_rate = 0.0;
+    uint64_t bsy_stall_ns = 0;
+
+    // Early SWD disable: user firmware reconfigures SWCLK/SWDIO once it has executed for
+    // more than `early_swd_disable_after_ns` since NRST release. From then on the target ignores every
+    // request (the host reads the pulled-up line, ACK=0b111) until NRST is asserted again.
+    // Halting the core before that point (see core_halted()) keeps SWD alive; a write whose
+    // data phase ends after the pins were repurposed is lost.
+    bool early_swd_disable = false;
+    uint64_t early_swd_disable_after_ns = 0;
+
+    // Marginal signal integrity (long cable, fixture): data phases clocked with a SWCLK half
+    // period below `si_min_half_period_ns` see a parity error with probability
+    // `si_error_rate` (on top of parity_error_rate; counted in si_errors).
+    uint64_t si_min_half_period_ns = 0;
+    double si_error_rate = 0.0;
+  };
+
+  struct FaultStats {
+    uint64_t ap_accesses = 0;
+    uint64_t waits = 0;
+    uint64_t faults = 0;
+    uint64_t sticky_faults = 0;  // FAULT because a sticky error flag was still set
+    uint64_t read_parity_errors = 0;
+    uint64_t write_parity_errors = 0;
+    uint64_t bsy_stalls = 0;
+    uint64_t ignored_requests = 0;  // requests seen while SWD was disabled by firmware
+    uint64_t lost_writes = 0;       // writes ACKed OK whose data phase ended after the disable
+    uint64_t sticky_clears = 0;
+    uint64_t si_errors = 0;         // parity errors from a too-fast SWCLK (also in *_parity_errors)
+    uint64_t rdp_faults = 0;        // flash accesses refused under RDP level 1 (not injected)
+  };
+
+  void set_faults(const FaultConfig &cfg);
+  const FaultConfig &faults() const { return faults_; }
+  const FaultStats &fault_stats() const { return fault_stats_; }
+
+  // --- Transaction-level interface ---
+  // Used by the transaction-level backend (see sim/swd_txn_backend.h), which bypasses the
+  // SWCLK edge state machine entirely. Both paths share the same DP/AP/memory model,
+  // including posted AP read semantics (an AP read returns the previous RDBUFF value).
+  //
+  // txn_line_reset()/txn_jtag_to_swd() mirror what the edge model detects on the wire.
+  // txn_read()/txn_write_request() return the 3-bit ACK; before the SWD switch has been seen
+  // the target does not respond, so the host sees the floating line (0b111).
+  // SWCLK half period of the transfers that follow (the edge model measures it between
+  // rising edges instead).
+  void set_swclk_half_period_ns(uint64_t ns) { swclk_half_period_ns_ = ns; }
+
+  void txn_line_reset();
+  void txn_jtag_to_swd();
+  // The parity bit travels with the data (as on the wire) so the host can do its own check.
+  uint8_t txn_read(bool apndp, uint8_t addr, uint32_t *data_out, uint8_t *parity_out);
+  // Writes are split like on the wire: the request/ACK, then (only after an OK ACK) the data
+  // phase. Call txn_write_data() with time advanced to the end of the data phase; that is
+  // when the edge model applies the write too.
+  uint8_t txn_write_request(bool apndp, uint8_t addr);
+  void txn_write_data(uint32_t data, uint8_t parity);
+
+  // Direct view of the simulated flash array (FLASH_BASE..FLASH_BASE+size-1).
+  // Intended for test harnesses that compare against the image they programmed.
+  const std::vector<uint8_t> &flash_contents() const { return flash_; }
+
+  // Simulated SRAM (SRAM_BASE = 0x20000000, sized by the device, zeroed by reset()). Takes
+  // 8/16/32-bit writes.
+  const std::vector<uint8_t> &sram_contents() const { return sram_; }
+
  private:
   // --- SWD protocol state machine ---
   enum class Phase : uint8_t {
@@ -94,22 +253,56 @@ class Stm32SwdTarget {
   static uint8_t parity_u32(uint32_t v);
   static inline uint8_t get_bit_u32(uint32_t v, uint8_t i) { return (v >> i) & 1u; }
 
+  // Shared by the edge state machine and the transaction-level interface.
+  // respond_ack() decides the ACK for a decoded request (0b111 = no response at all) and
+  // must be called exactly once per request, before any side effect.
+  uint8_t respond_ack(ReqKind kind, uint8_t addr);
+  uint32_t read_request_value(ReqKind kind, uint8_t addr);
+  void apply_write(ReqKind kind, uint8_t addr, uint32_t v);
+  uint8_t read_parity_out(uint32_t v);
+  void complete_write(ReqKind kind, uint8_t addr, uint32_t v, uint8_t parity_rx);
+
+  // Core run/halt model.
+  void dhcsr_write(uint32_t v);
+  void core_registers_reset();
+  void core_reg_update();
+  uint64_t firmware_run_ns() const;
+
+  // Fault injection helpers.
+  bool swd_disabled_by_firmware() const;
+  bool roll(double p);
+  bool roll_data_error();
+
   // --- DP/AP register model ---
   uint32_t dp_read_reg(uint8_t addr);
   void dp_write_reg(uint8_t addr, uint32_t v);
 
+  // AP register address including SELECT.APBANKSEL (a request carries only A[3:2]).
+  uint8_t ap_bank_addr(uint8_t addr) const { return (uint8_t)((((dp_select_ >> 4) & 0xFu) << 4) | (addr & 0xCu)); }
+  // Memory address an access to the banked AP register `addr` (DRW or BDn) goes to; false
+  // for the other registers.
+  bool ap_mem_addr(uint8_t addr, uint32_t *mem_addr) const;
   uint32_t ap_read_reg(uint8_t addr);
   void ap_write_reg(uint8_t addr, uint32_t v);
+  void ap_advance_tar();
 
   // --- AHB memory model ---
   bool mem_read32(uint32_t addr, uint32_t &out);
   bool mem_write32(uint32_t addr, uint32_t v);
+  // `bytes` (1/2/4) bytes of `v` on the byte lanes of `addr`.
+  bool mem_write_lanes(uint32_t addr, uint32_t v, uint32_t bytes);
+  void sram_reset();
 
   // --- STM32G0 flash controller simulation ---
   void flash_reset();
   void flash_update_busy();
-  void flash_start_busy(uint64_t duration_ns);
+  void flash_start_busy(uint64_t duration_ns, uint32_t busy_bits);
+  bool in_flash(uint32_t addr, uint32_t n) const;
+  bool in_sram(uint32_t addr, uint32_t n) const;
   void flash_try_unlock(uint32_t key);
+  void flash_try_option_unlock(uint32_t key);
+  void flash_start_option_program();
+  void option_reload();
   void flash_start_mass_erase();
   void flash_program32(uint32_t addr, uint32_t v);
 
@@ -135,6 +328,7 @@ class Stm32SwdTarget {
   // Decoded request
   ReqKind req_kind_ = ReqKind::None;
   uint8_t req_addr_ = 0;
+  uint8_t ack_ = 0b001;
 
   // Read response payload
   uint32_t read_data_ = 0;
@@ -167,20 +361,57 @@ class Stm32SwdTarget {
   uint32_t dp_ctrlstat_ = 0;
   uint32_t dp_select_ = 0;
   uint32_t dp_rdbuff_ = 0;
+  uint32_t dp_sticky_ = 0;  // CTRL/STAT.STICKYERR / WDATAERR, cleared via ABORT
 
-  // --- AP registers (AHB-AP #0, bank 0 only for this sim) ---
+  // --- AP registers (AHB-AP #0: CSW/TAR/DRW, BD0-BD3, IDR) ---
   uint32_t ap_csw_ = 0;
   uint32_t ap_tar_ = 0;
+  bool packed_transfers_ = false;
 
   // --- Flash + flash regs ---
+  stm32g0_devices::Device device_ = stm32g0_devices::k_devices[stm32g0_devices::k_default_device];
+  uint32_t flash_size_ = device_.flash_max_bytes;
+  uint16_t rev_id_ = 0x1000;
   std::vector<uint8_t> flash_;
+  std::vector<uint8_t> sram_;
 
   uint32_t flash_keyr_last_ = 0;
   uint32_t flash_sr_ = 0;
-  uint32_t flash_cr_ = 0x80000000u; // LOCK set after reset
-  uint32_t flash_optr_ = 0;
+  uint32_t flash_optkeyr_last_ = 0;
+  uint32_t flash_cr_ = 0xC0000000u; // LOCK + OPTLOCK set after reset
+  uint32_t flash_optr_ = 0;         // FLASH_OPTR register (written value until the reload)
+  uint32_t ob_stored_ = 0;          // option area (OPTSTRT)
+  uint32_t ob_loaded_ = 0;          // options in effect (OBL_LAUNCH)
+  uint32_t option_reloads_ = 0;
+  uint64_t option_program_busy_ns_ = 25ull * 1000ull * 1000ull;
 
   uint64_t flash_bsy_clear_time_ns_ = 0;
+  uint64_t mass_erase_busy_ns_ = 50ull * 1000ull * 1000ull;
+  uint64_t program32_busy_ns_ = 200ull * 1000ull;
+
+  // --- NRST + core run state ---
+  bool nrst_high_ = true;
+  bool core_halted_ = false;
+  bool halt_requested_in_reset_ = false;
+  bool halt_request_survives_reset_ = false;
+  uint64_t core_run_since_ns_ = 0;  // start of the current running stretch
+  uint64_t core_ran_ns_ = 0;        // firmware run time accumulated before that stretch
+
+  // --- Core registers (indexed by DCRSR.REGSEL; [13] unused, SP aliases MSP/PSP) ---
+  uint32_t core_regs_[21] = {};
+  uint32_t dcrdr_ = 0;
+  uint32_t dcrsr_ = 0;
+  bool core_reg_pending_ = false;
+  uint64_t core_reg_ready_ns_ = 0;
+  uint64_t core_reg_latency_ns_ = 0;
+
+  // --- Fault injection ---
+  FaultConfig faults_;
+  FaultStats fault_stats_;
+  std::mt19937 fault_rng_{1};
+  uint32_t fault_addr_hit_count_ = 0;
+  uint64_t swclk_half_period_ns_ = 0;
+  uint64_t last_rise_ns_ = 0;
 };
 
 } // namespace sim
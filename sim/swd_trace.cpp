@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <memory>
+
+#include "runtime.h"
+#include "sim_api.h"
+
+// Decoded SWD transaction trace (sim::set_trace_path()).
+//
+// swd_min (built with SWD_MIN_TRACE) reports every DP/AP transfer to a sink; this one writes
+// one CSV row per transfer for the current Runtime. Columns:
+//   t_ns        simulated time at the end of the transfer (including its post-idle clocks)
+//   phase       last sim::log_step() marker ("" before the first one)
+//   port,dir    DP/AP, R/W
+//   reg,addr    register name and byte address (AP registers are in the SELECTed bank)
+//   value       data written, or data sampled (AP reads: the posted/stale value)
+//   ack,ok      3-bit ACK; ok=0 also covers read parity errors
+//   clocks      SWCLK cycles of the transfer, of which idle_clocks are request idle + post idle
+//   gap_clocks  SWCLK cycles clocked since the previous transfer (line reset, JTAG-to-SWD, idle)
+// swd_trace_analyze summarizes the file.
+
+namespace sim {
+
+static void write_trace_record(const swd_min::TraceRecord &rec, void *user) {
+  Runtime &r = *static_cast<Runtime *>(user);
+  if (!r.trace_out) return;
+  char line[192];
+  std::snprintf(line, sizeof(line), "%llu,%s,%s,%s,%s,0x%02X,0x%08X,%u,%u,%u,%u,%u\n", (unsigned long long)r.t_ns,
+                r.trace_phase.c_str(), rec.apndp ? "AP" : "DP", rec.rnw ? "R" : "W", rec.reg, (unsigned)rec.addr,
+                (unsigned)rec.value, (unsigned)rec.ack, rec.ok ? 1u : 0u, (unsigned)rec.clocks,
+                (unsigned)rec.idle_clocks, (unsigned)rec.gap_clocks);
+  *r.trace_out << line;
+}
+
+void set_trace_path(const char *path) {
+  auto &r = rt();
+  r.trace_out.reset();
+  if (!path || !path[0]) {
+    swd_min::set_trace_sink(nullptr, nullptr);
+    return;
+  }
+  r.trace_out = std::make_unique<std::ofstream>(path);
+  if (!*r.trace_out) {
+    std::fprintf(stderr, "cannot open trace file %s\n", path);
+    r.trace_out.reset();
+    swd_min::set_trace_sink(nullptr, nullptr);
+    return;
+  }
+  *r.trace_out << "t_ns,phase,port,dir,reg,addr,value,ack,ok,clocks,idle_clocks,gap_clocks\n";
+  swd_min::set_trace_sink(write_trace_record, &r);
+}
+
+} // namespace sim
@@ -0,0 +1,322 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Decoded SWD transaction trace analyzer.
+//
+// Reads a trace written by sim::set_trace_path() (e.g. `txn_regression 1 1 trace.csv`) and
+// prints:
+// - totals: transfers by port/direction, non-OK ACKs, SWCLK cycles split into transfer,
+//   idle (request idle bits + post-transfer idle) and gaps (line reset, JTAG-to-SWD, idle)
+// - per phase (sim::log_step() markers): transfers, SWCLK cycles, simulated time
+// - redundant DP SELECT / AP CSW / AP TAR writes: the register already held the value.
+//   TAR is tracked through DRW auto-increment (CSW AddrInc single, Size) up to the 1KB
+//   boundary the AHB-AP does not increment across (a TAR write there is required).
+// - TAR rewrites that resume an interrupted stream: a DRW stream was left for another
+//   address (e.g. FLASH_SR polling) and TAR is written back to where the stream stood.
+//   Grouped by the interleaved address, with the SWCLK cycles the round trip costs.
+// Register state is forgotten after a non-OK ACK and after >= 50 gap clocks (line reset).
+//
+// Usage: swd_trace_analyze <trace.csv>
+
+namespace {
+
+struct Row {
+  uint64_t t_ns = 0;
+  std::string phase;
+  bool ap = false;
+  bool read = false;
+  std::string reg;
+  uint32_t addr = 0;
+  uint32_t value = 0;
+  uint32_t ack = 0;
+  bool ok = false;
+  uint32_t clocks = 0;
+  uint32_t idle_clocks = 0;
+  uint32_t gap_clocks = 0;
+};
+
+static constexpr uint32_t k_dp_select = 0x08;
+static constexpr uint32_t k_ap_csw = 0x00;
+static constexpr uint32_t k_ap_tar = 0x04;
+static constexpr uint32_t k_ap_drw = 0x0C;
+static constexpr uint32_t k_line_reset_clocks = 50;
+static constexpr uint32_t k_tar_wrap_bytes = 1024;
+
+bool parse_row(const std::string &line, Row &r) {
+  std::vector<std::string> f;
+  std::stringstream ss(line);
+  std::string cell;
+  while (std::getline(ss, cell, ',')) f.push_back(cell);
+  if (f.size() != 12) return false;
+  r.t_ns = std::strtoull(f[0].c_str(), nullptr, 10);
+  r.phase = f[1];
+  r.ap = (f[2] == "AP");
+  r.read = (f[3] == "R");
+  r.reg = f[4];
+  r.addr = (uint32_t)std::strtoul(f[5].c_str(), nullptr, 0);
+  r.value = (uint32_t)std::strtoul(f[6].c_str(), nullptr, 0);
+  r.ack = (uint32_t)std::strtoul(f[7].c_str(), nullptr, 0);
+  r.ok = (f[8] == "1");
+  r.clocks = (uint32_t)std::strtoul(f[9].c_str(), nullptr, 0);
+  r.idle_clocks = (uint32_t)std::strtoul(f[10].c_str(), nullptr, 0);
+  r.gap_clocks = (uint32_t)std::strtoul(f[11].c_str(), nullptr, 0);
+  return true;
+}
+
+struct PhaseStats {
+  uint64_t transfers = 0;
+  uint64_t clocks = 0;
+  uint64_t idle_clocks = 0;
+  uint64_t gap_clocks = 0;
+  uint64_t t_ns = 0;
+};
+
+struct Redundant {
+  uint64_t writes = 0;
+  uint64_t redundant = 0;
+  uint64_t wasted_clocks = 0;
+};
+
+struct Resume {
+  uint64_t count = 0;
+  uint64_t resume_clocks = 0;     // the TAR writes returning to the stream
+  uint64_t excursion_clocks = 0;  // TAR writes of the interleaved accesses
+};
+
+// A run of DRW accesses started by one TAR write.
+struct Run {
+  uint32_t start = 0;       // TAR value written
+  uint32_t end = 0;         // TAR after the run's accesses (where the run would continue)
+  uint64_t tar_mark = 0;    // ApState::tar_write_clocks after the TAR write that started the run
+};
+static constexpr size_t k_run_history = 8;
+
+// Host-visible AHB-AP / DP register state, as far as the trace lets us know it.
+struct ApState {
+  bool select_known = false;
+  uint32_t select = 0;
+  bool csw_known = false;
+  uint32_t csw = 0;
+  bool tar_known = false;
+  uint32_t tar = 0;
+
+  // Recent runs, oldest first; the last one is the current run (if tar_known).
+  std::vector<Run> runs;
+  uint64_t tar_write_clocks = 0;  // all TAR writes so far
+
+  void forget() { *this = ApState{}; }
+
+  uint32_t bank() const { return select_known ? (select & 0xF0u) : 0u; }
+
+  // After a DRW access, TAR moves by the access size when CSW.AddrInc is "single".
+  void advance_tar() {
+    if (!tar_known) return;
+    if (!csw_known) {
+      tar_known = false;
+      return;
+    }
+    if (((csw >> 4) & 0x3u) != 0x1u) return;
+    const uint32_t size = 1u << (csw & 0x7u);
+    if (size > 4u) {
+      tar_known = false;
+      return;
+    }
+    // Auto-increment is only guaranteed within a 1KB block; past it TAR must be rewritten.
+    if (((tar + size) & (k_tar_wrap_bytes - 1u)) == 0) {
+      tar_known = false;
+      return;
+    }
+    tar += size;
+  }
+};
+
+double pct(uint64_t part, uint64_t whole) { return whole ? 100.0 * (double)part / (double)whole : 0.0; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: swd_trace_analyze <trace.csv>\n");
+    return 1;
+  }
+  std::ifstream in(argv[1]);
+  if (!in) {
+    std::fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  std::string line;
+  std::getline(in, line);  // header
+
+  uint64_t rows = 0;
+  uint64_t bad_rows = 0;
+  uint64_t dp_r = 0, dp_w = 0, ap_r = 0, ap_w = 0, non_ok = 0;
+  uint64_t clocks = 0, idle_clocks = 0, gap_clocks = 0;
+  uint64_t first_t_ns = 0, last_t_ns = 0;
+
+  std::vector<std::string> phase_order;
+  std::map<std::string, PhaseStats> phases;
+  Redundant red_select, red_csw, red_tar;
+  std::map<uint32_t, Resume> resumes;  // keyed by the interleaved (excursion) address
+
+  ApState s;
+  Row r;
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    if (!parse_row(line, r)) {
+      bad_rows++;
+      continue;
+    }
+    if (rows == 0) first_t_ns = r.t_ns;
+    const uint64_t dt = (rows == 0) ? 0 : r.t_ns - last_t_ns;
+    last_t_ns = r.t_ns;
+    rows++;
+
+    if (r.ap) (r.read ? ap_r : ap_w)++;
+    else (r.read ? dp_r : dp_w)++;
+    if (r.ack != 1u) non_ok++;
+    clocks += r.clocks;
+    idle_clocks += r.idle_clocks;
+    gap_clocks += r.gap_clocks;
+
+    if (!phases.count(r.phase)) phase_order.push_back(r.phase);
+    PhaseStats &ps = phases[r.phase];
+    ps.transfers++;
+    ps.clocks += r.clocks;
+    ps.idle_clocks += r.idle_clocks;
+    ps.gap_clocks += r.gap_clocks;
+    ps.t_ns += dt;
+
+    if (r.gap_clocks >= k_line_reset_clocks) s.forget();
+
+    const uint32_t reg = r.addr & 0x0Cu;
+    if (!r.ap && !r.read && reg == k_dp_select) {
+      red_select.writes++;
+      if (r.ok && s.select_known && s.select == r.value) {
+        red_select.redundant++;
+        red_select.wasted_clocks += r.clocks;
+      }
+    } else if (r.ap && !r.read && s.bank() == 0 && reg == k_ap_csw) {
+      red_csw.writes++;
+      if (r.ok && s.csw_known && s.csw == r.value) {
+        red_csw.redundant++;
+        red_csw.wasted_clocks += r.clocks;
+      }
+    } else if (r.ap && !r.read && s.bank() == 0 && reg == k_ap_tar) {
+      red_tar.writes++;
+      if (!s.tar_known) {
+        s.runs.clear();
+      } else if (!s.runs.empty()) {
+        // The current run has covered [start, s.tar]; earlier runs that would continue inside
+        // it were resumed along the way.
+        s.runs.back().end = s.tar;
+        const uint32_t lo = s.runs.back().start;
+        for (size_t k = s.runs.size() - 1; k-- > 0;) {
+          if (s.runs[k].end >= lo && s.runs[k].end <= s.tar) s.runs.erase(s.runs.begin() + (long)k);
+        }
+      }
+      if (r.ok && s.tar_known && s.tar == r.value) {
+        red_tar.redundant++;
+        red_tar.wasted_clocks += r.clocks;
+      } else if (r.ok) {
+        // Returning to where an earlier run would continue, after runs at other addresses?
+        for (size_t k = s.runs.size(); k-- > 0;) {
+          if (s.runs[k].end != r.value) continue;
+          Resume &res = resumes[s.runs[k + 1].start];
+          res.count++;
+          res.resume_clocks += r.clocks;
+          res.excursion_clocks += s.tar_write_clocks - s.runs[k].tar_mark;
+          s.runs.clear();
+          break;
+        }
+        s.runs.push_back(Run{r.value, r.value, s.tar_write_clocks + r.clocks});
+        if (s.runs.size() > k_run_history) s.runs.erase(s.runs.begin());
+      }
+      s.tar_write_clocks += r.clocks;
+    }
+
+    if (!r.ok) {
+      // WAIT/FAULT/parity: whatever the register model did is not visible in the trace.
+      s.forget();
+      continue;
+    }
+
+    if (!r.ap && !r.read && reg == k_dp_select) {
+      s.select_known = true;
+      s.select = r.value;
+    } else if (r.ap && s.bank() == 0) {
+      if (reg == k_ap_csw && !r.read) {
+        s.csw_known = true;
+        s.csw = r.value;
+      } else if (reg == k_ap_csw) {
+        s.csw_known = false;  // posted read: the value arrives with the next transfer
+      } else if (reg == k_ap_tar && !r.read) {
+        s.tar_known = true;
+        s.tar = r.value;
+      } else if (reg == k_ap_drw) {
+        s.advance_tar();
+      }
+    }
+  }
+
+  if (rows == 0) {
+    std::fprintf(stderr, "%s: no transactions\n", argv[1]);
+    return 1;
+  }
+
+  const uint64_t total_clocks = clocks + gap_clocks;
+  std::printf("swd_trace_analyze: %s\n", argv[1]);
+  std::printf("  transfers: %llu (dp_read=%llu dp_write=%llu ap_read=%llu ap_write=%llu) non_ok_ack=%llu\n",
+              (unsigned long long)rows, (unsigned long long)dp_r, (unsigned long long)dp_w, (unsigned long long)ap_r,
+              (unsigned long long)ap_w, (unsigned long long)non_ok);
+  std::printf("  swclk cycles: %llu = transfers %llu (of which idle %llu) + gaps %llu\n",
+              (unsigned long long)total_clocks, (unsigned long long)clocks, (unsigned long long)idle_clocks,
+              (unsigned long long)gap_clocks);
+  std::printf("  idle overhead: %.1f%% of swclk cycles (request idle + post idle), gaps %.1f%%\n",
+              pct(idle_clocks, total_clocks), pct(gap_clocks, total_clocks));
+  std::printf("  simulated time: %.3f ms\n", (double)(last_t_ns - first_t_ns) / 1e6);
+
+  std::printf("\n  %-24s %10s %12s %7s %7s %11s\n", "phase", "transfers", "swclk", "idle%", "gap%", "sim_ms");
+  for (const std::string &name : phase_order) {
+    const PhaseStats &ps = phases[name];
+    const uint64_t pc = ps.clocks + ps.gap_clocks;
+    std::printf("  %-24s %10llu %12llu %6.1f%% %6.1f%% %11.3f\n", name.empty() ? "(none)" : name.c_str(),
+                (unsigned long long)ps.transfers, (unsigned long long)pc, pct(ps.idle_clocks, pc),
+                pct(ps.gap_clocks, pc), (double)ps.t_ns / 1e6);
+  }
+
+  std::printf("\n  redundant writes (register already held the value):\n");
+  const struct {
+    const char *name;
+    const Redundant &r;
+  } red[] = {{"DP SELECT", red_select}, {"AP CSW", red_csw}, {"AP TAR", red_tar}};
+  uint64_t wasted = 0;
+  for (const auto &e : red) {
+    std::printf("    %-10s %8llu of %8llu writes, %10llu swclk (%.1f%%)\n", e.name,
+                (unsigned long long)e.r.redundant, (unsigned long long)e.r.writes,
+                (unsigned long long)e.r.wasted_clocks, pct(e.r.wasted_clocks, total_clocks));
+    wasted += e.r.wasted_clocks;
+  }
+
+  std::printf("\n  TAR rewrites resuming an interrupted DRW stream (by interleaved address):\n");
+  if (resumes.empty()) std::printf("    none\n");
+  for (const auto &kv : resumes) {
+    const Resume &res = kv.second;
+    std::printf("    0x%08X %8llu round trips, resume TAR %10llu swclk (%.1f%%), interleaved TAR %10llu swclk (%.1f%%)\n",
+                kv.first, (unsigned long long)res.count, (unsigned long long)res.resume_clocks,
+                pct(res.resume_clocks, total_clocks), (unsigned long long)res.excursion_clocks,
+                pct(res.excursion_clocks, total_clocks));
+    wasted += res.resume_clocks;
+  }
+  std::printf("\n  avoidable TAR/SELECT/CSW traffic: %llu swclk (%.1f%%)\n", (unsigned long long)wasted,
+              pct(wasted, total_clocks));
+
+  if (bad_rows) std::fprintf(stderr, "%llu malformed rows skipped\n", (unsigned long long)bad_rows);
+  return bad_rows ? 2 : 0;
+}
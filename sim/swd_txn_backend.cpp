@@ -0,0 +1,89 @@
+#include "swd_txn_backend.h"
+
+#include "runtime.h"
+
+namespace sim {
+namespace txn {
+
+// SWD line reset threshold (matches the edge model in Stm32SwdTarget).
+static constexpr uint32_t k_line_reset_cycles = 50;
+
+static inline uint64_t half_period_ns(uint32_t half_period_us) {
+  return half_period_us ? (uint64_t)half_period_us * 1000ull : k_gpio_half_period_ns;
+}
+
+static void advance(uint64_t cycles, uint32_t half_period_us) {
+  auto &r = rt();
+  r.t_ns += cycles * 2ull * half_period_ns(half_period_us);
+  r.target.set_time_ns(r.t_ns);
+}
+
+uint8_t transfer(bool apndp, bool rnw, uint8_t addr, uint32_t *data, uint8_t *parity,
+                 uint32_t req_idle_low_bits, uint32_t half_period_us) {
+  auto &r = rt();
+  Stats &st = r.txn_stats;
+  r.target.set_swclk_half_period_ns(half_period_ns(half_period_us));
+
+  // Request + ACK happen first; the target samples the request at the end of it.
+  const uint64_t header_cycles = (uint64_t)req_idle_low_bits + 8u + 3u + 2u;
+  advance(header_cycles, half_period_us);
+
+  uint8_t ack = 0;
+  if (rnw) {
+    uint32_t v = 0;
+    uint8_t p = 0;
+    ack = r.target.txn_read(apndp, addr, &v, &p);
+    if (ack == 0b001) {
+      if (data) *data = v;
+      if (parity) *parity = p;
+    }
+  } else {
+    ack = r.target.txn_write_request(apndp, addr);
+  }
+
+  uint64_t cycles = header_cycles;
+  if (ack == 0b001) {
+    // Data phase; a write takes effect once its parity bit has been clocked in.
+    advance(33u, half_period_us);
+    cycles += 33u;
+    if (!rnw) r.target.txn_write_data(data ? *data : 0u, parity ? *parity : 0u);
+  } else {
+    st.non_ok_acks++;
+  }
+
+  if (apndp) {
+    if (rnw) st.ap_reads++;
+    else st.ap_writes++;
+  } else {
+    if (rnw) st.dp_reads++;
+    else st.dp_writes++;
+  }
+  st.transfer_cycles += cycles;
+  return ack;
+}
+
+void idle_cycles(uint32_t cycles, bool swdio_high, uint32_t half_period_us) {
+  if (cycles == 0) return;
+  Stats &st = rt().txn_stats;
+  advance(cycles, half_period_us);
+  st.idle_cycles += cycles;
+  if (swdio_high && cycles >= k_line_reset_cycles) {
+    rt().target.txn_line_reset();
+    st.line_resets++;
+  }
+}
+
+void jtag_to_swd(uint32_t half_period_us) {
+  advance(16u, half_period_us);
+  rt().txn_stats.idle_cycles += 16u;
+  rt().target.txn_jtag_to_swd();
+}
+
+const Stats &stats() { return rt().txn_stats; }
+
+void reset_stats() { rt().txn_stats = Stats{}; }
+
+Timing &timing() { return rt().txn_timing; }
+
+} // namespace txn
+} // namespace sim
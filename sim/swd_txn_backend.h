@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// Transaction-level SWD backend (simulator only).
+//
+// The default simulator executables run swd_min's bit-bang code edge by edge through
+// the Arduino shim, GpioModel and Stm32SwdTarget::on_swclk_rising_edge(). That is what
+// we want for waveforms, but it is far too slow for regression-testing programming
+// logic on realistic (tens of KB) images.
+//
+// When src/swd_min.cpp is compiled with SWD_SIM_TXN_BACKEND defined, its DP/AP
+// primitives call into this backend instead of toggling pins. Each call:
+// - forwards the transfer to the simulated target's register model
+//   (Stm32SwdTarget::txn_read()/txn_write()), and
+// - advances simulated time by the number of SWCLK cycles the bit-bang code would
+//   have produced for the same transfer (cost model below).
+//
+// Cost model (one cycle = 2 * half period; half_period_us == 0 means swd_min adds no delay,
+// modelled as k_gpio_half_period_ns):
+//   transfer, ACK OK    : req_idle_low_bits + 8 (request) + 3 (ACK) + 2 (turnaround) + 33 (data+parity)
+//   transfer, ACK !OK   : req_idle_low_bits + 8 (request) + 3 (ACK) + 2 (turnaround)
+//   idle / line reset   : cycles as requested
+//   JTAG-to-SWD         : 16
+namespace sim {
+namespace txn {
+
+// SWCLK half period of the bit-bang loop without any delayMicroseconds() (GPIO writes + loop
+// overhead on the ESP32; roughly 2 MHz SWCLK).
+static constexpr uint64_t k_gpio_half_period_ns = 250;
+
+struct Stats {
+  uint64_t dp_reads = 0;
+  uint64_t dp_writes = 0;
+  uint64_t ap_reads = 0;
+  uint64_t ap_writes = 0;
+  uint64_t non_ok_acks = 0;
+  uint64_t line_resets = 0;
+
+  // SWCLK cycles spent in transfers vs. idle/reset/sequence clocking.
+  uint64_t transfer_cycles = 0;
+  uint64_t idle_cycles = 0;
+
+  uint64_t transactions() const { return dp_reads + dp_writes + ap_reads + ap_writes; }
+};
+
+// swd_min's timing knobs. In transaction-level builds SWD_HALF_PERIOD_US,
+// SWD_POST_IDLE_LOW_CYCLES and SWD_REQ_IDLE_LOW_BITS read these (unless overridden with -D),
+// so one binary can sweep them. Defaults match the firmware's compile-time values.
+struct Timing {
+  uint32_t half_period_us = 1;
+  uint32_t post_idle_low_cycles = 8;
+  uint32_t req_idle_low_bits = 2;
+};
+
+// One SWD transfer. Returns the 3-bit ACK; on OK + read, *data / *parity receive the
+// value and parity bit the host would have sampled (posted semantics for AP reads).
+// For writes, *parity is the parity bit the host sends with *data.
+uint8_t transfer(bool apndp, bool rnw, uint8_t addr, uint32_t *data, uint8_t *parity,
+                 uint32_t req_idle_low_bits, uint32_t half_period_us);
+
+// Host clocks `cycles` SWCLK periods with SWDIO held at `swdio_high`.
+// A run of >= 50 high cycles is a line reset.
+void idle_cycles(uint32_t cycles, bool swdio_high, uint32_t half_period_us);
+
+// Host sends the 16-bit JTAG-to-SWD sequence (0xE79E).
+void jtag_to_swd(uint32_t half_period_us);
+
+// Stats and timing belong to the current sim::Runtime (see sim::ScopedRuntime).
+const Stats &stats();
+void reset_stats();
+Timing &timing();
+
+} // namespace txn
+} // namespace sim
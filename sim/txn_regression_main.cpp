@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "stm32g0_prog.h"
+#include "swd_min.h"
+
+#include "runtime.h"
+#include "sim_api.h"
+#include "swd_txn_backend.h"
+
+// Transaction-level regression runner.
+//
+// Runs the production programming sequence (connect+halt recovery -> mass erase ->
+// program -> fast verify) against the simulated target for many randomized images,
+// using the transaction-level SWD backend (see swd_txn_backend.h). After every image
+// the simulated flash array is compared byte-for-byte against what was requested, so
+// a "verify OK" that hides a bad program is caught as well.
+//
+// With `trace_csv`, every DP/AP transfer is written to a decoded transaction trace tagged
+// with the phase (STEP_CONNECT/ERASE/PROGRAM/VERIFY); see swd_trace_analyze.
+//
+// Usage: txn_regression [images=200] [seed=1] [trace_csv]
+
+namespace {
+
+struct PhaseTimes {
+  uint64_t connect_ns = 0;
+  uint64_t erase_ns = 0;
+  uint64_t program_ns = 0;
+  uint64_t verify_ns = 0;
+};
+
+bool run_one(uint32_t index, const std::vector<uint8_t> &image, PhaseTimes &t) {
+  const uint32_t len = (uint32_t)image.size();
+
+  uint64_t t0 = sim::now_ns();
+  sim::log_step("STEP_CONNECT");
+  if (!stm32g0_prog::connect_and_halt_under_reset_recovery()) {
+    std::fprintf(stderr, "image %u: connect failed\n", index);
+    return false;
+  }
+  uint64_t t1 = sim::now_ns();
+  t.connect_ns += t1 - t0;
+
+  sim::log_step("STEP_ERASE");
+  if (!stm32g0_prog::flash_mass_erase()) {
+    std::fprintf(stderr, "image %u: mass erase failed\n", index);
+    return false;
+  }
+  t0 = sim::now_ns();
+  t.erase_ns += t0 - t1;
+
+  sim::log_step("STEP_PROGRAM");
+  if (!stm32g0_prog::flash_program(stm32g0_prog::FLASH_BASE, image.data(), len)) {
+    std::fprintf(stderr, "image %u: program failed (len=%u)\n", index, len);
+    return false;
+  }
+  t1 = sim::now_ns();
+  t.program_ns += t1 - t0;
+
+  // flash_program() pads the tail to a doubleword with 0xFF; verify the padded image.
+  std::vector<uint8_t> padded(image);
+  padded.resize((len + 7u) & ~7u, 0xFF);
+  uint32_t mismatches = 0;
+  sim::log_step("STEP_VERIFY");
+  if (!stm32g0_prog::flash_verify_fast(stm32g0_prog::FLASH_BASE, padded.data(), (uint32_t)padded.size(),
+                                        &mismatches, /*max_report=*/4)) {
+    std::fprintf(stderr, "image %u: verify failed (len=%u mismatches=%u)\n", index, len, mismatches);
+    return false;
+  }
+  t.verify_ns += sim::now_ns() - t1;
+
+  // Ground truth: the target model's flash array must hold the padded image followed by
+  // erased bytes.
+  const std::vector<uint8_t> &flash = sim::rt().target.flash_contents();
+  for (size_t i = 0; i < flash.size(); i++) {
+    const uint8_t exp = (i < padded.size()) ? padded[i] : 0xFF;
+    if (flash[i] != exp) {
+      std::fprintf(stderr, "image %u: target flash differs at offset 0x%zX (exp=%02X got=%02X)\n", index, i, exp,
+                   flash[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+double ms(uint64_t ns) { return (double)ns / 1e6; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const uint32_t images = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 0) : 200u;
+  const uint32_t seed = (argc > 2) ? (uint32_t)std::strtoul(argv[2], nullptr, 0) : 1u;
+  const char *trace_path = (argc > 3) ? argv[3] : nullptr;
+
+  sim::set_log_path("txn_regression.csv");
+  sim::set_waveform_logging(false);
+  sim::set_console_output(false);
+
+  static const swd_min::Pins pins(35, 36, 37);
+  swd_min::begin(pins);
+  swd_min::set_verbose(false);
+  if (trace_path) sim::set_trace_path(trace_path);
+
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<uint32_t> len_dist(1u, stm32g0_prog::target().flash_size);
+  std::uniform_int_distribution<uint32_t> byte_dist(0u, 255u);
+
+  PhaseTimes t;
+  uint32_t failures = 0;
+  uint64_t bytes = 0;
+  const auto wall_start = std::chrono::steady_clock::now();
+
+  for (uint32_t i = 0; i < images; i++) {
+    std::vector<uint8_t> image(len_dist(rng));
+    for (auto &b : image) b = (uint8_t)byte_dist(rng);
+    bytes += image.size();
+    if (!run_one(i, image, t)) failures++;
+  }
+
+  const double wall_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  const sim::txn::Stats &st = sim::txn::stats();
+
+  std::printf("txn_regression: images=%u seed=%u failures=%u bytes=%llu\n", images, seed, failures,
+              (unsigned long long)bytes);
+  std::printf("  simulated time (total ms): connect=%.1f erase=%.1f program=%.1f verify=%.1f\n", ms(t.connect_ns),
+              ms(t.erase_ns), ms(t.program_ns), ms(t.verify_ns));
+  if (images) {
+    std::printf("  simulated time (avg ms/image): connect=%.2f erase=%.2f program=%.2f verify=%.2f\n",
+                ms(t.connect_ns) / images, ms(t.erase_ns) / images, ms(t.program_ns) / images,
+                ms(t.verify_ns) / images);
+  }
+  std::printf("  transactions: dp_read=%llu dp_write=%llu ap_read=%llu ap_write=%llu non_ok_ack=%llu\n",
+              (unsigned long long)st.dp_reads, (unsigned long long)st.dp_writes, (unsigned long long)st.ap_reads,
+              (unsigned long long)st.ap_writes, (unsigned long long)st.non_ok_acks);
+  const swd_min::ShadowStats &sh = swd_min::shadow_stats();
+  std::printf("  dp/ap shadow: skipped select=%u/%u csw=%u/%u tar=%u/%u (%.1f transfers/image saved) invalidations=%u\n",
+              sh.select_skipped, sh.select_skipped + sh.select_writes, sh.csw_skipped, sh.csw_skipped + sh.csw_writes,
+              sh.tar_skipped, sh.tar_skipped + sh.tar_writes, images ? (double)sh.skipped() / images : 0.0,
+              sh.invalidations);
+  std::printf("  swclk cycles: transfer=%llu idle=%llu line_resets=%llu\n", (unsigned long long)st.transfer_cycles,
+              (unsigned long long)st.idle_cycles, (unsigned long long)st.line_resets);
+  std::printf("  wall time: %.2f s (%.1f images/s)\n", wall_s, wall_s > 0 ? images / wall_s : 0.0);
+
+  if (trace_path) sim::set_trace_path(nullptr);
+  return failures ? 2 : 0;
+}
@@ -0,0 +1,200 @@
+#include "link_monitor.h"
+
+#include <string.h>
+
+// Servomotor Arduino library (vendored into lib/Servomotor)
+#include <Servomotor.h>
+
+// For CommunicationStatistics and the COMMUNICATION_ERROR_* codes.
+#include <Communication.h>
+
+#include "link_monitor_core.h"
+#include "tee_log.h"
+
+namespace link_monitor {
+
+static inline Print &LOG() { return tee_log::out(); }
+
+using link_monitor_core::Entry;
+
+static SemaphoreHandle_t g_mu = nullptr;
+static link_monitor_core::EntryTable g_entries;
+
+static SemaphoreHandle_t mu() {
+  if (!g_mu) g_mu = xSemaphoreCreateMutex();
+  return g_mu;
+}
+
+void publish_host(const char *name, uint64_t unique_id, const CommunicationStatistics &host, uint32_t bytes_per_second) {
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  const uint32_t now = millis();
+  Entry *e = g_entries.find_or_add(name, unique_id, now);
+  e->host = host;
+  e->bytes_per_second = bytes_per_second;
+  e->host_ms = now;
+  xSemaphoreGive(mu());
+}
+
+static uint32_t host_errors(const CommunicationStatistics &s) {
+  return s.timeouts + s.crc32Mismatches + s.badFirstByte + s.badResponseChar + s.badThirdByte + s.otherErrors;
+}
+
+static uint32_t device_errors(const getCommunicationStatisticsResponse &d) {
+  return d.crc32ErrorCount + d.packetDecodeErrorCount + d.firstBitErrorCount + d.framingErrorCount +
+         d.overrunErrorCount + d.noiseErrorCount;
+}
+
+static void print_report(const char *name, uint64_t unique_id, const CommunicationStatistics &s, uint32_t bps,
+                         int device_error, const getCommunicationStatisticsResponse &d) {
+  LOG().printf("Link statistics: %s", name);
+  if (unique_id != 0) {
+    LOG().printf(" (uniqueId 0x%08lX%08lX)", (unsigned long)(unique_id >> 32), (unsigned long)(unique_id & 0xFFFFFFFFu));
+  }
+  LOG().printf(", last %lu ms\n", (unsigned long)(millis() - s.startMillis));
+  LOG().printf("  host: sent %lu frames / %lu bytes, received %lu frames / %lu bytes, %lu bytes/s\n",
+               (unsigned long)s.framesSent, (unsigned long)s.bytesSent, (unsigned long)s.framesReceived,
+               (unsigned long)s.bytesReceived, (unsigned long)bps);
+  LOG().printf("  host errors: timeout %lu, crc32 %lu, first byte %lu, response char %lu, third byte %lu, other %lu, "
+               "device error codes %lu\n",
+               (unsigned long)s.timeouts, (unsigned long)s.crc32Mismatches, (unsigned long)s.badFirstByte,
+               (unsigned long)s.badResponseChar, (unsigned long)s.badThirdByte, (unsigned long)s.otherErrors,
+               (unsigned long)s.deviceErrors);
+  if (s.latencySamples > 0) {
+    LOG().printf("  latency: min %lu us, mean %lu us, max %lu us\n", (unsigned long)s.latencyMinMicroseconds,
+                 (unsigned long)(s.latencySumMicroseconds / s.latencySamples), (unsigned long)s.latencyMaxMicroseconds);
+    for (uint8_t i = 0; i < COMMUNICATION_LATENCY_BUCKETS; i++) {
+      if (s.latencyHistogram[i] == 0) continue;
+      const uint32_t limit = communicationLatencyBucketLimit(i);
+      if (limit != 0) {
+        LOG().printf("    < %6lu us: %lu\n", (unsigned long)limit, (unsigned long)s.latencyHistogram[i]);
+      } else {
+        LOG().printf("    >= %5lu us: %lu\n", (unsigned long)communicationLatencyBucketLimit(i - 1),
+                     (unsigned long)s.latencyHistogram[i]);
+      }
+    }
+  }
+  if (device_error != 0) {
+    LOG().printf("  device: GET_COMMUNICATION_STATISTICS failed errno=%d\n", device_error);
+  } else {
+    LOG().printf("  device errors: crc32 %lu, packet decode %lu, first bit %lu, framing %lu, overrun %lu, noise %lu\n",
+                 (unsigned long)d.crc32ErrorCount, (unsigned long)d.packetDecodeErrorCount,
+                 (unsigned long)d.firstBitErrorCount, (unsigned long)d.framingErrorCount,
+                 (unsigned long)d.overrunErrorCount, (unsigned long)d.noiseErrorCount);
+  }
+  const uint32_t errors = host_errors(s) + (device_error == 0 ? device_errors(d) : 0);
+  if (errors == 0 && device_error == 0) {
+    LOG().println("  link: OK");
+  } else {
+    LOG().printf("  link: %lu errors in %lu exchanges -- check the RS485 cabling\n", (unsigned long)errors,
+                 (unsigned long)s.framesSent);
+  }
+}
+
+bool report(Servomotor &motor, const char *name, uint64_t unique_id, bool reset) {
+  getCommunicationStatisticsPayload payload;
+  payload.resetCounter = reset ? 1 : 0;
+  getCommunicationStatisticsResponse device;
+  memset(&device, 0, sizeof(device));
+  const int err = motor.execute<GET_COMMUNICATION_STATISTICS>(&payload, &device);
+
+  Communication &comm = motor.communication();
+  const CommunicationStatistics host = comm.statistics();
+  const uint32_t bps = comm.bytesPerSecond();
+  print_report(name, unique_id, host, bps, err, device);
+
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  const uint32_t now = millis();
+  Entry *e = g_entries.find_or_add(name, unique_id, now);
+  e->host = host;
+  e->bytes_per_second = bps;
+  e->host_ms = now;
+  e->device_error = err;
+  e->device_ms = now;
+  if (err == 0) {
+    e->device = device;
+    e->device_valid = true;
+  }
+  xSemaphoreGive(mu());
+
+  if (reset) {
+    comm.resetStatistics();
+    publish_host(name, unique_id, comm.statistics(), 0);
+    LOG().printf("Link statistics: %s counters reset\n", name);
+  }
+  return err == 0;
+}
+
+static String u64_hex(uint64_t v) {
+  char buf[19];
+  snprintf(buf, sizeof(buf), "0x%08lX%08lX", (unsigned long)(v >> 32), (unsigned long)(v & 0xFFFFFFFFu));
+  return String(buf);
+}
+
+static void append_entry(String &json, const Entry &e, uint32_t now) {
+  const CommunicationStatistics &s = e.host;
+  json += "{\"name\":\"" + String(e.name) + "\"";
+  json += ",\"unique_id\":\"" + u64_hex(e.unique_id) + "\"";
+  json += ",\"host\":{\"age_ms\":" + String((unsigned long)(now - e.host_ms));
+  json += ",\"window_ms\":" + String((unsigned long)(e.host_ms - s.startMillis));
+  json += ",\"frames_sent\":" + String((unsigned long)s.framesSent);
+  json += ",\"bytes_sent\":" + String((unsigned long)s.bytesSent);
+  json += ",\"frames_received\":" + String((unsigned long)s.framesReceived);
+  json += ",\"bytes_received\":" + String((unsigned long)s.bytesReceived);
+  json += ",\"bytes_per_second\":" + String((unsigned long)e.bytes_per_second);
+  json += ",\"device_error_codes\":" + String((unsigned long)s.deviceErrors);
+  json += ",\"timeouts\":" + String((unsigned long)s.timeouts);
+  json += ",\"crc32_mismatches\":" + String((unsigned long)s.crc32Mismatches);
+  json += ",\"bad_first_byte\":" + String((unsigned long)s.badFirstByte);
+  json += ",\"bad_response_char\":" + String((unsigned long)s.badResponseChar);
+  json += ",\"bad_third_byte\":" + String((unsigned long)s.badThirdByte);
+  json += ",\"other_errors\":" + String((unsigned long)s.otherErrors);
+  json += ",\"latency_samples\":" + String((unsigned long)s.latencySamples);
+  json += ",\"latency_min_us\":" + String((unsigned long)s.latencyMinMicroseconds);
+  json += ",\"latency_mean_us\":" +
+          String((unsigned long)(s.latencySamples ? s.latencySumMicroseconds / s.latencySamples : 0));
+  json += ",\"latency_max_us\":" + String((unsigned long)s.latencyMaxMicroseconds);
+  json += ",\"latency_bucket_limits_us\":[";
+  for (uint8_t i = 0; i + 1 < COMMUNICATION_LATENCY_BUCKETS; i++) {
+    if (i) json += ",";
+    json += String((unsigned long)communicationLatencyBucketLimit(i));
+  }
+  json += "],\"latency_histogram\":[";
+  for (uint8_t i = 0; i < COMMUNICATION_LATENCY_BUCKETS; i++) {
+    if (i) json += ",";
+    json += String((unsigned long)s.latencyHistogram[i]);
+  }
+  json += "]}";
+  json += ",\"device\":";
+  if (!e.device_valid && e.device_ms == 0) {
+    json += "null";
+  } else {
+    const getCommunicationStatisticsResponse &d = e.device;
+    json += "{\"age_ms\":" + String((unsigned long)(now - e.device_ms));
+    json += ",\"errno\":" + String(e.device_error);
+    json += ",\"valid\":" + String(e.device_valid ? "true" : "false");
+    json += ",\"crc32_errors\":" + String((unsigned long)d.crc32ErrorCount);
+    json += ",\"packet_decode_errors\":" + String((unsigned long)d.packetDecodeErrorCount);
+    json += ",\"first_bit_errors\":" + String((unsigned long)d.firstBitErrorCount);
+    json += ",\"framing_errors\":" + String((unsigned long)d.framingErrorCount);
+    json += ",\"overrun_errors\":" + String((unsigned long)d.overrunErrorCount);
+    json += ",\"noise_errors\":" + String((unsigned long)d.noiseErrorCount);
+    json += "}";
+  }
+  json += ",\"total_errors\":" + String((unsigned long)(host_errors(s) + (e.device_valid ? device_errors(e.device) : 0)));
+  json += "}";
+}
+
+String json() {
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  const uint32_t now = millis();
+  String out = "{\"devices\":[";
+  for (size_t i = 0; i < g_entries.size(); i++) {
+    if (i) out += ",";
+    append_entry(out, g_entries.at(i), now);
+  }
+  out += "]}";
+  xSemaphoreGive(mu());
+  return out;
+}
+
+}  // namespace link_monitor
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Forward declaration to avoid pulling in the whole Arduino library header from users.
+class Servomotor;
+struct CommunicationStatistics;
+
+namespace link_monitor {
+
+// RS485 link quality per device, for spotting degrading fixture cabling before it shows up as
+// upgrade failures.
+//
+// Each device is an entry keyed by its unique ID; a device addressed by alias (unique_id 0, e.g.
+// the reference) is keyed by its role `name` ("dut", "reference") instead. An entry merges the
+// host-side counters of the device's Communication object (frames, bytes, errors by kind, latency
+// histogram) with the device's own GET_COMMUNICATION_STATISTICS counters. The host-side counters
+// only describe one device if the Servomotor object is switched between units with
+// link_monitor_core::use_device(), which starts them over (see link_monitor_core.h).
+//
+// Mode 2 owns the bus, so it publishes here; the web UI task only reads the last published
+// snapshot (json()). Thread-safe.
+
+// Publishes the host-side counters only (cheap; no bus traffic).
+void publish_host(const char *name, uint64_t unique_id, const CommunicationStatistics &host, uint32_t bytes_per_second);
+
+// Reads the device-side counters of `motor` (resetting them afterwards if `reset`), publishes
+// them together with the host-side ones and prints the merged report. With `reset`, the host-side
+// counters start over too. Returns false if the device did not answer.
+bool report(Servomotor &motor, const char *name, uint64_t unique_id, bool reset);
+
+// {"devices":[{...}, ...]} with everything last published, host and device counters per entry.
+String json();
+
+}  // namespace link_monitor
@@ -0,0 +1,44 @@
+#include "link_monitor_core.h"
+
+#include <string.h>
+
+// Servomotor Arduino library (vendored into lib/Servomotor)
+#include <Servomotor.h>
+
+namespace link_monitor_core {
+
+static bool same_device(const Entry &e, const char *name, uint64_t unique_id) {
+  if (unique_id != 0) return e.unique_id == unique_id;
+  return e.unique_id == 0 && strncmp(e.name, name, k_name_len - 1) == 0;
+}
+
+Entry *EntryTable::find_or_add(const char *name, uint64_t unique_id, uint32_t now_ms) {
+  Entry *e = nullptr;
+  for (size_t i = 0; i < n_ && !e; i++) {
+    if (same_device(entries_[i], name, unique_id)) e = &entries_[i];
+  }
+  if (!e) {
+    if (n_ < k_max_entries) {
+      e = &entries_[n_++];
+    } else {
+      e = &entries_[0];
+      for (size_t i = 1; i < n_; i++) {
+        if (now_ms - entries_[i].used_ms > now_ms - e->used_ms) e = &entries_[i];
+      }
+    }
+    memset(e, 0, sizeof(*e));
+    strncpy(e->name, name, k_name_len - 1);
+    e->unique_id = unique_id;
+  }
+  e->used_ms = now_ms;
+  return e;
+}
+
+bool use_device(Servomotor &motor, uint64_t unique_id) {
+  if (motor.isUsingExtendedAddressing() && motor.usingThisUniqueId() == unique_id) return false;
+  motor.useUniqueId(unique_id);
+  motor.communication().resetStatistics();
+  return true;
+}
+
+}  // namespace link_monitor_core
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Servomotor Arduino library (vendored into lib/Servomotor): CommunicationStatistics and the
+// GET_COMMUNICATION_STATISTICS response.
+#include <Communication.h>
+#include <CommandPayloads.h>
+
+// Forward declaration to avoid pulling in the whole Arduino library header from users.
+class Servomotor;
+
+namespace link_monitor_core {
+
+// The part of link_monitor that needs nothing but the Servomotor library: the per-device entry
+// table and switching the DUT Servomotor object to another unit. link_monitor.cpp wraps it in a
+// mutex and the report/JSON output; testdata/test_link_monitor.cpp drives it on the host.
+
+static constexpr size_t k_max_entries = 4;
+static constexpr size_t k_name_len = 16;
+
+struct Entry {
+  char name[k_name_len];          // role ("dut", "reference")
+  uint64_t unique_id;             // 0: addressed by alias
+  CommunicationStatistics host;
+  uint32_t bytes_per_second;
+  uint32_t host_ms;               // millis() when the host counters were published
+  bool device_valid;              // device counters below were read at least once
+  int device_error;               // errno of the last device read
+  uint32_t device_ms;
+  getCommunicationStatisticsResponse device;
+  uint32_t used_ms;               // last find_or_add() for this device
+};
+
+// One entry per device, keyed by unique ID. A device addressed by alias (unique_id 0, e.g. the
+// reference) is told apart by its role name instead. When the table is full the least recently
+// used entry is reused. Not thread-safe.
+class EntryTable {
+ public:
+  // Returns the device's entry, a fresh (zeroed) one if it has none yet.
+  Entry *find_or_add(const char *name, uint64_t unique_id, uint32_t now_ms);
+
+  size_t size() const { return n_; }
+  const Entry &at(size_t i) const { return entries_[i]; }
+
+ private:
+  Entry entries_[k_max_entries] = {};
+  size_t n_ = 0;
+};
+
+// Points `motor` at the unit `unique_id`. When that is a different device than before, the
+// Communication counters of `motor` start over, so host-side statistics never mix two units.
+// Returns true if the device changed.
+bool use_device(Servomotor &motor, uint64_t unique_id);
+
+}  // namespace link_monitor_core
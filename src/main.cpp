@@ -6,6 +6,7 @@
 #include "firmware_source.h"
 #include "firmware_source_file.h"
 #include "stm32g0_prog.h"
+#include "swd_clock_store.h"
 #include "swd_min.h"
 
 #include <SPIFFS.h>
@@ -13,6 +14,8 @@
 #include "product_info_injector_reader.h"
 #include "program_state.h"
 #include "serial_log.h"
+#include "servomotor_upgrade.h"
+#include "target_dump.h"
 #include "wifi_web_ui.h"
 
 #include "unit_context.h"
@@ -51,12 +54,33 @@ static const swd_min::Pins PINS(35, 36, 37);
 // - Returning to Mode 1: restore SWD pin configuration before any SWD operation.
 static bool g_swd_pins_floating = false;
 
+// This station's SWD clock (loaded from SPIFFS at boot, updated by 'k'). swd_min::begin()
+// resets the clock to its compile-time default, so it is re-applied after every begin().
+static bool g_swd_clock_valid = false;
+static swd_min::ClockConfig g_swd_clock = {1, 1};
+
+static void swd_begin() {
+  swd_min::begin(PINS);
+  if (g_swd_clock_valid) swd_min::set_clock_config(g_swd_clock);
+}
+
 // Production jig button:
 // - GPIO45 configured as INPUT_PULLUP
 // - external button pulls to GND when pressed
 static constexpr int k_prod_button_pin = 45;
 static constexpr uint32_t k_button_debounce_ms = 30;
 
+// Optional production step 'o' (between verify and run): FLASH_OPTR bits to program, as a
+// mask and the values under it (field masks in stm32g0_prog.h). A zero mask leaves the step
+// out. Set both from platformio.ini build_flags.
+#ifndef PROD_OPTION_BYTES_MASK
+#define PROD_OPTION_BYTES_MASK 0u
+#endif
+#ifndef PROD_OPTION_BYTES_VALUE
+#define PROD_OPTION_BYTES_VALUE 0u
+#endif
+static constexpr bool k_prod_option_bytes = (PROD_OPTION_BYTES_MASK) != 0u;
+
 // Forward declarations (used by production sequence helper).
 static bool print_idcode_attempt();
 static bool cmd_erase();
@@ -94,7 +118,7 @@ static void enter_mode1_swd_pin_state() {
   // explicit here so Mode 1 behavior is consistent even for commands that only
   // touch NRST.
   if (g_swd_pins_floating) {
-    swd_min::begin(PINS);
+    swd_begin();
     g_swd_pins_floating = false;
   }
 }
@@ -128,16 +152,22 @@ static void print_help() {
   LOG().println("  t = terminal: dump RAM terminal buffer to USB serial");
   LOG().println("  m = memory: print heap/PSRAM stats");
   LOG().println("  d = toggle SWD verbose diagnostics");
+  LOG().println("  k = tune SWD clock for this station (connect + bulk; saved to SPIFFS)");
   LOG().println("  b = DP ABORT write test (write under NRST low, then under NRST high)");
   LOG().println("  c = DP CTRL/STAT single-write test (DP[0x04]=0x50000000)");
-  LOG().println("  p = read Program Counter (PC) register (tests core register access)");
+  LOG().println("  p = read Program Counter (PC) 5x, then the whole core register file (core left halted)");
   LOG().println("  r = read first 8 bytes of target flash @ 0x08000000");
+  LOG().println("  D = dump whole flash + SRAM (with header) to /dump_flash.bin and /dump_sram.bin (WiFi UI download)");
   LOG().println("  e = erase entire flash (mass erase; connect-under-reset recovery method)");
   LOG().println("  w = write firmware to flash (prints serial+unique_id, first block hexdump, product_info_struct)");
   LOG().println("      (prints a simple benchmark: connect/program/total time)");
   LOG().println("  v = verify firmware in flash (FAST; prints benchmark + mismatch count)");
+  LOG().println("  o = read + decode option bytes (FLASH_OPTR: RDP, BOR, watchdogs)");
+  LOG().printf("  O = program production option bytes (mask=0x%08lX value=0x%08lX; option reload + re-attach)\n",
+              (unsigned long)(PROD_OPTION_BYTES_MASK), (unsigned long)(PROD_OPTION_BYTES_VALUE));
   LOG().println("  a = access point (WiFi) status: up/down + IP address");
-  LOG().println("  <space> = PRODUCTION: run i -> e -> w -> v -> R (fail-fast; stops at first error)");
+  LOG().printf("  <space> = PRODUCTION: run i -> e -> w -> v -> %sR (fail-fast; stops at first error)\n",
+              k_prod_option_bytes ? "o -> " : "");
   LOG().println("Production jig:");
   LOG().printf("  Button on GPIO%d (INPUT_PULLUP) pulls to GND when pressed -> runs <space> sequence\n",
               k_prod_button_pin);
@@ -207,10 +237,42 @@ static bool cmd_reset_pulse_run_strict() {
   return true;
 }
 
+static void cmd_read_option_bytes() {
+  if (!stm32g0_prog::connect_and_halt_under_reset_recovery()) {
+    LOG().println("Option bytes: connect FAIL");
+    return;
+  }
+  uint32_t optr = 0;
+  if (!stm32g0_prog::read_option_bytes(&optr)) {
+    LOG().println("Option bytes: FLASH_OPTR read FAIL");
+    return;
+  }
+  stm32g0_prog::print_option_bytes(optr);
+}
+
+// Expects an attached target (after 'v' in production). Verify must already be done: from RDP
+// level 1 on, flash can no longer be read over SWD.
+static bool cmd_program_option_bytes() {
+  stm32g0_prog::OptionBytesResult r;
+  const uint32_t t0 = millis();
+  const bool ok = stm32g0_prog::program_option_bytes(PROD_OPTION_BYTES_MASK, PROD_OPTION_BYTES_VALUE, &r);
+  const uint32_t ms_total = millis() - t0;
+  if (!ok) {
+    LOG().println("Option bytes FAIL");
+    return false;
+  }
+  stm32g0_prog::print_option_bytes(r.optr_after);
+  LOG().printf("Benchmark o: program=%lums reload=%lums total=%lums%s\n", (unsigned long)(r.program_us / 1000u),
+              (unsigned long)(r.reload_us / 1000u), (unsigned long)ms_total,
+              r.changed ? "" : " (already set; nothing programmed)");
+  LOG().println("Option bytes OK");
+  return true;
+}
+
 static bool run_production_sequence(const char *source) {
   LOG().println("========================================");
   LOG().printf("PRODUCTION sequence triggered by %s\n", source);
-  LOG().println("Sequence: i -> e -> w -> v -> R (fail-fast)");
+  LOG().printf("Sequence: i -> e -> w -> v -> %sR (fail-fast)\n", k_prod_option_bytes ? "o -> " : "");
   LOG().println("----------------------------------------");
 
   // Fail-safe: do not program if filesystem has almost no free space.
@@ -257,8 +319,9 @@ static bool run_production_sequence(const char *source) {
     return false;
   }
 
-  LOG().printf("Production consumed serial=%lu unique_id=0x%08lX%08lX\n", (unsigned long)consumed.serial,
-              (unsigned long)(consumed.unique_id >> 32), (unsigned long)(consumed.unique_id & 0xFFFFFFFFu));
+  LOG().printf("Production consumed serial=%lu unique_id=0x%08lX%08lX (pool: %u left)\n", (unsigned long)consumed.serial,
+              (unsigned long)(consumed.unique_id >> 32), (unsigned long)(consumed.unique_id & 0xFFFFFFFFu),
+              (unsigned)serial_log::pool_size());
 
   {
     unit_context::Context ctx;
@@ -270,26 +333,35 @@ static bool run_production_sequence(const char *source) {
 
   if (!cmd_write_with_product_info(consumed.serial, consumed.unique_id)) {
     LOG().println("ERROR: Production sequence aborted at step 'w' (write)");
-    (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed.serial, consumed.unique_id, /*ok=*/false);
+    (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed, /*ok=*/false);
     return false;
   }
   completed_steps += 'w';
 
   if (!cmd_verify_with_product_info(consumed.serial, consumed.unique_id)) {
     LOG().println("ERROR: Production sequence aborted at step 'v' (verify)");
-    (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed.serial, consumed.unique_id, /*ok=*/false);
+    (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed, /*ok=*/false);
     return false;
   }
   completed_steps += 'v';
 
+  if (k_prod_option_bytes) {
+    if (!cmd_program_option_bytes()) {
+      LOG().println("ERROR: Production sequence aborted at step 'o' (option bytes)");
+      (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed, /*ok=*/false);
+      return false;
+    }
+    completed_steps += 'o';
+  }
+
   if (!cmd_reset_pulse_run_strict()) {
     LOG().println("ERROR: Production sequence aborted at step 'R' (run)");
-    (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed.serial, consumed.unique_id, /*ok=*/false);
+    (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed, /*ok=*/false);
     return false;
   }
   completed_steps += 'R';
 
-  (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed.serial, consumed.unique_id, /*ok=*/true);
+  (void)serial_log::append_summary_with_unique_id(completed_steps.c_str(), consumed, /*ok=*/true);
   LOG().println("PRODUCTION sequence SUCCESS");
   return true;
 }
@@ -632,6 +704,13 @@ static bool cmd_verify_with_product_info(uint32_t serial, uint64_t unique_id) {
               (unsigned long)ms_connect, (unsigned long)ms_verify, (unsigned long)ms_total, (double)kbps);
   LOG().printf("Verify mismatches: %lu\n", (unsigned long)mismatches);
 
+  // Show what the target actually holds (one block read; the core is still halted).
+  product_info_struct target_pi;
+  if (connect_ok && stm32g0_prog::read_product_info(&target_pi)) {
+    LOG().println("product_info_struct read back from target flash:");
+    print_product_info_struct(target_pi);
+  }
+
   const bool ok = connect_ok && verify_ok;
   LOG().println(ok ? "Verify OK (all bytes match)" : "Verify FAIL");
   return ok;
@@ -667,6 +746,23 @@ static bool cmd_read_flash_first_8() {
   return true;
 }
 
+static bool cmd_tune_swd_clock() {
+  LOG().println("Tuning SWD clock (connect window + bulk); target SRAM is overwritten...");
+  stm32g0_prog::ClockTuneResult res;
+  if (!stm32g0_prog::tune_swd_clock(&res)) {
+    LOG().println("SWD clock tune FAIL (settings unchanged)");
+    return false;
+  }
+  g_swd_clock = res.config;
+  g_swd_clock_valid = true;
+  if (!ensure_fs_mounted() || !swd_clock_store::save(SPIFFS, res.config)) {
+    LOG().printf("SWD clock tune OK, but saving %s FAIL (active until reboot)\n", swd_clock_store::path());
+    return false;
+  }
+  LOG().printf("SWD clock saved to %s\n", swd_clock_store::path());
+  return true;
+}
+
 static bool cmd_toggle_verbose() {
   const bool enabled = !swd_min::verbose_enabled();
   swd_min::set_verbose(enabled);
@@ -746,6 +842,8 @@ void setup() {
     if (!serial_log::begin(SPIFFS)) {
       LOG().printf("Serial log init FAIL (%s)\n", serial_log::log_path());
     }
+    // Keep a few serials reserved ahead of production (core 0).
+    serial_log::start_pool_task();
     if (serial_log::has_serial_next()) {
       LOG().printf("Next serial (loaded): %lu\n", (unsigned long)serial_log::serial_next());
     } else {
@@ -771,6 +869,8 @@ void setup() {
       LOG().println("Firmware selection: NOT SELECTED (use WiFi UI; programming disabled)");
     }
 
+    g_swd_clock_valid = swd_clock_store::load(SPIFFS, &g_swd_clock);
+
     // Servomotor main firmware selection (SM*) for Mode 2 upgrade.
     String sm_fw_path;
     bool sm_auto_sel = false;
@@ -784,9 +884,16 @@ void setup() {
     } else {
       program_state::set_servomotor_firmware_filename("");
     }
+
+    // Model code, compatibility and CRC32 of every SM* file, so Mode 2 picks each DUT's image
+    // from its GET_PRODUCT_INFO.
+    (void)servomotor_upgrade::rebuild_catalog();
   }
 
-  swd_min::begin(PINS);
+  swd_begin();
+  const swd_min::ClockConfig clk = swd_min::clock_config();
+  LOG().printf("SWD clock: connect=%luus bulk=%luus half period (%s)\n", (unsigned long)clk.connect_half_period_us,
+              (unsigned long)clk.bulk_half_period_us, g_swd_clock_valid ? swd_clock_store::path() : "default; tune with 'k'");
 
   pinMode(k_prod_button_pin, INPUT_PULLUP);
 
@@ -800,7 +907,9 @@ void setup() {
   LOG().println();
 
   // Do one attempt automatically on boot.
+  program_state::acquire_swd(UINT32_MAX);
   print_idcode_attempt();
+  program_state::release_swd();
 
   print_mode1_banner();
 }
@@ -1002,7 +1111,9 @@ void loop() {
       // Falling edge (released->pressed): stable goes HIGH->LOW.
       if (!button_stable && button_armed) {
         button_armed = false;
+        program_state::acquire_swd(UINT32_MAX);
         run_production_sequence("GPIO45 button");
+        program_state::release_swd();
       }
 
       // Re-arm after release.
@@ -1036,6 +1147,9 @@ void loop() {
   tee_log::set_capture_enabled(capture);
   print_user_pressed_banner(c);
 
+  // Commands own SWD; a web UI dump in progress finishes first.
+  program_state::acquire_swd(UINT32_MAX);
+
   // Mode switching pins policy:
   // - Entering Mode 2: float SWD-related pins.
   // - Any other Mode 1 command: ensure SWD pins are restored before execution.
@@ -1151,6 +1265,10 @@ void loop() {
       cmd_toggle_verbose();
       break;
 
+    case 'k':
+      cmd_tune_swd_clock();
+      break;
+
     case 'b':
       cmd_dp_abort_write_test();
       break;
@@ -1183,14 +1301,33 @@ void loop() {
       cmd_verify();
       break;
 
+    case 'o':
+      cmd_read_option_bytes();
+      break;
+
+    case 'O':
+      if (!k_prod_option_bytes) {
+        LOG().println("No production option bytes configured (PROD_OPTION_BYTES_MASK is 0)");
+      } else if (stm32g0_prog::connect_and_halt_under_reset_recovery()) {
+        (void)cmd_program_option_bytes();
+      } else {
+        LOG().println("Option bytes: connect FAIL");
+      }
+      break;
+
     case 'a':
       cmd_print_wifi_ap_status();
       break;
 
+    case 'D':
+      LOG().println(target_dump::dump_to_files(/*unix_time=*/0) ? "Dump OK" : "Dump FAIL");
+      break;
+
     default:
       LOG().printf("Unknown command '%c' (0x%02X). Press 'h' for help.\n", c, (unsigned)c);
       break;
   }
+  program_state::release_swd();
 
   // Always restore capture.
   tee_log::set_capture_enabled(prev_capture);
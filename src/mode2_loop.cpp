@@ -10,9 +10,14 @@
 // For COMMUNICATION_ERROR_TIMEOUT
 #include <Communication.h>
 
+#include "link_monitor.h"
+#include "link_monitor_core.h"
 #include "tee_log.h"
 #include "unit_context.h"
 
+#include "servomotor_capture.h"
+#include "servomotor_sync_capture.h"
+#include "servomotor_trajectory.h"
 #include "servomotor_upgrade.h"
 
 static inline Print &LOG() { return tee_log::out(); }
@@ -44,6 +49,11 @@ static void print_help() {
   LOG().println("  i = get product info (RS485)");
   LOG().println("  l = LED test: turn GREEN+RED LEDs on solid (indefinite)");
   LOG().println("  u = upgrade firmware over RS485 (unique ID addressing)");
+  LOG().println("  b = read the multipurpose buffer into fwfs file /MPBUF (streamed)");
+  LOG().println("  S = time-aligned DUT vs reference position capture (500 x 5 ms) into fwfs file /SYNCCAP");
+  LOG().println("  T = endurance trajectory (100 back-and-forth cycles of 1 rot/s, streamed; any key aborts)");
+  LOG().println("  L = link statistics (host + device counters, DUT and reference; also on /api/link)");
+  LOG().println("  K = link statistics, then reset host + device counters");
 }
 
 static void print_mode2_banner() {
@@ -168,13 +178,14 @@ static void cmd_get_comprehensive_position_reference(Servomotor &ref_motor) {
 }
 
 static bool ensure_dut_unique_id_configured(Servomotor &motor) {
-  if (motor.isUsingExtendedAddressing()) {
+  // Follow the most recently programmed unit. A new unit's host-side link counters start over.
+  const unit_context::Context ctx = unit_context::get();
+  if (ctx.valid && ctx.unique_id != 0) {
+    (void)link_monitor_core::use_device(motor, ctx.unique_id);
     return true;
   }
 
-  const unit_context::Context ctx = unit_context::get();
-  if (ctx.valid && ctx.unique_id != 0) {
-    motor.useUniqueId(ctx.unique_id);
+  if (motor.isUsingExtendedAddressing()) {
     return true;
   }
 
@@ -182,6 +193,20 @@ static bool ensure_dut_unique_id_configured(Servomotor &motor) {
   return false;
 }
 
+static void cmd_link_statistics(Servomotor &motor, Servomotor &ref_motor, bool reset) {
+  if (ensure_dut_unique_id_configured(motor)) {
+    (void)link_monitor::report(motor, "dut", motor.usingThisUniqueId(), reset);
+  }
+  (void)link_monitor::report(ref_motor, "reference", 0, reset);
+}
+
+static void publish_link_statistics(Servomotor &motor, Servomotor &ref_motor) {
+  link_monitor::publish_host("dut", motor.isUsingExtendedAddressing() ? motor.usingThisUniqueId() : 0,
+                             motor.communication().statistics(), motor.communication().bytesPerSecond());
+  link_monitor::publish_host("reference", 0, ref_motor.communication().statistics(),
+                             ref_motor.communication().bytesPerSecond());
+}
+
 static bool cmd_detect_devices_and_print(Servomotor &broadcast_motor) {
   LOG().println("Servomotor DETECT_DEVICES (broadcast) ...");
 
@@ -441,10 +466,39 @@ void run() {
         }
       } break;
 
+      case 'b':
+        if (ensure_dut_unique_id_configured(motor)) {
+          (void)servomotor_capture::read_multipurpose_buffer_to_file(motor, "/MPBUF");
+        }
+        break;
+
+      case 'S':
+        if (ensure_dut_unique_id_configured(motor)) {
+          (void)servomotor_sync_capture::capture_to_file(motor, ref_motor, "/SYNCCAP", 500, 5000);
+        }
+        break;
+
+      case 'T':
+        if (ensure_dut_unique_id_configured(motor)) {
+          (void)servomotor_trajectory::run_endurance(motor, 100, 1.0f, 0.25f);
+        }
+        break;
+
+      case 'L':
+        cmd_link_statistics(motor, ref_motor, /*reset=*/false);
+        break;
+
+      case 'K':
+        cmd_link_statistics(motor, ref_motor, /*reset=*/true);
+        break;
+
       default:
         LOG().printf("Unknown command '%c'. Press 'h' for help.\n", c);
         break;
     }
+
+    // Keep /api/link current with the host-side counters after every command.
+    publish_link_statistics(motor, ref_motor);
   }
 }
 
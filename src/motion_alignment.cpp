@@ -0,0 +1,136 @@
+#include "motion_alignment.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace motion_alignment {
+
+uint32_t estimate_sample_time_us(uint32_t sent_us, uint32_t received_us, uint16_t request_bytes,
+                                 uint16_t response_bytes, uint32_t baud) {
+  if (baud == 0) return sent_us + (received_us - sent_us) / 2;
+  const uint32_t round_trip_us = received_us - sent_us;
+  const uint32_t request_us = (uint32_t)((uint64_t)request_bytes * 10u * 1000000u / baud);
+  const uint32_t response_us = (uint32_t)((uint64_t)response_bytes * 10u * 1000000u / baud);
+  if (request_us + response_us >= round_trip_us) {
+    // Host timing coarser than the wire time: the window is empty, take the request end.
+    return sent_us + (request_us < round_trip_us ? request_us : round_trip_us);
+  }
+  const uint32_t turnaround_us = round_trip_us - request_us - response_us;
+  return sent_us + request_us + turnaround_us / 2;
+}
+
+// Signed time of `t_us` relative to `origin_us`, valid across a micros() wrap.
+static inline double rel_us(uint32_t t_us, uint32_t origin_us) { return (double)(int32_t)(t_us - origin_us); }
+
+static inline int32_t saturate_i32(double v) {
+  if (v > 2147483647.0) return INT32_MAX;
+  if (v < -2147483648.0) return INT32_MIN;
+  return (int32_t)llround(v);
+}
+
+struct Stats {
+  size_t n = 0;
+  double sum = 0, sum_sq = 0, max_abs = 0;
+  void add(double v) {
+    n++;
+    sum += v;
+    sum_sq += v * v;
+    if (fabs(v) > max_abs) max_abs = fabs(v);
+  }
+  double mean() const { return n ? sum / (double)n : 0; }
+  double rms() const { return n ? sqrt(sum_sq / (double)n) : 0; }
+};
+
+size_t align(const Sample *dut, size_t n_dut, const Sample *ref, size_t n_ref, RecordSample *out, size_t out_cap,
+             RecordHeader *header, Summary *summary) {
+  Summary s;
+  memset(&s, 0, sizeof(s));
+  s.dut_samples = n_dut;
+  s.ref_samples = n_ref;
+  RecordHeader h;
+  memset(&h, 0, sizeof(h));
+  h.magic = k_record_magic;
+  h.version = k_record_version;
+  h.sample_size = sizeof(RecordSample);
+
+  if (n_dut >= 2) s.mean_period_us = rel_us(dut[n_dut - 1].t_us, dut[0].t_us) / (double)(n_dut - 1);
+
+  // Back-to-back readings paired directly.
+  const size_t n_pairs = n_dut < n_ref ? n_dut : n_ref;
+  Stats skew, paired;
+  for (size_t i = 0; i < n_pairs; i++) {
+    skew.add(rel_us(ref[i].t_us, dut[i].t_us));
+    paired.add((double)(dut[i].hall - dut[0].hall) - (double)(ref[i].hall - ref[0].hall));
+  }
+  s.mean_pair_skew_us = skew.mean();
+  s.paired_mean = paired.mean();
+  s.paired_rms = paired.rms();
+  s.paired_max_abs = paired.max_abs;
+
+  // Interpolate the reference at every DUT timestamp inside its span.
+  size_t written = 0;
+  size_t j = 0;
+  bool have_origin = false;
+  double ref_commanded0 = 0, ref_hall0 = 0;
+  Stats diff;
+  double sum_d = 0, sum_r = 0, sum_dd = 0, sum_rr = 0, sum_dr = 0;
+  for (size_t i = 0; n_ref >= 2 && i < n_dut; i++) {
+    const uint32_t t = dut[i].t_us;
+    if (rel_us(t, ref[0].t_us) < 0) continue;
+    while (j + 2 < n_ref && rel_us(ref[j + 1].t_us, t) < 0) j++;
+    const double span = rel_us(ref[j + 1].t_us, ref[j].t_us);
+    const double into = rel_us(t, ref[j].t_us);
+    if (into > span || span <= 0) continue;  // past the last reference reading
+    const double f = into / span;
+    const double ref_commanded = (double)ref[j].commanded + f * (double)(ref[j + 1].commanded - ref[j].commanded);
+    const double ref_hall = (double)ref[j].hall + f * (double)(ref[j + 1].hall - ref[j].hall);
+    if (span > s.max_ref_gap_us) s.max_ref_gap_us = span;
+
+    if (!have_origin) {
+      have_origin = true;
+      h.t0_us = t;
+      h.dut_commanded0 = dut[i].commanded;
+      h.dut_hall0 = dut[i].hall;
+      h.ref_commanded0 = (int64_t)llround(ref_commanded);
+      h.ref_hall0 = (int64_t)llround(ref_hall);
+      ref_commanded0 = (double)h.ref_commanded0;
+      ref_hall0 = (double)h.ref_hall0;
+    }
+    const double d = (double)(dut[i].hall - h.dut_hall0);
+    const double r = ref_hall - ref_hall0;
+    diff.add(d - r);
+    sum_d += d;
+    sum_r += r;
+    sum_dd += d * d;
+    sum_rr += r * r;
+    sum_dr += d * r;
+
+    if (out != nullptr && written < out_cap) {
+      RecordSample &o = out[written];
+      o.dt_us = t - h.t0_us;
+      o.dut_commanded = saturate_i32((double)(dut[i].commanded - h.dut_commanded0));
+      o.dut_hall = saturate_i32(d);
+      o.ref_commanded = saturate_i32(ref_commanded - ref_commanded0);
+      o.ref_hall = saturate_i32(r);
+      written++;
+    }
+  }
+
+  s.aligned = diff.n;
+  s.aligned_mean = diff.mean();
+  s.aligned_rms = diff.rms();
+  s.aligned_max_abs = diff.max_abs;
+  if (diff.n >= 2) {
+    const double n = (double)diff.n;
+    const double cov = sum_dr - sum_d * sum_r / n;
+    const double var_d = sum_dd - sum_d * sum_d / n;
+    const double var_r = sum_rr - sum_r * sum_r / n;
+    if (var_d > 0 && var_r > 0) s.correlation = cov / sqrt(var_d * var_r);
+  }
+  h.n_samples = (uint32_t)(out != nullptr ? written : 0);
+  if (header != nullptr) *header = h;
+  if (summary != nullptr) *summary = s;
+  return diff.n;
+}
+
+}  // namespace motion_alignment
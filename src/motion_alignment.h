@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace motion_alignment {
+
+// Time alignment of two position streams (DUT and reference motor) read one after the other over
+// RS485. Every reading carries a master-clock timestamp (ESP32 micros()); the reference stream is
+// linearly interpolated onto the DUT timestamps, so the request/response round trip between the two
+// readings of one sample no longer shows up as a position difference.
+//
+// Pure C++ (no Arduino); host-tested by testdata/test_motion_alignment.cpp.
+
+struct Sample {
+  uint32_t t_us;  // when the device latched the reading, master time
+  int64_t commanded;
+  int64_t hall;
+};
+
+// Best estimate of when the device took a reading, from the host-side times around the exchange:
+// `sent_us` just before the request was written, `received_us` once the response was in. The
+// device reads the position between the end of the request and the start of its response; both are
+// found from the frame sizes at `baud` (8N1), and the midpoint of that window is returned. The
+// error is then at most half the device's turnaround instead of a whole round trip.
+uint32_t estimate_sample_time_us(uint32_t sent_us, uint32_t received_us, uint16_t request_bytes,
+                                 uint16_t response_bytes, uint32_t baud);
+
+// Binary record written by the capture ("SYNC", little endian): one RecordHeader, then n_samples
+// RecordSamples. Positions are relative to the header's origins and saturate at the int32 range.
+static constexpr uint32_t k_record_magic = 0x434E5953;  // "SYNC"
+static constexpr uint16_t k_record_version = 1;
+
+struct __attribute__((packed)) RecordHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t sample_size;  // sizeof(RecordSample)
+  uint32_t n_samples;
+  uint32_t t0_us;        // master time of the first sample
+  int64_t dut_commanded0;
+  int64_t dut_hall0;
+  int64_t ref_commanded0;
+  int64_t ref_hall0;
+};
+
+struct __attribute__((packed)) RecordSample {
+  uint32_t dt_us;  // since t0_us
+  int32_t dut_commanded;
+  int32_t dut_hall;
+  int32_t ref_commanded;  // interpolated at dt_us
+  int32_t ref_hall;       // interpolated at dt_us
+};
+
+struct Summary {
+  size_t dut_samples;
+  size_t ref_samples;
+  size_t aligned;            // DUT samples inside the reference stream's time span
+  double mean_period_us;     // between DUT samples
+  double mean_pair_skew_us;  // reference reading minus DUT reading of the same sample
+  double max_ref_gap_us;     // largest interpolation interval used
+  // Hall position difference (DUT - reference), both relative to their first aligned sample
+  double aligned_mean;
+  double aligned_rms;
+  double aligned_max_abs;
+  // The same for the i-th readings paired directly, as if taken at the same time
+  double paired_mean;
+  double paired_rms;
+  double paired_max_abs;
+  double correlation;        // Pearson, DUT vs reference hall position (aligned)
+};
+
+// Aligns `ref` onto the timestamps of `dut` (both in time order). Writes up to `out_cap` aligned
+// samples to `out` (may be nullptr), fills `header` and `summary` (either may be nullptr) and
+// returns the number of aligned samples.
+size_t align(const Sample *dut, size_t n_dut, const Sample *ref, size_t n_ref, RecordSample *out, size_t out_cap,
+             RecordHeader *header, Summary *summary);
+
+}  // namespace motion_alignment
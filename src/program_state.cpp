@@ -11,6 +11,13 @@ static SemaphoreHandle_t mu() {
   return g_mu;
 }
 
+static SemaphoreHandle_t g_swd_mu = nullptr;
+
+static SemaphoreHandle_t swd_mu() {
+  if (!g_swd_mu) g_swd_mu = xSemaphoreCreateMutex();
+  return g_swd_mu;
+}
+
 void set_firmware_filename(const String &path) {
   xSemaphoreTake(mu(), portMAX_DELAY);
   g_fw = path;
@@ -37,4 +44,11 @@ String servomotor_firmware_filename() {
   return out;
 }
 
+bool acquire_swd(uint32_t timeout_ms) {
+  const TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  return xSemaphoreTake(swd_mu(), ticks) == pdTRUE;
+}
+
+void release_swd() { xSemaphoreGive(swd_mu()); }
+
 }  // namespace program_state
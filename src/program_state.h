@@ -12,4 +12,10 @@ String firmware_filename();
 void set_servomotor_firmware_filename(const String &path);
 String servomotor_firmware_filename();
 
+// SWD ownership. The console loop holds it while it runs a command (Mode 2 included) or the
+// production sequence; the web UI's target dump takes it for the length of the dump.
+// `timeout_ms` = UINT32_MAX waits forever. Returns false on timeout.
+bool acquire_swd(uint32_t timeout_ms);
+void release_swd();
+
 }  // namespace program_state
@@ -10,19 +10,42 @@ namespace serial_log {
 
 static constexpr const char *k_log_path = "/log.txt";
 static constexpr const char *k_consumed_records_path = "/serial_consumed.bin";
+static constexpr const char *k_unique_id_records_path = "/serial_unique_id.bin";
+static constexpr uint32_t k_unique_id_record_bytes = 12u;  // serial (u32 LE) + unique_id (u64 LE)
 
 static constexpr uint32_t k_unique_id_hex_len = 16u;
 
+// Serials reserved ahead of production (see start_pool_task()).
+#ifndef SERIAL_POOL_DEPTH
+#define SERIAL_POOL_DEPTH 4
+#endif
+static_assert(SERIAL_POOL_DEPTH >= 1, "SERIAL_POOL_DEPTH must be at least 1");
+
 // In-memory state guarded by a mutex.
 static SemaphoreHandle_t g_mu = nullptr;
 static bool g_has_next = false;
-static uint32_t g_next = 0;
+static uint32_t g_next = 0;          // next serial handed out
+static uint32_t g_reserve_next = 0;  // next serial appended to the consumed-records file
+static uint32_t g_generation = 0;    // bumped whenever the sequence is (re)set
 static fs::FS *g_fs = nullptr;
 
+// Held across a reservation (records append + state update), so records stay in serial
+// order between the pool task, the consume_for_write() fallback and USERSET.
+static SemaphoreHandle_t g_reserve_mu = nullptr;
+static serial_pool::SpscRing<SERIAL_POOL_DEPTH + 1> g_pool;
+static TaskHandle_t g_pool_task = nullptr;
+
+static void ensure_mutexes() {
+  if (!g_mu) g_mu = xSemaphoreCreateMutex();
+  if (!g_reserve_mu) g_reserve_mu = xSemaphoreCreateMutex();
+}
+
 const char *log_path() { return k_log_path; }
 
 const char *consumed_records_path() { return k_consumed_records_path; }
 
+const char *unique_id_records_path() { return k_unique_id_records_path; }
+
 static uint64_t gen_unique_id64() {
   // ESP32 HW RNG.
   const uint64_t hi = (uint64_t)esp_random();
@@ -59,7 +82,8 @@ uint32_t bytes_per_unit_estimate() {
   // Successful/failure log line format:
   //   <steps>_<serial>_<unique_id_hex16>_OK\n
   // Additionally, before programming we append one uint32_t to
-  // /serial_consumed.bin (4 bytes).
+  // /serial_consumed.bin (4 bytes) and one (serial, unique_id) record to
+  // /serial_unique_id.bin (12 bytes).
 
   // Representative (slightly pessimistic) example line.
   static constexpr const char *k_example_line = "iewvR_99999_0123456789ABCDEF_OK\n";
@@ -71,7 +95,7 @@ uint32_t bytes_per_unit_estimate() {
   // Small slack for SPIFFS allocation granularity / minor future expansion.
   static constexpr uint32_t k_overhead_bytes = 16u;
 
-  return log_line_bytes + k_consumed_record_bytes + k_overhead_bytes;
+  return log_line_bytes + k_consumed_record_bytes + k_unique_id_record_bytes + k_overhead_bytes;
 }
 
 static bool append_consumed_u32(uint32_t v) {
@@ -92,6 +116,44 @@ static bool append_consumed_u32(uint32_t v) {
   return w == sizeof(b);
 }
 
+static bool append_unique_id_record(uint32_t serial, uint64_t unique_id) {
+  if (!g_fs) return false;
+  File f = g_fs->open(k_unique_id_records_path, FILE_APPEND);
+  if (!f) return false;
+
+  uint8_t b[k_unique_id_record_bytes];
+  for (uint32_t i = 0; i < 4u; i++) b[i] = (uint8_t)(serial >> (8u * i));
+  for (uint32_t i = 0; i < 8u; i++) b[4u + i] = (uint8_t)(unique_id >> (8u * i));
+
+  const size_t w = f.write(b, sizeof(b));
+  f.flush();
+  f.close();
+  return w == sizeof(b);
+}
+
+// Newest unique_id recorded for `serial`, searching back at most `max_records` records.
+static bool find_unique_id(uint32_t serial, uint32_t max_records, uint64_t *out) {
+  if (!g_fs || !out || !g_fs->exists(k_unique_id_records_path)) return false;
+  File f = g_fs->open(k_unique_id_records_path, "r");
+  if (!f) return false;
+
+  const uint32_t count = (uint32_t)f.size() / k_unique_id_record_bytes;
+  bool found = false;
+  for (uint32_t back = 1; back <= count && back <= max_records && !found; back++) {
+    uint8_t b[k_unique_id_record_bytes];
+    if (!f.seek((count - back) * k_unique_id_record_bytes, SeekSet)) break;
+    if (f.read(b, sizeof(b)) != (int)sizeof(b)) break;
+    const uint32_t s = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    if (s != serial) continue;
+    uint64_t uid = 0;
+    for (uint32_t i = 0; i < 8u; i++) uid |= (uint64_t)b[4u + i] << (8u * i);
+    *out = uid;
+    found = true;
+  }
+  f.close();
+  return found;
+}
+
 static bool pad_consumed_records_to_u32_boundary_with_zeros() {
   if (!g_fs) return false;
   if (!g_fs->exists(k_consumed_records_path)) return true;
@@ -190,16 +252,46 @@ static SyncResult scan_file_for_last_serial() {
 }
 
 static void set_state(bool has, uint32_t next) {
-  if (!g_mu) g_mu = xSemaphoreCreateMutex();
+  ensure_mutexes();
   xSemaphoreTake(g_mu, portMAX_DELAY);
   g_has_next = has;
   g_next = next;
+  g_reserve_next = next;
+  g_generation++;  // anything still in the pool belongs to the old sequence
   xSemaphoreGive(g_mu);
 }
 
+// Logs RESERVED_<serial>_<unique_id_hex16> for every serial in [first, end): reserved in the
+// consumed-records file but without a summary line (pool entries, the unit in flight, or
+// manual 'w'/'s' consumes). The ID comes from the unique_id records; serials reserved before
+// those existed are logged as RESERVED_<serial>. An empty or inverted range (the log is
+// already past the last reservation) logs nothing.
+static bool append_reserved_lines(uint32_t first, uint32_t end) {
+  if (end <= first) return true;
+  const uint32_t lookback = (end - first) + (uint32_t)SERIAL_POOL_DEPTH + 2u;
+  for (uint32_t s = first; s != end; s++) {
+    char line[48];
+    uint64_t uid = 0;
+    int n;
+    if (find_unique_id(s, lookback, &uid)) {
+      n = snprintf(line, sizeof(line), "RESERVED_%lu_%08lX%08lX\n", (unsigned long)s, (unsigned long)(uid >> 32),
+                   (unsigned long)(uid & 0xFFFFFFFFu));
+    } else {
+      n = snprintf(line, sizeof(line), "RESERVED_%lu\n", (unsigned long)s);
+    }
+    if (n <= 0 || (size_t)n >= sizeof(line)) return false;
+    if (!append_line(line)) return false;
+  }
+  return true;
+}
+
+static void request_refill() {
+  if (g_pool_task) xTaskNotifyGive(g_pool_task);
+}
+
 bool begin(fs::FS &fs) {
   g_fs = &fs;
-  if (!g_mu) g_mu = xSemaphoreCreateMutex();
+  ensure_mutexes();
 
   // Default: invalid until derived.
   set_state(false, 0);
@@ -211,7 +303,17 @@ bool begin(fs::FS &fs) {
   // can safely continue production without serial reuse.
   const RecordsSyncResult r = sync_from_consumed_records();
 
-  return s.ok && r.ok;
+  // Serials reserved before the last reset (pool entries, the unit that was being
+  // programmed, manual consumes) have no summary line; put them in the audit trail before
+  // continuing.
+  bool reserved_ok = true;
+  if (s.ok && s.has_last && r.ok && r.sequence_ok) {
+    const uint32_t first = s.last_was_userset ? s.last_serial : (s.last_serial + 1u);
+    reserved_ok = append_reserved_lines(first, r.next);
+  }
+
+  request_refill();
+  return s.ok && r.ok && reserved_ok;
 }
 
 SyncResult sync_from_log() {
@@ -250,7 +352,18 @@ uint32_t serial_next() {
   return v;
 }
 
-bool user_set_serial_next(uint32_t next) {
+static bool user_set_serial_next_locked(uint32_t next) {
+  // 0) Serials the pool reserved under the old sequence are never handed out now
+  //    (bumping the generation makes their ring entries stale); log them.
+  xSemaphoreTake(g_mu, portMAX_DELAY);
+  const bool had = g_has_next;
+  const uint32_t unused_first = g_next;
+  const uint32_t unused_end = g_reserve_next;
+  g_next = g_reserve_next;
+  g_generation++;
+  xSemaphoreGive(g_mu);
+  if (had && !append_reserved_lines(unused_first, unused_end)) return false;
+
   // Append-only: do not rewrite.
   // 1) Invalidate the consumed-records sequence and seed it with the new value.
   //    This is used on reboot to allow resuming without serial reuse.
@@ -270,6 +383,15 @@ bool user_set_serial_next(uint32_t next) {
   return true;
 }
 
+bool user_set_serial_next(uint32_t next) {
+  ensure_mutexes();
+  xSemaphoreTake(g_reserve_mu, portMAX_DELAY);
+  const bool ok = user_set_serial_next_locked(next);
+  xSemaphoreGive(g_reserve_mu);
+  request_refill();
+  return ok;
+}
+
 RecordsSyncResult sync_from_consumed_records() {
   RecordsSyncResult res;
   if (!g_fs) return res;
@@ -370,24 +492,93 @@ RecordsSyncResult sync_from_consumed_records() {
   return res;
 }
 
-Consumed consume_for_write() {
-  Consumed out;
-  if (!g_mu) return out;
-
+// Draws a unique_id for the next serial, records the pair, then appends the serial to the
+// consumed-records file, and fills `e` (with the tag). Caller holds g_reserve_mu.
+static bool reserve_one(serial_pool::Entry *e) {
   xSemaphoreTake(g_mu, portMAX_DELAY);
   const bool has = g_has_next;
-  const uint32_t next = g_next;
+  const uint32_t serial = g_reserve_next;
+  const uint32_t generation = g_generation;
+  xSemaphoreGive(g_mu);
+  if (!has) return false;
+
+  // Both must persist (append-only) before the serial can be handed out. The ID goes first:
+  // a reset in between leaves an ID record for a serial that is reserved again later (the
+  // newest record wins), never a reserved serial without its ID.
+  const uint64_t unique_id = gen_unique_id64();
+  if (!append_unique_id_record(serial, unique_id)) return false;
+  if (!append_consumed_u32(serial)) return false;
+
+  xSemaphoreTake(g_mu, portMAX_DELAY);
+  g_reserve_next = serial + 1u;
   xSemaphoreGive(g_mu);
-  if (!has) return out;
 
-  // Must persist (append-only) before the caller begins programming the target.
-  if (!append_consumed_u32(next)) return out;
+  e->serial = serial;
+  e->unique_id = unique_id;
+  e->generation = generation;
+  serial_pool::format_tag(*e);
+  return true;
+}
+
+// Hands `e` out if it belongs to the current sequence.
+static bool accept(const serial_pool::Entry &e) {
+  xSemaphoreTake(g_mu, portMAX_DELAY);
+  const bool ok = g_has_next && e.generation == g_generation;
+  if (ok) g_next = e.serial + 1u;
+  xSemaphoreGive(g_mu);
+  return ok;
+}
+
+// Pops until a current entry comes out. Stale ones were logged by user_set_serial_next().
+static bool take_from_pool(serial_pool::Entry *e) {
+  while (g_pool.pop(e)) {
+    if (accept(*e)) return true;
+  }
+  return false;
+}
+
+static void pool_task(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (g_pool.size() < g_pool.capacity()) {
+      serial_pool::Entry e;
+      xSemaphoreTake(g_reserve_mu, portMAX_DELAY);
+      const bool ok = reserve_one(&e) && g_pool.push(e);
+      xSemaphoreGive(g_reserve_mu);
+      if (!ok) break;  // serial not set, or the filesystem refused the append
+    }
+  }
+}
+
+void start_pool_task() {
+  if (g_pool_task || !g_fs) return;
+  ensure_mutexes();
+  // Core 0, next to the web UI: reservations hit SPIFFS, production runs on core 1.
+  xTaskCreatePinnedToCore(pool_task, "serial_pool", 4096, nullptr, 1, &g_pool_task, 0);
+  request_refill();
+}
+
+size_t pool_size() { return g_pool.size(); }
 
-  set_state(true, next + 1u);
+Consumed consume_for_write() {
+  Consumed out;
+  if (!g_mu) return out;
+
+  serial_pool::Entry e;
+  if (!take_from_pool(&e)) {
+    // Pool empty (task not started, still refilling, or just after a USERSET): reserve
+    // here, behind any reservation the pool task has in flight so serials stay in order.
+    xSemaphoreTake(g_reserve_mu, portMAX_DELAY);
+    const bool ok = take_from_pool(&e) || (reserve_one(&e) && accept(e));
+    xSemaphoreGive(g_reserve_mu);
+    if (!ok) return out;
+  }
 
   out.valid = true;
-  out.serial = next;
-  out.unique_id = gen_unique_id64();
+  out.serial = e.serial;
+  out.unique_id = e.unique_id;
+  out.tag_len = e.tag_len;
+  memcpy(out.tag, e.tag, sizeof(out.tag));
   return out;
 }
 
@@ -396,7 +587,9 @@ bool append_summary(const char *steps, uint32_t serial, bool ok) {
   char line[80];
   const int n = snprintf(line, sizeof(line), "%s_%lu_%s\n", steps, (unsigned long)serial, ok ? "OK" : "FAIL");
   if (n <= 0 || (size_t)n >= sizeof(line)) return false;
-  return append_line(line);
+  const bool written = append_line(line);
+  request_refill();  // the unit is done; top the pool up before the next one
+  return written;
 }
 
 bool append_summary_with_unique_id(const char *steps, uint32_t serial, uint64_t unique_id, bool ok) {
@@ -412,7 +605,27 @@ bool append_summary_with_unique_id(const char *steps, uint32_t serial, uint64_t
   const int n = snprintf(line, sizeof(line), "%s_%lu_%08lX%08lX_%s\n", steps, (unsigned long)serial, (unsigned long)hi,
                          (unsigned long)lo, ok ? "OK" : "FAIL");
   if (n <= 0 || (size_t)n >= sizeof(line)) return false;
-  return append_line(line);
+  const bool written = append_line(line);
+  request_refill();  // the unit is done; top the pool up before the next one
+  return written;
+}
+
+bool append_summary_with_unique_id(const char *steps, const Consumed &consumed, bool ok) {
+  if (!steps) return false;
+  if (consumed.tag_len == 0) return append_summary_with_unique_id(steps, consumed.serial, consumed.unique_id, ok);
+
+  // <steps><tag><OK|FAIL>\n, same text as above without formatting.
+  const char *result = ok ? "OK\n" : "FAIL\n";
+  const size_t ns = strlen(steps);
+  const size_t nr = strlen(result);
+  char line[96];
+  if (ns + consumed.tag_len + nr >= sizeof(line)) return false;
+  memcpy(line, steps, ns);
+  memcpy(line + ns, consumed.tag, consumed.tag_len);
+  memcpy(line + ns + consumed.tag_len, result, nr + 1u);
+  const bool written = append_line(line);
+  request_refill();  // the unit is done; top the pool up before the next one
+  return written;
 }
 
 }  // namespace serial_log
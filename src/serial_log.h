@@ -4,6 +4,8 @@
 
 #include <FS.h>
 
+#include "serial_pool.h"
+
 namespace serial_log {
 
 // Append-only log in SPIFFS.
@@ -37,7 +39,8 @@ SyncResult sync_from_log();
 bool has_serial_next();
 uint32_t serial_next();
 
-// Append USERSET_<serial> and update in-memory serial_next.
+// Append USERSET_<serial> and update in-memory serial_next. Serials the pool had
+// reserved under the old sequence are logged as RESERVED_<serial>_<uid16> first.
 bool user_set_serial_next(uint32_t next);
 
 // Append an event line to /log.txt in the form:
@@ -55,6 +58,11 @@ bool append_event(const char *tag, const char *value);
 // (followed by the new user-set next serial).
 const char *consumed_records_path();
 
+// Unique-ID record file (append-only) in SPIFFS: one (serial, unique_id) pair,
+// little-endian uint32_t + uint64_t, per reserved serial, written just before
+// the serial goes into the consumed-records file.
+const char *unique_id_records_path();
+
 struct RecordsSyncResult {
   bool ok = false;
 
@@ -85,6 +93,9 @@ RecordsSyncResult sync_from_consumed_records();
     bool valid = false;
     uint32_t serial = 0;
     uint64_t unique_id = 0;
+    // "_<serial>_<unique_id_hex16>_", formatted when the serial was reserved.
+    uint8_t tag_len = 0;
+    char tag[serial_pool::k_tag_max + 1] = {};
   };
 
 // Conservative estimate of how many bytes of SPIFFS storage are required per
@@ -98,13 +109,36 @@ uint32_t bytes_per_unit_estimate();
 //
 // Contract:
 // - Requires that serial_next is valid.
-// - Appends the consumed serial to the binary consumed-records file (and closes
-//   it) BEFORE the caller begins writing firmware to the target.
+// - The consumed serial is in the binary consumed-records file (appended and
+//   closed) BEFORE the caller begins writing firmware to the target.
 // - Advances in-memory serial_next to serial+1.
 // - Does NOT append any intermediate marker to /log.txt; production log should
 //   contain only the final summary line per unit.
+//
+// Normally the serial comes from the reservation pool (see start_pool_task()),
+// so this is a ring pop with no filesystem access or RNG. With the pool empty it
+// reserves one itself, as before.
 Consumed consume_for_write();
 
+// Reservation pool.
+//
+// A task on core 0 keeps up to SERIAL_POOL_DEPTH serials reserved ahead of
+// production: each is appended to the consumed-records file first, then gets its
+// unique_id and summary tag and goes into a lock-free ring that
+// consume_for_write() pops. The pool is refilled after each summary line (i.e.
+// between units, not while the next one is being programmed), after a USERSET
+// and at start.
+//
+// Crash safety: a serial and its unique_id are persisted (unique-ID records,
+// then consumed records) before they can be handed out, so a reset never reuses
+// one; the next boot continues after the last reservation. Reserved serials that
+// never got a summary line are logged as RESERVED_<serial>_<unique_id_hex16> --
+// by begin() after a reset (all of them, including manual 'w'/'s' consumes), and
+// by user_set_serial_next() for the pool it discards. begin() returns false if
+// it could not log them.
+void start_pool_task();
+size_t pool_size();
+
   // Append summary line with attempted step letters.
   // - For success: <steps>_<serial>_<unique_id_hex16>_OK
   // - For failure: <steps>_<serial>_<unique_id_hex16>_FAIL
@@ -112,6 +146,8 @@ Consumed consume_for_write();
   // Example:
   //   iewvR_1003_0123456789ABCDEF_OK
   bool append_summary_with_unique_id(const char *steps, uint32_t serial, uint64_t unique_id, bool ok);
+  // Same line from a consume_for_write() result, using its preformatted tag.
+  bool append_summary_with_unique_id(const char *steps, const Consumed &consumed, bool ok);
 
   // Legacy format (kept for compatibility with older logs/tools):
   // - For success: <steps>_<serial>_OK
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Pre-reserved (serial, unique_id) entries for production, and the single-producer /
+// single-consumer ring serial_log hands them out of. Header-only and free of Arduino
+// dependencies so the ring and the formatting are host-tested (testdata/test_serial_pool.cpp).
+
+namespace serial_pool {
+
+// "_<serial>_<unique_id as 16 upper-case hex>_": the part of a summary line between the step
+// letters and OK/FAIL (see serial_log::append_summary_with_unique_id()).
+static constexpr size_t k_tag_max = 1 + 10 + 1 + 16 + 1;
+
+struct Entry {
+  uint32_t serial = 0;
+  uint64_t unique_id = 0;
+  uint32_t generation = 0;  // serial_log bumps it on USERSET; older entries are stale
+  uint8_t tag_len = 0;
+  char tag[k_tag_max + 1] = {};
+};
+
+// Formats `e.tag` from e.serial and e.unique_id (no snprintf; same text as the summary line).
+inline void format_tag(Entry &e) {
+  char digits[10];
+  size_t nd = 0;
+  uint32_t s = e.serial;
+  do {
+    digits[nd++] = (char)('0' + (s % 10u));
+    s /= 10u;
+  } while (s != 0u);
+
+  static const char k_hex[] = "0123456789ABCDEF";
+  size_t n = 0;
+  e.tag[n++] = '_';
+  while (nd > 0) e.tag[n++] = digits[--nd];
+  e.tag[n++] = '_';
+  for (int shift = 60; shift >= 0; shift -= 4) e.tag[n++] = k_hex[(e.unique_id >> shift) & 0xFu];
+  e.tag[n++] = '_';
+  e.tag[n] = '\0';
+  e.tag_len = (uint8_t)n;
+}
+
+// Lock-free ring for one producer task and one consumer task. Holds up to N - 1 entries.
+// push() only from the producer, pop() only from the consumer; size() from either.
+template <size_t N>
+class SpscRing {
+  static_assert(N >= 2, "SpscRing needs at least two slots");
+
+ public:
+  bool push(const Entry &e) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t next = (head + 1u) % N;
+    if (next == tail_.load(std::memory_order_acquire)) return false;  // full
+    slots_[head] = e;
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(Entry *out) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;  // empty
+    *out = slots_[tail];
+    tail_.store((tail + 1u) % N, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return (head + N - tail) % N;
+  }
+
+  static constexpr size_t capacity() { return N - 1u; }
+
+ private:
+  Entry slots_[N];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+}  // namespace serial_pool
@@ -0,0 +1,82 @@
+#include "servomotor_capture.h"
+
+#include <SPIFFS.h>
+
+// Servomotor Arduino library (vendored into lib/Servomotor)
+#include <Servomotor.h>
+
+// For ResponseChunkHandler and the COMMUNICATION_ERROR_* codes.
+#include <Communication.h>
+
+#include "tee_log.h"
+
+// Route all prints in this file into the RAM terminal buffer as well.
+#define Serial tee_log::out()
+
+namespace servomotor_capture {
+
+struct FileSink {
+  File *file;
+  uint32_t written;
+};
+
+static bool write_chunk_to_file(void *context, const uint8_t *data, uint16_t size) {
+  FileSink *sink = static_cast<FileSink *>(context);
+  if (sink->file->write(data, size) != size) return false;  // filesystem full: stop the stream
+  sink->written += size;
+  return true;
+}
+
+// Opens `path`, runs `stream` with a file sink and keeps the file only if the response was good.
+template <typename StreamFn>
+static bool stream_to_file(const char *what, const char *path, uint32_t *out_bytes, StreamFn stream) {
+  if (out_bytes) *out_bytes = 0;
+  if (!path || path[0] != '/') {
+    Serial.printf("ERROR: %s: invalid path\n", what);
+    return false;
+  }
+  File f = SPIFFS.open(path, "w");
+  if (!f) {
+    Serial.printf("ERROR: %s: cannot open %s for writing\n", what, path);
+    return false;
+  }
+  FileSink sink = {&f, 0};
+  uint32_t received = 0;
+  const int err = stream(&write_chunk_to_file, &sink, &received);
+  f.close();
+  if (err != 0) {
+    SPIFFS.remove(path);
+    if (err == COMMUNICATION_ERROR_STREAM_ABORTED) {
+      Serial.printf("ERROR: %s: %s full after %lu of %lu bytes\n", what, path, (unsigned long)sink.written,
+                    (unsigned long)received);
+    } else if (err == COMMUNICATION_ERROR_TIMEOUT) {
+      Serial.printf("ERROR: %s timed out after %lu bytes\n", what, (unsigned long)sink.written);
+    } else {
+      Serial.printf("ERROR: %s failed errno=%d\n", what, err);
+    }
+    return false;
+  }
+  if (out_bytes) *out_bytes = sink.written;
+  Serial.printf("%s: %lu bytes -> %s (CRC32 OK)\n", what, (unsigned long)sink.written, path);
+  return true;
+}
+
+bool read_multipurpose_buffer_to_file(Servomotor &motor, const char *path, uint32_t *out_bytes) {
+  return stream_to_file("readMultipurposeBuffer", path, out_bytes,
+                        [&](ResponseChunkHandler on_chunk, void *context, uint32_t *received) {
+                          return motor.readMultipurposeBufferStream(on_chunk, context, received);
+                        });
+}
+
+bool capture_hall_sensor_data_to_file(Servomotor &motor, const char *path, uint8_t capture_type, uint32_t n_points,
+                                      uint8_t channels_bitmask, uint16_t time_steps_per_sample,
+                                      uint16_t n_samples_to_sum, uint16_t division_factor, uint32_t *out_bytes) {
+  return stream_to_file("captureHallSensorData", path, out_bytes,
+                        [&](ResponseChunkHandler on_chunk, void *context, uint32_t *received) {
+                          return motor.captureHallSensorDataStream(capture_type, n_points, channels_bitmask,
+                                                                   time_steps_per_sample, n_samples_to_sum,
+                                                                   division_factor, on_chunk, context, received);
+                        });
+}
+
+}  // namespace servomotor_capture
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Forward declaration to avoid pulling in the whole Arduino library header from users.
+class Servomotor;
+
+namespace servomotor_capture {
+
+// Stream large Servomotor responses (hall sensor captures, the multipurpose buffer) straight into a
+// file on the ESP32 fwfs filesystem (SPIFFS). Payload chunks are written as they come off the
+// UART (Communication::getResponseStream()); nothing holds the whole response in RAM.
+//
+// The file is only kept if the response CRC32 checks out; on any error it is removed.
+// `out_bytes` (optional) receives the payload size. Returns true on success.
+
+// READ_MULTIPURPOSE_BUFFER (data left by calibration, go-to-closed-loop or a hall capture).
+bool read_multipurpose_buffer_to_file(Servomotor &motor, const char *path, uint32_t *out_bytes = nullptr);
+
+// CAPTURE_HALL_SENSOR_DATA with the given capture parameters.
+bool capture_hall_sensor_data_to_file(Servomotor &motor, const char *path, uint8_t capture_type, uint32_t n_points,
+                                      uint8_t channels_bitmask, uint16_t time_steps_per_sample,
+                                      uint16_t n_samples_to_sum, uint16_t division_factor,
+                                      uint32_t *out_bytes = nullptr);
+
+}  // namespace servomotor_capture
@@ -0,0 +1,131 @@
+#include "servomotor_sync_capture.h"
+
+#include <SPIFFS.h>
+
+#include <vector>
+
+// Servomotor Arduino library (vendored into lib/Servomotor)
+#include <Servomotor.h>
+
+#include "motion_alignment.h"
+#include "tee_log.h"
+
+// Route all prints in this file into the RAM terminal buffer as well.
+#define Serial tee_log::out()
+
+namespace servomotor_sync_capture {
+
+// Must match the baud the Mode 2 Servomotor objects are constructed with (library default).
+static constexpr uint32_t k_baud = 230400;
+static constexpr uint16_t k_max_samples = 2000;
+
+static uint16_t request_frame_bytes(const Servomotor &motor) {
+  return (uint16_t)(1 + (motor.isUsingExtendedAddressing() ? 9 : 1) + 1 + (motor.isCRC32Enabled() ? 4 : 0));
+}
+
+static uint16_t response_frame_bytes(const Servomotor &motor) {
+  return (uint16_t)(1 + 1 + 1 + sizeof(getComprehensivePositionResponse) + (motor.isCRC32Enabled() ? 4 : 0));
+}
+
+// One timestamped GET_COMPREHENSIVE_POSITION; returns the error.
+static int read_sample(Servomotor &motor, motion_alignment::Sample *out) {
+  getComprehensivePositionResponse r;
+  const uint32_t sent = micros();
+  const int err = motor.execute<GET_COMPREHENSIVE_POSITION>(nullptr, &r);
+  const uint32_t received = micros();
+  if (err != 0) return err;
+  out->t_us = motion_alignment::estimate_sample_time_us(sent, received, request_frame_bytes(motor),
+                                                        response_frame_bytes(motor), k_baud);
+  out->commanded = r.commandedPosition;
+  out->hall = r.hallSensorPosition;
+  return 0;
+}
+
+static bool write_record(const char *path, const motion_alignment::RecordHeader &header,
+                         const std::vector<motion_alignment::RecordSample> &samples) {
+  File f = SPIFFS.open(path, "w");
+  if (!f) {
+    Serial.printf("ERROR: syncCapture: cannot open %s for writing\n", path);
+    return false;
+  }
+  const size_t body = header.n_samples * sizeof(motion_alignment::RecordSample);
+  const bool ok = f.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                  f.write((const uint8_t *)samples.data(), body) == body;
+  f.close();
+  if (!ok) {
+    SPIFFS.remove(path);
+    Serial.printf("ERROR: syncCapture: %s full\n", path);
+  }
+  return ok;
+}
+
+bool capture_to_file(Servomotor &dut, Servomotor &ref, const char *path, uint16_t n_samples, uint32_t period_us) {
+  if (!path || path[0] != '/' || n_samples < 2 || n_samples > k_max_samples) {
+    Serial.println("ERROR: syncCapture: invalid parameters");
+    return false;
+  }
+  std::vector<motion_alignment::Sample> dut_samples;
+  std::vector<motion_alignment::Sample> ref_samples;
+  dut_samples.reserve(n_samples);
+  ref_samples.reserve(n_samples);
+
+  Serial.printf("syncCapture: %u samples every %lu us (DUT then reference)\n", (unsigned)n_samples,
+                (unsigned long)period_us);
+  uint32_t dut_errors = 0;
+  uint32_t ref_errors = 0;
+  int last_err = 0;
+  uint32_t next_us = micros();
+  for (uint16_t i = 0; i < n_samples; i++) {
+    while ((int32_t)(micros() - next_us) < 0) {
+    }
+    next_us += period_us;
+    motion_alignment::Sample s;
+    int err = read_sample(dut, &s);
+    if (err == 0) {
+      dut_samples.push_back(s);
+    } else {
+      dut_errors++;
+      last_err = err;
+    }
+    err = read_sample(ref, &s);
+    if (err == 0) {
+      ref_samples.push_back(s);
+    } else {
+      ref_errors++;
+      last_err = err;
+    }
+  }
+  if (dut_errors || ref_errors) {
+    Serial.printf("syncCapture: %lu DUT / %lu reference reads failed (last errno=%d)\n", (unsigned long)dut_errors,
+                  (unsigned long)ref_errors, last_err);
+  }
+
+  std::vector<motion_alignment::RecordSample> aligned(dut_samples.size());
+  motion_alignment::RecordHeader header;
+  motion_alignment::Summary s;
+  const size_t n = motion_alignment::align(dut_samples.data(), dut_samples.size(), ref_samples.data(),
+                                           ref_samples.size(), aligned.data(), aligned.size(), &header, &s);
+  Serial.println("syncCapture summary:");
+  Serial.printf("  samples: DUT %u, reference %u, aligned %u\n", (unsigned)s.dut_samples, (unsigned)s.ref_samples,
+                (unsigned)s.aligned);
+  Serial.printf("  period: %.1f us (requested %lu us)\n", s.mean_period_us, (unsigned long)period_us);
+  Serial.printf("  reference read after DUT by %.1f us on average, largest interpolation gap %.1f us\n",
+                s.mean_pair_skew_us, s.max_ref_gap_us);
+  Serial.printf("  hall DUT - reference, aligned: mean %.1f rms %.1f max %.1f counts\n", s.aligned_mean, s.aligned_rms,
+                s.aligned_max_abs);
+  Serial.printf("  hall DUT - reference, paired:  mean %.1f rms %.1f max %.1f counts\n", s.paired_mean, s.paired_rms,
+                s.paired_max_abs);
+  Serial.printf("  correlation: %.6f\n", s.correlation);
+  if (n < 2) {
+    Serial.println("ERROR: syncCapture: not enough aligned samples");
+    return false;
+  }
+  if (!write_record(path, header, aligned)) {
+    return false;
+  }
+  Serial.printf("syncCapture: %u samples -> %s (%u bytes)\n", (unsigned)header.n_samples, path,
+                (unsigned)(sizeof(header) + header.n_samples * sizeof(motion_alignment::RecordSample)));
+  return true;
+}
+
+}  // namespace servomotor_sync_capture
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Forward declaration to avoid pulling in the whole Arduino library header from users.
+class Servomotor;
+
+namespace servomotor_sync_capture {
+
+// Time-aligned DUT vs reference position capture.
+//
+// Reads GET_COMPREHENSIVE_POSITION from `dut` and `ref` every `period_us`, one after the other.
+// Each reading is timestamped on the ESP32 clock with the estimated instant the device took it
+// (motion_alignment::estimate_sample_time_us()). Afterwards the reference stream is interpolated
+// onto the DUT timestamps (motion_alignment::align()).
+//
+// No TIME_SYNC is sent: the position response carries no device timestamp, so the devices' clocks
+// would play no part in the alignment. Every time comes from the master side.
+//
+// The aligned samples go to `path` on fwfs (SPIFFS) as a motion_alignment "SYNC" record; a summary
+// (achieved period, DUT/reference skew, DUT - reference hall difference aligned vs directly
+// paired, correlation) is printed.
+//
+// Returns true if the record was written.
+bool capture_to_file(Servomotor &dut, Servomotor &ref, const char *path, uint16_t n_samples, uint32_t period_us);
+
+}  // namespace servomotor_sync_capture
@@ -0,0 +1,90 @@
+#include "servomotor_trajectory.h"
+
+// Servomotor Arduino library (vendored into lib/Servomotor)
+#include <Servomotor.h>
+#include <TrajectoryStreamer.h>
+
+#include "tee_log.h"
+
+// Prints go to the RAM terminal buffer as well; Serial itself is read to catch an abort key.
+static inline Print &LOG() { return tee_log::out(); }
+
+namespace servomotor_trajectory {
+
+struct EnduranceCycles {
+  uint32_t cycles;
+  int32_t acceleration;  // internal units
+  uint32_t leg_time_steps;
+};
+
+// Move 4k+0 .. 4k+3 of cycle k: +a, -a, -a, +a.
+static bool endurance_move(void *context, uint32_t index, TrajectoryMove *move) {
+  const EnduranceCycles *e = static_cast<const EnduranceCycles *>(context);
+  if (index / 4 >= e->cycles) return false;
+  const uint32_t leg = index % 4;
+  move->isVelocity = false;
+  move->value = (leg == 0 || leg == 3) ? e->acceleration : -e->acceleration;
+  move->timeSteps = e->leg_time_steps;
+  return true;
+}
+
+static void print_stats(const TrajectoryStreamer &streamer, unsigned long elapsed_ms) {
+  const TrajectoryStats &s = streamer.stats();
+  LOG().printf("Trajectory: %lu moves in %lu MULTIMOVE frames, %lu ms\n", (unsigned long)s.movesSent,
+               (unsigned long)s.framesSent, elapsed_ms);
+  if (s.depthSamples != 0) {
+    LOG().printf("  queue depth: min %u, mean %.1f, max %u (of %u) over %lu polls\n", (unsigned)s.minQueueDepth,
+                 (double)s.queueDepthSum / (double)s.depthSamples, (unsigned)s.maxQueueDepth,
+                 (unsigned)TRAJECTORY_MOTOR_QUEUE_SIZE, (unsigned long)s.depthSamples);
+  }
+  LOG().printf("  underruns: %lu\n", (unsigned long)s.underruns);
+  LOG().printf("  time syncs: %lu, max |timeError| %ld\n", (unsigned long)s.timeSyncs, (long)s.maxAbsTimeError);
+}
+
+bool run_endurance(Servomotor &motor, uint32_t cycles, float max_rps, float leg_seconds) {
+  if (cycles == 0 || leg_seconds <= 0.0f) {
+    LOG().println("ERROR: trajectory: invalid parameters");
+    return false;
+  }
+  EnduranceCycles e;
+  e.cycles = cycles;
+  e.acceleration = (int32_t)Units::RotationsPerSecondSquared::toInternal(max_rps / leg_seconds);
+  e.leg_time_steps = (uint32_t)Units::Seconds::toInternal(leg_seconds);
+
+  LOG().printf("Trajectory: %lu cycles of +/-%.2f rot/s, %.3f s legs (%lu moves); any key aborts\n",
+               (unsigned long)cycles, (double)max_rps, (double)leg_seconds, (unsigned long)(cycles * 4));
+
+  TrajectoryStreamer streamer(motor);
+  streamer.setSource(&endurance_move, &e);
+  const unsigned long start = millis();
+  if (!streamer.begin()) {
+    LOG().printf("ERROR: trajectory: TIME_SYNC failed errno=%d\n", streamer.stats().lastError);
+    return false;
+  }
+  bool aborted = false;
+  while (streamer.service()) {
+    if (Serial.available()) {
+      while (Serial.available()) (void)Serial.read();
+      motor.emergencyStop();
+      aborted = true;
+      break;
+    }
+    delay(1);
+  }
+  print_stats(streamer, millis() - start);
+
+  if (aborted) {
+    LOG().println("Trajectory ABORTED (emergency stop sent)");
+    return false;
+  }
+  if (streamer.state() == TRAJECTORY_FAILED) {
+    LOG().printf("ERROR: trajectory stopped, errno=%d\n", streamer.stats().lastError);
+    LOG().println("Trajectory FAIL");
+    return false;
+  }
+  const bool ok = streamer.stats().underruns == 0;
+  LOG().println(ok ? "Trajectory OK" : "Trajectory FAIL (queue underrun)");
+  return ok;
+}
+
+}  // namespace servomotor_trajectory
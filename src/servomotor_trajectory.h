@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Forward declaration to avoid pulling in the whole Arduino library header from users.
+class Servomotor;
+
+namespace servomotor_trajectory {
+
+// Endurance test: stream `cycles` back-and-forth velocity cycles to the motor with the library's
+// TrajectoryStreamer (MULTIMOVE chunks, GET_N_QUEUED_ITEMS flow control, TIME_SYNC). Each cycle is
+// four constant-acceleration legs of `leg_seconds`: 0 -> +max_rps -> 0 -> -max_rps -> 0, so the
+// motor ends every cycle at standstill where it started.
+//
+// The MOSFETs must already be enabled. Any byte on the console aborts with an emergency stop.
+// Prints the achieved queue depth, underruns and time sync error at the end. Returns true if the
+// whole trajectory ran without errors or underruns.
+bool run_endurance(Servomotor &motor, uint32_t cycles, float max_rps, float leg_seconds);
+
+}  // namespace servomotor_trajectory
@@ -1,17 +1,16 @@
 #include "servomotor_upgrade.h"
 
 #include <SPIFFS.h>
+#include <string.h>
 
 #include <vector>
 
 // Servomotor Arduino library (vendored into lib/Servomotor)
 #include <Servomotor.h>
 
-// For COMMUNICATION_ERROR_TIMEOUT and calculate_crc32().
-#include <Communication.h>
-
 #include "firmware_fs.h"
 #include "program_state.h"
+#include "servomotor_upgrade_core.h"
 #include "tee_log.h"
 
 // Route all prints in this file into the RAM terminal buffer as well.
@@ -19,22 +18,6 @@
 
 namespace servomotor_upgrade {
 
-static constexpr size_t k_flash_page_size = 2048;
-static constexpr size_t k_model_code_len = 8;
-static constexpr uint8_t k_first_firmware_page_number = 5;
-static constexpr uint8_t k_last_firmware_page_number = 30;
-
-// Match the known-good host upgrader timing in
-// [`upgrade_firmware.py`](../../Servomotor/python_programs/upgrade_firmware.py:68).
-// WAIT_FOR_RESET_TIME = 0.07 seconds (70ms).
-static constexpr uint32_t k_wait_after_pre_reset_ms = 70;
-
-// Local jig behavior: after the last page is sent+ACKed, wait a bit before the
-// post-reset, then after the post-reset wait long enough for the bootloader to
-// time out and run the application.
-static constexpr uint32_t k_wait_before_post_reset_ms = 100;
-static constexpr uint32_t k_wait_after_post_reset_ms = 1000;
-
 static bool read_all(File &f, uint8_t *dst, size_t n) {
   if (!dst && n) return false;
   size_t got = 0;
@@ -46,200 +29,191 @@ static bool read_all(File &f, uint8_t *dst, size_t n) {
   return true;
 }
 
-static bool select_sm_firmware_path(String &out_path) {
-  out_path = "";
+static SemaphoreHandle_t g_mu = nullptr;
+static servomotor_upgrade_core::Catalog g_catalog;
+static bool g_catalog_built = false;
 
-  // Prefer the cached selection (usually set by the web UI).
-  const String cached = program_state::servomotor_firmware_filename();
-  if (cached.length() > 0) {
-    out_path = cached;
-    return true;
-  }
-
-  // Fall back to persisted active selection (and auto-select if exactly one SM* exists).
-  bool auto_sel = false;
-  if (!firmware_fs::reconcile_active_servomotor_selection_ex(&out_path, &auto_sel)) {
-    Serial.println("ERROR: servomotor firmware not selected (use WiFi UI)");
-    return false;
-  }
+// Last image sent (Mode 2 only): reused for the next unit while its file is unchanged.
+static servomotor_upgrade_core::Image g_image;
+static servomotor_upgrade_core::CatalogEntry g_image_entry;
+static bool g_image_valid = false;
 
-  // Cache it for status/UI.
-  program_state::set_servomotor_firmware_filename(out_path);
-  return true;
+static SemaphoreHandle_t mu() {
+  if (!g_mu) g_mu = xSemaphoreCreateMutex();
+  return g_mu;
 }
 
-bool upgrade_main_firmware_by_unique_id(Servomotor &motor, uint64_t unique_id, const char *firmware_path) {
-  if (unique_id == 0) {
-    Serial.println("ERROR: unique_id is 0 (invalid)");
-    return false;
-  }
-
-  if (!firmware_fs::begin()) {
-    Serial.println("ERROR: SPIFFS fwfs not mounted");
-    return false;
-  }
-
-  String path;
-  if (firmware_path && firmware_path[0] != 0) {
-    path = String(firmware_path);
-  } else {
-    if (!select_sm_firmware_path(path)) return false;
-  }
+static String strip_leading_slash(const String &path) { return path.startsWith("/") ? path.substring(1) : path; }
 
+// Reads `/basename` and prepares its pages.
+static bool load_image(const String &basename, servomotor_upgrade_core::Image *image, size_t *file_size) {
+  const String path = String("/") + basename;
   File f = SPIFFS.open(path, "r");
   if (!f) {
     Serial.printf("ERROR: could not open servomotor firmware file: %s\n", path.c_str());
     return false;
   }
 
-  const size_t file_size = (size_t)f.size();
-  if (file_size < (k_model_code_len + 1u)) {
-    Serial.println("ERROR: servomotor firmware file too small");
+  *file_size = (size_t)f.size();
+  std::vector<uint8_t> file(*file_size);
+  if (!read_all(f, file.data(), file.size())) {
+    Serial.println("ERROR: failed to read servomotor firmware file");
     f.close();
     return false;
   }
+  f.close();
+  return servomotor_upgrade_core::prepare_image(file.data(), file.size(), image, tee_log::out());
+}
 
-  uint8_t model_code[k_model_code_len];
-  uint8_t fw_compat = 0;
-  if (!read_all(f, model_code, sizeof(model_code)) || !read_all(f, &fw_compat, 1)) {
-    Serial.println("ERROR: failed to read firmware header");
-    f.close();
-    return false;
-  }
+CatalogAdd catalog_add_file(const String &basename) {
+  servomotor_upgrade_core::Image image;
+  size_t file_size = 0;
+  servomotor_upgrade_core::CatalogEntry e;
+  if (!load_image(basename, &image, &file_size) ||
+      !servomotor_upgrade_core::describe_image(basename.c_str(), file_size, image, &e)) {
+    Serial.printf("Servomotor catalog: %s is not a valid .firmware file\n", basename.c_str());
+    catalog_remove_file(basename);
+    return CatalogAdd::kInvalid;
+  }
+
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  const bool ok = g_catalog.add(e);
+  xSemaphoreGive(mu());
+  if (!ok) {
+    Serial.printf("ERROR: servomotor catalog full (%u files); %s left out\n",
+                  (unsigned)servomotor_upgrade_core::k_catalog_capacity, basename.c_str());
+    return CatalogAdd::kFull;
+  }
+  Serial.printf("Servomotor catalog: %s model='%.8s' compat=%u size=%lu crc32=0x%08lX pages=%u\n", e.basename,
+                (const char *)e.model_code, (unsigned)e.firmware_compatibility, (unsigned long)e.file_size,
+                (unsigned long)e.crc32, (unsigned)e.pages);
+  return CatalogAdd::kAdded;
+}
 
-  const size_t firmware_data_size = file_size - k_model_code_len - 1u;
-  if (firmware_data_size < (k_flash_page_size - 4u)) {
-    Serial.printf("ERROR: firmware payload too small (%lu bytes)\n", (unsigned long)firmware_data_size);
-    f.close();
+bool catalog_has_room(const String &basename) {
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  const bool room = g_catalog.size() < servomotor_upgrade_core::k_catalog_capacity ||
+                    g_catalog.find_basename(basename.c_str()) != nullptr;
+  xSemaphoreGive(mu());
+  return room;
+}
+
+void catalog_remove_file(const String &basename) {
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  (void)g_catalog.remove(basename.c_str());
+  xSemaphoreGive(mu());
+}
+
+bool rebuild_catalog() {
+  if (!firmware_fs::begin()) {
+    Serial.println("ERROR: SPIFFS fwfs not mounted");
     return false;
   }
-
-  // Read the remainder into RAM.
-  std::vector<uint8_t> data;
-  data.resize(firmware_data_size);
-  if (!read_all(f, data.data(), data.size())) {
-    Serial.println("ERROR: failed to read firmware payload");
-    f.close();
+  String names[servomotor_upgrade_core::k_catalog_capacity];
+  size_t count = 0;
+  if (!firmware_fs::list_servomotor_firmware_basenames(names, servomotor_upgrade_core::k_catalog_capacity, &count)) {
     return false;
   }
-  f.close();
 
-  // Pad to multiple-of-4 with 0x00.
-  while ((data.size() & 0x3u) != 0u) data.push_back(0x00);
-  if (data.size() < 8u) {
-    Serial.println("ERROR: firmware payload unexpectedly small after padding");
-    return false;
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  g_catalog.clear();
+  g_catalog_built = true;
+  xSemaphoreGive(mu());
+
+  for (size_t i = 0; i < count && i < servomotor_upgrade_core::k_catalog_capacity; i++) {
+    (void)catalog_add_file(names[i]);
   }
+  return true;
+}
+
+String catalog_json() {
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  String json = "{\"files\":[";
+  for (size_t i = 0; i < g_catalog.size(); i++) {
+    const servomotor_upgrade_core::CatalogEntry &e = g_catalog.entry(i);
+    char model[servomotor_upgrade_core::k_model_code_len + 1];
+    memcpy(model, e.model_code, servomotor_upgrade_core::k_model_code_len);
+    model[servomotor_upgrade_core::k_model_code_len] = 0;
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             "%s{\"basename\":\"%s\",\"model\":\"%s\",\"compat\":%u,\"size\":%lu,\"crc32\":\"0x%08lX\",\"pages\":%u}",
+             i ? "," : "", e.basename, model, (unsigned)e.firmware_compatibility, (unsigned long)e.file_size,
+             (unsigned long)e.crc32, (unsigned)e.pages);
+    json += buf;
+  }
+  xSemaphoreGive(mu());
+  json += "]}";
+  return json;
+}
 
-  // Mirror python:
-  // firmware_size = (len(data) >> 2) - 1
-  // firmware_crc  = crc32(data[4:])
-  const uint32_t firmware_size_words = (uint32_t)((data.size() >> 2) - 1u);
-  const uint32_t firmware_crc = calculate_crc32(data.data() + 4u, data.size() - 4u);
-
-  // tx = size_words(4 LE) + data[4:] + crc32(4 LE)
-  std::vector<uint8_t> tx;
-  tx.resize(4u + (data.size() - 4u) + 4u);
-  memcpy(tx.data(), &firmware_size_words, 4u);
-  memcpy(tx.data() + 4u, data.data() + 4u, data.size() - 4u);
-  memcpy(tx.data() + 4u + (data.size() - 4u), &firmware_crc, 4u);
-
-  const size_t max_tx = (size_t)(k_last_firmware_page_number - k_first_firmware_page_number + 1u) * k_flash_page_size;
-  if (tx.size() > max_tx) {
-    Serial.printf("ERROR: transformed firmware too large (%lu > %lu bytes)\n", (unsigned long)tx.size(),
-                  (unsigned long)max_tx);
+bool upgrade_main_firmware_by_unique_id(Servomotor &motor, uint64_t unique_id, const char *firmware_path) {
+  if (unique_id == 0) {
+    Serial.println("ERROR: unique_id is 0 (invalid)");
     return false;
   }
 
-  Serial.printf("Servomotor upgrade: file=%s model='%.8s' compat=%u\n", path.c_str(), (const char *)model_code,
-                (unsigned)fw_compat);
-  Serial.printf("Servomotor upgrade: tx=%lu bytes size_words=%lu crc32=0x%08lX unique_id=0x%08lX%08lX\n",
-                (unsigned long)tx.size(), (unsigned long)firmware_size_words, (unsigned long)firmware_crc,
-                (unsigned long)(unique_id >> 32), (unsigned long)(unique_id & 0xFFFFFFFFu));
-
-  // Optional pacing between pages. Default to 0 for unique-ID addressing because
-  // each page is ACKed (the ACK provides pacing). If you observe dropped bytes
-  // on your RS485 link, raise this (e.g. 50..200ms) instead of modifying the
-  // vendored Arduino library.
-  static constexpr uint32_t k_inter_page_delay_ms = 0;
-
-  // Reset into bootloader, mirroring the host upgrader flow.
-  // Note: this is a *software* reset over RS485, not a hardware NRST toggle.
-  Serial.println("Servomotor upgrade: pre-reset (SYSTEM_RESET) ...");
-  motor.systemReset();
-  {
-    const int err = motor.getError();
-    if (err != 0) {
-      if (err == COMMUNICATION_ERROR_TIMEOUT) {
-        Serial.println("ERROR: SYSTEM_RESET timed out (no ACK)");
-      } else {
-        Serial.printf("ERROR: SYSTEM_RESET failed errno=%d\n", err);
-      }
-      return false;
-    }
+  if (!firmware_fs::begin()) {
+    Serial.println("ERROR: SPIFFS fwfs not mounted");
+    return false;
   }
-  delay(k_wait_after_pre_reset_ms);
-
-  // Send pages and require ACK for each firmwareUpgrade.
-  uint8_t page[2058];
-  memcpy(page, model_code, k_model_code_len);
-  page[k_model_code_len] = fw_compat;
-
-  uint8_t page_number = k_first_firmware_page_number;
-  size_t off = 0;
-  while (off < tx.size()) {
-    if (page_number > k_last_firmware_page_number) {
-      Serial.println("ERROR: firmware too large for allowed page range");
-      return false;
-    }
 
-    page[k_model_code_len + 1u] = page_number;
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  const bool built = g_catalog_built;
+  xSemaphoreGive(mu());
+  if (!built && !rebuild_catalog()) return false;
 
-    const size_t remain = tx.size() - off;
-    const size_t take = (remain >= k_flash_page_size) ? k_flash_page_size : remain;
-    memcpy(page + k_model_code_len + 2u, tx.data() + off, take);
-    if (take < k_flash_page_size) {
-      memset(page + k_model_code_len + 2u + take, 0x00, k_flash_page_size - take);
-    }
-
-    Serial.printf("Servomotor upgrade: writing page %u (offset %lu)\n", (unsigned)page_number, (unsigned long)off);
-    motor.firmwareUpgrade(page);
-    const int err = motor.getError();
-    if (err != 0) {
-      if (err == COMMUNICATION_ERROR_TIMEOUT) {
-        Serial.printf("ERROR: firmwareUpgrade timed out (no ACK) at page %u\n", (unsigned)page_number);
-      } else {
-        Serial.printf("ERROR: firmwareUpgrade failed at page %u errno=%d\n", (unsigned)page_number, err);
-      }
-      return false;
+  // An explicit file must fit the DUT; otherwise the active selection only breaks ties between
+  // files for the same model.
+  const bool explicit_file = firmware_path && firmware_path[0] != 0;
+  String preferred;
+  if (explicit_file) {
+    preferred = strip_leading_slash(String(firmware_path));
+  } else {
+    preferred = program_state::servomotor_firmware_filename();
+    if (preferred.length() == 0 && firmware_fs::reconcile_active_servomotor_selection_ex(&preferred, nullptr)) {
+      program_state::set_servomotor_firmware_filename(preferred);
     }
+    preferred = strip_leading_slash(preferred);
+  }
 
-    off += take;
-    page_number++;
+  // Work on a copy: picking needs the bus, and the web UI must not wait for it.
+  static servomotor_upgrade_core::Catalog catalog;
+  xSemaphoreTake(mu(), portMAX_DELAY);
+  catalog = g_catalog;
+  xSemaphoreGive(mu());
 
-    if (k_inter_page_delay_ms) delay(k_inter_page_delay_ms);
+  const servomotor_upgrade_core::CatalogEntry *entry =
+      servomotor_upgrade_core::select_for_device(motor, catalog, preferred.length() ? preferred.c_str() : nullptr,
+                                                 tee_log::out());
+  if (!entry) return false;
+  if (explicit_file && preferred != entry->basename) {
+    Serial.printf("ERROR: %s does not fit this DUT\n", preferred.c_str());
+    return false;
   }
 
-  delay(k_wait_before_post_reset_ms);
-
-  // Post-reset to start the new firmware (mirrors host upgrader).
-  Serial.println("Servomotor upgrade: post-reset (SYSTEM_RESET) ...");
-  motor.systemReset();
-  {
-    const int err = motor.getError();
-    if (err != 0) {
-      if (err == COMMUNICATION_ERROR_TIMEOUT) {
-        Serial.println("ERROR: post SYSTEM_RESET timed out (no ACK)");
-      } else {
-        Serial.printf("ERROR: post SYSTEM_RESET failed errno=%d\n", err);
-      }
+  const bool cached = g_image_valid && strcmp(g_image_entry.basename, entry->basename) == 0 &&
+                      g_image_entry.crc32 == entry->crc32 && g_image_entry.file_size == entry->file_size;
+  if (!cached) {
+    g_image_valid = false;
+    size_t file_size = 0;
+    if (!load_image(String(entry->basename), &g_image, &file_size)) return false;
+    if (file_size != entry->file_size || g_image.crc32 != entry->crc32 ||
+        memcmp(g_image.model_code, entry->model_code, servomotor_upgrade_core::k_model_code_len) != 0 ||
+        g_image.firmware_compatibility != entry->firmware_compatibility) {
+      Serial.printf("ERROR: %s changed since it was cataloged; re-cataloged, retry\n", entry->basename);
+      (void)catalog_add_file(String(entry->basename));
       return false;
     }
+    g_image_entry = *entry;
+    g_image_valid = true;
   }
-  delay(k_wait_after_post_reset_ms);
 
-  Serial.println("Servomotor upgrade OK");
-  return true;
+  Serial.printf("Servomotor upgrade: file=%s%s tx=%lu bytes size_words=%lu crc32=0x%08lX unique_id=0x%08lX%08lX\n",
+                g_image_entry.basename, cached ? " (cached)" : "", (unsigned long)g_image.tx.size(),
+                (unsigned long)g_image.size_words, (unsigned long)g_image.crc32, (unsigned long)(unique_id >> 32),
+                (unsigned long)(unique_id & 0xFFFFFFFFu));
+
+  return servomotor_upgrade_core::send_image(motor, g_image, tee_log::out());
 }
 
 }  // namespace servomotor_upgrade
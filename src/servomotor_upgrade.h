@@ -17,12 +17,35 @@ namespace servomotor_upgrade {
 // `.firmware` format used by the host tool. The extension of tthe filename has been removed
 // to keep the character count 31 or less.
 //
-// If `firmware_path` is nullptr, the implementation will auto-select exactly
-// one `SM*` file from SPIFFS root.
+// The image is picked from the firmware catalog by the DUT's GET_PRODUCT_INFO
+// (product code + firmware compatibility); a DUT that no stored SM* file fits
+// is rejected before any page is sent. If several files fit, the active
+// selection (WiFi UI) decides. If `firmware_path` is given, that file is used,
+// but only if it fits the DUT.
 //
 // Returns true only if all pages are ACKed.
 bool upgrade_main_firmware_by_unique_id(Servomotor &motor, uint64_t unique_id, const char *firmware_path = nullptr);
 
+// Firmware catalog: model code, compatibility, size, CRC32 and page count of
+// every SM* file, worked out when the file is stored rather than per unit.
+// Thread-safe (the web UI maintains it, Mode 2 reads it).
+
+// Rebuilds the catalog from all SM* files on fwfs. Call once fwfs is mounted.
+bool rebuild_catalog();
+
+// Catalogs (or re-catalogs) one SM* file, basename without the leading "/".
+// kInvalid: not a valid `.firmware` file; kFull: valid, but the catalog already
+// holds k_catalog_capacity other files. Either way it is left out.
+enum class CatalogAdd : uint8_t { kAdded, kInvalid, kFull };
+CatalogAdd catalog_add_file(const String &basename);
+// True if catalog_add_file(basename) would not hit kFull (basename is already
+// cataloged, or there is a free entry).
+bool catalog_has_room(const String &basename);
+void catalog_remove_file(const String &basename);
+
+// {"files":[{"basename":"SM...","model":"M17","compat":1,"size":..,"crc32":"0x..","pages":..},...]}
+String catalog_json();
+
 // Convenience/debug helper: query product info over RS485 and print it.
 // Returns true only if a valid response was received.
 bool print_product_info_by_unique_id(Servomotor &motor);
@@ -0,0 +1,281 @@
+#include "servomotor_upgrade_core.h"
+
+#include <string.h>
+
+// Servomotor Arduino library (vendored into lib/Servomotor)
+#include <Servomotor.h>
+
+// For COMMUNICATION_ERROR_TIMEOUT and calculate_crc32().
+#include <Communication.h>
+
+namespace servomotor_upgrade_core {
+
+// Match the known-good host upgrader timing in
+// [`upgrade_firmware.py`](../../Servomotor/python_programs/upgrade_firmware.py:68).
+// WAIT_FOR_RESET_TIME = 0.07 seconds (70ms).
+static constexpr uint32_t k_wait_after_pre_reset_ms = 70;
+
+// Local jig behavior: after the last page is sent+ACKed, wait a bit before the
+// post-reset, then after the post-reset wait long enough for the bootloader to
+// time out and run the application.
+static constexpr uint32_t k_wait_before_post_reset_ms = 100;
+static constexpr uint32_t k_wait_after_post_reset_ms = 1000;
+
+bool prepare_image(const uint8_t *file, size_t file_size, Image *out, Print &log) {
+  if (!file || file_size < (k_model_code_len + 1u)) {
+    log.println("ERROR: servomotor firmware file too small");
+    return false;
+  }
+  memcpy(out->model_code, file, k_model_code_len);
+  out->firmware_compatibility = file[k_model_code_len];
+
+  const size_t firmware_data_size = file_size - k_model_code_len - 1u;
+  if (firmware_data_size < (k_flash_page_size - 4u)) {
+    log.printf("ERROR: firmware payload too small (%lu bytes)\n", (unsigned long)firmware_data_size);
+    return false;
+  }
+
+  // Pad to multiple-of-4 with 0x00.
+  std::vector<uint8_t> data(file + k_model_code_len + 1u, file + file_size);
+  while ((data.size() & 0x3u) != 0u) data.push_back(0x00);
+  if (data.size() < 8u) {
+    log.println("ERROR: firmware payload unexpectedly small after padding");
+    return false;
+  }
+
+  // Mirror python:
+  // firmware_size = (len(data) >> 2) - 1
+  // firmware_crc  = crc32(data[4:])
+  out->size_words = (uint32_t)((data.size() >> 2) - 1u);
+  out->crc32 = calculate_crc32(data.data() + 4u, data.size() - 4u);
+
+  // tx = size_words(4 LE) + data[4:] + crc32(4 LE)
+  std::vector<uint8_t> &tx = out->tx;
+  tx.resize(4u + (data.size() - 4u) + 4u);
+  memcpy(tx.data(), &out->size_words, 4u);
+  memcpy(tx.data() + 4u, data.data() + 4u, data.size() - 4u);
+  memcpy(tx.data() + 4u + (data.size() - 4u), &out->crc32, 4u);
+
+  const size_t max_tx = (size_t)(k_last_firmware_page_number - k_first_firmware_page_number + 1u) * k_flash_page_size;
+  if (tx.size() > max_tx) {
+    log.printf("ERROR: transformed firmware too large (%lu > %lu bytes)\n", (unsigned long)tx.size(),
+               (unsigned long)max_tx);
+    return false;
+  }
+  return true;
+}
+
+bool send_image(Servomotor &motor, const Image &image, Print &log) {
+  // Optional pacing between pages. Default to 0 for unique-ID addressing because
+  // each page is ACKed (the ACK provides pacing). If you observe dropped bytes
+  // on your RS485 link, raise this (e.g. 50..200ms) instead of modifying the
+  // vendored Arduino library.
+  static constexpr uint32_t k_inter_page_delay_ms = 0;
+
+  // Reset into bootloader, mirroring the host upgrader flow.
+  // Note: this is a *software* reset over RS485, not a hardware NRST toggle.
+  log.println("Servomotor upgrade: pre-reset (SYSTEM_RESET) ...");
+  motor.systemReset();
+  {
+    const int err = motor.getError();
+    if (err != 0) {
+      if (err == COMMUNICATION_ERROR_TIMEOUT) {
+        log.println("ERROR: SYSTEM_RESET timed out (no ACK)");
+      } else {
+        log.printf("ERROR: SYSTEM_RESET failed errno=%d\n", err);
+      }
+      return false;
+    }
+  }
+  delay(k_wait_after_pre_reset_ms);
+
+  // Send pages and require ACK for each firmwareUpgrade.
+  uint8_t page[2058];
+  memcpy(page, image.model_code, k_model_code_len);
+  page[k_model_code_len] = image.firmware_compatibility;
+
+  const std::vector<uint8_t> &tx = image.tx;
+  uint8_t page_number = k_first_firmware_page_number;
+  size_t off = 0;
+  while (off < tx.size()) {
+    if (page_number > k_last_firmware_page_number) {
+      log.println("ERROR: firmware too large for allowed page range");
+      return false;
+    }
+
+    page[k_model_code_len + 1u] = page_number;
+
+    const size_t remain = tx.size() - off;
+    const size_t take = (remain >= k_flash_page_size) ? k_flash_page_size : remain;
+    memcpy(page + k_model_code_len + 2u, tx.data() + off, take);
+    if (take < k_flash_page_size) {
+      memset(page + k_model_code_len + 2u + take, 0x00, k_flash_page_size - take);
+    }
+
+    log.printf("Servomotor upgrade: writing page %u (offset %lu)\n", (unsigned)page_number, (unsigned long)off);
+    motor.firmwareUpgrade(page);
+    const int err = motor.getError();
+    if (err != 0) {
+      if (err == COMMUNICATION_ERROR_TIMEOUT) {
+        log.printf("ERROR: firmwareUpgrade timed out (no ACK) at page %u\n", (unsigned)page_number);
+      } else {
+        log.printf("ERROR: firmwareUpgrade failed at page %u errno=%d\n", (unsigned)page_number, err);
+      }
+      return false;
+    }
+
+    off += take;
+    page_number++;
+
+    if (k_inter_page_delay_ms) delay(k_inter_page_delay_ms);
+  }
+
+  delay(k_wait_before_post_reset_ms);
+
+  // Post-reset to start the new firmware (mirrors host upgrader).
+  log.println("Servomotor upgrade: post-reset (SYSTEM_RESET) ...");
+  motor.systemReset();
+  {
+    const int err = motor.getError();
+    if (err != 0) {
+      if (err == COMMUNICATION_ERROR_TIMEOUT) {
+        log.println("ERROR: post SYSTEM_RESET timed out (no ACK)");
+      } else {
+        log.printf("ERROR: post SYSTEM_RESET failed errno=%d\n", err);
+      }
+      return false;
+    }
+  }
+  delay(k_wait_after_post_reset_ms);
+
+  log.println("Servomotor upgrade OK");
+  return true;
+}
+
+bool describe_image(const char *basename, size_t file_size, const Image &image, CatalogEntry *out) {
+  if (!basename || strlen(basename) >= k_catalog_basename_len || !out) return false;
+  memset(out, 0, sizeof(*out));
+  strncpy(out->basename, basename, k_catalog_basename_len - 1);
+  memcpy(out->model_code, image.model_code, k_model_code_len);
+  out->firmware_compatibility = image.firmware_compatibility;
+  out->file_size = (uint32_t)file_size;
+  out->size_words = image.size_words;
+  out->crc32 = image.crc32;
+  out->pages = (uint8_t)((image.tx.size() + k_flash_page_size - 1u) / k_flash_page_size);
+  return true;
+}
+
+void Catalog::clear() {
+  n_ = 0;
+  memset(slots_, k_none, sizeof(slots_));
+  memset(next_same_key_, k_none, sizeof(next_same_key_));
+}
+
+size_t Catalog::slot_hash(const uint8_t *model_code, uint8_t firmware_compatibility) {
+  // FNV-1a over the key
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < k_model_code_len; i++) h = (h ^ model_code[i]) * 16777619u;
+  h = (h ^ firmware_compatibility) * 16777619u;
+  return h & (k_slots - 1u);
+}
+
+bool Catalog::same_key(const CatalogEntry &e, const uint8_t *model_code, uint8_t firmware_compatibility) const {
+  return e.firmware_compatibility == firmware_compatibility && memcmp(e.model_code, model_code, k_model_code_len) == 0;
+}
+
+void Catalog::reindex() {
+  memset(slots_, k_none, sizeof(slots_));
+  memset(next_same_key_, k_none, sizeof(next_same_key_));
+  for (size_t i = 0; i < n_; i++) {
+    const CatalogEntry &e = entries_[i];
+    size_t s = slot_hash(e.model_code, e.firmware_compatibility);
+    while (slots_[s] != k_none && !same_key(entries_[slots_[s]], e.model_code, e.firmware_compatibility)) {
+      s = (s + 1u) & (k_slots - 1u);
+    }
+    if (slots_[s] == k_none) {
+      slots_[s] = (uint8_t)i;
+    } else {
+      uint8_t j = slots_[s];
+      while (next_same_key_[j] != k_none) j = next_same_key_[j];
+      next_same_key_[j] = (uint8_t)i;
+    }
+  }
+}
+
+bool Catalog::add(const CatalogEntry &entry) {
+  if (const CatalogEntry *existing = find_basename(entry.basename)) {
+    entries_[existing - entries_] = entry;
+  } else {
+    if (n_ == k_catalog_capacity) return false;
+    entries_[n_++] = entry;
+  }
+  reindex();
+  return true;
+}
+
+bool Catalog::remove(const char *basename) {
+  const CatalogEntry *e = find_basename(basename);
+  if (!e) return false;
+  const size_t i = (size_t)(e - entries_);
+  for (size_t j = i + 1u; j < n_; j++) entries_[j - 1u] = entries_[j];
+  n_--;
+  reindex();
+  return true;
+}
+
+const CatalogEntry *Catalog::find_basename(const char *basename) const {
+  if (!basename) return nullptr;
+  for (size_t i = 0; i < n_; i++) {
+    if (strncmp(entries_[i].basename, basename, k_catalog_basename_len) == 0) return &entries_[i];
+  }
+  return nullptr;
+}
+
+const CatalogEntry *Catalog::find(const uint8_t *model_code, uint8_t firmware_compatibility,
+                                  const char *preferred_basename, bool *ambiguous) const {
+  if (ambiguous) *ambiguous = false;
+  size_t s = slot_hash(model_code, firmware_compatibility);
+  while (slots_[s] != k_none && !same_key(entries_[slots_[s]], model_code, firmware_compatibility)) {
+    s = (s + 1u) & (k_slots - 1u);
+  }
+  if (slots_[s] == k_none) return nullptr;
+
+  const uint8_t first = slots_[s];
+  if (next_same_key_[first] == k_none) return &entries_[first];
+  for (uint8_t j = first; j != k_none; j = next_same_key_[j]) {
+    if (preferred_basename && strncmp(entries_[j].basename, preferred_basename, k_catalog_basename_len) == 0) {
+      return &entries_[j];
+    }
+  }
+  if (ambiguous) *ambiguous = true;
+  return nullptr;
+}
+
+const CatalogEntry *select_for_device(Servomotor &motor, const Catalog &catalog, const char *preferred_basename,
+                                      Print &log) {
+  const getProductInfoResponse info = motor.getProductInfo();
+  const int err = motor.getError();
+  if (err != 0) {
+    log.printf("ERROR: GET_PRODUCT_INFO failed errno=%d (cannot pick servomotor firmware)\n", err);
+    return nullptr;
+  }
+
+  bool ambiguous = false;
+  const CatalogEntry *e =
+      catalog.find((const uint8_t *)info.productCode, info.firmwareCompatibility, preferred_basename, &ambiguous);
+  if (!e) {
+    if (ambiguous) {
+      log.printf("ERROR: several SM* files fit model '%.8s' compat=%u; select one (WiFi UI)\n", info.productCode,
+                 (unsigned)info.firmwareCompatibility);
+    } else {
+      log.printf("ERROR: no SM* file for model '%.8s' compat=%u (%u cataloged)\n", info.productCode,
+                 (unsigned)info.firmwareCompatibility, (unsigned)catalog.size());
+    }
+    return nullptr;
+  }
+  log.printf("Servomotor upgrade: DUT model '%.8s' compat=%u -> %s (%u pages, crc32=0x%08lX)\n", info.productCode,
+             (unsigned)info.firmwareCompatibility, e->basename, (unsigned)e->pages, (unsigned long)e->crc32);
+  return e;
+}
+
+}  // namespace servomotor_upgrade_core
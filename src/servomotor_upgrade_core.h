@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Forward declarations to avoid pulling in the whole Arduino library header from users.
+class Print;
+class Servomotor;
+
+namespace servomotor_upgrade_core {
+
+// The part of the RS485 main-firmware upgrade that needs nothing but the Servomotor library:
+// turning a `.firmware` file into FIRMWARE_UPGRADE pages and sending them with the reset sequence
+// of the host upgrader. servomotor_upgrade.cpp feeds it from fwfs; the host tests drive it against
+// the bus emulator (sim/servomotor_host/ServomotorBusEmulator.h).
+
+static constexpr size_t k_flash_page_size = 2048;
+static constexpr size_t k_model_code_len = 8;
+static constexpr uint8_t k_first_firmware_page_number = 5;
+static constexpr uint8_t k_last_firmware_page_number = 30;
+
+struct Image {
+  uint8_t model_code[k_model_code_len];
+  uint8_t firmware_compatibility;
+  uint32_t size_words;   // application size in words, minus one (first word of the page stream)
+  uint32_t crc32;        // of the application after its first word (last word of the page stream)
+  std::vector<uint8_t> tx;  // page stream: size word, application after its first word, CRC32
+};
+
+// Parses a `.firmware` file (model code, firmware compatibility byte, application) into `out`.
+// Returns false (after printing why to `log`) if it is malformed or too large for the page range.
+bool prepare_image(const uint8_t *file, size_t file_size, Image *out, Print &log);
+
+// SYSTEM_RESET into the bootloader, every page with its ACK, then SYSTEM_RESET into the new
+// application. `motor` must be addressed by unique ID. Returns true only if all pages are ACKed.
+bool send_image(Servomotor &motor, const Image &image, Print &log);
+
+// ---- Firmware catalog ----
+//
+// What the upgrade needs to know about each stored SM* file, worked out once when the file is
+// uploaded (or at boot) instead of on every unit: the DUT's GET_PRODUCT_INFO (product code and
+// firmware compatibility) then picks its image with one hash lookup, and a DUT no stored image
+// fits is rejected before any page is sent. Several models can share one fixture.
+
+static constexpr size_t k_catalog_basename_len = 32;  // SPIFFS object name limit, with the NUL
+static constexpr size_t k_catalog_capacity = 16;
+
+struct CatalogEntry {
+  char basename[k_catalog_basename_len];  // no leading "/"
+  uint8_t model_code[k_model_code_len];
+  uint8_t firmware_compatibility;
+  uint32_t file_size;
+  uint32_t size_words;
+  uint32_t crc32;
+  uint8_t pages;  // FIRMWARE_UPGRADE pages the image takes
+};
+
+// Fills `out` from a prepared image of the file `basename`.
+bool describe_image(const char *basename, size_t file_size, const Image &image, CatalogEntry *out);
+
+class Catalog {
+ public:
+  Catalog() { clear(); }
+
+  void clear();
+  // Adds `entry`, replacing the entry with the same basename. False if the catalog is full.
+  bool add(const CatalogEntry &entry);
+  bool remove(const char *basename);
+  const CatalogEntry *find_basename(const char *basename) const;
+
+  size_t size() const { return n_; }
+  const CatalogEntry &entry(size_t i) const { return entries_[i]; }
+
+  // The image for a product code and firmware compatibility. When several files share them,
+  // `preferred_basename` (the active selection; may be null) decides; without it the lookup fails
+  // and sets *ambiguous.
+  const CatalogEntry *find(const uint8_t *model_code, uint8_t firmware_compatibility, const char *preferred_basename,
+                           bool *ambiguous) const;
+
+ private:
+  static constexpr size_t k_slots = 32;  // power of two, at least twice the capacity
+  static constexpr uint8_t k_none = 0xFF;
+
+  static size_t slot_hash(const uint8_t *model_code, uint8_t firmware_compatibility);
+  bool same_key(const CatalogEntry &e, const uint8_t *model_code, uint8_t firmware_compatibility) const;
+  void reindex();
+
+  CatalogEntry entries_[k_catalog_capacity];
+  size_t n_;
+  uint8_t slots_[k_slots];                  // first entry with the key hashed there
+  uint8_t next_same_key_[k_catalog_capacity];  // further entries with the same key
+};
+
+// Reads the DUT's product info and picks its image from `catalog` (see Catalog::find()).
+// Returns null, after printing why, if the device does not answer or no image fits it.
+const CatalogEntry *select_for_device(Servomotor &motor, const Catalog &catalog, const char *preferred_basename,
+                                      Print &log);
+
+}  // namespace servomotor_upgrade_core
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// STM32G0 family members the station can program, keyed by DBGMCU_IDCODE.DEV_ID (RM0444).
+// Every line shares the SW-DP IDCODE (0x0BC11477), the flash/SRAM base addresses, the
+// flash register block and doubleword (PG) programming; what differs is captured here so
+// stm32g0_prog picks it up once at connect time (stm32g0_prog::identify_target()) and the
+// erase/program/verify paths just use the fields instead of branching on the part.
+//
+// Header-only and free of Arduino dependencies: the simulator's target model is built from
+// the same descriptors (sim::Stm32SwdTarget::set_device()).
+
+namespace stm32g0_devices {
+
+static constexpr uint32_t DBGMCU_IDCODE = 0x40015800u;  // DEV_ID [11:0], REV_ID [31:16]
+static constexpr uint32_t DEV_ID_MASK = 0xFFFu;
+static constexpr uint32_t FLASHSIZE = 0x1FFF75E0u;      // flash size in KB (engineering data)
+
+// FLASH_CR / FLASH_SR bits that differ between single- and dual-bank parts.
+static constexpr uint32_t FLASH_CR_MER1 = (1u << 2);
+static constexpr uint32_t FLASH_CR_MER2 = (1u << 15);  // dual-bank only
+static constexpr uint32_t FLASH_SR_BSY1 = (1u << 16);
+static constexpr uint32_t FLASH_SR_BSY2 = (1u << 17);  // dual-bank only
+
+// FLASH_OPTR bits present on every line (RDP, BOR, reset/watchdog/boot options); dual-bank
+// parts add nSWAP_BANK (20) and DUAL_BANK (21).
+static constexpr uint32_t OPTR_USER_MASK_SINGLE_BANK = 0x3F4FFFFFu;
+static constexpr uint32_t OPTR_USER_MASK_DUAL_BANK = 0x3F7FFFFFu;
+
+struct Device {
+  uint16_t dev_id;
+  const char *name;
+  uint32_t flash_max_bytes;     // largest part of the line; FLASHSIZE says what this one has
+  uint16_t flash_size_kb_mask;  // valid FLASHSIZE bits (CMSIS FLASH_SIZE macro)
+  uint32_t page_size;
+  uint8_t banks;
+  uint32_t sram_bytes;
+  uint32_t mass_erase_cr;  // FLASH_CR bits that erase every bank (with STRT)
+  uint32_t busy_sr;        // FLASH_SR bits that mean an operation is running
+  uint32_t optr_user_mask;
+};
+
+static constexpr Device k_devices[] = {
+    {0x466, "STM32G03x/G04x", 64u * 1024u, 0x7Fu, 2048u, 1, 8u * 1024u, FLASH_CR_MER1, FLASH_SR_BSY1,
+     OPTR_USER_MASK_SINGLE_BANK},
+    {0x456, "STM32G05x/G06x", 64u * 1024u, 0x7Fu, 2048u, 1, 18u * 1024u, FLASH_CR_MER1, FLASH_SR_BSY1,
+     OPTR_USER_MASK_SINGLE_BANK},
+    {0x460, "STM32G07x/G08x", 128u * 1024u, 0xFFu, 2048u, 1, 36u * 1024u, FLASH_CR_MER1, FLASH_SR_BSY1,
+     OPTR_USER_MASK_SINGLE_BANK},
+    {0x467, "STM32G0Bx/G0Cx", 512u * 1024u, 0x3FFu, 2048u, 2, 144u * 1024u, FLASH_CR_MER1 | FLASH_CR_MER2,
+     FLASH_SR_BSY1 | FLASH_SR_BSY2, OPTR_USER_MASK_DUAL_BANK},
+};
+static constexpr size_t k_device_count = sizeof(k_devices) / sizeof(k_devices[0]);
+
+// The station's original DUT; assumed until a connect has identified the part.
+static constexpr size_t k_default_device = 0;
+
+// Index into k_devices for DBGMCU_IDCODE `idcode`, or k_device_count if the part is unknown.
+inline size_t find(uint32_t idcode) {
+  const uint32_t dev_id = idcode & DEV_ID_MASK;
+  for (size_t i = 0; i < k_device_count; i++) {
+    if (k_devices[i].dev_id == dev_id) return i;
+  }
+  return k_device_count;
+}
+
+// Flash size in bytes from a FLASHSIZE word, or 0 if it is out of range for `d`.
+inline uint32_t flash_size_bytes(const Device &d, uint32_t flashsize_word) {
+  const uint32_t bytes = (flashsize_word & d.flash_size_kb_mask) * 1024u;
+  return (bytes == 0u || bytes > d.flash_max_bytes || (bytes % d.page_size) != 0u) ? 0u : bytes;
+}
+
+}  // namespace stm32g0_devices
@@ -2,6 +2,7 @@
 
 #include <cstring>
 
+#include "product_info.h"
 #include "swd_min.h"
 
 #include "tee_log.h"
@@ -31,8 +32,18 @@ static constexpr uint32_t DHCSR_S_RESET_ST = (1u << 25);   // Reset sticky bit
 static constexpr uint32_t DCRSR = 0xE000EDF4u;  // Debug Core Register Selector Register
 static constexpr uint32_t DCRDR = 0xE000EDF8u;  // Debug Core Register Data Register
 static constexpr uint32_t DCRSR_REGWNR = (1u << 16);  // 0=read, 1=write
-// Core register numbers for DCRSR[4:0]
-static constexpr uint32_t REGNUM_PC = 15u;      // Program Counter (R15)
+// DHCSR, DCRSR, DCRDR and DEMCR are the four words at 0xE000EDF0, so a banked AHB-AP session
+// with TAR = DHCSR reaches them without TAR writes: BD0 = DHCSR, BD1 = DCRSR, BD2 = DCRDR.
+static constexpr uint8_t BD_DHCSR = 0;
+static constexpr uint8_t BD_DCRSR = 1;
+static constexpr uint8_t BD_DCRDR = 2;
+static_assert(DCRSR == DHCSR + 4u * BD_DCRSR && DCRDR == DHCSR + 4u * BD_DCRDR, "DCB register layout");
+
+// S_REGRDY polls per register before giving up. A Cortex-M0+ completes the transfer within a few
+// HCLK cycles, far less than one SWD transfer, so the first poll normally sees it.
+#ifndef CORE_REG_READY_POLLS
+#define CORE_REG_READY_POLLS 32
+#endif
 
 // Debug Exception and Monitor Control Register - used for vector catch on reset
 static constexpr uint32_t DEMCR = 0xE000EDFCu;
@@ -42,6 +53,7 @@ static constexpr uint32_t DEMCR_TRCENA = (1u << 24);       // Enable DWT/ITM
 // STM32G0 Flash registers (RM0444)
 static constexpr uint32_t FLASH_REG_BASE = 0x40022000u;
 static constexpr uint32_t FLASH_KEYR = FLASH_REG_BASE + 0x08u;
+static constexpr uint32_t FLASH_OPTKEYR = FLASH_REG_BASE + 0x0Cu;
 static constexpr uint32_t FLASH_SR = FLASH_REG_BASE + 0x10u;
 static constexpr uint32_t FLASH_CR = FLASH_REG_BASE + 0x14u;
   static constexpr uint32_t FLASH_OPTR = FLASH_REG_BASE + 0x20u;
@@ -49,9 +61,8 @@ static constexpr uint32_t FLASH_CR = FLASH_REG_BASE + 0x14u;
 // Keys
 static constexpr uint32_t FLASH_KEY1 = 0x45670123u;
 static constexpr uint32_t FLASH_KEY2 = 0xCDEF89ABu;
-
-  // FLASH_SR bits
-  static constexpr uint32_t FLASH_SR_BSY = (1u << 16);
+static constexpr uint32_t FLASH_OPTKEY1 = 0x08192A3Bu;
+static constexpr uint32_t FLASH_OPTKEY2 = 0x4C5D6E7Fu;
 
   // FLASH_SR completion + error flags (STM32G031)
   // Bit positions confirmed in [`FLASH_ERASE.md`](FLASH_ERASE.md:88) via [`docs/stm32g031xx.h`](docs/stm32g031xx.h:2440)
@@ -74,9 +85,11 @@ static constexpr uint32_t FLASH_KEY2 = 0xCDEF89ABu;
   // FLASH_CR bits
   static constexpr uint32_t FLASH_CR_PG = (1u << 0);
   static constexpr uint32_t FLASH_CR_PER = (1u << 1);
-  static constexpr uint32_t FLASH_CR_MER1 = (1u << 2);
   // static constexpr uint32_t FLASH_CR_PNB_MASK = (0x7Fu << 3); // (unused: page erase not implemented yet)
   static constexpr uint32_t FLASH_CR_STRT = (1u << 16);
+  static constexpr uint32_t FLASH_CR_OPTSTRT = (1u << 17);
+  static constexpr uint32_t FLASH_CR_OBL_LAUNCH = (1u << 27);
+  static constexpr uint32_t FLASH_CR_OPTLOCK = (1u << 30);
   static constexpr uint32_t FLASH_CR_LOCK = (1u << 31);
 
 static bool wait_flash_not_busy(uint32_t timeout_ms, swd_min::AhbApSession *s = nullptr) {
@@ -85,12 +98,13 @@ static bool wait_flash_not_busy(uint32_t timeout_ms, swd_min::AhbApSession *s =
   // Use microsecond-scale backoff for short operations.
   const uint32_t start_us = micros();
   const uint32_t timeout_us = timeout_ms * 1000u;
+  const uint32_t busy = target().device->busy_sr;  // BSY1, plus BSY2 on dual-bank parts
 
   while ((uint32_t)(micros() - start_us) < timeout_us) {
     uint32_t sr = 0;
     const bool ok = s ? s->read32(FLASH_SR, &sr) : swd_min::mem_read32(FLASH_SR, &sr);
     if (!ok) return false;
-    if ((sr & FLASH_SR_BSY) == 0) return true;
+    if ((sr & busy) == 0) return true;
 
     // Backoff tuned by expected operation duration.
     if (timeout_ms >= 1000u) {
@@ -155,6 +169,70 @@ static bool flash_clear_cr_bits(uint32_t mask) {
   return swd_min::mem_write32(FLASH_CR, cr);
 }
 
+// --- Target identification ---
+
+Target target() {
+  const swd_min::TargetId &id = swd_min::context().target_id;
+  Target t;
+  if (id.valid) {
+    t.device = &stm32g0_devices::k_devices[id.device];
+    t.rev_id = (uint16_t)(id.mcu_idcode >> 16);
+    t.flash_size = id.flash_size;
+  } else {
+    t.device = &stm32g0_devices::k_devices[stm32g0_devices::k_default_device];
+    t.rev_id = 0;
+    t.flash_size = t.device->flash_max_bytes;
+  }
+  t.sram_size = t.device->sram_bytes;
+  return t;
+}
+
+bool identify_target() {
+  uint32_t idcode = 0;
+  uint32_t flashsize = 0;
+  if (!swd_min::mem_read32(stm32g0_devices::DBGMCU_IDCODE, &idcode) ||
+      !swd_min::mem_read32(stm32g0_devices::FLASHSIZE, &flashsize)) {
+    Serial.println("ERROR: target identification failed (DBGMCU_IDCODE/FLASHSIZE read)");
+    return false;
+  }
+  const size_t i = stm32g0_devices::find(idcode);
+  if (i == stm32g0_devices::k_device_count) {
+    Serial.printf("ERROR: unsupported target: DBGMCU_IDCODE=0x%08lX (DEV_ID 0x%03lX not in the device table)\n",
+                  (unsigned long)idcode, (unsigned long)(idcode & stm32g0_devices::DEV_ID_MASK));
+    return false;
+  }
+  const stm32g0_devices::Device &d = stm32g0_devices::k_devices[i];
+  const uint32_t flash_size = stm32g0_devices::flash_size_bytes(d, flashsize);
+  if (flash_size == 0) {
+    Serial.printf("ERROR: %s reports FLASHSIZE=0x%08lX (not a valid flash size)\n", d.name,
+                  (unsigned long)flashsize);
+    return false;
+  }
+
+  swd_min::TargetId &id = swd_min::context().target_id;
+  id.valid = true;
+  id.mcu_idcode = idcode;
+  id.flash_size = flash_size;
+  id.device = (uint8_t)i;
+  if (verbose()) {
+    Serial.printf("Target: %s rev 0x%04lX, %lu KB flash (%u bank%s), %lu KB SRAM\n", d.name,
+                  (unsigned long)(idcode >> 16), (unsigned long)(flash_size / 1024u), (unsigned)d.banks,
+                  d.banks > 1 ? "s" : "", (unsigned long)(d.sram_bytes / 1024u));
+  }
+  return true;
+}
+
+// [addr, addr+len) must lie in the identified part's flash.
+static bool flash_range_ok(uint32_t addr, uint32_t len) {
+  const uint32_t size = target().flash_size;
+  if (addr < FLASH_BASE || addr - FLASH_BASE > size || len > size - (addr - FLASH_BASE)) {
+    Serial.printf("ERROR: 0x%08lX + %lu bytes is outside the target's %lu KB flash\n", (unsigned long)addr,
+                  (unsigned long)len, (unsigned long)(size / 1024u));
+    return false;
+  }
+  return true;
+}
+
 bool connect_and_halt() {
   if (verbose()) {
     Serial.println("Step 1/4: Assert reset and switch the debug port to SWD mode...");
@@ -196,19 +274,21 @@ bool connect_and_halt() {
     Serial.println("ERROR: write DHCSR failed");
     return false;
   }
+  // Connect window over: everything from here runs at the bulk SWD clock.
+  swd_min::use_clock(swd_min::ClockPhase::Bulk);
 
   // Confirm halted.
   for (int i = 0; i < 50; i++) {
     uint32_t dhcsr = 0;
     if (swd_min::mem_read32_verbose("Read DHCSR status to confirm the CPU is halted", DHCSR, &dhcsr) &&
         (dhcsr & DHCSR_S_HALT)) {
-      return true;
+      return identify_target();
     }
     delay(1);
   }
 
   Serial.println("WARN: core did not report HALT; continuing anyway");
-  return true;
+  return identify_target();
 }
 
 bool connect_and_halt_under_reset_recovery() {
@@ -241,6 +321,8 @@ bool connect_and_halt_under_reset_recovery() {
   (void)swd_min::mem_write32(DHCSR, DHCSR_C_DEBUGEN_C_HALT);
 
   // Step 3b: Pre-stage AHB-AP so the next DRW write targets DHCSR.
+  // SELECT/CSW are usually still in place from the DHCSR write above (shadowed); TAR has
+  // auto-incremented past DHCSR and is rewritten.
   if (!swd_min::ap_select(/*apsel=*/0, /*apbanksel=*/0)) {
     Serial.println("ERROR: ap_select failed");
     return false;
@@ -249,11 +331,11 @@ bool connect_and_halt_under_reset_recovery() {
   // Matches the AHB-AP CSW used by [`swd_min::mem_write32()`](src/swd_min.cpp:929).
   static constexpr uint32_t CSW_32_INC = 0x23000012u;
   uint8_t ack = 0;
-  if (!swd_min::ap_write_reg(swd_min::AP_ADDR_CSW, CSW_32_INC, &ack) || ack != swd_min::ACK_OK) {
+  if (!swd_min::ap_write_reg_cached(swd_min::AP_ADDR_CSW, CSW_32_INC, &ack) || ack != swd_min::ACK_OK) {
     Serial.printf("ERROR: AP CSW write failed, ACK=%u (%s)\n", (unsigned)ack, swd_min::ack_to_str(ack));
     return false;
   }
-  if (!swd_min::ap_write_reg(swd_min::AP_ADDR_TAR, DHCSR, &ack) || ack != swd_min::ACK_OK) {
+  if (!swd_min::ap_write_reg_cached(swd_min::AP_ADDR_TAR, DHCSR, &ack) || ack != swd_min::ACK_OK) {
     Serial.printf("ERROR: AP TAR write failed, ACK=%u (%s)\n", (unsigned)ack, swd_min::ack_to_str(ack));
     return false;
   }
@@ -270,6 +352,7 @@ bool connect_and_halt_under_reset_recovery() {
       if (ack == swd_min::ACK_OK) break;
     }
   }
+  swd_min::use_clock(swd_min::ClockPhase::Bulk);
 
   if (verbose()) {
     Serial.printf("Immediate halt write ACK=%u (%s)\n", (unsigned)first_halt_ack, swd_min::ack_to_str(first_halt_ack));
@@ -300,7 +383,7 @@ bool connect_and_halt_under_reset_recovery() {
   if ((dhcsr & DHCSR_S_HALT) == 0) {
     Serial.println("WARN: core did not report HALT; continuing anyway");
   }
-  return true;
+  return identify_target();
 }
 
 bool flash_read_bytes(uint32_t addr, uint8_t *out, uint32_t len, uint32_t *flash_optr_out) {
@@ -327,26 +410,97 @@ bool flash_read_bytes(uint32_t addr, uint8_t *out, uint32_t len, uint32_t *flash
     Serial.printf("Reading %lu bytes starting at 0x%08lX via AHB-AP...\n", (unsigned long)len, (unsigned long)addr);
   }
 
-  // Read bytes via 32-bit transfers.
-  // Keep it simple: read 32-bit words and memcpy out; support unaligned/odd lengths.
-  uint32_t off = 0;
-  while (off < len) {
-    const uint32_t aligned_addr = (addr + off) & ~0x3u;
-    uint32_t word = 0;
-    if (!swd_min::mem_read32_verbose("Read 32-bit word from target memory", aligned_addr, &word)) {
-      Serial.printf("ERROR: mem_read32 failed at 0x%08lX\n", (unsigned long)aligned_addr);
+  // One pipelined block read over the words covering [addr, addr+len): TAR once, then
+  // one DRW read per word (unaligned heads/tails are cut from the covering words).
+  if (!swd_min::read_block(addr, out, len)) {
+    Serial.printf("ERROR: read_block failed at 0x%08lX (+%lu bytes)\n", (unsigned long)addr, (unsigned long)len);
+    return false;
+  }
+
+  return true;
+}
+
+bool read_product_info(product_info_struct *out) {
+  if (!out) return false;
+  // sizeof(product_info_struct) = 32 at a word-aligned address: TAR + 8 DRW reads + RDBUFF
+  // (plus SELECT/CSW only if the shadow does not already hold them).
+  uint8_t buf[sizeof(product_info_struct)];
+  if (!swd_min::read_block(PRODUCT_INFO_MEMORY_LOCATION, buf, sizeof(buf))) {
+    Serial.printf("ERROR: product_info read failed at 0x%08lX\n", (unsigned long)PRODUCT_INFO_MEMORY_LOCATION);
+    return false;
+  }
+  memcpy(out, buf, sizeof(buf));
+  return true;
+}
+
+// --- Memory dump ---
+
+#ifndef DUMP_BURST_WORDS
+#define DUMP_BURST_WORDS 256  // one TAR auto-increment window (1KB) per burst
+#endif
+
+bool read_dump_header(uint32_t base, uint32_t size, uint32_t unix_time, DumpHeader *out) {
+  if (!out) return false;
+  memset(out, 0, sizeof(*out));
+  out->magic = DUMP_MAGIC;
+  out->version = DUMP_VERSION;
+  out->header_size = (uint16_t)sizeof(DumpHeader);
+  out->base = base;
+  out->size = size;
+  out->unix_time = unix_time;
+  out->uptime_ms = (uint32_t)millis();
+
+  if (!swd_min::read_idcode(&out->idcode)) {
+    Serial.println("ERROR: dump header: IDCODE read failed");
+    return false;
+  }
+  if (!swd_min::mem_read32(FLASH_OPTR, &out->optr) || !swd_min::mem_read32(DHCSR, &out->dhcsr)) {
+    Serial.println("ERROR: dump header: FLASH_OPTR/DHCSR read failed");
+    return false;
+  }
+  // Returned units are often read-protected; the rest of the header (and SRAM) is still
+  // worth having, so a flash read fault only leaves the product fields empty.
+  product_info_struct pi;
+  if (!read_product_info(&pi)) {
+    Serial.printf("WARN: dump header: no product info (FLASH_OPTR=0x%08lX)\n", (unsigned long)out->optr);
+    out->flags |= DUMP_FLAG_NO_PRODUCT_INFO;
+    // The faulted read left CTRL/STAT.STICKYERR set; clear it so the dump that follows runs.
+    static constexpr uint32_t ABORT_ERRCLR = (1u << 4) | (1u << 3) | (1u << 2) | (1u << 1);
+    return swd_min::dp_write_reg(swd_min::DP_ADDR_ABORT, ABORT_ERRCLR);
+  }
+  out->serial = pi.serial_number;
+  out->unique_id = pi.unique_id;
+  memcpy(out->model_code, pi.model_code, sizeof(out->model_code));
+  return true;
+}
+
+bool dump_memory(uint32_t base, uint32_t size, Print &out, uint32_t *bytes_out) {
+  if (bytes_out) *bytes_out = 0;
+  if ((base & 0x3u) || (size & 0x3u)) return false;
+
+  swd_min::AhbApSession ap;
+  if (!ap.begin()) return false;
+
+  uint32_t buf[DUMP_BURST_WORDS];
+  uint32_t done = 0;
+  while (done < size) {
+    const uint32_t addr = base + done;
+    // Bursts end on 1KB boundaries, so each one is a single TAR write.
+    uint32_t words = (0x400u - (addr & 0x3FFu)) / 4u;
+    if (words > DUMP_BURST_WORDS) words = DUMP_BURST_WORDS;
+    if (words > (size - done) / 4u) words = (size - done) / 4u;
+    if (!ap.read32_pipelined(addr, buf, words)) {
+      Serial.printf("ERROR: dump read failed at 0x%08lX\n", (unsigned long)addr);
       return false;
     }
-
-    uint8_t bytes[4];
-    memcpy(bytes, &word, 4);
-    for (uint32_t i = 0; i < 4 && off < len; i++) {
-      const uint32_t a = aligned_addr + i;
-      if (a < addr) continue;
-      out[off++] = bytes[i];
+    const size_t n = (size_t)words * 4u;  // little-endian host: words are the target's bytes
+    if (out.write(reinterpret_cast<const uint8_t *>(buf), n) != n) {
+      Serial.printf("ERROR: dump sink short write at 0x%08lX\n", (unsigned long)addr);
+      return false;
     }
+    done += (uint32_t)n;
+    if (bytes_out) *bytes_out = done;
   }
-
   return true;
 }
 
@@ -368,11 +522,11 @@ bool flash_mass_erase() {
   // Clear potentially-conflicting control bits.
   if (!flash_clear_cr_bits(FLASH_CR_PG | FLASH_CR_PER)) return false;
 
-  Serial.println("Mass erase (MER1)...");
-
-  // Set MER1, then STRT.
-  if (!swd_min::mem_write32(FLASH_CR, FLASH_CR_MER1)) return false;
-  if (!swd_min::mem_write32(FLASH_CR, FLASH_CR_MER1 | FLASH_CR_STRT)) return false;
+  // MER1 (and MER2 on dual-bank parts), then STRT.
+  const uint32_t mer = target().device->mass_erase_cr;
+  Serial.printf("Mass erase (%s)...\n", (mer & stm32g0_devices::FLASH_CR_MER2) ? "MER1+MER2" : "MER1");
+  if (!swd_min::mem_write32(FLASH_CR, mer)) return false;
+  if (!swd_min::mem_write32(FLASH_CR, mer | FLASH_CR_STRT)) return false;
 
   if (!wait_flash_not_busy(/*timeout_ms=*/30000)) {
     Serial.println("ERROR: flash busy timeout during mass erase");
@@ -398,8 +552,8 @@ bool flash_mass_erase() {
   // Clear EOP (and any errors if they appeared between reads).
   if (!flash_clear_sr_flags(FLASH_SR_CLEAR_MASK)) return false;
 
-  // Clear MER1 + STRT and lock.
-  if (!flash_clear_cr_bits(FLASH_CR_MER1 | FLASH_CR_STRT)) return false;
+  // Clear MERx + STRT and lock.
+  if (!flash_clear_cr_bits(mer | FLASH_CR_STRT)) return false;
   if (!swd_min::mem_write32(FLASH_CR, FLASH_CR_LOCK)) return false;
 
   Serial.println("Mass erase done");
@@ -462,11 +616,11 @@ bool flash_mass_erase_under_reset() {
 
   static constexpr uint32_t CSW_32_INC = 0x23000012u;  // matches [`swd_min::mem_write32()`](src/swd_min.cpp:788)
   uint8_t ack = 0;
-  if (!swd_min::ap_write_reg(swd_min::AP_ADDR_CSW, CSW_32_INC, &ack) || ack != swd_min::ACK_OK) {
+  if (!swd_min::ap_write_reg_cached(swd_min::AP_ADDR_CSW, CSW_32_INC, &ack) || ack != swd_min::ACK_OK) {
     Serial.printf("ERROR: AP CSW write failed, ACK=%u (%s)\n", (unsigned)ack, swd_min::ack_to_str(ack));
     return false;
   }
-  if (!swd_min::ap_write_reg(swd_min::AP_ADDR_TAR, DHCSR, &ack) || ack != swd_min::ACK_OK) {
+  if (!swd_min::ap_write_reg_cached(swd_min::AP_ADDR_TAR, DHCSR, &ack) || ack != swd_min::ACK_OK) {
     Serial.printf("ERROR: AP TAR write failed, ACK=%u (%s)\n", (unsigned)ack, swd_min::ack_to_str(ack));
     return false;
   }
@@ -495,6 +649,7 @@ bool flash_mass_erase_under_reset() {
       if (ack == swd_min::ACK_OK) break;
     }
   }
+  swd_min::use_clock(swd_min::ClockPhase::Bulk);
 
   // Exit the critical window: now it's safe to print/delay.
   Serial.println("---------------------------------------- NRST HIGH");
@@ -529,6 +684,8 @@ bool flash_mass_erase_under_reset() {
     return false;
   }
   Serial.printf("DHCSR = 0x%08lX (S_HALT=%u)\n", (unsigned long)dhcsr, (unsigned)((dhcsr & DHCSR_S_HALT) ? 1u : 0u));
+  // The erase below needs the part's MERx bits.
+  if (!identify_target()) return false;
 
   // Step 7: Run the standard mass erase routine (NRST HIGH).
   Serial.println("Step 7: Run normal mass erase... ");
@@ -554,6 +711,7 @@ bool flash_mass_erase_under_reset() {
 
 bool flash_program(uint32_t addr, const uint8_t *data, uint32_t len) {
   if (!data || len == 0) return true;
+  if (!flash_range_ok(addr, len)) return false;
 
   swd_min::AhbApSession ap;
   if (!ap.begin()) {
@@ -583,7 +741,7 @@ bool flash_program(uint32_t addr, const uint8_t *data, uint32_t len) {
   {
     uint32_t cr = 0;
     if (!ap.read32(FLASH_CR, &cr)) return false;
-    cr &= ~(FLASH_CR_PER | FLASH_CR_MER1);
+    cr &= ~(FLASH_CR_PER | target().device->mass_erase_cr);
     cr |= FLASH_CR_PG;
     if (!ap.write32(FLASH_CR, cr)) return false;
   }
@@ -632,11 +790,19 @@ bool flash_program(uint32_t addr, const uint8_t *data, uint32_t len) {
 static bool reader_read_exact_or_pad(stm32g0_prog::FirmwareReader &r, uint32_t offset, uint8_t *dst, uint32_t n,
                                     uint8_t pad) {
   // Read up to n bytes; if fewer bytes available (EOF), pad remaining with pad.
-  uint32_t got = 0;
-  if (!r.read_at(offset, dst, n, &got)) return false;
-  if (got > n) return false;
-  if (got < n) {
-    memset(dst + got, pad, n - got);
+  // A reader may return fewer bytes than asked before EOF, so keep reading until it returns 0.
+  // Offsets past EOF (the padded tail) are never passed to the reader: read_at() fails there.
+  const uint32_t size = r.size();
+  uint32_t total = 0;
+  while (total < n && offset + total < size) {
+    uint32_t got = 0;
+    if (!r.read_at(offset + total, dst + total, n - total, &got)) return false;
+    if (got > n - total) return false;
+    if (got == 0) break;
+    total += got;
+  }
+  if (total < n) {
+    memset(dst + total, pad, n - total);
   }
   return true;
 }
@@ -647,6 +813,7 @@ bool flash_program_reader(uint32_t addr, FirmwareReader &r) {
     Serial.println("ERROR: firmware file is empty");
     return false;
   }
+  if (!flash_range_ok(addr, len)) return false;
 
   swd_min::AhbApSession ap;
   if (!ap.begin()) {
@@ -673,7 +840,7 @@ bool flash_program_reader(uint32_t addr, FirmwareReader &r) {
   {
     uint32_t cr = 0;
     if (!ap.read32(FLASH_CR, &cr)) return false;
-    cr &= ~(FLASH_CR_PER | FLASH_CR_MER1);
+    cr &= ~(FLASH_CR_PER | target().device->mass_erase_cr);
     cr |= FLASH_CR_PG;
     if (!ap.write32(FLASH_CR, cr)) return false;
   }
@@ -823,8 +990,8 @@ bool flash_verify_fast(uint32_t addr, const uint8_t *data, uint32_t len, uint32_
           return false;
         }
 
-        // Invalidate TAR state before continuing the pipelined loop.
-        ap.invalidate();
+        // TAR now points just past `last_addr` (= the next chunk); the driver's DP/AP shadow
+        // tracks that, so the next chunk skips its TAR write.
 
         if (check0 != buf[0] || check_last != buf[chunk_words - 1u]) {
           Serial.printf("WARN: pipelined AP reads appear unreliable in this region (0x%08lX..0x%08lX); using safe reads\n",
@@ -853,9 +1020,8 @@ bool flash_verify_fast(uint32_t addr, const uint8_t *data, uint32_t len, uint32_
             const uint32_t a = addr + ((word_index + i) * 4u);
             // Extra diagnostic: re-read this word using the known-correct (DP.RDBUFF) path.
             uint32_t got_safe = 0;
+            // `mem_read32()` shares the DP/AP shadow with the session; no invalidate needed.
             const bool safe_ok = swd_min::mem_read32(a, &got_safe);
-            // `mem_read32()` reconfigures AP/DP state, so invalidate the session TAR cache.
-            ap.invalidate();
 
             if (safe_ok) {
               Serial.printf("Mismatch @ 0x%08lX: exp=%08lX got=%08lX (safe=%08lX)\n", (unsigned long)a,
@@ -962,6 +1128,200 @@ bool flash_verify_fast_reader(uint32_t addr, FirmwareReader &r, uint32_t *mismat
   return mismatches == 0;
 }
 
+// --- Option bytes ---
+
+bool read_option_bytes(uint32_t *optr) { return swd_min::mem_read32(FLASH_OPTR, optr); }
+
+void print_option_bytes(uint32_t optr) {
+  const uint32_t rdp = optr & OPTR_RDP_MASK;
+  const unsigned level = (rdp == OPTR_RDP_LEVEL_0) ? 0u : (rdp == OPTR_RDP_LEVEL_2) ? 2u : 1u;
+  Serial.printf("FLASH_OPTR=0x%08lX RDP=0x%02lX (level %u) BOR_EN=%u BORR=%lu BORF=%lu IWDG_SW=%u IWDG_STOP=%u "
+                "IWDG_STDBY=%u WWDG_SW=%u\n",
+                (unsigned long)optr, (unsigned long)rdp, level, (optr & OPTR_BOR_EN) ? 1u : 0u,
+                (unsigned long)((optr & OPTR_BORR_LEV_MASK) >> 9), (unsigned long)((optr & OPTR_BORF_LEV_MASK) >> 11),
+                (optr & OPTR_IWDG_SW) ? 1u : 0u, (optr & OPTR_IWDG_STOP) ? 1u : 0u, (optr & OPTR_IWDG_STDBY) ? 1u : 0u,
+                (optr & OPTR_WWDG_SW) ? 1u : 0u);
+}
+
+// OPTLOCK can only be cleared with the flash itself unlocked (LOCK clear).
+static bool option_unlock_fast(swd_min::AhbApSession &ap) {
+  if (!flash_unlock_fast(ap)) return false;
+  uint32_t cr = 0;
+  if (!ap.read32(FLASH_CR, &cr)) return false;
+  if ((cr & FLASH_CR_OPTLOCK) == 0) return true;
+
+  if (!ap.write32(FLASH_OPTKEYR, FLASH_OPTKEY1)) return false;
+  if (!ap.write32(FLASH_OPTKEYR, FLASH_OPTKEY2)) return false;
+
+  if (!ap.read32(FLASH_CR, &cr)) return false;
+  if (cr & FLASH_CR_OPTLOCK) {
+    Serial.println("ERROR: option byte unlock failed (OPTLOCK still set)");
+    return false;
+  }
+  return true;
+}
+
+bool program_option_bytes(uint32_t mask, uint32_t value, OptionBytesResult *result) {
+  OptionBytesResult r = {};
+  const uint32_t t0 = micros();
+  const stm32g0_devices::Device &dev = *target().device;
+  if (mask & ~dev.optr_user_mask) {
+    Serial.printf("ERROR: OPTR mask 0x%08lX includes bits outside %s's user options (0x%08lX)\n",
+                  (unsigned long)mask, dev.name, (unsigned long)dev.optr_user_mask);
+    return false;
+  }
+
+  swd_min::AhbApSession ap;
+  if (!ap.begin()) {
+    Serial.println("ERROR: AHB-AP session init failed");
+    return false;
+  }
+  if (!ap.read32(FLASH_OPTR, &r.optr_before)) return false;
+  const uint32_t want = (r.optr_before & ~mask) | (value & mask);
+  r.optr_after = r.optr_before;
+  if ((want & OPTR_RDP_MASK) == OPTR_RDP_LEVEL_2) {
+    Serial.println("ERROR: refusing RDP level 2 (permanent)");
+    return false;
+  }
+  if (want == r.optr_before) {
+    if (result) *result = r;
+    return true;
+  }
+  if ((r.optr_before & OPTR_RDP_MASK) != OPTR_RDP_LEVEL_0 && (want & OPTR_RDP_MASK) == OPTR_RDP_LEVEL_0) {
+    Serial.println("RDP level 1 -> 0: the option reload mass-erases flash");
+  }
+
+  // RM0444 3.4.2: BSY1 clear, unlock, write OPTR, OPTSTRT, wait BSY1, then OBL_LAUNCH.
+  if (!wait_flash_not_busy(/*timeout_ms=*/5000, &ap)) {
+    Serial.println("ERROR: flash busy timeout before option bytes");
+    return false;
+  }
+  if (!option_unlock_fast(ap)) return false;
+  if (!flash_clear_sr_flags_fast(ap, FLASH_SR_CLEAR_MASK)) return false;
+  if (!ap.write32(FLASH_OPTR, want)) return false;
+  {
+    uint32_t cr = 0;
+    if (!ap.read32(FLASH_CR, &cr)) return false;
+    cr &= ~(FLASH_CR_PG | FLASH_CR_PER | target().device->mass_erase_cr);
+    if (!ap.write32(FLASH_CR, cr | FLASH_CR_OPTSTRT)) return false;
+  }
+  // Option programming erases and rewrites the option page (tens of ms); an RDP regression
+  // mass-erases the flash as well.
+  if (!wait_flash_not_busy(/*timeout_ms=*/5000, &ap)) {
+    Serial.println("ERROR: flash busy timeout during option byte programming");
+    return false;
+  }
+  uint32_t sr = 0;
+  if (!ap.read32(FLASH_SR, &sr)) return false;
+  if (sr & FLASH_SR_ALL_ERRORS) {
+    Serial.printf("ERROR: option byte programming error flags set: FLASH_SR=0x%08lX\n", (unsigned long)sr);
+    (void)flash_clear_sr_flags_fast(ap, sr);
+    return false;
+  }
+  const uint32_t t1 = micros();
+  r.program_us = t1 - t0;
+
+  // The reload resets the part (and with it the DP), so this write may not even be ACKed.
+  {
+    uint32_t cr = 0;
+    if (!ap.read32(FLASH_CR, &cr)) return false;
+    (void)ap.write32(FLASH_CR, cr | FLASH_CR_OBL_LAUNCH);
+  }
+  if (!connect_and_halt_under_reset_recovery()) {
+    Serial.println("ERROR: re-attach after option byte reload failed");
+    return false;
+  }
+  if (!read_option_bytes(&r.optr_after)) return false;
+  r.changed = true;
+  r.reload_us = micros() - t1;
+  if (result) *result = r;
+
+  if ((r.optr_after & mask) != (value & mask)) {
+    Serial.printf("ERROR: FLASH_OPTR=0x%08lX after reload, expected 0x%08lX under mask 0x%08lX\n",
+                  (unsigned long)r.optr_after, (unsigned long)(value & mask), (unsigned long)mask);
+    return false;
+  }
+  return true;
+}
+
+// --- Core registers ---
+
+// One register inside a banked session (see BD_DHCSR). DHCSR and DCRDR are read back to back as
+// posted reads, so DCRDR is only taken if S_REGRDY was already set when DHCSR was sampled.
+static bool core_reg_read(swd_min::AhbApSession &ap, uint8_t regsel, uint32_t *out) {
+  if (!ap.banked_write(BD_DCRSR, regsel & 0x1Fu)) return false;
+  for (int i = 0; i < CORE_REG_READY_POLLS; i++) {
+    uint32_t dhcsr = 0;
+    if (!ap.banked_read_posted(BD_DHCSR, nullptr)) return false;
+    if (!ap.banked_read_posted(BD_DCRDR, &dhcsr)) return false;
+    if (dhcsr & DHCSR_S_REGRDY) return ap.rdbuff(out);
+  }
+  return false;
+}
+
+static bool core_reg_write(swd_min::AhbApSession &ap, uint8_t regsel, uint32_t val) {
+  if (!ap.banked_write(BD_DCRDR, val)) return false;
+  if (!ap.banked_write(BD_DCRSR, DCRSR_REGWNR | (regsel & 0x1Fu))) return false;
+  for (int i = 0; i < CORE_REG_READY_POLLS; i++) {
+    uint32_t dhcsr = 0;
+    if (!ap.banked_read_posted(BD_DHCSR, nullptr)) return false;
+    if (!ap.rdbuff(&dhcsr)) return false;
+    if (dhcsr & DHCSR_S_REGRDY) return true;
+  }
+  return false;
+}
+
+bool read_core_register(uint8_t regsel, uint32_t *out) {
+  swd_min::AhbApSession ap;
+  if (!ap.banked_begin(DHCSR)) return false;
+  const bool ok = core_reg_read(ap, regsel, out);
+  return ap.banked_end() && ok;
+}
+
+bool write_core_register(uint8_t regsel, uint32_t val) {
+  swd_min::AhbApSession ap;
+  if (!ap.banked_begin(DHCSR)) return false;
+  const bool ok = core_reg_write(ap, regsel, val);
+  return ap.banked_end() && ok;
+}
+
+bool read_core_registers(CoreRegisters *out) {
+  if (!out) return false;
+  swd_min::AhbApSession ap;
+  if (!ap.banked_begin(DHCSR)) return false;
+  bool ok = true;
+  for (uint8_t i = 0; ok && i < 16u; i++) ok = core_reg_read(ap, i, &out->r[i]);
+  ok = ok && core_reg_read(ap, CORE_REG_XPSR, &out->xpsr) && core_reg_read(ap, CORE_REG_MSP, &out->msp) &&
+       core_reg_read(ap, CORE_REG_PSP, &out->psp) && core_reg_read(ap, CORE_REG_CONTROL_PRIMASK, &out->control_primask);
+  return ap.banked_end() && ok;
+}
+
+bool write_core_registers(const CoreRegisters &regs) {
+  swd_min::AhbApSession ap;
+  if (!ap.banked_begin(DHCSR)) return false;
+  // Stack pointers and CONTROL first, so a later write cannot be redirected by SPSEL.
+  bool ok = core_reg_write(ap, CORE_REG_MSP, regs.msp) && core_reg_write(ap, CORE_REG_PSP, regs.psp) &&
+            core_reg_write(ap, CORE_REG_CONTROL_PRIMASK, regs.control_primask);
+  for (uint8_t i = 0; ok && i < 13u; i++) ok = core_reg_write(ap, i, regs.r[i]);
+  ok = ok && core_reg_write(ap, CORE_REG_LR, regs.r[CORE_REG_LR]) && core_reg_write(ap, CORE_REG_PC, regs.r[CORE_REG_PC]) &&
+       core_reg_write(ap, CORE_REG_XPSR, regs.xpsr);
+  return ap.banked_end() && ok;
+}
+
+void print_core_registers(const CoreRegisters &regs) {
+  for (uint8_t i = 0; i < 12u; i += 4u) {
+    Serial.printf("  R%-2u=0x%08lX R%-2u=0x%08lX R%-2u=0x%08lX R%-2u=0x%08lX\n", (unsigned)i,
+                  (unsigned long)regs.r[i], (unsigned)(i + 1u), (unsigned long)regs.r[i + 1u], (unsigned)(i + 2u),
+                  (unsigned long)regs.r[i + 2u], (unsigned)(i + 3u), (unsigned long)regs.r[i + 3u]);
+  }
+  Serial.printf("  R12=0x%08lX SP =0x%08lX LR =0x%08lX PC =0x%08lX\n", (unsigned long)regs.r[12],
+                (unsigned long)regs.r[CORE_REG_SP], (unsigned long)regs.r[CORE_REG_LR], (unsigned long)regs.r[CORE_REG_PC]);
+  Serial.printf("  xPSR=0x%08lX (exception %lu) MSP=0x%08lX PSP=0x%08lX CONTROL=0x%02lX PRIMASK=%lu\n",
+                (unsigned long)regs.xpsr, (unsigned long)(regs.xpsr & 0x3Fu), (unsigned long)regs.msp,
+                (unsigned long)regs.psp, (unsigned long)(regs.control_primask >> 24),
+                (unsigned long)(regs.control_primask & 1u));
+}
+
 bool read_program_counter() {
   // This function reads the Program Counter (PC) register to prove we can access
   // core registers while NRST is HIGH.
@@ -1009,44 +1369,13 @@ bool read_program_counter() {
   bool all_reads_ok = true;
   
   for (int i = 0; i < 5; i++) {
-    // Write PC register number (15) to DCRSR to request a read
-    // Bit 16 = 0 for read, bits [4:0] = register number
-    const uint32_t dcrsr_read_pc = REGNUM_PC;  // Read PC (R15)
-    if (!swd_min::mem_write32_verbose("Select CPU register number (DCRSR) to read PC (R15)", DCRSR, dcrsr_read_pc)) {
-      Serial.printf("ERROR: Failed to write DCRSR (iteration %d)\n", i);
-      all_reads_ok = false;
-      break;
-    }
-    
-    // Wait for S_REGRDY in DHCSR (indicates register transfer complete)
-    bool ready = false;
-    for (int wait = 0; wait < 200; wait++) {
-      if (!swd_min::mem_read32(DHCSR, &dhcsr)) {
-        Serial.printf("ERROR: Failed to read DHCSR (iteration %d)\n", i);
-        all_reads_ok = false;
-        break;
-      }
-      if (dhcsr & DHCSR_S_REGRDY) {
-        ready = true;
-        break;
-      }
-      delayMicroseconds(10);
-    }
-    
-    if (!ready) {
-      Serial.printf("ERROR: S_REGRDY timeout (iteration %d, DHCSR=0x%08lX)\n", i, (unsigned long)dhcsr);
-      all_reads_ok = false;
-      break;
-    }
-    
-    // Read the PC value from DCRDR
     uint32_t pc = 0;
-    if (!swd_min::mem_read32_verbose("Read CPU register value (DCRDR)", DCRDR, &pc)) {
-      Serial.printf("ERROR: Failed to read DCRDR (iteration %d)\n", i);
+    if (!read_core_register(CORE_REG_PC, &pc)) {
+      Serial.printf("ERROR: PC read failed (iteration %d; SWD error or S_REGRDY timeout)\n", i);
       all_reads_ok = false;
       break;
     }
-    
+
     pc_values[i] = pc;
     Serial.printf("  Read %d: PC = 0x%08lX\n", i + 1, (unsigned long)pc);
 
@@ -1068,6 +1397,14 @@ bool read_program_counter() {
     Serial.println("FAIL: Could not complete all PC reads");
     return false;
   }
+
+  CoreRegisters regs;
+  if (read_core_registers(&regs)) {
+    Serial.println("Core registers:");
+    print_core_registers(regs);
+  } else {
+    Serial.println("WARN: register file snapshot failed");
+  }
   
   Serial.println("\nAnalysis:");
 
@@ -1083,7 +1420,7 @@ bool read_program_counter() {
   // Check if PC is in valid flash range (0x08000000 - 0x08010000)
   bool pc_in_flash = true;
   for (int i = 0; i < 5; i++) {
-    if (pc_values[i] < FLASH_BASE || pc_values[i] >= (FLASH_BASE + FLASH_SIZE_BYTES)) {
+    if (pc_values[i] < FLASH_BASE || pc_values[i] >= (FLASH_BASE + target().flash_size)) {
       pc_in_flash = false;
       break;
     }
@@ -1113,6 +1450,145 @@ bool read_program_counter() {
   return true;
 }
 
+// --- SWD clock tuning ---
+
+#ifndef SWD_TUNE_ROUNDS
+#define SWD_TUNE_ROUNDS 8  // bulk pattern rounds per candidate (x4 for the confirmation run)
+#endif
+#ifndef SWD_TUNE_CONNECT_TRIALS
+#define SWD_TUNE_CONNECT_TRIALS 3  // connects per candidate (x2 for the confirmation run)
+#endif
+#ifndef SRAM_TUNE_BYTES
+#define SRAM_TUNE_BYTES 256
+#endif
+
+// Slowest first; 0 = no delay (GPIO-limited).
+static const uint32_t k_tune_half_periods_us[] = {5, 3, 2, 1, 0};
+static constexpr uint32_t k_tune_steps = sizeof(k_tune_half_periods_us) / sizeof(k_tune_half_periods_us[0]);
+static constexpr uint32_t CTRLSTAT_STICKY_MASK = (1u << 1) | (1u << 5) | (1u << 7);  // STICKYORUN/ERR, WDATAERR
+
+// IDCODE, then write/read-back patterns in SRAM; `rounds` of each.
+static bool tune_bulk_link_ok(uint32_t idcode_ref, uint32_t rounds) {
+  uint8_t wr[SRAM_TUNE_BYTES];
+  uint8_t rd[SRAM_TUNE_BYTES];
+  uint32_t x = 0x9E3779B9u;
+  for (uint32_t r = 0; r < rounds; r++) {
+    uint32_t idcode = 0;
+    if (!swd_min::read_idcode(&idcode) || idcode != idcode_ref) return false;
+
+    // Alternating bits, walking ones, then pseudo-random data.
+    for (uint32_t i = 0; i < sizeof(wr); i++) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      wr[i] = (r % 3 == 0) ? (uint8_t)((i & 1) ? 0x55 : 0xAA) : (r % 3 == 1) ? (uint8_t)(1u << (i & 7)) : (uint8_t)x;
+    }
+    if (!swd_min::write_block(SRAM_BASE, wr, sizeof(wr))) return false;
+    memset(rd, 0, sizeof(rd));
+    if (!swd_min::read_block(SRAM_BASE, rd, sizeof(rd))) return false;
+    if (memcmp(wr, rd, sizeof(wr)) != 0) return false;
+
+    // A write data-phase parity error only shows up as WDATAERR.
+    uint32_t ctrlstat = 0;
+    if (!swd_min::dp_read_reg(swd_min::DP_ADDR_CTRLSTAT, &ctrlstat) || (ctrlstat & CTRLSTAT_STICKY_MASK)) return false;
+  }
+  return true;
+}
+
+// Back at a known-good clock after a failed candidate: re-sync and clear sticky errors.
+static bool tune_recover(uint32_t half_period_us) {
+  swd_min::set_half_period_us(half_period_us);
+  swd_min::swd_line_reset();
+  return swd_min::dp_init_and_power_up();
+}
+
+static bool tune_connect_ok(uint32_t trials) {
+  for (uint32_t t = 0; t < trials; t++) {
+    if (!connect_and_halt_under_reset_recovery()) return false;
+    uint32_t dhcsr = 0;
+    if (!swd_min::mem_read32(DHCSR, &dhcsr) || !(dhcsr & DHCSR_S_HALT)) return false;
+  }
+  return true;
+}
+
+bool tune_swd_clock(ClockTuneResult *out) {
+  ClockTuneResult res;
+  res.config = swd_min::clock_config();  // replaced by the tuned values only if the whole tune passes
+  swd_min::ClockConfig tuned = res.config;
+  res.bulk_failed_half_period_us = UINT32_MAX;
+  res.connect_failed_half_period_us = UINT32_MAX;
+
+  // Start from the settings in use, or the slowest ones if those do not connect.
+  const bool prev_verbose = verbose();
+  swd_min::set_verbose(false);
+  uint32_t idcode_ref = 0;
+  bool ok = connect_and_halt_under_reset_recovery() && swd_min::read_idcode(&idcode_ref);
+  if (!ok) {
+    const uint32_t slowest = k_tune_half_periods_us[0];
+    swd_min::set_clock_config(swd_min::ClockConfig{slowest, slowest});
+    ok = connect_and_halt_under_reset_recovery() && swd_min::read_idcode(&idcode_ref);
+    if (!ok) Serial.println("ERROR: clock tune: no connection, not even at the slowest SWD clock");
+  }
+
+  // Bulk: fastest setting that passes, confirmed with a longer run (else one step slower).
+  int best = -1;
+  for (uint32_t i = 0; ok && i < k_tune_steps; i++) {
+    swd_min::set_half_period_us(k_tune_half_periods_us[i]);
+    if (!tune_bulk_link_ok(idcode_ref, SWD_TUNE_ROUNDS)) {
+      res.bulk_failed_half_period_us = k_tune_half_periods_us[i];
+      ok = best >= 0 && tune_recover(k_tune_half_periods_us[best]);
+      break;
+    }
+    best = (int)i;
+  }
+  while (ok) {
+    swd_min::set_half_period_us(k_tune_half_periods_us[best]);
+    if (tune_bulk_link_ok(idcode_ref, 4u * SWD_TUNE_ROUNDS)) break;
+    res.bulk_failed_half_period_us = k_tune_half_periods_us[best];
+    ok = best > 0 && tune_recover(k_tune_half_periods_us[--best]);
+  }
+  if (ok) tuned.bulk_half_period_us = k_tune_half_periods_us[best];
+
+  // Connect window: full connect-under-reset cycles at each setting. Too slow can lose the
+  // race against firmware that disables SWD, so failures before the first pass are skipped;
+  // the first failure after it ends the walk.
+  int first = -1;
+  best = -1;
+  for (uint32_t i = 0; ok && i < k_tune_steps; i++) {
+    swd_min::set_clock_config(swd_min::ClockConfig{k_tune_half_periods_us[i], tuned.bulk_half_period_us});
+    if (tune_connect_ok(SWD_TUNE_CONNECT_TRIALS)) {
+      if (first < 0) first = (int)i;
+      best = (int)i;
+    } else if (best >= 0) {
+      res.connect_failed_half_period_us = k_tune_half_periods_us[i];
+      break;
+    }
+  }
+  while (ok && best >= first && best >= 0) {
+    swd_min::set_clock_config(swd_min::ClockConfig{k_tune_half_periods_us[best], tuned.bulk_half_period_us});
+    if (tune_connect_ok(2u * SWD_TUNE_CONNECT_TRIALS)) break;
+    res.connect_failed_half_period_us = k_tune_half_periods_us[best--];
+  }
+  if (ok && (best < 0 || best < first)) ok = false;
+  if (ok) {
+    tuned.connect_half_period_us = k_tune_half_periods_us[best];
+    res.config = tuned;
+  }
+
+  // Leave the target connected and halted at the chosen settings (the previous ones on failure).
+  swd_min::set_clock_config(res.config);
+  if (ok) ok = connect_and_halt_under_reset_recovery();
+  swd_min::set_verbose(prev_verbose);
+  if (out) *out = res;
+
+  Serial.printf("SWD clock tune %s: connect=%luus bulk=%luus (half period; failed at connect=%ld bulk=%ld)\n",
+                ok ? "OK" : "FAIL", (unsigned long)res.config.connect_half_period_us,
+                (unsigned long)res.config.bulk_half_period_us,
+                res.connect_failed_half_period_us == UINT32_MAX ? -1L : (long)res.connect_failed_half_period_us,
+                res.bulk_failed_half_period_us == UINT32_MAX ? -1L : (long)res.bulk_failed_half_period_us);
+  return ok;
+}
+
 bool prepare_target_for_normal_run() {
   // Rationale:
   // - During programming/debug we may have left the core halted via DHCSR.C_HALT.
@@ -2,6 +2,11 @@
 
 #include <Arduino.h>
 
+#include "stm32g0_devices.h"
+#include "swd_min.h"
+
+struct product_info_struct;  // include/product_info.h
+
 namespace stm32g0_prog {
 
 // Minimal read-at-offset interface used for filesystem-backed firmware.
@@ -18,10 +23,26 @@ class FirmwareReader {
   virtual bool read_at(uint32_t offset, uint8_t *dst, uint32_t n, uint32_t *out_n) = 0;
 };
 
-// Target specifics (STM32G031)
+// Target specifics common to the STM32G0 family. Sizes depend on the part; see target().
 static constexpr uint32_t FLASH_BASE = 0x08000000u;
-static constexpr uint32_t FLASH_SIZE_BYTES = 0x10000u;     // 64KB
-static constexpr uint32_t FLASH_PAGE_SIZE_BYTES = 2048u;   // 2KB
+static constexpr uint32_t SRAM_BASE = 0x20000000u;
+
+// The attached part, as identified at connect time. `device` points into this translation
+// unit's copy of the table; compare parts by device->dev_id.
+struct Target {
+  const stm32g0_devices::Device *device;
+  uint16_t rev_id;
+  uint32_t flash_size;  // bytes, from the flash size register
+  uint32_t sram_size;   // bytes
+};
+
+// Reads DBGMCU_IDCODE and the flash size register of an attached target and selects its
+// entry in stm32g0_devices::k_devices. The connect functions below call it; they fail for a
+// part that is not in the table (or reports a flash size it cannot have).
+bool identify_target();
+// The part identified by the last connect. Until then (or after reset_and_switch_to_swd()
+// without a connect) it is the table's default device with its largest flash.
+Target target();
 
 // Connect to target over SWD and halt the core.
 bool connect_and_halt();
@@ -62,6 +83,48 @@ bool flash_verify_fast(uint32_t addr, const uint8_t *data, uint32_t len, uint32_
 // Reads 4 bytes at a time (word compare) and pads past EOF with 0xFF.
 bool flash_verify_fast_reader(uint32_t addr, FirmwareReader &r, uint32_t *mismatch_count_out, uint32_t max_report);
 
+// Option bytes (FLASH_OPTR, RM0444 3.4). Field masks for the user options production sets;
+// everything else (boot selection, NRST mode, ...) is left as the part ships.
+static constexpr uint32_t OPTR_RDP_MASK = 0xFFu;
+static constexpr uint32_t OPTR_RDP_LEVEL_0 = 0xAAu;
+static constexpr uint32_t OPTR_RDP_LEVEL_1 = 0xBBu;  // any value other than AA/CC
+static constexpr uint32_t OPTR_RDP_LEVEL_2 = 0xCCu;  // permanent; program_option_bytes() refuses it
+static constexpr uint32_t OPTR_BOR_EN = (1u << 8);
+static constexpr uint32_t OPTR_BORR_LEV_MASK = (3u << 9);   // rising threshold, 0..3
+static constexpr uint32_t OPTR_BORF_LEV_MASK = (3u << 11);  // falling threshold, 0..3
+static constexpr uint32_t OPTR_NRST_STOP = (1u << 13);
+static constexpr uint32_t OPTR_NRST_STDBY = (1u << 14);
+static constexpr uint32_t OPTR_NRST_SHDW = (1u << 15);
+static constexpr uint32_t OPTR_IWDG_SW = (1u << 16);     // 0 = IWDG started by hardware at reset
+static constexpr uint32_t OPTR_IWDG_STOP = (1u << 17);   // 0 = IWDG frozen in Stop
+static constexpr uint32_t OPTR_IWDG_STDBY = (1u << 18);  // 0 = IWDG frozen in Standby
+static constexpr uint32_t OPTR_WWDG_SW = (1u << 19);     // 0 = WWDG started by hardware at reset
+
+struct OptionBytesResult {
+  uint32_t optr_before;
+  uint32_t optr_after;
+  bool changed;          // false: OPTR already matched, nothing was programmed
+  uint32_t program_us;   // unlock + OPTR write + OPTSTRT until BSY1 clears
+  uint32_t reload_us;    // OBL_LAUNCH, re-attach and OPTR read-back
+};
+
+// Reads FLASH_OPTR from an attached target.
+bool read_option_bytes(uint32_t *optr);
+// Prints the decoded OPTR fields (one line).
+void print_option_bytes(uint32_t optr);
+
+// Sets the OPTR bits in `mask` to `value` on an attached target, in the same SWD session:
+// unlock (KEYR, then OPTKEYR), write OPTR, OPTSTRT and wait for BSY1, then OBL_LAUNCH. The
+// option reload resets the part and drops the SWD link, so this re-attaches with
+// connect_and_halt_under_reset_recovery() and checks the reloaded OPTR. Leaves the core
+// halted. If OPTR already matches, nothing is written (result->changed = false).
+//
+// Anything that reads flash over SWD (verify, product info, dumps) must come first: from RDP
+// level 1 on, debugger access to flash faults. Setting RDP back to level 0 mass-erases the
+// flash. Refuses RDP level 2, and mask bits the identified part does not have
+// (Device::optr_user_mask).
+bool program_option_bytes(uint32_t mask, uint32_t value, OptionBytesResult *result);
+
 // Read arbitrary bytes from target memory via SWD/AHB-AP.
 // This is used for flash reads (e.g. addr=FLASH_BASE) but is generic.
 //
@@ -72,11 +135,105 @@ bool flash_verify_fast_reader(uint32_t addr, FirmwareReader &r, uint32_t *mismat
 //   FLASH_OPTR at absolute address 0x40022020 (FLASH_R_BASE + 0x20), and store it.
 bool flash_read_bytes(uint32_t addr, uint8_t *out, uint32_t len, uint32_t *flash_optr_out = nullptr);
 
+// Read the product_info_struct the firmware image carries at PRODUCT_INFO_MEMORY_LOCATION
+// (see include/product_info.h) with a single block read. Same preconditions as
+// flash_read_bytes().
+bool read_product_info(product_info_struct *out);
+
+// Memory dump (failure analysis of returned units): a DumpHeader, then `size` raw bytes from
+// `base`. All fields little-endian; the header is 64 bytes so tools can skip it blindly.
+static constexpr uint32_t DUMP_MAGIC = 0x504D5544u;  // "DUMP" at offset 0
+static constexpr uint16_t DUMP_VERSION = 2u;  // 2: `flags` (was reserved, zero)
+// DumpHeader::flags
+static constexpr uint32_t DUMP_FLAG_NO_PRODUCT_INFO = (1u << 0);  // flash unreadable (e.g. RDP level 1)
+
+struct DumpHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t header_size;   // sizeof(DumpHeader)
+  uint32_t base;          // first dumped address
+  uint32_t size;          // bytes after the header
+  uint32_t idcode;        // DP IDCODE
+  uint32_t optr;          // FLASH_OPTR (RDP level in [7:0])
+  uint32_t dhcsr;         // DHCSR when the dump started (S_HALT expected)
+  uint32_t unix_time;     // wall clock supplied by the requester (0 = unknown; the station has no RTC)
+  uint32_t uptime_ms;     // station millis()
+  uint32_t serial;        // product_info_struct in flash (0xFFFFFFFF on a blank part)
+  uint64_t unique_id;
+  uint8_t model_code[8];
+  uint32_t flags;         // DUMP_FLAG_*
+  uint32_t reserved;
+};
+static_assert(sizeof(DumpHeader) == 64, "DumpHeader layout");
+
+// Fills `out` for a dump of [base, base+size) from an attached, halted target (see
+// flash_read_bytes() for the preconditions). Fails on an SWD error reading IDCODE, FLASH_OPTR
+// or DHCSR. The product_info read is best-effort: if the flash is unreadable (RDP level 1),
+// serial/unique_id/model_code stay zero and DUMP_FLAG_NO_PRODUCT_INFO is set.
+bool read_dump_header(uint32_t base, uint32_t size, uint32_t unix_time, DumpHeader *out);
+
+// Streams `size` bytes at `base` (both word aligned) to `out` in 1KB pipelined bursts
+// (TAR + 256 DRW reads + RDBUFF each), so nothing larger than one burst is buffered.
+// Fails on an SWD error or a short write to `out`; *bytes_out says how far it got.
+bool dump_memory(uint32_t base, uint32_t size, Print &out, uint32_t *bytes_out = nullptr);
+
 // Read the Program Counter register to verify core is running/accessible.
 // Reads PC multiple times to show it's changing (proves core is executing).
 // Returns true if successful.
 bool read_program_counter();
 
+// Core register access (DCRSR/DCRDR) on an attached, halted core; none of these halt it.
+// Register numbers are DCRSR.REGSEL: 0..12 = R0..R12, 13 = SP (the active stack pointer),
+// 14 = LR, 15 = PC (debug return address), then the ones below.
+static constexpr uint8_t CORE_REG_SP = 13u;
+static constexpr uint8_t CORE_REG_LR = 14u;
+static constexpr uint8_t CORE_REG_PC = 15u;
+static constexpr uint8_t CORE_REG_XPSR = 16u;
+static constexpr uint8_t CORE_REG_MSP = 17u;
+static constexpr uint8_t CORE_REG_PSP = 18u;
+static constexpr uint8_t CORE_REG_CONTROL_PRIMASK = 20u;  // CONTROL in [31:24], PRIMASK in [0]
+
+struct CoreRegisters {
+  uint32_t r[16];  // R0..R12, SP, LR, PC
+  uint32_t xpsr;
+  uint32_t msp;
+  uint32_t psp;
+  uint32_t control_primask;
+};
+
+// One AHB-AP session for the whole transfer: TAR stays on DHCSR and DHCSR/DCRSR/DCRDR are
+// reached through the banked data registers, with S_REGRDY polled in the same posted-read
+// pipeline as the data (a register costs 4 SWD transfers when the core is ready at once).
+// Returns false on an SWD error or if S_REGRDY does not come (core not halted).
+bool read_core_register(uint8_t regsel, uint32_t *out);
+bool write_core_register(uint8_t regsel, uint32_t val);
+// Snapshot of the whole register file (e.g. a crashed DUT for failure analysis).
+bool read_core_registers(CoreRegisters *out);
+// Loads the register file (e.g. to start code in SRAM): MSP, PSP, CONTROL/PRIMASK, R0..R12,
+// LR, PC and xPSR, in that order. r[13] is not written separately; SP is whichever of MSP/PSP
+// CONTROL selects.
+bool write_core_registers(const CoreRegisters &regs);
+// Prints a register snapshot (one line per group).
+void print_core_registers(const CoreRegisters &regs);
+
+// SWD clock auto-tune. Walks the SWCLK half period from slow to fast
+// (k_tune_half_periods_us in stm32g0_prog.cpp) and keeps the fastest setting that passes:
+// - bulk: IDCODE + SRAM write/read pattern rounds (overwrites SRAM_TUNE_BYTES at
+//   0x20000000 on a halted core);
+// - connect: repeated connect_and_halt_under_reset_recovery() that must leave the core halted.
+// The first failure (ACK/parity error, wrong IDCODE, pattern mismatch) after a pass ends the
+// walk; the winner must then pass a longer confirmation run or the tuner backs off one step.
+// Applies the result with swd_min::set_clock_config() and leaves the core halted. On failure
+// nothing changes: the previous settings stay in use and come back in `config`.
+struct ClockTuneResult {
+  swd_min::ClockConfig config;
+  // Setting whose failure ended the walk or the confirmation run (UINT32_MAX: none; the
+  // fastest setting passed).
+  uint32_t bulk_failed_half_period_us;
+  uint32_t connect_failed_half_period_us;
+};
+bool tune_swd_clock(ClockTuneResult *out);
+
 // Best-effort helper to let the target run normally after we've been debugging.
 // Clears vector-catch-on-reset (DEMCR.VC_CORERESET) and clears core halt request
 // (DHCSR.C_HALT). Leaves debug enabled (DHCSR.C_DEBUGEN) so we can still re-attach
@@ -0,0 +1,64 @@
+#include "swd_clock_store.h"
+
+namespace swd_clock_store {
+
+static constexpr const char *k_path = "/swd_clock.txt";
+
+// Anything slower than this is a typo, not a tuning result.
+static constexpr uint32_t k_max_half_period_us = 100u;
+
+const char *path() { return k_path; }
+
+static bool parse_value(const String &line, const char *key, uint32_t *out) {
+  const String prefix = String(key) + "=";
+  if (!line.startsWith(prefix)) return false;
+  const String digits = line.substring(prefix.length());
+  if (digits.length() == 0) return false;
+  for (size_t i = 0; i < digits.length(); i++) {
+    if (digits[i] < '0' || digits[i] > '9') return false;
+  }
+  const uint32_t v = (uint32_t)digits.toInt();
+  if (v > k_max_half_period_us) return false;
+  *out = v;
+  return true;
+}
+
+bool load(fs::FS &fs, swd_min::ClockConfig *out) {
+  if (!out) return false;
+  File f = fs.open(k_path, "r");
+  if (!f) return false;
+
+  bool have_connect = false;
+  bool have_bulk = false;
+  swd_min::ClockConfig cfg = *out;
+  while (f.available()) {
+    String line = f.readStringUntil('\n');
+    line.replace("\r", "");
+    line.trim();
+    if (parse_value(line, "connect_half_period_us", &cfg.connect_half_period_us)) have_connect = true;
+    if (parse_value(line, "bulk_half_period_us", &cfg.bulk_half_period_us)) have_bulk = true;
+  }
+  f.close();
+
+  if (!have_connect || !have_bulk) return false;
+  *out = cfg;
+  return true;
+}
+
+bool save(fs::FS &fs, const swd_min::ClockConfig &cfg) {
+  File f = fs.open(k_path, "w");
+  if (!f) return false;
+  char buf[80];
+  const int n = snprintf(buf, sizeof(buf), "connect_half_period_us=%lu\nbulk_half_period_us=%lu\n",
+                         (unsigned long)cfg.connect_half_period_us, (unsigned long)cfg.bulk_half_period_us);
+  if (n <= 0 || (size_t)n >= sizeof(buf)) {
+    f.close();
+    return false;
+  }
+  const size_t w = f.print(buf);
+  f.flush();
+  f.close();
+  return w == (size_t)n;
+}
+
+}  // namespace swd_clock_store
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <FS.h>
+
+#include "swd_min.h"
+
+namespace swd_clock_store {
+
+// Per-station SWD clock settings (found by stm32g0_prog::tune_swd_clock()).
+// Cable length and fixture differ between stations, so each jig keeps its own in SPIFFS:
+//   connect_half_period_us=<N>
+//   bulk_half_period_us=<N>
+
+const char *path();
+
+// Returns false if there is no (valid) file; *out is left unchanged then.
+bool load(fs::FS &fs, swd_min::ClockConfig *out);
+bool save(fs::FS &fs, const swd_min::ClockConfig &cfg);
+
+}  // namespace swd_clock_store
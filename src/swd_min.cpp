@@ -4,6 +4,25 @@
 #include "driver/gpio.h"
 #endif
 
+#if defined(SWD_SIM_TXN_BACKEND)
+// Host simulator only: DP/AP transfers go straight to the simulated target's register
+// model instead of being bit-banged (see sim/swd_txn_backend.h). The idle/reset helpers
+// below only account for the SWCLK cycles they would have produced.
+#include "swd_txn_backend.h"
+
+// The timing knobs come from the current simulator Runtime unless fixed with -D, so one
+// simulator binary can sweep them (sim/param_sweep_main.cpp).
+#ifndef SWD_HALF_PERIOD_US
+#define SWD_HALF_PERIOD_US (sim::txn::timing().half_period_us)
+#endif
+#ifndef SWD_POST_IDLE_LOW_CYCLES
+#define SWD_POST_IDLE_LOW_CYCLES (sim::txn::timing().post_idle_low_cycles)
+#endif
+#ifndef SWD_REQ_IDLE_LOW_BITS
+#define SWD_REQ_IDLE_LOW_BITS (sim::txn::timing().req_idle_low_bits)
+#endif
+#endif
+
 #include "tee_log.h"
 
 // Route all Serial prints in this file into the RAM terminal buffer as well.
@@ -11,17 +30,52 @@
 
 namespace swd_min {
 
-static Pins g_pins;
-// User-facing verbose mode (toggled by 'd').
-static bool g_verbose = true;
+#if defined(SWD_MIN_EXTERNAL_CONTEXT)
+// Host simulator: context() is provided by the simulated jig (sim::Runtime).
+static inline Context &ctx() { return context(); }
+#else
+static Context g_context;
+Context &context() { return g_context; }
+static inline Context &ctx() { return g_context; }
+#endif
 
 // Raw low-level packet tracing is intentionally OFF (too noisy for humans).
 // If you need packet-level troubleshooting later, add a command to toggle this.
 static constexpr bool k_verbose_raw = false;
-static bool g_nrst_last_high = true;
 
-void set_verbose(bool enabled) { g_verbose = enabled; }
-bool verbose_enabled() { return g_verbose; }
+void set_verbose(bool enabled) { ctx().verbose = enabled; }
+bool verbose_enabled() { return ctx().verbose; }
+
+void set_clock_config(const ClockConfig &cfg) {
+  ctx().clock = cfg;
+  use_clock(ctx().clock_phase);
+}
+
+ClockConfig clock_config() { return ctx().clock; }
+
+void use_clock(ClockPhase phase) {
+  ctx().clock_phase = phase;
+  ctx().half_period_us =
+      (phase == ClockPhase::Bulk) ? ctx().clock.bulk_half_period_us : ctx().clock.connect_half_period_us;
+}
+
+uint32_t half_period_us() { return ctx().half_period_us; }
+
+void set_half_period_us(uint32_t half_period_us) { ctx().half_period_us = half_period_us; }
+
+void set_trace_sink(TraceSink sink, void *user) {
+  ctx().trace_sink = sink;
+  ctx().trace_user = user;
+}
+
+// SWCLK cycle accounting for the transaction trace (compiled out unless SWD_MIN_TRACE).
+static inline void trace_count_clocks(uint32_t n) {
+#if defined(SWD_MIN_TRACE)
+  ctx().trace_clocks += n;
+#else
+  (void)n;
+#endif
+}
 
 #ifndef SWD_HALF_PERIOD_US
 // Fast timing for tight window after NRST release.
@@ -30,29 +84,32 @@ bool verbose_enabled() { return g_verbose; }
 #define SWD_HALF_PERIOD_US 1
 #endif
 
-static inline void swd_delay() { delayMicroseconds(SWD_HALF_PERIOD_US); }
+static inline void swd_delay() {
+  const uint32_t us = ctx().half_period_us;
+  if (us) delayMicroseconds(us);
+}
 
 static inline void swclk_low() {
 #if defined(ARDUINO_ARCH_ESP32)
-  gpio_set_level((gpio_num_t)g_pins.swclk, 0);
+  gpio_set_level((gpio_num_t)ctx().pins.swclk, 0);
 #else
-  digitalWrite(g_pins.swclk, LOW);
+  digitalWrite(ctx().pins.swclk, LOW);
 #endif
 }
 
 static inline void swclk_high() {
 #if defined(ARDUINO_ARCH_ESP32)
-  gpio_set_level((gpio_num_t)g_pins.swclk, 1);
+  gpio_set_level((gpio_num_t)ctx().pins.swclk, 1);
 #else
-  digitalWrite(g_pins.swclk, HIGH);
+  digitalWrite(ctx().pins.swclk, HIGH);
 #endif
 }
 
 static inline void swdio_output() {
 #if defined(ARDUINO_ARCH_ESP32)
-  gpio_set_direction((gpio_num_t)g_pins.swdio, GPIO_MODE_OUTPUT);
+  gpio_set_direction((gpio_num_t)ctx().pins.swdio, GPIO_MODE_OUTPUT);
 #else
-  pinMode(g_pins.swdio, OUTPUT);
+  pinMode(ctx().pins.swdio, OUTPUT);
 #endif
 }
 
@@ -62,26 +119,26 @@ static inline void swdio_input_pullup() {
   // that the line is truly released (mid-rail behavior).
   // NOTE: name kept as-is; simulator may override how INPUT_PULLDOWN is interpreted.
 #if defined(ARDUINO_ARCH_ESP32)
-  gpio_set_direction((gpio_num_t)g_pins.swdio, GPIO_MODE_INPUT);
-  gpio_set_pull_mode((gpio_num_t)g_pins.swdio, GPIO_PULLDOWN_ONLY);
+  gpio_set_direction((gpio_num_t)ctx().pins.swdio, GPIO_MODE_INPUT);
+  gpio_set_pull_mode((gpio_num_t)ctx().pins.swdio, GPIO_PULLDOWN_ONLY);
 #else
-  pinMode(g_pins.swdio, INPUT_PULLDOWN);
+  pinMode(ctx().pins.swdio, INPUT_PULLDOWN);
 #endif
 }
 
 static inline void swdio_write(uint8_t bit) {
 #if defined(ARDUINO_ARCH_ESP32)
-  gpio_set_level((gpio_num_t)g_pins.swdio, bit ? 1 : 0);
+  gpio_set_level((gpio_num_t)ctx().pins.swdio, bit ? 1 : 0);
 #else
-  digitalWrite(g_pins.swdio, bit ? HIGH : LOW);
+  digitalWrite(ctx().pins.swdio, bit ? HIGH : LOW);
 #endif
 }
 
 static inline uint8_t swdio_read() {
 #if defined(ARDUINO_ARCH_ESP32)
-  return (uint8_t)gpio_get_level((gpio_num_t)g_pins.swdio);
+  return (uint8_t)gpio_get_level((gpio_num_t)ctx().pins.swdio);
 #else
-  return (uint8_t)digitalRead(g_pins.swdio);
+  return (uint8_t)digitalRead(ctx().pins.swdio);
 #endif
 }
 
@@ -90,9 +147,9 @@ static inline void ensure_swd_pin_modes() {
   // Any subsequent SWD activity must re-assert OUTPUT mode (especially SWCLK), otherwise the bus will appear dead
   // and we'll sample garbage ACK values (often 0b111).
 #if defined(ARDUINO_ARCH_ESP32)
-  gpio_set_direction((gpio_num_t)g_pins.swclk, GPIO_MODE_OUTPUT);
+  gpio_set_direction((gpio_num_t)ctx().pins.swclk, GPIO_MODE_OUTPUT);
 #else
-  pinMode(g_pins.swclk, OUTPUT);
+  pinMode(ctx().pins.swclk, OUTPUT);
 #endif
   swclk_low();
   swdio_output();
@@ -111,6 +168,7 @@ static inline void pulse_clock() {
   swclk_high();
   swd_delay();
   swclk_low();
+  trace_count_clocks(1);
 }
 
 static inline void write_bit(uint8_t bit) {
@@ -126,6 +184,7 @@ static inline void write_bit(uint8_t bit) {
   swclk_high();
   swd_delay();
   swclk_low();
+  trace_count_clocks(1);
 }
 
 static inline uint8_t read_bit() {
@@ -138,6 +197,7 @@ static inline uint8_t read_bit() {
   swclk_high();
   swd_delay();
   swclk_low();
+  trace_count_clocks(1);
   return swdio_read();
 }
 
@@ -191,6 +251,10 @@ static const char *ap_reg_name(uint8_t addr) {
     case AP_ADDR_TAR: return "TAR";
     case AP_ADDR_DRW: return "DRW";
     case AP_ADDR_IDR: return "IDR";
+    case AP_ADDR_BD0: return "BD0";
+    case AP_ADDR_BD1: return "BD1";
+    case AP_ADDR_BD2: return "BD2";
+    case AP_ADDR_BD3: return "BD3";
     default: return "(unknown)";
   }
 }
@@ -243,6 +307,11 @@ static const char *ap_read_purpose(uint8_t addr) {
 // human-readable lines with: purpose + register + address + data + ACK.
 
 static inline void line_idle_cycles(uint32_t cycles) {
+#if defined(SWD_SIM_TXN_BACKEND)
+  sim::txn::idle_cycles(cycles, /*swdio_high=*/true, ctx().half_period_us);
+  trace_count_clocks(cycles);
+  return;
+#endif
   // Bus idle: host drives SWDIO high.
   swdio_output();
   swdio_write(1);
@@ -255,6 +324,11 @@ static inline void line_idle_cycles_low(uint32_t cycles) {
   // Bus idle/flush (low): host drives SWDIO low.
   // This is useful between transfers because it is unambiguous and cannot be
   // confused with the SWD line-reset sequence (which is triggered by long runs of 1s).
+#if defined(SWD_SIM_TXN_BACKEND)
+  sim::txn::idle_cycles(cycles, /*swdio_high=*/false, ctx().half_period_us);
+  trace_count_clocks(cycles);
+  return;
+#endif
   swdio_output();
   swdio_write(0);
   for (uint32_t i = 0; i < cycles; i++) {
@@ -268,12 +342,20 @@ static inline void line_idle_cycles_low(uint32_t cycles) {
 #define SWD_POST_IDLE_LOW_CYCLES 8
 #endif
 
+static void shadow_clear();
+
 static inline void line_reset() {
   // >50 cycles with SWDIO high.
   line_idle_cycles(80);
+  shadow_clear();
 }
 
 static inline void jtag_to_swd_sequence() {
+#if defined(SWD_SIM_TXN_BACKEND)
+  sim::txn::jtag_to_swd(ctx().half_period_us);
+  trace_count_clocks(16);
+  return;
+#endif
   // Send 16-bit sequence 0xE79E, LSB-first.
   swdio_output();
   const uint16_t seq = 0xE79E;
@@ -300,7 +382,34 @@ static inline uint8_t make_request(uint8_t apndp, uint8_t rnw, uint8_t addr) {
   return req;
 }
 
-static bool dp_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_enable, bool post_idle) {
+#ifndef SWD_REQ_IDLE_LOW_BITS
+// Empirical quirk (seen with ST-LINK/V2 waveforms): insert idle-low bits
+// immediately before the request start bit.
+// Tunable so we can match real targets/probes.
+#define SWD_REQ_IDLE_LOW_BITS 2
+#endif
+
+#if defined(SWD_SIM_TXN_BACKEND)
+static inline uint8_t txn_transfer(uint8_t apndp, uint8_t rnw, uint8_t addr, uint32_t *data, uint8_t *parity) {
+  const uint8_t ack =
+      sim::txn::transfer(apndp != 0, rnw != 0, addr, data, parity, SWD_REQ_IDLE_LOW_BITS, ctx().half_period_us);
+  // Same cost model as the backend: request idle + request + ACK + turnaround (+ data + parity).
+  trace_count_clocks((uint32_t)SWD_REQ_IDLE_LOW_BITS + 8u + 3u + 2u + (ack == ACK_OK ? 33u : 0u));
+  return ack;
+}
+#endif
+
+static bool dp_read_xfer(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_enable, bool post_idle) {
+#if defined(SWD_SIM_TXN_BACKEND)
+  uint32_t v = 0;
+  uint8_t p_rx = 0;
+  const uint8_t ack = txn_transfer(/*APnDP=*/0, /*RnW=*/1, addr, &v, &p_rx);
+  if (ack_out) *ack_out = ack;
+  if (ack != ACK_OK || p_rx != parity_u32(v)) {
+    if (post_idle) line_idle_cycles_low(SWD_POST_IDLE_LOW_CYCLES);
+    return false;
+  }
+#else
   const uint8_t req = make_request(/*APnDP=*/0, /*RnW=*/1, addr);
 
   (void)req; // request byte is not printed (not useful for humans)
@@ -309,13 +418,6 @@ static bool dp_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_
   swdio_output();
   swdio_write(1); // ensure high between transfers
 
-#ifndef SWD_REQ_IDLE_LOW_BITS
-  // Empirical quirk (seen with ST-LINK/V2 waveforms): insert idle-low bits
-  // immediately before the request start bit.
-  // Tunable so we can match real targets/probes.
-#define SWD_REQ_IDLE_LOW_BITS 2
-#endif
-
   for (int i = 0; i < (int)SWD_REQ_IDLE_LOW_BITS; i++) {
     write_bit(0);
   }
@@ -381,9 +483,10 @@ static bool dp_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_
     Serial.printf("SWD DP READ  addr=0x%02X  data=0x%08lX  parity=%u\n", (unsigned)addr, (unsigned long)v,
                   (unsigned)p_rx);
   }
+#endif
 
   if (val_out) *val_out = v;
-  if (g_verbose && log_enable) {
+  if (ctx().verbose && log_enable) {
     Serial.printf("%s (DP READ %s addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", dp_read_purpose(addr),
                   dp_reg_name_read(addr), (unsigned)addr, (unsigned long)v, (unsigned)ack, ack_to_str(ack));
   }
@@ -391,7 +494,17 @@ static bool dp_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_
   return true;
 }
 
-static bool dp_write(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable, bool post_idle) {
+static bool dp_write_xfer(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable, bool post_idle) {
+#if defined(SWD_SIM_TXN_BACKEND)
+  uint32_t wdata = val;
+  uint8_t wparity = parity_u32(val);
+  const uint8_t ack = txn_transfer(/*APnDP=*/0, /*RnW=*/0, addr, &wdata, &wparity);
+  if (ack_out) *ack_out = ack;
+  if (ack != ACK_OK) {
+    if (post_idle) line_idle_cycles_low(SWD_POST_IDLE_LOW_CYCLES);
+    return false;
+  }
+#else
   const uint8_t req = make_request(/*APnDP=*/0, /*RnW=*/0, addr);
 
   (void)req; // request byte is not printed (not useful for humans)
@@ -443,9 +556,10 @@ static bool dp_write(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enab
     write_bit((val >> i) & 1u);
   }
   write_bit(parity_u32(val));
+#endif
 
   // Post-transfer idle/flush (low)
-  if (g_verbose && log_enable) {
+  if (ctx().verbose && log_enable) {
     Serial.printf("%s (DP WRITE %s addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", dp_write_purpose(addr, val),
                   dp_reg_name_write(addr), (unsigned)addr, (unsigned long)val, (unsigned)ack, ack_to_str(ack));
   }
@@ -453,9 +567,19 @@ static bool dp_write(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enab
   return true;
 }
 
-static bool ap_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_enable, bool post_idle) {
+static bool ap_read_xfer(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_enable, bool post_idle) {
   // AP reads are posted; caller should read DP RDBUFF to get the value.
   // We'll perform AP read request, then DP RDBUFF read.
+#if defined(SWD_SIM_TXN_BACKEND)
+  uint32_t v = 0;
+  uint8_t p_rx = 0;
+  const uint8_t ack = txn_transfer(/*APnDP=*/1, /*RnW=*/1, addr, &v, &p_rx);
+  if (ack_out) *ack_out = ack;
+  if (ack != ACK_OK || p_rx != parity_u32(v)) {
+    if (post_idle) line_idle_cycles_low(SWD_POST_IDLE_LOW_CYCLES);
+    return false;
+  }
+#else
   const uint8_t req = make_request(/*APnDP=*/1, /*RnW=*/1, addr);
 
   (void)req; // request byte is not printed (not useful for humans)
@@ -514,11 +638,12 @@ static bool ap_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_
     Serial.printf("SWD AP READ  addr=0x%02X  data(stale)=0x%08lX  parity=%u\n", (unsigned)addr, (unsigned long)v,
                   (unsigned)p_rx);
   }
+#endif
 
   // The value returned here is NOT the true AP register value (posted read semantics);
   // it is the stale read buffer. Caller should read DP RDBUFF.
   if (val_out) *val_out = v;
-  if (g_verbose && log_enable) {
+  if (ctx().verbose && log_enable) {
     Serial.printf("%s (AP READ %s addr=0x%02X, data(stale)=0x%08lX, ACK=%u %s)\n", ap_read_purpose(addr),
                   ap_reg_name(addr), (unsigned)addr, (unsigned long)v, (unsigned)ack, ack_to_str(ack));
   }
@@ -526,7 +651,17 @@ static bool ap_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_
   return true;
 }
 
-static bool ap_write_internal(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable, bool post_idle) {
+static bool ap_write_xfer(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable, bool post_idle) {
+#if defined(SWD_SIM_TXN_BACKEND)
+  uint32_t wdata = val;
+  uint8_t wparity = parity_u32(val);
+  const uint8_t ack = txn_transfer(/*APnDP=*/1, /*RnW=*/0, addr, &wdata, &wparity);
+  if (ack_out) *ack_out = ack;
+  if (ack != ACK_OK) {
+    if (post_idle) line_idle_cycles_low(SWD_POST_IDLE_LOW_CYCLES);
+    return false;
+  }
+#else
   const uint8_t req = make_request(/*APnDP=*/1, /*RnW=*/0, addr);
 
   (void)req; // request byte is not printed (not useful for humans)
@@ -567,9 +702,10 @@ static bool ap_write_internal(uint8_t addr, uint32_t val, uint8_t *ack_out, bool
 
   // Leave line in a known idle-low state.
   swdio_write(0);
+#endif
 
   // Post-transfer idle/flush (low)
-  if (g_verbose && log_enable) {
+  if (ctx().verbose && log_enable) {
     Serial.printf("%s (AP WRITE %s addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", ap_write_purpose(addr, val),
                   ap_reg_name(addr), (unsigned)addr, (unsigned long)val, (unsigned)ack, ack_to_str(ack));
   }
@@ -577,6 +713,159 @@ static bool ap_write_internal(uint8_t addr, uint32_t val, uint8_t *ack_out, bool
   return true;
 }
 
+// --- DP/AP register shadow (see ApShadow in swd_min.h) ---
+
+static void shadow_clear() {
+  ApShadow &s = ctx().shadow;
+  if (s.select_valid || s.csw_valid || s.tar_valid) ctx().shadow_stats.invalidations++;
+  s = ApShadow{};
+}
+
+// SELECT = APSEL 0, APBANKSEL 0: AP addresses 0x00/0x04/0x0C are CSW/TAR/DRW.
+static inline bool shadow_ahb_bank0() {
+  const ApShadow &s = ctx().shadow;
+  return s.select_valid && (s.select & 0xFF0000F0u) == 0;
+}
+
+static void shadow_advance_tar() {
+  ApShadow &s = ctx().shadow;
+  if (!s.tar_valid) return;
+  if (!s.csw_valid) {
+    s.tar_valid = false;
+    return;
+  }
+  // CSW.AddrInc: 0 = off, 1 = single (by Size), 2 = packed (by 4).
+  const uint32_t inc = (s.csw >> 4) & 0x3u;
+  if (inc == 0) return;
+  const uint32_t step = (inc == 1) ? (1u << (s.csw & 0x7u)) : (inc == 2) ? 4u : 0u;
+  if (step == 0 || step > 4u) {
+    s.tar_valid = false;
+    return;
+  }
+  s.tar += step;
+  // Auto-increment is only guaranteed within a 1KB block (see AhbApSession::write32()).
+  if ((s.tar & 0x3FFu) < step) s.tar_valid = false;
+}
+
+// Called for every transfer after it completed (or failed).
+static void shadow_note(uint8_t apndp, uint8_t rnw, uint8_t addr, uint32_t val, bool ok) {
+  ApShadow &s = ctx().shadow;
+  ShadowStats &st = ctx().shadow_stats;
+  if (!apndp) {
+    if (!rnw && addr == DP_ADDR_SELECT) st.select_writes++;
+    if (!ok) {
+      shadow_clear();
+    } else if (!rnw && addr == DP_ADDR_SELECT) {
+      s.select_valid = true;
+      s.select = val;
+    }
+    return;
+  }
+  const bool bank0 = shadow_ahb_bank0();
+  if (bank0 && !rnw && addr == AP_ADDR_CSW) st.csw_writes++;
+  if (bank0 && !rnw && addr == AP_ADDR_TAR) st.tar_writes++;
+  if (!ok) {
+    // WAIT/FAULT/parity: the AP state is no longer known.
+    shadow_clear();
+    return;
+  }
+  if (!bank0) return;
+  if (addr == AP_ADDR_CSW && !rnw) {
+    s.csw_valid = true;
+    s.csw = val;
+  } else if (addr == AP_ADDR_TAR && !rnw) {
+    s.tar_valid = true;
+    s.tar = val;
+  } else if (addr == AP_ADDR_DRW) {
+    shadow_advance_tar();
+  }
+}
+
+#if defined(SWD_MIN_TRACE)
+// One trace record per transfer; `start_clocks` is ctx().trace_clocks before the transfer.
+static void trace_emit(uint8_t apndp, uint8_t rnw, uint8_t addr, uint32_t value, uint8_t ack, bool ok,
+                       bool post_idle, uint64_t start_clocks) {
+  Context &c = ctx();
+  if (c.trace_sink) {
+    TraceRecord rec;
+    rec.t_us = (uint32_t)micros();
+    rec.apndp = apndp;
+    rec.rnw = rnw;
+    rec.addr = addr;
+    rec.ack = ack;
+    rec.reg = apndp ? ap_reg_name(addr) : (rnw ? dp_reg_name_read(addr) : dp_reg_name_write(addr));
+    rec.value = value;
+    rec.ok = ok;
+    rec.clocks = (uint32_t)(c.trace_clocks - start_clocks);
+    rec.idle_clocks = (uint32_t)SWD_REQ_IDLE_LOW_BITS + (post_idle ? (uint32_t)SWD_POST_IDLE_LOW_CYCLES : 0u);
+    rec.gap_clocks = (uint32_t)(start_clocks - c.trace_last_clocks);
+    c.trace_sink(rec, c.trace_user);
+  }
+  c.trace_last_clocks = c.trace_clocks;
+}
+#endif
+
+// Traced, shadow-tracking entry points for the transfer primitives above.
+static bool dp_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_enable, bool post_idle) {
+  uint32_t v = 0;
+#if defined(SWD_MIN_TRACE)
+  const uint64_t start = ctx().trace_clocks;
+  uint8_t ack = 0;
+  const bool ok = dp_read_xfer(addr, &v, &ack, log_enable, post_idle);
+  if (ack_out) *ack_out = ack;
+  trace_emit(/*APnDP=*/0, /*RnW=*/1, addr, v, ack, ok, post_idle, start);
+#else
+  const bool ok = dp_read_xfer(addr, &v, ack_out, log_enable, post_idle);
+#endif
+  if (ok && val_out) *val_out = v;
+  shadow_note(/*APnDP=*/0, /*RnW=*/1, addr, v, ok);
+  return ok;
+}
+
+static bool dp_write(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable, bool post_idle) {
+#if defined(SWD_MIN_TRACE)
+  const uint64_t start = ctx().trace_clocks;
+  uint8_t ack = 0;
+  const bool ok = dp_write_xfer(addr, val, &ack, log_enable, post_idle);
+  if (ack_out) *ack_out = ack;
+  trace_emit(/*APnDP=*/0, /*RnW=*/0, addr, val, ack, ok, post_idle, start);
+#else
+  const bool ok = dp_write_xfer(addr, val, ack_out, log_enable, post_idle);
+#endif
+  shadow_note(/*APnDP=*/0, /*RnW=*/0, addr, val, ok);
+  return ok;
+}
+
+static bool ap_read(uint8_t addr, uint32_t *val_out, uint8_t *ack_out, bool log_enable, bool post_idle) {
+  uint32_t v = 0;
+#if defined(SWD_MIN_TRACE)
+  const uint64_t start = ctx().trace_clocks;
+  uint8_t ack = 0;
+  const bool ok = ap_read_xfer(addr, &v, &ack, log_enable, post_idle);
+  if (ack_out) *ack_out = ack;
+  trace_emit(/*APnDP=*/1, /*RnW=*/1, addr, v, ack, ok, post_idle, start);
+#else
+  const bool ok = ap_read_xfer(addr, &v, ack_out, log_enable, post_idle);
+#endif
+  if (ok && val_out) *val_out = v;
+  shadow_note(/*APnDP=*/1, /*RnW=*/1, addr, v, ok);
+  return ok;
+}
+
+static bool ap_write_internal(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable, bool post_idle) {
+#if defined(SWD_MIN_TRACE)
+  const uint64_t start = ctx().trace_clocks;
+  uint8_t ack = 0;
+  const bool ok = ap_write_xfer(addr, val, &ack, log_enable, post_idle);
+  if (ack_out) *ack_out = ack;
+  trace_emit(/*APnDP=*/1, /*RnW=*/0, addr, val, ack, ok, post_idle, start);
+#else
+  const bool ok = ap_write_xfer(addr, val, ack_out, log_enable, post_idle);
+#endif
+  shadow_note(/*APnDP=*/1, /*RnW=*/0, addr, val, ok);
+  return ok;
+}
+
 static bool ap_write(uint8_t addr, uint32_t val, uint8_t *ack_out, bool log_enable) {
   return ap_write_internal(addr, val, ack_out, log_enable, /*post_idle=*/true);
 }
@@ -586,14 +875,21 @@ static bool ap_write_fast(uint8_t addr, uint32_t val, uint8_t *ack_out) {
 }
 
 void begin(const Pins &pins) {
-  g_pins = pins;
-
-  pinMode(g_pins.swclk, OUTPUT);
+  ctx().pins = pins;
+  ctx().trace_clocks = 0;
+  ctx().trace_last_clocks = 0;
+  ctx().shadow = ApShadow{};
+  ctx().mem_caps = MemApCaps{};
+  ctx().target_id = TargetId{};
+  ctx().clock = ClockConfig{(uint32_t)SWD_HALF_PERIOD_US, (uint32_t)SWD_HALF_PERIOD_US};
+  use_clock(ClockPhase::Connect);
+
+  pinMode(ctx().pins.swclk, OUTPUT);
   swclk_low();
 
-  pinMode(g_pins.nrst, OUTPUT);
-  digitalWrite(g_pins.nrst, HIGH);
-  g_nrst_last_high = true;
+  pinMode(ctx().pins.nrst, OUTPUT);
+  digitalWrite(ctx().pins.nrst, HIGH);
+  ctx().nrst_last_high = true;
 
   swdio_output();
   swdio_write(1);
@@ -604,8 +900,8 @@ void release_swd_pins() {
   // them without fighting our GPIO drivers.
   //
   // NOTE: this intentionally does not touch NRST.
-  pinMode(g_pins.swclk, INPUT);
-  pinMode(g_pins.swdio, INPUT);
+  pinMode(ctx().pins.swclk, INPUT);
+  pinMode(ctx().pins.swdio, INPUT);
 }
 
 void release_swd_and_nrst_pins() {
@@ -613,32 +909,38 @@ void release_swd_and_nrst_pins() {
   // This includes NRST so the jig does not hold the target in reset or fight any
   // external pull-ups.
   release_swd_pins();
-  pinMode(g_pins.nrst, INPUT);
+  pinMode(ctx().pins.nrst, INPUT);
 }
 
 void set_nrst(bool asserted) {
   // asserted=true => drive NRST low
   const bool next_high = asserted ? false : true;
-  if (next_high != g_nrst_last_high) {
+  if (next_high != ctx().nrst_last_high) {
     Serial.printf("---------------------------------------- NRST %s\n", next_high ? "HIGH" : "LOW");
-    g_nrst_last_high = next_high;
+    ctx().nrst_last_high = next_high;
   }
-  digitalWrite(g_pins.nrst, asserted ? LOW : HIGH);
+  digitalWrite(ctx().pins.nrst, asserted ? LOW : HIGH);
+  // Reset (assert or release) may clear the DP/AP state.
+  shadow_clear();
 }
 
 void set_nrst_quiet(bool asserted) {
   // asserted=true => drive NRST low
   const bool next_high = asserted ? false : true;
-  g_nrst_last_high = next_high;
-  digitalWrite(g_pins.nrst, asserted ? LOW : HIGH);
+  ctx().nrst_last_high = next_high;
+  digitalWrite(ctx().pins.nrst, asserted ? LOW : HIGH);
+  shadow_clear();
 }
 
 bool nrst_is_high() {
-  return digitalRead(g_pins.nrst) == HIGH;
+  return digitalRead(ctx().pins.nrst) == HIGH;
 }
 
 void reset_and_switch_to_swd() {
   ensure_swd_pin_modes();
+  ctx().mem_caps = MemApCaps{};
+  ctx().target_id = TargetId{};
+  use_clock(ClockPhase::Connect);
 
   // Hold target in reset during SWD attach. This matches ST-LINK/V2 behavior observed
   // on the bench (NRST held low across the early SWD connect + initial transactions).
@@ -664,7 +966,7 @@ void swd_line_reset() {
   // This is used to re-establish SWD communication after releasing NRST,
   // because on STM32G0 the system reset (NRST release) clears the DP/AP state.
   // See: Perplexity research on STM32G0 reset behavior.
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println(
         "Re-sync SWD physical layer (line reset, JTAG-to-SWD sequence, line reset; NRST is not changed)");
   }
@@ -686,20 +988,20 @@ bool connect_under_reset_and_init() {
   // Based on Perplexity research: "keep doing SWD transactions continuously,
   // then release NRST while the debugger is already active, and keep clocking SWD."
 
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("Connect-under-reset: aggressively re-connect to SWD immediately after releasing NRST");
   }
 
   // NRST should already be LOW at this point (from reset_and_switch_to_swd)
   // Release NRST while immediately starting SWD activity
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("Release reset and immediately re-sync SWD...");
   }
   set_nrst(false);
 
   // Immediately try multiple reconnect attempts with minimal delay
   for (int attempt = 0; attempt < 5; attempt++) {
-    if (g_verbose) {
+    if (ctx().verbose) {
       Serial.printf("Reconnect attempt %d/5: line reset + JTAG-to-SWD + read DP IDCODE\n", attempt + 1);
     }
     // Quick line reset + JTAG-to-SWD
@@ -712,15 +1014,15 @@ bool connect_under_reset_and_init() {
     uint32_t idcode = 0;
     uint8_t ack = 0;
     // Log this read in human format when verbose is enabled.
-    if (dp_read(DP_ADDR_IDCODE, &idcode, &ack, /*log_enable=*/g_verbose, /*post_idle=*/true) && ack == ACK_OK) {
-      if (g_verbose) {
+    if (dp_read(DP_ADDR_IDCODE, &idcode, &ack, /*log_enable=*/ctx().verbose, /*post_idle=*/true) && ack == ACK_OK) {
+      if (ctx().verbose) {
         Serial.printf("Re-connect success on attempt %d (DP IDCODE=0x%08lX)\n", attempt + 1, (unsigned long)idcode);
       }
       // Now do full DP init
       return dp_init_and_power_up();
     }
 
-    if (g_verbose && attempt < 3) {
+    if (ctx().verbose && attempt < 3) {
       Serial.printf("Re-connect attempt %d failed (ACK=%u %s); retrying...\n", attempt + 1, (unsigned)ack,
                     ack_to_str(ack));
     }
@@ -729,7 +1031,7 @@ bool connect_under_reset_and_init() {
     delayMicroseconds(100);
   }
 
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("Re-connect failed: no valid SWD response after releasing NRST");
   }
   return false;
@@ -737,11 +1039,11 @@ bool connect_under_reset_and_init() {
 
 bool attach_and_read_idcode(uint32_t *idcode_out, uint8_t *ack_out) {
   // The two banner lines requested should only appear as part of this convenience helper.
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("Assert reset and switch debug port to SWD mode (line reset + JTAG-to-SWD + line reset)");
   }
   reset_and_switch_to_swd();
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("SWD mode selected; NRST is still asserted (LOW)");
   }
   return read_idcode(idcode_out, ack_out);
@@ -770,7 +1072,7 @@ bool dp_init_and_power_up() {
   // - Wait for ack
   // - Configure lane (optional, ignored)
 
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("DP init: clear errors and request debug/system power-up");
   }
 
@@ -779,14 +1081,14 @@ bool dp_init_and_power_up() {
   {
     uint8_t ack = 0;
     uint32_t idcode = 0;
-    (void)dp_read(DP_ADDR_IDCODE, &idcode, &ack, /*log_enable=*/g_verbose, /*post_idle=*/true);
+    (void)dp_read(DP_ADDR_IDCODE, &idcode, &ack, /*log_enable=*/ctx().verbose, /*post_idle=*/true);
   }
 
   // Clear sticky errors: write ABORT with STKCMPCLR/STKERRCLR/WDERRCLR/ORUNERRCLR
   // (bits 0..4: ORUNERRCLR=4, WDERRCLR=3, STKERRCLR=2, STKCMPCLR=1)
   {
     uint8_t ack = 0;
-    (void)dp_write(DP_ADDR_ABORT, (1u << 4) | (1u << 3) | (1u << 2) | (1u << 1), &ack, /*log_enable=*/g_verbose,
+    (void)dp_write(DP_ADDR_ABORT, (1u << 4) | (1u << 3) | (1u << 2) | (1u << 1), &ack, /*log_enable=*/ctx().verbose,
                    /*post_idle=*/true);
   }
 
@@ -794,8 +1096,8 @@ bool dp_init_and_power_up() {
   const uint32_t req = (1u << 30) | (1u << 28);
   {
     uint8_t ack = 0;
-    if (!dp_write(DP_ADDR_CTRLSTAT, req, &ack, /*log_enable=*/g_verbose, /*post_idle=*/true)) {
-      if (g_verbose) {
+    if (!dp_write(DP_ADDR_CTRLSTAT, req, &ack, /*log_enable=*/ctx().verbose, /*post_idle=*/true)) {
+      if (ctx().verbose) {
         Serial.printf("DP power-up request failed (DP WRITE CTRL/STAT addr=0x%02X, data=0x%08lX, ACK=%u %s)\n",
                       (unsigned)DP_ADDR_CTRLSTAT, (unsigned long)req, (unsigned)ack, ack_to_str(ack));
       }
@@ -810,7 +1112,7 @@ bool dp_init_and_power_up() {
     uint32_t cs = 0;
     uint8_t ack = 0;
     if (!dp_read(DP_ADDR_CTRLSTAT, &cs, &ack, /*log_enable=*/false, /*post_idle=*/true)) {
-      if (g_verbose && i < 10) {
+      if (ctx().verbose && i < 10) {
         Serial.printf(
             "Poll CTRL/STAT failed (poll %d: DP READ CTRL/STAT addr=0x%02X, ACK=%u %s)\n", i,
             (unsigned)DP_ADDR_CTRLSTAT, (unsigned)ack, ack_to_str(ack));
@@ -820,7 +1122,7 @@ bool dp_init_and_power_up() {
     const bool sys_ack = (cs >> 31) & 1u;
     const bool dbg_ack = (cs >> 29) & 1u;
 
-    if (g_verbose) {
+    if (ctx().verbose) {
       const bool changed = (!have_last) || (cs != last_cs);
       if (i < 10 || changed) {
         Serial.printf(
@@ -835,7 +1137,7 @@ bool dp_init_and_power_up() {
     if (sys_ack && dbg_ack) return true;
     delay(1);
   }
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.println("DP init timeout: never observed both SYS+DBG power-up ACK bits");
   }
   return false;
@@ -845,8 +1147,32 @@ bool ap_select(uint8_t apsel, uint8_t apbanksel) {
   // SELECT: [31:24]=APSEL, [7:4]=APBANKSEL
   const uint32_t sel = ((uint32_t)apsel << 24) | ((uint32_t)(apbanksel & 0xFu) << 4);
 
+  if (ctx().shadow.select_valid && ctx().shadow.select == sel) {
+    ctx().shadow_stats.select_skipped++;
+    return true;
+  }
+
   // Log in the requested one-line English format when verbose is enabled.
-  return dp_write(DP_ADDR_SELECT, sel, nullptr, /*log_enable=*/g_verbose, /*post_idle=*/true);
+  return dp_write(DP_ADDR_SELECT, sel, nullptr, /*log_enable=*/ctx().verbose, /*post_idle=*/true);
+}
+
+// CSW/TAR write unless the shadow says the register already holds `val`.
+// `skipped_out` (optional) reports whether the write was skipped.
+static bool ap_write_cached(uint8_t addr, uint32_t val, uint8_t *ack_out, bool fast, bool *skipped_out = nullptr) {
+  const ApShadow &s = ctx().shadow;
+  bool cached = false;
+  if (shadow_ahb_bank0()) {
+    if (addr == AP_ADDR_CSW) cached = s.csw_valid && s.csw == val;
+    if (addr == AP_ADDR_TAR) cached = s.tar_valid && s.tar == val;
+  }
+  if (skipped_out) *skipped_out = cached;
+  if (cached) {
+    if (addr == AP_ADDR_CSW) ctx().shadow_stats.csw_skipped++;
+    else ctx().shadow_stats.tar_skipped++;
+    if (ack_out) *ack_out = ACK_OK;
+    return true;
+  }
+  return fast ? ap_write_fast(addr, val, ack_out) : ap_write(addr, val, ack_out, /*log_enable=*/false);
 }
 
 bool ap_read_reg(uint8_t addr, uint32_t *val_out, uint8_t *ack_out) {
@@ -884,6 +1210,19 @@ bool ap_write_reg_fast(uint8_t addr, uint32_t val, uint8_t *ack_out) {
   return ok;
 }
 
+bool ap_write_reg_cached(uint8_t addr, uint32_t val, uint8_t *ack_out) {
+  uint8_t ack = 0;
+  const bool ok = ap_write_cached(addr, val, &ack, /*fast=*/false);
+  if (ack_out) *ack_out = ack;
+  return ok;
+}
+
+void shadow_invalidate() { shadow_clear(); }
+
+const ShadowStats &shadow_stats() { return ctx().shadow_stats; }
+
+void reset_shadow_stats() { ctx().shadow_stats = ShadowStats{}; }
+
 bool ap_write_reg_critical(uint8_t addr, uint32_t val, uint8_t *ack_out) {
   uint8_t ack = 0;
   const bool ok = ap_write_internal(addr, val, &ack, /*log_enable=*/false, /*post_idle=*/false);
@@ -894,43 +1233,24 @@ bool ap_write_reg_critical(uint8_t addr, uint32_t val, uint8_t *ack_out) {
 bool AhbApSession::begin() {
   // AHB-AP CSW value used throughout this repo.
   const uint32_t CSW_32_INC = 0x23000012u;
-  tar_valid_ = false;
 
   if (!ap_select(/*apsel=*/0, /*apbanksel=*/0)) return false;
-  if (!ap_write_reg_fast(AP_ADDR_CSW, CSW_32_INC, nullptr)) return false;
+  if (!ap_write_cached(AP_ADDR_CSW, CSW_32_INC, nullptr, /*fast=*/true)) return false;
   return true;
 }
 
-void AhbApSession::invalidate() {
-  tar_valid_ = false;
-  tar_ = 0;
-}
+void AhbApSession::invalidate() { ctx().shadow.tar_valid = false; }
 
 bool AhbApSession::write32(uint32_t addr, uint32_t val) {
   // If sequential, TAR can be left untouched because CSW has AddrInc=single.
-  if (!tar_valid_ || addr != tar_) {
-    if (!ap_write_reg_fast(AP_ADDR_TAR, addr, nullptr)) return false;
-    tar_ = addr;
-    tar_valid_ = true;
-  }
-  if (!ap_write_reg_fast(AP_ADDR_DRW, val, nullptr)) return false;
-  tar_ += 4;
-
-  // AHB-AP TAR auto-increment is commonly documented as wrapping on a 1KB boundary
-  // (low 10 address bits). To be robust across implementations, force a TAR rewrite
-  // whenever we cross that boundary.
-  if ((tar_ & 0x3FFu) == 0) {
-    tar_valid_ = false;
-  }
-  return true;
+  // The shadow follows the auto-increment and forces a TAR rewrite at each 1KB boundary:
+  // AHB-AP TAR auto-increment is commonly documented as wrapping there (low 10 address bits).
+  if (!ap_write_cached(AP_ADDR_TAR, addr, nullptr, /*fast=*/true)) return false;
+  return ap_write_reg_fast(AP_ADDR_DRW, val, nullptr);
 }
 
 bool AhbApSession::read32(uint32_t addr, uint32_t *val_out) {
-  if (!tar_valid_ || addr != tar_) {
-    if (!ap_write_reg_fast(AP_ADDR_TAR, addr, nullptr)) return false;
-    tar_ = addr;
-    tar_valid_ = true;
-  }
+  if (!ap_write_cached(AP_ADDR_TAR, addr, nullptr, /*fast=*/true)) return false;
 
   // Posted read sequence optimized for bulk polling:
   // - skip post-idle flush clocks on both transactions
@@ -942,12 +1262,6 @@ bool AhbApSession::read32(uint32_t addr, uint32_t *val_out) {
   uint8_t ack1 = 0;
   if (!dp_read(DP_ADDR_RDBUFF, &v, &ack1, /*log_enable=*/false, /*post_idle=*/false)) return false;
   if (val_out) *val_out = v;
-  tar_ += 4;
-
-  // See note in write32() about TAR auto-increment wrap.
-  if ((tar_ & 0x3FFu) == 0) {
-    tar_valid_ = false;
-  }
   return true;
 }
 
@@ -969,11 +1283,7 @@ bool AhbApSession::read32_pipelined(uint32_t addr, uint32_t *out_words, uint32_t
     const uint32_t burst_words = (remaining < words_left_in_1kb) ? remaining : words_left_in_1kb;
 
     // Ensure TAR points at the burst start.
-    if (!tar_valid_ || cur_addr != tar_) {
-      if (!ap_write_reg_fast(AP_ADDR_TAR, cur_addr, nullptr)) return false;
-      tar_ = cur_addr;
-      tar_valid_ = true;
-    }
+    if (!ap_write_cached(AP_ADDR_TAR, cur_addr, nullptr, /*fast=*/true)) return false;
 
     uint32_t stale = 0;
     uint8_t ack = 0;
@@ -994,20 +1304,41 @@ bool AhbApSession::read32_pipelined(uint32_t addr, uint32_t *out_words, uint32_t
     dst[burst_words - 1u] = last;
 
     // Advance.
-    tar_ += 4u * burst_words;
     cur_addr += 4u * burst_words;
     dst += burst_words;
     remaining -= burst_words;
-
-    // If we ended exactly on a 1KB boundary, force TAR rewrite on next burst.
-    if ((tar_ & 0x3FFu) == 0) {
-      tar_valid_ = false;
-    }
   }
 
   return true;
 }
 
+bool AhbApSession::banked_begin(uint32_t base) {
+  if (base & 0xFu) return false;
+  if (!begin()) return false;
+  if (!ap_write_cached(AP_ADDR_TAR, base, nullptr, /*fast=*/true)) return false;
+  return ap_select(/*apsel=*/0, /*apbanksel=*/AP_ADDR_BD0 >> 4);
+}
+
+bool AhbApSession::banked_write(uint8_t index, uint32_t val) {
+  return ap_write_fast((uint8_t)(AP_ADDR_BD0 + 4u * (index & 3u)), val, nullptr);
+}
+
+bool AhbApSession::banked_read_posted(uint8_t index, uint32_t *prev_out) {
+  uint32_t prev = 0;
+  if (!ap_read((uint8_t)(AP_ADDR_BD0 + 4u * (index & 3u)), &prev, nullptr, /*log_enable=*/false,
+               /*post_idle=*/false)) {
+    return false;
+  }
+  if (prev_out) *prev_out = prev;
+  return true;
+}
+
+bool AhbApSession::rdbuff(uint32_t *val_out) {
+  return dp_read(DP_ADDR_RDBUFF, val_out, nullptr, /*log_enable=*/false, /*post_idle=*/false);
+}
+
+bool AhbApSession::banked_end() { return ap_select(/*apsel=*/0, /*apbanksel=*/0); }
+
 bool mem_write32(uint32_t addr, uint32_t val) {
   // AHB-AP CSW value used throughout this repo (see MASS_ERASE.md / PC_READ.md).
   // Low bits still represent: SIZE=32-bit, AddrInc=single.
@@ -1015,9 +1346,10 @@ bool mem_write32(uint32_t addr, uint32_t val) {
   const uint32_t CSW_32_INC = 0x23000012u;
 
   // Intentionally do not print raw memory ops here; callers should log in human format.
+  // SELECT/CSW/TAR are only written when the shadow says they differ.
   if (!ap_select(/*apsel=*/0, /*apbanksel=*/0)) return false;
-  if (!ap_write_reg(AP_ADDR_CSW, CSW_32_INC, nullptr)) return false;
-  if (!ap_write_reg(AP_ADDR_TAR, addr, nullptr)) return false;
+  if (!ap_write_reg_cached(AP_ADDR_CSW, CSW_32_INC, nullptr)) return false;
+  if (!ap_write_reg_cached(AP_ADDR_TAR, addr, nullptr)) return false;
   if (!ap_write_reg(AP_ADDR_DRW, val, nullptr)) return false;
   return true;
 }
@@ -1027,8 +1359,8 @@ bool mem_read32(uint32_t addr, uint32_t *val_out) {
 
   // Intentionally do not print raw memory ops here; callers should log in human format.
   if (!ap_select(/*apsel=*/0, /*apbanksel=*/0)) return false;
-  if (!ap_write_reg(AP_ADDR_CSW, CSW_32_INC, nullptr)) return false;
-  if (!ap_write_reg(AP_ADDR_TAR, addr, nullptr)) return false;
+  if (!ap_write_reg_cached(AP_ADDR_CSW, CSW_32_INC, nullptr)) return false;
+  if (!ap_write_reg_cached(AP_ADDR_TAR, addr, nullptr)) return false;
   // Posted: initiate read from DRW then read RDBUFF
   uint32_t dummy = 0;
   if (!ap_read_reg(AP_ADDR_DRW, &dummy, nullptr)) return false;
@@ -1036,6 +1368,172 @@ bool mem_read32(uint32_t addr, uint32_t *val_out) {
   return true;
 }
 
+// --- Sized and block memory access ---
+
+// CSW with the same HPROT/upper bits as CSW_32_INC above; AddrInc 1 = single, 2 = packed.
+static inline uint32_t csw_for(uint8_t size, bool packed) {
+  return 0x23000000u | ((packed ? 2u : 1u) << 4) | size;
+}
+
+bool mem_ap_probe(MemApCaps *caps_out) {
+  MemApCaps &c = ctx().mem_caps;
+  if (!c.probed) {
+    // 8-bit + packed is the most demanding setting; the read-back shows what stuck.
+    const uint32_t want = csw_for(MEM_SIZE_8, /*packed=*/true);
+    uint32_t got = 0;
+    if (!ap_select(/*apsel=*/0, /*apbanksel=*/0)) return false;
+    if (!ap_write_reg(AP_ADDR_CSW, want, nullptr)) return false;
+    if (!ap_read_reg(AP_ADDR_CSW, &got, nullptr)) return false;
+    // The shadow recorded what we wrote; the AP holds what it read back as.
+    ctx().shadow.csw = got;
+    c.sub_word = (got & 0x7u) == MEM_SIZE_8;
+    c.packed = ((got >> 4) & 0x3u) == 2u;
+    c.probed = true;
+    if (ctx().verbose) {
+      Serial.printf("AHB-AP CSW probe: wrote 0x%08lX, read 0x%08lX (8/16-bit %s, packed %s)\n", (unsigned long)want,
+                    (unsigned long)got, c.sub_word ? "yes" : "no", c.packed ? "yes" : "no");
+    }
+  }
+  if (caps_out) *caps_out = c;
+  return true;
+}
+
+// One DRW access of a block transfer: `bytes` bytes at `addr`, CSW.Size `size`; `packed`
+// means a full word carried as 8/16-bit packed transfers.
+struct BlockStep {
+  uint32_t addr;
+  uint8_t bytes;
+  uint8_t size;
+  bool packed;
+};
+
+// Widest access that is aligned at `addr`, fits in `remaining` and is at most `max_size`.
+static BlockStep block_step(uint32_t addr, uint32_t remaining, uint8_t max_size, bool packed_ok) {
+  BlockStep st{addr, 1, MEM_SIZE_8, false};
+  if (max_size >= MEM_SIZE_32 && (addr & 3u) == 0 && remaining >= 4) {
+    st.bytes = 4;
+    st.size = MEM_SIZE_32;
+  } else if (max_size >= MEM_SIZE_16 && (addr & 1u) == 0 && remaining >= 2) {
+    st.bytes = 2;
+    st.size = MEM_SIZE_16;
+  }
+  if (st.bytes < 4 && packed_ok && (addr & 3u) == 0 && remaining >= 4) {
+    st.bytes = 4;
+    st.packed = true;
+  }
+  return st;
+}
+
+// Sub-word steps need 8/16-bit support; probe (once) before the first one.
+static bool block_caps(uint32_t addr, uint32_t len, uint8_t max_size, MemApCaps *caps) {
+  *caps = ctx().mem_caps;
+  const bool needs_sub_word = max_size < MEM_SIZE_32 || (addr & 3u) != 0 || (len & 3u) != 0;
+  if (!needs_sub_word) return true;
+  if (!mem_ap_probe(caps)) return false;
+  if (!caps->sub_word) {
+    Serial.println("ERROR: AHB-AP does not support 8/16-bit transfers");
+    return false;
+  }
+  return true;
+}
+
+// Point CSW/TAR at `st` (each write skipped when the shadow already matches).
+static bool block_setup(const BlockStep &st) {
+  if (!ap_write_cached(AP_ADDR_CSW, csw_for(st.size, st.packed), nullptr, /*fast=*/true)) return false;
+  return ap_write_cached(AP_ADDR_TAR, st.addr, nullptr, /*fast=*/true);
+}
+
+static inline bool block_setup_cached(const BlockStep &st) {
+  const ApShadow &s = ctx().shadow;
+  return shadow_ahb_bank0() && s.csw_valid && s.csw == csw_for(st.size, st.packed) && s.tar_valid &&
+         s.tar == st.addr;
+}
+
+bool read_block(uint32_t addr, uint8_t *out, uint32_t len, uint8_t max_size) {
+  if (len == 0) return true;
+  if (!out) return false;
+
+  // Word reads cover the range; only narrower accesses need exact heads/tails.
+  uint32_t start = addr;
+  uint32_t end = addr + len;
+  if (max_size >= MEM_SIZE_32) {
+    start &= ~0x3u;
+    end = (end + 3u) & ~0x3u;
+  }
+  MemApCaps caps;
+  if (!block_caps(start, end - start, max_size, &caps)) return false;
+  if (!ap_select(/*apsel=*/0, /*apbanksel=*/0)) return false;
+
+  // Posted reads: each DRW read returns the previous one's data; RDBUFF returns the last.
+  // A CSW/TAR write in between could disturb that, so drain through RDBUFF first.
+  auto store = [&](const BlockStep &st, uint32_t v) {
+    for (uint32_t i = 0; i < st.bytes; i++) {
+      const uint32_t a = st.addr + i;
+      if (a >= addr && a - addr < len) out[a - addr] = (uint8_t)(v >> (8u * (a & 3u)));
+    }
+  };
+  bool pending = false;
+  BlockStep prev{0, 0, 0, false};
+  uint32_t v = 0;
+  for (uint32_t cur = start; cur < end;) {
+    const BlockStep st = block_step(cur, end - cur, max_size, caps.packed);
+    if (pending && !block_setup_cached(st)) {
+      if (!dp_read(DP_ADDR_RDBUFF, &v, nullptr, /*log_enable=*/false, /*post_idle=*/false)) return false;
+      store(prev, v);
+      pending = false;
+    }
+    if (!block_setup(st)) return false;
+    if (!ap_read(AP_ADDR_DRW, &v, nullptr, /*log_enable=*/false, /*post_idle=*/false)) return false;
+    if (pending) store(prev, v);
+    prev = st;
+    pending = true;
+    cur += st.bytes;
+  }
+  if (!dp_read(DP_ADDR_RDBUFF, &v, nullptr, /*log_enable=*/false, /*post_idle=*/true)) return false;
+  store(prev, v);
+  return true;
+}
+
+bool write_block(uint32_t addr, const uint8_t *data, uint32_t len, uint8_t max_size) {
+  if (len == 0) return true;
+  if (!data) return false;
+
+  MemApCaps caps;
+  if (!block_caps(addr, len, max_size, &caps)) return false;
+  if (!ap_select(/*apsel=*/0, /*apbanksel=*/0)) return false;
+
+  for (uint32_t off = 0; off < len;) {
+    const BlockStep st = block_step(addr + off, len - off, max_size, caps.packed);
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < st.bytes; i++) v |= (uint32_t)data[off + i] << (8u * ((st.addr + i) & 3u));
+    if (!block_setup(st)) return false;
+    off += st.bytes;
+    // The last write gets the post-idle clocks that complete it.
+    const bool ok = (off < len) ? ap_write_fast(AP_ADDR_DRW, v, nullptr)
+                                : ap_write(AP_ADDR_DRW, v, nullptr, /*log_enable=*/false);
+    if (!ok) return false;
+  }
+  return true;
+}
+
+bool mem_read8(uint32_t addr, uint8_t *val_out) { return read_block(addr, val_out, 1, MEM_SIZE_8); }
+
+bool mem_read16(uint32_t addr, uint16_t *val_out) {
+  if ((addr & 1u) || !val_out) return false;
+  uint8_t b[2];
+  if (!read_block(addr, b, 2, MEM_SIZE_16)) return false;
+  *val_out = (uint16_t)(b[0] | (b[1] << 8));
+  return true;
+}
+
+bool mem_write8(uint32_t addr, uint8_t val) { return write_block(addr, &val, 1, MEM_SIZE_8); }
+
+bool mem_write16(uint32_t addr, uint16_t val) {
+  if (addr & 1u) return false;
+  const uint8_t b[2] = {(uint8_t)val, (uint8_t)(val >> 8)};
+  return write_block(addr, b, 2, MEM_SIZE_16);
+}
+
 bool mem_write32_verbose(const char *purpose, uint32_t addr, uint32_t val) {
   // AHB-AP CSW value used throughout this repo (see MASS_ERASE.md / PC_READ.md).
   const uint32_t CSW_32_INC = 0x23000012u;
@@ -1046,20 +1544,22 @@ bool mem_write32_verbose(const char *purpose, uint32_t addr, uint32_t val) {
   // Log the underlying AP transactions as one-line English messages.
   const char *p = (purpose && purpose[0]) ? purpose : "Memory write";
 
-  if (!ap_write(AP_ADDR_CSW, CSW_32_INC, &ack, /*log_enable=*/false)) return false;
-  if (g_verbose) {
+  // Writes the shadow makes unnecessary are skipped (and not logged).
+  bool skipped = false;
+  if (!ap_write_cached(AP_ADDR_CSW, CSW_32_INC, &ack, /*fast=*/false, &skipped)) return false;
+  if (ctx().verbose && !skipped) {
     Serial.printf("%s: Configure AHB-AP for 32-bit transfers (AP WRITE CSW addr=0x%02X, data=0x%08lX, ACK=%u %s)\n",
                   p, (unsigned)AP_ADDR_CSW, (unsigned long)CSW_32_INC, (unsigned)ack, ack_to_str(ack));
   }
 
-  if (!ap_write(AP_ADDR_TAR, addr, &ack, /*log_enable=*/false)) return false;
-  if (g_verbose) {
+  if (!ap_write_cached(AP_ADDR_TAR, addr, &ack, /*fast=*/false, &skipped)) return false;
+  if (ctx().verbose && !skipped) {
     Serial.printf("%s: Set target address (AP WRITE TAR addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", p,
                   (unsigned)AP_ADDR_TAR, (unsigned long)addr, (unsigned)ack, ack_to_str(ack));
   }
 
   if (!ap_write(AP_ADDR_DRW, val, &ack, /*log_enable=*/false)) return false;
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.printf("%s: Write 32-bit value to target memory (AP WRITE DRW addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", p,
                   (unsigned)AP_ADDR_DRW, (unsigned long)val, (unsigned)ack, ack_to_str(ack));
   }
@@ -1074,14 +1574,16 @@ bool mem_read32_verbose(const char *purpose, uint32_t addr, uint32_t *val_out) {
 
   const char *p = (purpose && purpose[0]) ? purpose : "Memory read";
 
-  if (!ap_write(AP_ADDR_CSW, CSW_32_INC, &ack, /*log_enable=*/false)) return false;
-  if (g_verbose) {
+  // Writes the shadow makes unnecessary are skipped (and not logged).
+  bool skipped = false;
+  if (!ap_write_cached(AP_ADDR_CSW, CSW_32_INC, &ack, /*fast=*/false, &skipped)) return false;
+  if (ctx().verbose && !skipped) {
     Serial.printf("%s: Configure AHB-AP for 32-bit transfers (AP WRITE CSW addr=0x%02X, data=0x%08lX, ACK=%u %s)\n",
                   p, (unsigned)AP_ADDR_CSW, (unsigned long)CSW_32_INC, (unsigned)ack, ack_to_str(ack));
   }
 
-  if (!ap_write(AP_ADDR_TAR, addr, &ack, /*log_enable=*/false)) return false;
-  if (g_verbose) {
+  if (!ap_write_cached(AP_ADDR_TAR, addr, &ack, /*fast=*/false, &skipped)) return false;
+  if (ctx().verbose && !skipped) {
     Serial.printf("%s: Set target address (AP WRITE TAR addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", p,
                   (unsigned)AP_ADDR_TAR, (unsigned long)addr, (unsigned)ack, ack_to_str(ack));
   }
@@ -1089,7 +1591,7 @@ bool mem_read32_verbose(const char *purpose, uint32_t addr, uint32_t *val_out) {
   // Start the posted read from DRW.
   uint32_t stale = 0;
   if (!ap_read(AP_ADDR_DRW, &stale, &ack, /*log_enable=*/false, /*post_idle=*/true)) return false;
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.printf(
         "%s: Start a posted memory read (AP READ DRW addr=0x%02X, data(stale)=0x%08lX, ACK=%u %s)\n", p,
         (unsigned)AP_ADDR_DRW, (unsigned long)stale, (unsigned)ack, ack_to_str(ack));
@@ -1098,7 +1600,7 @@ bool mem_read32_verbose(const char *purpose, uint32_t addr, uint32_t *val_out) {
   // Fetch the true value via DP.RDBUFF.
   uint32_t v = 0;
   if (!dp_read(DP_ADDR_RDBUFF, &v, &ack, /*log_enable=*/false, /*post_idle=*/true)) return false;
-  if (g_verbose) {
+  if (ctx().verbose) {
     Serial.printf("%s: Fetch posted-read result (DP READ RDBUFF addr=0x%02X, data=0x%08lX, ACK=%u %s)\n", p,
                   (unsigned)DP_ADDR_RDBUFF, (unsigned long)v, (unsigned)ack, ack_to_str(ack));
   }
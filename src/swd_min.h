@@ -20,6 +20,124 @@ struct Pins {
   constexpr Pins(int swclk_, int swdio_, int nrst_) : swclk(swclk_), swdio(swdio_), nrst(nrst_) {}
 };
 
+// Transaction trace (compile with -DSWD_MIN_TRACE; the simulator always does).
+// One record per DP/AP transfer, emitted after the transfer (and its post-idle clocks).
+struct TraceRecord {
+  uint32_t t_us;         // micros() at the end of the transfer
+  uint8_t apndp;         // 0 = DP, 1 = AP
+  uint8_t rnw;           // 1 = read
+  uint8_t addr;          // register byte address (A[3:2] on the wire; AP bank comes from SELECT)
+  uint8_t ack;
+  const char *reg;       // register name, e.g. "CTRL/STAT", "TAR"
+  uint32_t value;        // data written, or data sampled (AP reads: the posted/stale value)
+  bool ok;               // ACK OK and read parity good
+  uint32_t clocks;       // SWCLK cycles of this transfer, including idle_clocks
+  uint32_t idle_clocks;  // of which request idle-low bits + post-transfer idle
+  uint32_t gap_clocks;   // SWCLK cycles since the previous transfer (line reset, idle, JTAG-to-SWD)
+};
+typedef void (*TraceSink)(const TraceRecord &rec, void *user);
+
+// Host-side shadow of the DP/AP registers that select where an AHB-AP access goes.
+// Every successful SELECT/CSW/TAR write (and every DRW access, through TAR auto-increment)
+// updates it; line reset, NRST changes and any failed transfer (WAIT/FAULT/parity) clear it.
+// ap_select(), ap_write_reg_cached(), the mem_* helpers and AhbApSession skip writes that
+// would not change the register.
+struct ApShadow {
+  bool select_valid = false;
+  uint32_t select = 0;
+  bool csw_valid = false;
+  uint32_t csw = 0;
+  bool tar_valid = false;
+  uint32_t tar = 0;
+};
+
+// Writes issued vs. skipped thanks to the shadow (each skip is one SWD transfer saved).
+struct ShadowStats {
+  uint32_t select_writes = 0;
+  uint32_t select_skipped = 0;
+  uint32_t csw_writes = 0;
+  uint32_t csw_skipped = 0;
+  uint32_t tar_writes = 0;
+  uint32_t tar_skipped = 0;
+  uint32_t invalidations = 0;
+
+  uint32_t skipped() const { return select_skipped + csw_skipped + tar_skipped; }
+};
+
+// AHB-AP capabilities, probed once per attach by mem_ap_probe() (see below).
+struct MemApCaps {
+  bool probed = false;
+  bool sub_word = false;  // CSW.Size 8/16-bit accepted
+  bool packed = false;    // CSW.AddrInc=packed accepted (several 8/16-bit transfers per DRW access)
+};
+
+// What the target layer found out about the attached part (stm32g0_prog::identify_target()).
+// Kept with the driver state so every simulated jig has its own; cleared with mem_caps.
+struct TargetId {
+  bool valid = false;
+  uint32_t mcu_idcode = 0;  // DBGMCU_IDCODE
+  uint32_t flash_size = 0;  // bytes
+  uint8_t device = 0;       // index into the target layer's device table
+};
+
+// SWD clock, as the SWCLK half period in microseconds. 0 adds no delay at all (the GPIO
+// toggle rate sets the speed). The connect window (NRST release -> halt) and bulk
+// transfers have separate settings: reset_and_switch_to_swd() switches to `connect`, and
+// callers switch to `bulk` with use_clock() once the core is halted.
+struct ClockConfig {
+  uint32_t connect_half_period_us;
+  uint32_t bulk_half_period_us;
+};
+
+enum class ClockPhase : uint8_t { Connect, Bulk };
+
+// Mutable driver state. The firmware has exactly one (owned by swd_min.cpp). Host simulator
+// builds define SWD_MIN_EXTERNAL_CONTEXT and implement context() themselves, so that every
+// simulated jig carries its own.
+struct Context {
+  Pins pins;
+  // User-facing verbose mode (toggled by 'd').
+  bool verbose = true;
+  // Last level driven on NRST (for the "NRST HIGH/LOW" banner).
+  bool nrst_last_high = true;
+
+  // Transaction trace (SWD_MIN_TRACE builds only).
+  TraceSink trace_sink = nullptr;
+  void *trace_user = nullptr;
+  uint64_t trace_clocks = 0;       // SWCLK cycles since begin()
+  uint64_t trace_last_clocks = 0;  // trace_clocks at the end of the last traced transfer
+
+  // DP/AP register shadow and its counters.
+  ApShadow shadow;
+  ShadowStats shadow_stats;
+
+  // Cleared by begin() and reset_and_switch_to_swd() (a new target may be attached).
+  MemApCaps mem_caps;
+  TargetId target_id;
+
+  // SWD clock (begin() loads SWD_HALF_PERIOD_US into both settings).
+  ClockConfig clock = {1, 1};
+  ClockPhase clock_phase = ClockPhase::Connect;
+  uint32_t half_period_us = 1;  // active setting
+};
+
+// The active driver state.
+Context &context();
+
+// Install (or clear, with nullptr) the transaction trace sink. Without SWD_MIN_TRACE the
+// sink is never called.
+void set_trace_sink(TraceSink sink, void *user);
+
+// SWD clock settings (see ClockConfig). set_clock_config() applies the setting for the
+// current phase right away.
+void set_clock_config(const ClockConfig &cfg);
+ClockConfig clock_config();
+void use_clock(ClockPhase phase);
+// Active SWCLK half period (us).
+uint32_t half_period_us();
+// Run at an explicit half period until the next use_clock() (clock tuning).
+void set_half_period_us(uint32_t half_period_us);
+
 // SWD ACK values (3-bit field, LSB-first on the wire)
 static constexpr uint8_t ACK_OK    = 0b001;
 static constexpr uint8_t ACK_WAIT  = 0b010;
@@ -90,6 +208,11 @@ static constexpr uint8_t AP_ADDR_CSW = 0x00;
 static constexpr uint8_t AP_ADDR_TAR = 0x04;
 static constexpr uint8_t AP_ADDR_DRW = 0x0C;
 static constexpr uint8_t AP_ADDR_IDR = 0xFC;
+// Banked data registers (AP bank 1): BDn accesses TAR[31:4] + 4*n without touching TAR.
+static constexpr uint8_t AP_ADDR_BD0 = 0x10;
+static constexpr uint8_t AP_ADDR_BD1 = 0x14;
+static constexpr uint8_t AP_ADDR_BD2 = 0x18;
+static constexpr uint8_t AP_ADDR_BD3 = 0x1C;
 
 // Establish SWD, power up debug/system, clear sticky errors.
 bool dp_init_and_power_up();
@@ -98,6 +221,7 @@ bool dp_read_reg(uint8_t addr, uint32_t *val_out, uint8_t *ack_out = nullptr);
 bool dp_write_reg(uint8_t addr, uint32_t val, uint8_t *ack_out = nullptr);
 
 // Select AP # and bank. (For STM32G0 typically APSEL=0.)
+// Skipped when the shadow already holds the same SELECT value.
 bool ap_select(uint8_t apsel, uint8_t apbanksel);
 
 // AP read is *posted* in SWD: this helper returns the true value via RDBUFF.
@@ -110,6 +234,15 @@ bool ap_write_reg(uint8_t addr, uint32_t val, uint8_t *ack_out = nullptr);
 // Intended for performance-critical loops (e.g. flash programming).
 bool ap_write_reg_fast(uint8_t addr, uint32_t val, uint8_t *ack_out = nullptr);
 
+// AP CSW/TAR write that is skipped when the shadow already holds `val` (ACK reported as OK).
+// Other registers are always written. Assumes AP bank 0 is selected.
+bool ap_write_reg_cached(uint8_t addr, uint32_t val, uint8_t *ack_out = nullptr);
+
+// Forget the DP/AP shadow (next access rewrites SELECT, CSW and TAR).
+void shadow_invalidate();
+const ShadowStats &shadow_stats();
+void reset_shadow_stats();
+
 // Critical-window AP write: performs a single AP write with minimal post-transaction
 // overhead (no post-idle cycles, no human logging). Intended for the first DHCSR halt
 // write right after NRST release.
@@ -117,6 +250,8 @@ bool ap_write_reg_critical(uint8_t addr, uint32_t val, uint8_t *ack_out = nullpt
 
 // Lightweight AHB-AP session that avoids re-writing SELECT/CSW/TAR on every 32-bit access.
 // This is a major performance win for flash programming where accesses are sequential.
+// The TAR/CSW state lives in the driver's shadow, so it carries over between sessions and
+// the mem_* helpers.
 struct AhbApSession {
   bool begin();
   void invalidate();
@@ -129,15 +264,53 @@ struct AhbApSession {
   // Returns false on any SWD transaction failure.
   bool read32_pipelined(uint32_t addr, uint32_t *out_words, uint32_t words);
 
- private:
-  bool tar_valid_ = false;
-  uint32_t tar_ = 0;
+  // Banked access to the four words at `base` (16-byte aligned) through BD0..BD3: TAR is
+  // written once by banked_begin(), which also selects AP bank 1; banked_end() selects bank 0
+  // again and must be called before any other access in this session.
+  // banked_read_posted() starts a read of word `index` and returns the result of the previous
+  // AP read (posted, see read32_pipelined()); rdbuff() fetches the result of the last one.
+  // No post-transfer idle, no logging.
+  bool banked_begin(uint32_t base);
+  bool banked_write(uint8_t index, uint32_t val);
+  bool banked_read_posted(uint8_t index, uint32_t *prev_out);
+  bool rdbuff(uint32_t *val_out);
+  bool banked_end();
 };
 
 // AHB-AP memory access helpers (32-bit).
 bool mem_write32(uint32_t addr, uint32_t val);
 bool mem_read32(uint32_t addr, uint32_t *val_out);
 
+// --- Sized and block memory access ---
+
+// CSW.Size values.
+static constexpr uint8_t MEM_SIZE_8  = 0;
+static constexpr uint8_t MEM_SIZE_16 = 1;
+static constexpr uint8_t MEM_SIZE_32 = 2;
+
+// Find out whether the AHB-AP accepts 8/16-bit and packed transfers: write CSW and read it
+// back (the AP keeps only the settings it supports). Runs once per attach; later calls
+// return the cached result.
+bool mem_ap_probe(MemApCaps *caps_out = nullptr);
+
+// Single 8/16-bit accesses (the address must be naturally aligned). Fail if the AP has no
+// 8/16-bit support.
+bool mem_read8(uint32_t addr, uint8_t *val_out);
+bool mem_read16(uint32_t addr, uint16_t *val_out);
+bool mem_write8(uint32_t addr, uint8_t val);
+bool mem_write16(uint32_t addr, uint16_t val);
+
+// Bulk byte-range access with any alignment and length. Accesses are at most `max_size`
+// wide; sequential accesses rely on TAR auto-increment (TAR is rewritten at each 1KB
+// block) and reads are pipelined (posted), so a block costs about one transfer per word.
+// - read_block with MEM_SIZE_32 reads the whole words covering the range (memory reads have
+//   no side effects), so e.g. 32 bytes take TAR + 8 DRW reads + RDBUFF.
+// - write_block writes an unaligned head/tail with 8/16-bit accesses and the rest as words.
+// - With a narrower `max_size` (peripherals that need 8/16-bit accesses), aligned words go
+//   out as one packed DRW access when the AP supports it, else one access per element.
+bool read_block(uint32_t addr, uint8_t *out, uint32_t len, uint8_t max_size = MEM_SIZE_32);
+bool write_block(uint32_t addr, const uint8_t *data, uint32_t len, uint8_t max_size = MEM_SIZE_32);
+
 // Human-friendly variants: print one condensed English line per DP/AP read/write
 // (purpose + register + address + data + ACK status).
 bool mem_write32_verbose(const char *purpose, uint32_t addr, uint32_t val);
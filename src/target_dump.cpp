@@ -0,0 +1,79 @@
+#include "target_dump.h"
+
+#include <SPIFFS.h>
+
+#include "tee_log.h"
+
+// Route all prints in this file into the RAM terminal buffer as well.
+#define Serial tee_log::out()
+
+namespace target_dump {
+
+bool parse_region(const String &name, Region *out) {
+  if (name == "flash") {
+    *out = Region::kFlash;
+  } else if (name == "sram") {
+    *out = Region::kSram;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *region_name(Region region) { return region == Region::kFlash ? "flash" : "sram"; }
+
+const char *file_path(Region region) { return region == Region::kFlash ? "/dump_flash.bin" : "/dump_sram.bin"; }
+
+bool begin(Region region, uint32_t unix_time, stm32g0_prog::DumpHeader *header) {
+  if (!stm32g0_prog::connect_and_halt_under_reset_recovery()) {
+    Serial.println("ERROR: dump: connect + halt failed");
+    return false;
+  }
+  const uint32_t base = (region == Region::kFlash) ? stm32g0_prog::FLASH_BASE : stm32g0_prog::SRAM_BASE;
+  const stm32g0_prog::Target t = stm32g0_prog::target();  // identified by the connect above
+  const uint32_t size = (region == Region::kFlash) ? t.flash_size : t.sram_size;
+  return stm32g0_prog::read_dump_header(base, size, unix_time, header);
+}
+
+bool stream(const stm32g0_prog::DumpHeader &header, Print &out) {
+  if (out.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) != sizeof(header)) return false;
+  const uint32_t t0 = millis();
+  uint32_t done = 0;
+  const bool ok = stm32g0_prog::dump_memory(header.base, header.size, out, &done);
+  const uint32_t dt = millis() - t0;
+  Serial.printf("Dump 0x%08lX: %lu/%lu bytes in %lu ms (%lu KB/s) %s\n", (unsigned long)header.base,
+                (unsigned long)done, (unsigned long)header.size, (unsigned long)dt,
+                (unsigned long)(dt ? (done / dt) : 0u), ok ? "OK" : "FAIL");
+  return ok;
+}
+
+bool dump_to_files(uint32_t unix_time) {
+  bool ok = true;
+  for (Region region : {Region::kFlash, Region::kSram}) {
+    const char *path = file_path(region);
+    stm32g0_prog::DumpHeader header;
+    if (!begin(region, unix_time, &header)) {
+      ok = false;
+      continue;
+    }
+    File f = SPIFFS.open(path, "w");
+    if (!f) {
+      Serial.printf("ERROR: could not open %s for write\n", path);
+      ok = false;
+      continue;
+    }
+    const bool wrote = stream(header, f);
+    f.close();
+    if (!wrote) {
+      (void)SPIFFS.remove(path);
+      Serial.printf("ERROR: %s dump failed (file removed)\n", region_name(region));
+      ok = false;
+      continue;
+    }
+    Serial.printf("Dumped %s to %s (serial=%lu, OPTR=0x%08lX, DHCSR=0x%08lX)\n", region_name(region), path,
+                  (unsigned long)header.serial, (unsigned long)header.optr, (unsigned long)header.dhcsr);
+  }
+  return ok;
+}
+
+}  // namespace target_dump
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "stm32g0_prog.h"
+
+namespace target_dump {
+
+// Whole-flash / SRAM dumps of a DUT (failure analysis of returned units): a
+// stm32g0_prog::DumpHeader followed by the raw region, streamed from pipelined
+// SWD bursts straight into a fwfs file or an HTTP response.
+//
+// The target is attached with connect-under-reset + halt, like production, so
+// firmware that disables SWD is no obstacle. SRAM keeps its contents across that
+// reset; the core registers do not.
+//
+// The caller owns SWD (program_state::acquire_swd()).
+
+enum class Region : uint8_t {
+  kFlash = 0,
+  kSram = 1,
+};
+
+// "flash" / "sram".
+bool parse_region(const String &name, Region *out);
+const char *region_name(Region region);
+
+// fwfs file holding the last dump of `region` ("/dump_flash.bin", "/dump_sram.bin").
+const char *file_path(Region region);
+
+// Attaches, halts and reads the header for a dump of `region`. `unix_time` is the
+// requester's wall clock (0 = unknown).
+bool begin(Region region, uint32_t unix_time, stm32g0_prog::DumpHeader *header);
+
+// Writes `header` and then the region it describes to `out`. Call right after begin().
+bool stream(const stm32g0_prog::DumpHeader &header, Print &out);
+
+// Both regions into their fwfs files, replacing the previous dump. A file whose
+// dump fails is removed rather than left truncated.
+bool dump_to_files(uint32_t unix_time);
+
+}  // namespace target_dump
@@ -6,8 +6,12 @@
 #include <SPIFFS.h>
 
 #include "firmware_fs.h"
+#include "link_monitor.h"
 #include "program_state.h"
 #include "serial_log.h"
+#include "servomotor_upgrade.h"
+#include "servomotor_upgrade_core.h"
+#include "target_dump.h"
 
 #include "ram_log.h"
 #include "tee_log.h"
@@ -81,6 +85,20 @@ static bool parse_http_range_bytes(const String &range, size_t total_len, size_t
   return true;
 }
 
+// Print sink for the body of a chunked (CONTENT_LENGTH_UNKNOWN) response.
+class SendContentPrint final : public Print {
+ public:
+  size_t write(uint8_t b) override {
+    const char c = (char)b;
+    g_server.sendContent(&c, 1);
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    g_server.sendContent(reinterpret_cast<const char *>(buffer), size);
+    return size;
+  }
+};
+
 static void send_ram_log_as_text(bool include_header) {
   g_server.setContentLength(CONTENT_LENGTH_UNKNOWN);
   g_server.send(200, "text/plain", "");
@@ -93,19 +111,7 @@ static void send_ram_log_as_text(bool include_header) {
     g_server.sendContent(hdr);
   }
 
-  class SendContentPrint final : public Print {
-   public:
-    size_t write(uint8_t b) override {
-      const char c = (char)b;
-      g_server.sendContent(&c, 1);
-      return 1;
-    }
-    size_t write(const uint8_t *buffer, size_t size) override {
-      g_server.sendContent(reinterpret_cast<const char *>(buffer), size);
-      return size;
-    }
-  } sink;
-
+  SendContentPrint sink;
   ram_log::stream_to(sink);
 }
 
@@ -340,6 +346,11 @@ static const char k_index_html[] PROGMEM =
     "  <button onclick=\"window.location='/download/log.txt'\">Download log.txt</button>"
     "  <button onclick=\"window.location='/download/serial_consumed.bin'\">Download consumed serials</button>"
     "</div>"
+    "<div style='margin-top:12px'>"
+    "  <span>Target dump (resets + halts the DUT):</span>"
+    "  <button onclick=\"window.location='/api/target_dump?region=flash&t='+Math.floor(Date.now()/1000)\">Flash</button>"
+    "  <button onclick=\"window.location='/api/target_dump?region=sram&t='+Math.floor(Date.now()/1000)\">SRAM</button>"
+    "</div>"
     "<div style='display:flex;gap:12px;flex-wrap:wrap;margin-top:12px'>"
     "  <div style='flex:1;min-width:320px'>"
     "    <div>Consumed serial records:</div>"
@@ -646,6 +657,7 @@ static void register_file_kind_routes(firmware_fs::FileKind kind) {
       g_server.send(500, "text/plain", "Delete failed\n");
       return;
     }
+    if (kind == firmware_fs::FileKind::kServomotorFirmware) servomotor_upgrade::catalog_remove_file(name);
 
     String active;
     bool auto_sel = false;
@@ -684,6 +696,13 @@ static void register_file_kind_routes(firmware_fs::FileKind kind) {
             upload_err[idx] = String("ERROR: ") + err;
             return;
           }
+          // A full servomotor catalog would leave the file unused; refuse it before writing.
+          if (kind == firmware_fs::FileKind::kServomotorFirmware && !servomotor_upgrade::catalog_has_room(base)) {
+            upload_err[idx] = String("ERROR: servomotor catalog full (") +
+                              String((unsigned)servomotor_upgrade_core::k_catalog_capacity) +
+                              " files); delete one first";
+            return;
+          }
           upload_target_path[idx] = String("/") + base;
           upload_file[idx] = SPIFFS.open(upload_target_path[idx], "w");
           if (!upload_file[idx]) {
@@ -708,6 +727,23 @@ static void register_file_kind_routes(firmware_fs::FileKind kind) {
           }
           if (upload_err[idx].length() > 0) return;
 
+          // Catalog SM* files now (model code, compatibility, CRC32); reject what is not a
+          // `.firmware` file instead of failing on the first unit.
+          if (kind == firmware_fs::FileKind::kServomotorFirmware) {
+            const servomotor_upgrade::CatalogAdd added =
+                servomotor_upgrade::catalog_add_file(upload_target_path[idx].substring(1));
+            if (added == servomotor_upgrade::CatalogAdd::kInvalid) {
+              (void)SPIFFS.remove(upload_target_path[idx]);
+              upload_err[idx] = "ERROR: not a valid servomotor .firmware file";
+              return;
+            }
+            if (added == servomotor_upgrade::CatalogAdd::kFull) {
+              // Filled up during the upload: the file is valid, keep it.
+              upload_err[idx] = "ERROR: servomotor catalog full; file stored but not cataloged (delete one, then re-upload)";
+              return;
+            }
+          }
+
           // Auto-select if needed.
           String active;
           bool auto_sel = false;
@@ -826,6 +862,10 @@ static void setup_routes() {
   g_server.on("/api/status", HTTP_GET, []() { send_status_json(); });
   g_server.on("/api/mem", HTTP_GET, []() { send_mem_json(); });
   g_server.on("/api/serial", HTTP_POST, []() { handle_post_serial(); });
+  // RS485 link statistics as last published by Mode 2 (which owns the bus).
+  g_server.on("/api/link", HTTP_GET, []() { g_server.send(200, "application/json", link_monitor::json()); });
+  g_server.on("/api/servomotor_firmware/catalog", HTTP_GET,
+              []() { g_server.send(200, "application/json", servomotor_upgrade::catalog_json()); });
 
   // Register file-management endpoints.
   register_file_kind_routes(firmware_fs::FileKind::kBootloader);
@@ -896,6 +936,36 @@ static void setup_routes() {
   // RAM terminal buffer view.
   g_server.on("/api/ram_log", HTTP_GET, []() { send_ram_log_as_text(/*include_header=*/true); });
 
+  // Live target dump: GET /api/target_dump?region=flash|sram[&t=<unix seconds>]. Attaches over
+  // SWD (resets + halts the DUT) and streams the header and region as they are read. Only when
+  // the console is idle; 409 otherwise. A dump that fails mid-way ends short of header.size.
+  g_server.on("/api/target_dump", HTTP_GET, []() {
+    target_dump::Region region;
+    if (!target_dump::parse_region(g_server.arg("region"), &region)) {
+      g_server.send(400, "text/plain", "Bad request: expected region=flash|sram\n");
+      return;
+    }
+    const uint32_t unix_time = (uint32_t)g_server.arg("t").toInt();
+    if (!program_state::acquire_swd(/*timeout_ms=*/200)) {
+      g_server.send(409, "text/plain", "SWD busy (console command, Mode 2 or production run)\n");
+      return;
+    }
+    stm32g0_prog::DumpHeader header;
+    if (!target_dump::begin(region, unix_time, &header)) {
+      program_state::release_swd();
+      g_server.send(502, "text/plain", "Target attach failed\n");
+      return;
+    }
+    g_server.sendHeader("Cache-Control", "no-store");
+    g_server.sendHeader("Content-Disposition",
+                        String("attachment; filename=dump_") + target_dump::region_name(region) + ".bin");
+    g_server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    g_server.send(200, "application/octet-stream", "");
+    SendContentPrint sink;
+    (void)target_dump::stream(header, sink);
+    program_state::release_swd();
+  });
+
   // Download endpoints (full files).
   g_server.on("/download/log.txt", HTTP_GET, []() {
     File f = SPIFFS.open(serial_log::log_path(), "r");
@@ -919,6 +989,21 @@ static void setup_routes() {
     f.close();
   });
 
+  // Last dumps stored by the console 'D' command.
+  for (target_dump::Region region : {target_dump::Region::kFlash, target_dump::Region::kSram}) {
+    const String route = String("/download") + target_dump::file_path(region);
+    g_server.on(route.c_str(), HTTP_GET, [region]() {
+      File f = SPIFFS.open(target_dump::file_path(region), "r");
+      if (!f) {
+        g_server.send(404, "text/plain", "No dump stored (run 'D' on the console)\n");
+        return;
+      }
+      g_server.sendHeader("Content-Disposition", String("attachment; filename=") + (target_dump::file_path(region) + 1));
+      g_server.streamFile(f, "application/octet-stream");
+      f.close();
+    });
+  }
+
   // RAM terminal buffer download.
   g_server.on("/download/ram_log.txt", HTTP_GET, []() {
     g_server.sendHeader("Content-Disposition", "attachment; filename=ram_log.txt");
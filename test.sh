@@ -189,6 +189,30 @@ run_step \
   -o "$TMP_LOG_DIR/test_filename_normalizer" \
   && "$TMP_LOG_DIR/test_filename_normalizer"
 
+run_step \
+  "host_unit_motion_alignment" \
+  "Validate DUT/reference time alignment and interpolation (host-side C++ unit test)" \
+  /usr/bin/clang++ -std=c++17 -Wall -Wextra -Wpedantic -Werror \
+  "$ROOT_DIR/testdata/test_motion_alignment.cpp" \
+  "$ROOT_DIR/src/motion_alignment.cpp" \
+  -I"$ROOT_DIR" \
+  -o "$TMP_LOG_DIR/test_motion_alignment" \
+  && "$TMP_LOG_DIR/test_motion_alignment"
+
+run_step \
+  "host_unit_serial_pool" \
+  "Validate the serial reservation ring and summary tag formatting (host-side C++ unit test)" \
+  /usr/bin/clang++ -std=c++17 -Wall -Wextra -Wpedantic -Werror -pthread \
+  "$ROOT_DIR/testdata/test_serial_pool.cpp" \
+  -I"$ROOT_DIR" \
+  -o "$TMP_LOG_DIR/test_serial_pool" \
+  && "$TMP_LOG_DIR/test_serial_pool"
+
+run_step \
+  "host_sim_ctest" \
+  "Simulator tests: stm32g0_prog against the simulated STM32G0, with simulated-time budgets" \
+  bash -c "cmake -S '$ROOT_DIR/sim' -B '$TMP_LOG_DIR/sim_build' && cmake --build '$TMP_LOG_DIR/sim_build' -j && ctest --test-dir '$TMP_LOG_DIR/sim_build' --output-on-failure"
+
 # 3) Upload firmware.
 run_step \
   "fw_upload" \
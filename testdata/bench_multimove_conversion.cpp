@@ -0,0 +1,127 @@
+// Host micro-benchmark for converting multimove lists from user units to internal units
+// (lib/Servomotor/MultimoveConversion.h).
+//
+// Built and run by sim/CMakeLists.txt (ctest: bench_multimove_conversion). Three paths over the
+// same lists:
+//   per_item : convertVelocity/convertAcceleration/convertTime per item (unit switch every value)
+//   runtime  : convertMultimoveList(..., units) (unit lookups once per list)
+//   typed    : convertMultimoveList<VelocityTag, AccelerationTag, TimeTag> (one multiply per field)
+// The run fails only if the paths disagree; timings are printed for comparison.
+//
+// Usage: bench_multimove_conversion [lists]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "lib/Servomotor/MultimoveConversion.h"
+
+static constexpr int k_list_len = 32;
+
+// The tags are constexpr: these fold at compile time.
+static_assert(Units::Degrees::toInternal(1.0f) == CONVERSION_FACTOR_DEGREES, "constexpr position tag");
+static_assert(Units::toInternal<Units::EncoderCounts>(5.0f) == 5.0f, "identity tag");
+static_assert(Units::SameQuantity<Units::Rpm::Quantity, VelocityUnit>::value, "tag quantity");
+static_assert(!Units::SameQuantity<Units::Degrees::Quantity, VelocityUnit>::value, "tag quantity");
+
+static void convert_per_item(uint8_t moveCount, uint32_t moveTypes, const multimoveListConverted_t *moveList,
+                             multimoveList_t *convertedList, VelocityUnit vu, AccelerationUnit au, TimeUnit tu) {
+  // The loop Servomotor::multimove() used before convertMultimoveList().
+  for (int i = 0; i < moveCount; i++) {
+    const bool isVelocity = (moveTypes & (1UL << i)) != 0;
+    if (isVelocity) {
+      convertedList[i].value = (int32_t)convertVelocity(moveList[i].value, vu, ConversionDirection::TO_INTERNAL);
+    } else {
+      convertedList[i].value = (int32_t)convertAcceleration(moveList[i].value, au, ConversionDirection::TO_INTERNAL);
+    }
+    convertedList[i].timeSteps = (uint32_t)convertTime(moveList[i].duration, tu, ConversionDirection::TO_INTERNAL);
+  }
+}
+
+static bool same(const multimoveList_t *a, const multimoveList_t *b, int n) {
+  return memcmp(a, b, sizeof(multimoveList_t) * (size_t)n) == 0;
+}
+
+// Runtime hoisting must match the per-item wrappers for every unit combination.
+static bool check_all_unit_combinations(const std::vector<multimoveListConverted_t> &moves, uint32_t types) {
+  multimoveList_t a[k_list_len];
+  multimoveList_t b[k_list_len];
+  for (int v = 0; v <= (int)VelocityUnit::COUNTS_PER_TIMESTEP; v++) {
+    for (int ac = 0; ac <= (int)AccelerationUnit::COUNTS_PER_TIMESTEP_SQUARED; ac++) {
+      for (int t = 0; t <= (int)TimeUnit::MICROSECONDS; t++) {
+        convert_per_item(k_list_len, types, moves.data(), a, (VelocityUnit)v, (AccelerationUnit)ac, (TimeUnit)t);
+        convertMultimoveList(k_list_len, types, moves.data(), b, (VelocityUnit)v, (AccelerationUnit)ac, (TimeUnit)t);
+        if (!same(a, b, k_list_len)) {
+          fprintf(stderr, "runtime mismatch: velocity=%d acceleration=%d time=%d\n", v, ac, t);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+template <typename Fn>
+static double time_ns_per_item(const char *name, int lists, uint64_t *checksum, Fn fn) {
+  multimoveList_t out[k_list_len];
+  uint64_t sum = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int l = 0; l < lists; l++) {
+    fn(l, out);
+    sum += (uint32_t)out[l % k_list_len].value + out[(l + 7) % k_list_len].timeSteps;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)lists * k_list_len);
+  printf("%-9s %8.3f ns/item\n", name, ns);
+  *checksum = sum;
+  return ns;
+}
+
+int main(int argc, char **argv) {
+  const int lists = (argc > 1) ? atoi(argv[1]) : 200000;
+
+  // A pool of lists (small values so the int32 casts stay in range for every unit).
+  static constexpr int k_pool = 64;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+  std::uniform_real_distribution<float> duration(0.0f, 0.5f);
+  std::vector<multimoveListConverted_t> pool((size_t)k_pool * k_list_len);
+  std::vector<uint32_t> types(k_pool);
+  for (multimoveListConverted_t &m : pool) {
+    m.value = value(rng);
+    m.duration = duration(rng);
+  }
+  for (uint32_t &t : types) t = (uint32_t)rng();
+
+  bool ok = check_all_unit_combinations(pool, types[0]);
+
+  const VelocityUnit vu = VelocityUnit::RPM;
+  const AccelerationUnit au = AccelerationUnit::RPM_PER_SECOND;
+  const TimeUnit tu = TimeUnit::SECONDS;
+  auto list_at = [&](int l) { return pool.data() + (size_t)(l % k_pool) * k_list_len; };
+
+  uint64_t c_per_item = 0, c_runtime = 0, c_typed = 0;
+  const double per_item = time_ns_per_item("per_item", lists, &c_per_item, [&](int l, multimoveList_t *out) {
+    convert_per_item(k_list_len, types[l % k_pool], list_at(l), out, vu, au, tu);
+  });
+  const double runtime = time_ns_per_item("runtime", lists, &c_runtime, [&](int l, multimoveList_t *out) {
+    convertMultimoveList(k_list_len, types[l % k_pool], list_at(l), out, vu, au, tu);
+  });
+  const double typed = time_ns_per_item("typed", lists, &c_typed, [&](int l, multimoveList_t *out) {
+    convertMultimoveList<Units::Rpm, Units::RpmPerSecond, Units::Seconds>(k_list_len, types[l % k_pool], list_at(l), out);
+  });
+
+  if (c_per_item != c_runtime || c_per_item != c_typed) {
+    fprintf(stderr, "checksum mismatch: per_item=%llu runtime=%llu typed=%llu\n", (unsigned long long)c_per_item,
+            (unsigned long long)c_runtime, (unsigned long long)c_typed);
+    ok = false;
+  }
+  printf("speedup vs per_item: runtime %.2fx, typed %.2fx (%d lists of %d)\n", per_item / runtime, per_item / typed,
+         lists, k_list_len);
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
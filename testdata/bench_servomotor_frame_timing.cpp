@@ -0,0 +1,242 @@
+// Servomotor request frame timing on the RS485 wire: per-field UART writes vs one write per frame.
+//
+// Built and run by sim/CMakeLists.txt (ctest: bench_servomotor_frame_timing) against the desktop
+// Arduino emulator. The frames are captured on a loopback HardwareSerial exactly as the library
+// hands them to the UART driver (one segment per write() call). A wire model turns the segments
+// into byte timings: bytes are back to back at the baud rate inside a write(), and every further
+// write() call costs the driver gap measured by the RS485 sniffer (tools/rs485_sniffer.py writes
+// tools/sniffer_timing_data.txt; gaps between 3x the median byte spacing and 1 ms are taken as
+// write-boundary gaps, longer ones are turnarounds between frames).
+//
+// Reported per frame: write() calls, bytes, the largest inter-byte gap and the total frame time
+// including the DE/RE lead and tail. "per_field" is the segmentation sendCommandCore() used to
+// have (size, extended size, address, command, payload, CRC32 written separately); "sendCommand"
+// and "execute" are what Communication::sendCommand() and Servomotor::execute<>() write now.
+//
+// Fails (exit 1) if a frame that fits COMMUNICATION_TX_FRAME_BUFFER_SIZE takes more than one
+// write(), or if DE is not high across every write of a frame.
+//
+// Usage: bench_servomotor_frame_timing [sniffer_timing_data.txt] [baud]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Servomotor.h"
+
+static const uint8_t kDePin = 7;
+static const uint16_t kDeLeadMicroseconds = 20;
+static const uint16_t kDeTailMicroseconds = 10;
+static const double kDefaultWriteGapMicroseconds = 225.0;  // tools/sniffer_timing_data.txt median
+
+struct SnifferGaps {
+  size_t samples = 0;
+  double median_byte_spacing_us = 0;
+  size_t write_gaps = 0;
+  double write_gap_median_us = 0;
+  double write_gap_p99_us = 0;
+  double write_gap_max_us = 0;
+};
+
+static double percentile(std::vector<double> v, double q) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(q * (double)v.size()))];
+}
+
+// Columns: time_since_start_of_packet_ms gap_ms max_gap_ms byte (header line first).
+static bool load_sniffer_gaps(const char *path, SnifferGaps *out) {
+  FILE *f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  std::vector<double> gaps;
+  while (fgets(line, sizeof(line), f)) {
+    double t, gap, max_gap;
+    char byte[8];
+    if (sscanf(line, "%lf %lf %lf %7s", &t, &gap, &max_gap, byte) == 4) gaps.push_back(gap * 1000.0);
+  }
+  fclose(f);
+  if (gaps.empty()) return false;
+  out->samples = gaps.size();
+  out->median_byte_spacing_us = percentile(gaps, 0.5);
+  std::vector<double> write_gaps;
+  for (double g : gaps) {
+    if (g > 3.0 * out->median_byte_spacing_us && g < 1000.0) write_gaps.push_back(g);
+  }
+  out->write_gaps = write_gaps.size();
+  out->write_gap_median_us = percentile(write_gaps, 0.5);
+  out->write_gap_p99_us = percentile(write_gaps, 0.99);
+  out->write_gap_max_us = write_gaps.empty() ? 0 : *std::max_element(write_gaps.begin(), write_gaps.end());
+  return true;
+}
+
+struct Event {
+  bool is_pin;     // DE edge, else a serial write()
+  uint8_t level;   // DE level
+  size_t size;     // write() size
+};
+
+static std::vector<Event> g_events;
+
+struct FrameTiming {
+  size_t writes = 0;
+  size_t bytes = 0;
+  double max_gap_us = 0;
+  double frame_us = 0;
+};
+
+// Wire model: the DE lead, then each segment's bytes back to back, a driver gap before every segment
+// after the first, then the DE tail.
+static FrameTiming model(const std::vector<size_t> &segments, double byte_us, double write_gap_us) {
+  FrameTiming t;
+  t.writes = segments.size();
+  for (size_t s : segments) t.bytes += s;
+  if (segments.size() > 1) t.max_gap_us = write_gap_us;
+  t.frame_us = kDeLeadMicroseconds + (double)t.bytes * byte_us + (double)(t.writes ? t.writes - 1 : 0) * write_gap_us +
+               kDeTailMicroseconds;
+  return t;
+}
+
+// write() segments of the frame just sent; checks that DE brackets them. Clears the event log.
+static bool take_frame(std::vector<size_t> *segments, std::vector<uint8_t> *bytes, std::vector<uint8_t> &wire) {
+  segments->clear();
+  bool ok = g_events.size() >= 3 && g_events.front().is_pin && g_events.front().level == HIGH && g_events.back().is_pin &&
+            g_events.back().level == LOW;
+  for (size_t i = 1; ok && i + 1 < g_events.size(); i++) {
+    if (g_events[i].is_pin) ok = false;
+    else segments->push_back(g_events[i].size);
+  }
+  bytes->swap(wire);
+  wire.clear();
+  g_events.clear();
+  return ok;
+}
+
+// The field boundaries the old sendCommandCore() wrote separately.
+static std::vector<size_t> per_field_segments(const std::vector<uint8_t> &frame, bool extended, bool crc32) {
+  std::vector<size_t> s;
+  const bool extended_size = decodeFirstByte(frame[0]) == DECODED_FIRST_BYTE_EXTENDED_SIZE;
+  s.push_back(1);
+  if (extended_size) s.push_back(2);
+  if (extended) {
+    s.push_back(1);
+    s.push_back(8);
+  } else {
+    s.push_back(1);
+  }
+  s.push_back(1);
+  size_t header = 0;
+  for (size_t x : s) header += x;
+  const size_t payload = frame.size() - header - (crc32 ? 4 : 0);
+  if (payload) s.push_back(payload);
+  if (crc32) s.push_back(4);
+  return s;
+}
+
+struct Case {
+  const char *name;
+  uint8_t command_id;
+  bool extended;
+  bool crc32;
+  std::vector<uint8_t> payload;
+};
+
+int main(int argc, char **argv) {
+  arduino_emulator::set_console_output(false);
+  const char *sniffer_path = argc > 1 ? argv[1] : nullptr;
+  const double baud = argc > 2 ? atof(argv[2]) : 230400.0;
+  const double byte_us = 10.0 * 1e6 / baud;  // 8N1
+
+  double write_gap_us = kDefaultWriteGapMicroseconds;
+  SnifferGaps sniffer;
+  if (sniffer_path && load_sniffer_gaps(sniffer_path, &sniffer)) {
+    printf("sniffer %s: %zu bytes, median spacing %.1f us, %zu write-boundary gaps (median %.1f us, p99 %.1f us, "
+           "max %.1f us)\n",
+           sniffer_path, sniffer.samples, sniffer.median_byte_spacing_us, sniffer.write_gaps, sniffer.write_gap_median_us,
+           sniffer.write_gap_p99_us, sniffer.write_gap_max_us);
+    if (sniffer.write_gaps) write_gap_us = sniffer.write_gap_median_us;
+  } else if (sniffer_path) {
+    fprintf(stderr, "cannot read %s, using the default %.0f us write gap\n", sniffer_path, write_gap_us);
+  }
+  printf("model: %.0f baud (%.2f us/byte), %.1f us per extra write(), DE lead %u us / tail %u us\n\n", baud, byte_us,
+         write_gap_us, kDeLeadMicroseconds, kDeTailMicroseconds);
+
+  std::vector<uint8_t> wire;
+  Serial1.set_transmit_handler([&](const uint8_t *data, size_t size) {
+    wire.insert(wire.end(), data, data + size);
+    g_events.push_back(Event{false, 0, size});
+  });
+  arduino_emulator::set_pin_write_handler([](uint8_t pin, uint8_t level) {
+    if (pin == kDePin) g_events.push_back(Event{true, level, 0});
+  });
+  Communication comm(Serial1);
+  comm.setDirectionControl(kDePin, kDeLeadMicroseconds, kDeTailMicroseconds);
+  g_events.clear();
+
+  trapezoidMovePayload trapezoid = {};
+  std::vector<uint8_t> multimove(5 + 32 * 8, 0x11);
+  multimove[0] = 32;
+  std::vector<uint8_t> firmware_page(sizeof(firmwareUpgradePayload), 0xA5);
+  const std::vector<Case> cases = {
+      {"GET_POSITION", GET_POSITION, false, true, {}},
+      {"GET_POSITION crc32 off", GET_POSITION, false, false, {}},
+      {"GET_POSITION unique id", GET_POSITION, true, true, {}},
+      {"TRAPEZOID_MOVE", TRAPEZOID_MOVE, false, true,
+       std::vector<uint8_t>((uint8_t *)&trapezoid, (uint8_t *)&trapezoid + sizeof(trapezoid))},
+      {"MULTIMOVE x32", MULTIMOVE, false, true, multimove},
+      {"FIRMWARE_UPGRADE", FIRMWARE_UPGRADE, true, true, firmware_page},
+  };
+
+  int failures = 0;
+  printf("%-24s %-12s %6s %6s %12s %12s\n", "frame", "path", "writes", "bytes", "max_gap_us", "frame_us");
+  for (const Case &c : cases) {
+    if (c.crc32) comm.enableCRC32(); else comm.disableCRC32();
+    const uint64_t address = c.extended ? 0x0123456789ABCDEFull : 'X';
+    std::vector<size_t> segments;
+    std::vector<uint8_t> frame;
+
+    // Communication::sendCommand*()
+    if (c.extended) comm.sendCommandByUniqueId(address, c.command_id, c.payload.data(), (uint16_t)c.payload.size());
+    else comm.sendCommand((uint8_t)address, c.command_id, c.payload.data(), (uint16_t)c.payload.size());
+    if (!take_frame(&segments, &frame, wire)) {
+      fprintf(stderr, "%s: DE not high across the frame\n", c.name);
+      failures++;
+    }
+    if (frame.size() <= COMMUNICATION_TX_FRAME_BUFFER_SIZE && segments.size() != 1) {
+      fprintf(stderr, "%s: %zu write() calls for a %zu byte frame\n", c.name, segments.size(), frame.size());
+      failures++;
+    }
+    const FrameTiming before = model(per_field_segments(frame, c.extended, c.crc32), byte_us, write_gap_us);
+    const FrameTiming after = model(segments, byte_us, write_gap_us);
+
+    // What Servomotor::execute<>() sends: encodeCommand() into one buffer, then sendFrame().
+    std::vector<uint8_t> typed(frame.size() + 16);
+    FrameWriter writer(typed.data(), (uint16_t)typed.size());
+    writer.beginCommand(c.extended, address, c.command_id, (uint16_t)c.payload.size(), c.crc32);
+    writer.append(c.payload.data(), (uint16_t)c.payload.size());
+    typed.resize(writer.finish());
+    comm.sendFrame(typed.data(), (uint16_t)typed.size());
+    std::vector<uint8_t> typed_wire;
+    if (!take_frame(&segments, &typed_wire, wire) || segments.size() != 1 || typed_wire != frame) {
+      fprintf(stderr, "%s: sendFrame() did not write the same frame in one DE window\n", c.name);
+      failures++;
+    }
+    const FrameTiming typed_timing = model(segments, byte_us, write_gap_us);
+
+    const struct {
+      const char *path;
+      const FrameTiming &t;
+    } rows[] = {{"per_field", before}, {"sendCommand", after}, {"execute", typed_timing}};
+    for (const auto &r : rows) {
+      printf("%-24s %-12s %6zu %6zu %12.1f %12.1f\n", c.name, r.path, r.t.writes, r.t.bytes, r.t.max_gap_us, r.t.frame_us);
+    }
+  }
+  Serial1.set_transmit_handler(nullptr);
+  arduino_emulator::set_pin_write_handler(nullptr);
+  printf("\n%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
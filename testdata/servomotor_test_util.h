@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Servomotor.h"
+#include "test_check.h"
+
+// Fake-device plumbing shared by the lib/Servomotor host tests that answer requests themselves
+// rather than through ServomotorBusEmulator (which models real firmware).
+
+// A response frame carrying `size` payload bytes.
+inline std::vector<uint8_t> servomotor_response_frame(uint8_t error_code, const void *payload, uint16_t size,
+                                                      bool crc32 = true) {
+  std::vector<uint8_t> frame(std::min<size_t>(size + 16u, 0xFFFF));
+  FrameWriter w(frame.data(), (uint16_t)frame.size());
+  w.beginResponse(error_code, size, crc32);
+  w.append(payload, size);
+  frame.resize(w.finish());
+  return frame;
+}
+
+inline std::vector<uint8_t> servomotor_response_frame(uint8_t error_code, const std::vector<uint8_t> &payload,
+                                                      bool crc32 = true) {
+  return servomotor_response_frame(error_code, payload.data(), (uint16_t)payload.size(), crc32);
+}
+
+// Collects what the library writes to Serial1 into request frames and hands each one that parses
+// (CRC32 on) to on_request(); frames that do not parse are dropped unanswered.
+class FakeServomotorBus {
+ public:
+  size_t bytes_in = 0;  // every byte written to the bus
+
+  virtual ~FakeServomotorBus() {}
+
+  void attach() {
+    Serial1.set_transmit_handler([this](const uint8_t *data, size_t size) { on_bytes(data, size); });
+  }
+
+ protected:
+  // `cmd.payload` points into the frame and is only valid during the call.
+  virtual void on_request(const CommandView &cmd) = 0;
+
+  // Answers right away.
+  static void reply(uint8_t error_code, const void *payload, uint16_t size) {
+    const std::vector<uint8_t> frame = servomotor_response_frame(error_code, payload, size);
+    Serial1.inject_rx(frame.data(), frame.size());
+  }
+
+ private:
+  void on_bytes(const uint8_t *data, size_t size) {
+    bytes_in += size;
+    pending_.insert(pending_.end(), data, data + size);
+    for (;;) {
+      const uint16_t n = frameSizeFromHeader(pending_.data(), (uint16_t)pending_.size());
+      if (n == 0 || pending_.size() < n) return;
+      const std::vector<uint8_t> frame(pending_.begin(), pending_.begin() + n);
+      pending_.erase(pending_.begin(), pending_.begin() + n);
+      CommandView cmd;
+      if (parseCommand(frame.data(), n, true, &cmd) == COMMUNICATION_SUCCESS) on_request(cmd);
+    }
+  }
+
+  std::vector<uint8_t> pending_;
+};
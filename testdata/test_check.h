@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdio.h>
+
+// CHECK() for the host-side tests in testdata/: each test is a `bool fn()` that returns false on
+// the first failed check, after printing where it failed.
+#define CHECK(cond)                                                                  \
+  do {                                                                               \
+    if (!(cond)) {                                                                   \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);       \
+      return false;                                                                  \
+    }                                                                                \
+  } while (0)
@@ -0,0 +1,166 @@
+// Host-side tests for the link monitor's per-device table (src/link_monitor_core.h).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_link_monitor) against the desktop Arduino
+// emulator. Fake devices on Serial1 (two DUTs by unique ID, the reference by alias) answer
+// GET_POSITION and GET_COMMUNICATION_STATISTICS with their own device counters. Checks:
+//   - two DUTs tested in a row on one Servomotor object get an entry each, with only their own
+//     host-side traffic next to their own device counters and unique ID
+//   - switching to the same unit again keeps the counters
+//   - alias-addressed devices are keyed by role name; a full table reuses the least recently used
+//
+// Usage: test_link_monitor
+
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+
+#include "servomotor_test_util.h"
+#include "src/link_monitor_core.h"
+
+static const uint64_t kA = 0xA1A1A1A1A1A1A1A1ull;
+static const uint64_t kB = 0xB2B2B2B2B2B2B2B2ull;
+static const uint8_t kRefAlias = 'X';
+
+// Devices keyed by unique ID; the reference answers to its alias.
+class FakeBus : public FakeServomotorBus {
+ public:
+  std::map<uint64_t, getCommunicationStatisticsResponse> by_id;
+  getCommunicationStatisticsResponse reference = {};
+  std::map<uint64_t, int> requests;  // by unique ID
+
+ protected:
+  void on_request(const CommandView &cmd) override {
+    const getCommunicationStatisticsResponse *d = nullptr;
+    if (cmd.isExtendedAddress) {
+      auto it = by_id.find(cmd.uniqueId);
+      if (it == by_id.end()) return;
+      requests[cmd.uniqueId]++;
+      d = &it->second;
+    } else if (cmd.alias == kRefAlias) {
+      d = &reference;
+    } else {
+      return;
+    }
+    if (cmd.commandID == GET_POSITION) {
+      const int64_t position = 0;
+      reply(0, &position, sizeof(position));
+    } else if (cmd.commandID == GET_COMMUNICATION_STATISTICS) {
+      reply(0, d, sizeof(*d));
+    }
+  }
+};
+
+static FakeBus g_bus;
+
+// What link_monitor::report() does without the printing: device counters, then host counters.
+static bool publish(link_monitor_core::EntryTable &table, Servomotor &motor, const char *name, uint64_t unique_id) {
+  getCommunicationStatisticsPayload payload;
+  payload.resetCounter = 0;
+  getCommunicationStatisticsResponse device;
+  const int err = motor.execute<GET_COMMUNICATION_STATISTICS>(&payload, &device);
+  link_monitor_core::Entry *e = table.find_or_add(name, unique_id, millis());
+  e->host = motor.communication().statistics();
+  e->device_error = err;
+  if (err == 0) {
+    e->device = device;
+    e->device_valid = true;
+  }
+  return err == 0;
+}
+
+static const link_monitor_core::Entry *find(const link_monitor_core::EntryTable &table, uint64_t unique_id,
+                                            const char *name) {
+  for (size_t i = 0; i < table.size(); i++) {
+    const link_monitor_core::Entry &e = table.at(i);
+    if (e.unique_id == unique_id && strcmp(e.name, name) == 0) return &e;
+  }
+  return nullptr;
+}
+
+static bool test_two_duts_in_a_row() {
+  g_bus.by_id[kA] = getCommunicationStatisticsResponse{1, 2, 3, 4, 5, 6};
+  g_bus.by_id[kB] = getCommunicationStatisticsResponse{10, 0, 0, 0, 0, 0};
+  g_bus.reference = getCommunicationStatisticsResponse{0, 0, 0, 0, 0, 7};
+  Servomotor dut(0, Serial1);
+  Servomotor ref(kRefAlias, Serial1);
+  dut.enableCRC32();
+  ref.enableCRC32();
+  link_monitor_core::EntryTable table;
+  getPositionResponse position;
+
+  // First unit: 3 requests, then the report.
+  CHECK(link_monitor_core::use_device(dut, kA));
+  for (int i = 0; i < 3; i++) CHECK(dut.execute<GET_POSITION>(nullptr, &position) == 0);
+  CHECK(publish(table, dut, "dut", kA));
+  CHECK(ref.execute<GET_POSITION>(nullptr, &position) == 0);
+  CHECK(publish(table, ref, "reference", 0));
+  CHECK(!link_monitor_core::use_device(dut, kA));  // same unit: counters kept
+  CHECK(dut.communication().statistics().framesSent == 4);
+
+  // Second unit on the same Servomotor object: 5 requests, then the report.
+  CHECK(link_monitor_core::use_device(dut, kB));
+  CHECK(dut.usingThisUniqueId() == kB);
+  CHECK(dut.communication().statistics().framesSent == 0);
+  for (int i = 0; i < 5; i++) CHECK(dut.execute<GET_POSITION>(nullptr, &position) == 0);
+  CHECK(publish(table, dut, "dut", kB));
+  CHECK(publish(table, ref, "reference", 0));
+
+  CHECK(table.size() == 3);
+  const link_monitor_core::Entry *a = find(table, kA, "dut");
+  const link_monitor_core::Entry *b = find(table, kB, "dut");
+  const link_monitor_core::Entry *r = find(table, 0, "reference");
+  CHECK(a && b && r);
+  CHECK(a->host.framesSent == 4 && a->host.framesReceived == 4);
+  CHECK(a->device.crc32ErrorCount == 1 && a->device.noiseErrorCount == 6);
+  CHECK(b->host.framesSent == 6 && b->host.framesReceived == 6);
+  CHECK(b->device.crc32ErrorCount == 10 && b->device.noiseErrorCount == 0);
+  CHECK(r->host.framesSent == 3 && r->device.noiseErrorCount == 7);  // never reset
+  CHECK(g_bus.requests[kA] == 4 && g_bus.requests[kB] == 6);
+  return true;
+}
+
+static bool test_table() {
+  link_monitor_core::EntryTable table;
+  // Alias-addressed devices by name; a unique ID finds its entry under any name.
+  link_monitor_core::Entry *ref = table.find_or_add("reference", 0, 0);
+  CHECK(table.find_or_add("dut", 0, 1) != ref);
+  CHECK(table.find_or_add("reference", 0, 2) == ref);
+  link_monitor_core::Entry *a = table.find_or_add("dut", kA, 3);
+  CHECK(table.find_or_add("other", kA, 4) == a && strcmp(a->name, "dut") == 0);
+  CHECK(table.size() == 3);
+
+  // Full: the least recently used entry (the alias-0 "dut", used at 1) goes first.
+  a->host.framesSent = 99;
+  table.find_or_add("dut", kB, 5);
+  CHECK(table.size() == link_monitor_core::k_max_entries);
+  table.find_or_add("reference", 0, 6);
+  link_monitor_core::Entry *c = table.find_or_add("dut", 0xC3ull, 7);
+  CHECK(table.size() == link_monitor_core::k_max_entries);
+  CHECK(c->unique_id == 0xC3ull && c->host.framesSent == 0);
+  CHECK(find(table, 0, "dut") == nullptr);
+  CHECK(find(table, 0, "reference") && find(table, kA, "dut") && find(table, kB, "dut"));
+  CHECK(find(table, kA, "dut")->host.framesSent == 99);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  g_bus.attach();
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool (*fn)();
+  } tests[] = {
+      {"two_duts_in_a_row", test_two_duts_in_a_row},
+      {"table", test_table},
+  };
+  for (const auto &t : tests) {
+    const bool ok = t.fn();
+    printf("%-24s %s\n", t.name, ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
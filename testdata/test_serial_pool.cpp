@@ -0,0 +1,120 @@
+// Host-side tests for the serial reservation pool (src/serial_pool.h).
+//
+// Checks:
+//   - format_tag() produces the same text as the snprintf summary-line format
+//   - SpscRing FIFO order, capacity and wrap-around
+//   - one producer thread and one consumer thread: every entry arrives once, in order
+//
+// Usage: test_serial_pool
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <random>
+#include <thread>
+
+#include "src/serial_pool.h"
+#include "test_check.h"
+
+static bool test_format_tag() {
+  std::mt19937_64 rng(1);
+  const uint32_t serials[] = {0u, 1u, 9u, 10u, 1003u, 99999u, 4294967295u};
+  const uint64_t ids[] = {0ull, 0x0123456789ABCDEFull, 0xFFFFFFFFFFFFFFFFull, rng(), rng()};
+  for (uint32_t serial : serials) {
+    for (uint64_t id : ids) {
+      serial_pool::Entry e;
+      e.serial = serial;
+      e.unique_id = id;
+      serial_pool::format_tag(e);
+      char expect[64];
+      const int n = snprintf(expect, sizeof(expect), "_%lu_%08lX%08lX_", (unsigned long)serial,
+                             (unsigned long)(id >> 32), (unsigned long)(id & 0xFFFFFFFFu));
+      CHECK(n > 0 && (size_t)n <= serial_pool::k_tag_max);
+      CHECK(e.tag_len == (uint8_t)n && strcmp(e.tag, expect) == 0);
+    }
+  }
+  return true;
+}
+
+static bool test_ring() {
+  serial_pool::SpscRing<5> ring;
+  serial_pool::Entry e;
+  CHECK(ring.capacity() == 4u && ring.size() == 0u && !ring.pop(&e));
+
+  // Several laps so head and tail wrap.
+  uint32_t pushed = 0;
+  uint32_t popped = 0;
+  for (int lap = 0; lap < 10; lap++) {
+    while (ring.size() < ring.capacity()) {
+      e.serial = pushed++;
+      CHECK(ring.push(e));
+    }
+    e.serial = 0xFFFFFFFFu;
+    CHECK(!ring.push(e) && ring.size() == 4u);
+    for (int i = 0; i < 3; i++) {
+      CHECK(ring.pop(&e) && e.serial == popped++);
+    }
+    CHECK(ring.size() == 1u);
+  }
+  while (ring.pop(&e)) CHECK(e.serial == popped++);
+  CHECK(popped == pushed && ring.size() == 0u);
+  return true;
+}
+
+static bool test_threads() {
+  static constexpr uint32_t k_count = 200000;
+  serial_pool::SpscRing<5> ring;
+
+  std::thread producer([&ring]() {
+    for (uint32_t i = 0; i < k_count;) {
+      serial_pool::Entry e;
+      e.serial = i;
+      e.unique_id = ((uint64_t)i << 32) | (i ^ 0xA5A5A5A5u);
+      serial_pool::format_tag(e);
+      if (ring.push(e)) {
+        i++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t next = 0;
+  uint32_t bad = 0;
+  while (next < k_count) {
+    serial_pool::Entry e;
+    if (!ring.pop(&e)) {
+      std::this_thread::yield();
+      continue;
+    }
+    serial_pool::Entry expect;
+    expect.serial = next;
+    expect.unique_id = ((uint64_t)next << 32) | (next ^ 0xA5A5A5A5u);
+    serial_pool::format_tag(expect);
+    if (e.serial != next || e.unique_id != expect.unique_id || strcmp(e.tag, expect.tag) != 0) bad++;
+    next++;
+  }
+  producer.join();
+  CHECK(bad == 0u && ring.size() == 0u);
+  return true;
+}
+
+int main() {
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool (*fn)();
+  } tests[] = {
+      {"format_tag", test_format_tag},
+      {"ring", test_ring},
+      {"threads", test_threads},
+  };
+  for (const auto &t : tests) {
+    const bool ok = t.fn();
+    printf("%-24s %s\n", t.name, ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+// Host-side tests for the non-blocking Servomotor request queue (lib/Servomotor/AsyncRequests.h).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_async) against the desktop Arduino
+// emulator. A fake bus holds several devices (by unique ID), each answering after its own delay;
+// the test's main loop keeps a "heartbeat" counter going while requests are outstanding to show
+// that poll() never blocks. Checks:
+//   - requests to several devices complete with the right payloads, in submission order, with at
+//     most one request on the wire at a time
+//   - per-request timeouts (a silent device) without holding up later requests
+//   - callbacks, take(), release() of queued and in-flight requests, stale handles, a full queue
+//   - device error codes and wrong-size responses
+//   - wait() and the blocking execute<>() on the same bus
+//
+// Usage: test_servomotor_async
+
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "servomotor_test_util.h"
+
+struct FakeDevice {
+  unsigned long delay_ms = 2;
+  bool silent = false;
+  uint8_t error_code = 0;
+  int extra_payload_bytes = 0;  // > 0: answer with a wrong-size payload
+  int64_t position = 0;         // GET_POSITION answer
+  int requests = 0;
+};
+
+// Devices on one bus, answering GET_POSITION and ENABLE_MOSFETS after their delay.
+class FakeBus : public FakeServomotorBus {
+ public:
+  std::map<uint64_t, FakeDevice> devices;
+  std::vector<uint64_t> order;  // unique IDs in the order requests arrived
+  int max_outstanding = 0;
+
+  // Puts due replies on the wire.
+  void tick() {
+    const unsigned long now = millis();
+    for (size_t i = 0; i < scheduled_.size();) {
+      if ((long)(now - scheduled_[i].due) >= 0) {
+        Serial1.inject_rx(scheduled_[i].frame.data(), scheduled_[i].frame.size());
+        scheduled_.erase(scheduled_.begin() + i);
+        outstanding_--;
+      } else {
+        i++;
+      }
+    }
+  }
+
+ protected:
+  void on_request(const CommandView &cmd) override {
+    if (!cmd.isExtendedAddress) return;
+    order.push_back(cmd.uniqueId);
+    auto it = devices.find(cmd.uniqueId);
+    if (it == devices.end()) return;
+    FakeDevice &d = it->second;
+    d.requests++;
+    if (d.silent) return;
+    std::vector<uint8_t> payload;
+    if (cmd.commandID == GET_POSITION) {
+      payload.resize(sizeof(getPositionResponse));
+      memcpy(payload.data(), &d.position, sizeof(d.position));
+    }
+    payload.resize(payload.size() + d.extra_payload_bytes);
+    scheduled_.push_back(Scheduled{millis() + d.delay_ms,
+                                   servomotor_response_frame(d.error_code, payload)});
+    outstanding_++;
+    if (outstanding_ > max_outstanding) max_outstanding = outstanding_;
+  }
+
+ private:
+  struct Scheduled {
+    unsigned long due;
+    std::vector<uint8_t> frame;
+  };
+
+  std::vector<Scheduled> scheduled_;
+  int outstanding_ = 0;
+};
+
+// Answers every request at once with position 300, for the blocking API's own receive loop.
+class ImmediateBus : public FakeServomotorBus {
+ protected:
+  void on_request(const CommandView &) override {
+    const int64_t value = 300;
+    reply(0, &value, sizeof(value));
+  }
+};
+
+static FakeBus g_bus;
+
+// Main loop stand-in: pumps the queue and the fake bus until nothing is pending; returns the
+// number of loop iterations (the "heartbeat").
+static unsigned long run_until_idle(AsyncRequestQueue &queue, unsigned long limit_ms = 3000) {
+  const unsigned long start = millis();
+  unsigned long heartbeat = 0;
+  while (queue.poll() != 0 && millis() - start < limit_ms) {
+    g_bus.tick();
+    heartbeat++;
+  }
+  return heartbeat;
+}
+
+struct Completion {
+  int calls = 0;
+  int error = 1234;
+  int64_t position = 0;
+  AsyncRequestHandle handle = ASYNC_REQUEST_INVALID_HANDLE;
+};
+
+static void on_position(void *context, AsyncRequestHandle handle, int error, const uint8_t *payload, uint16_t size) {
+  Completion *c = static_cast<Completion *>(context);
+  c->calls++;
+  c->error = error;
+  c->handle = handle;
+  if (error == 0 && size == sizeof(getPositionResponse)) memcpy(&c->position, payload, sizeof(c->position));
+}
+
+static const uint64_t kA = 0x1111111111111111ull;
+static const uint64_t kB = 0x2222222222222222ull;
+static const uint64_t kC = 0x3333333333333333ull;
+static const uint64_t kSilent = 0x4444444444444444ull;
+
+static bool test_multiple_devices(Servomotor &motor, AsyncRequestQueue &queue) {
+  g_bus.order.clear();
+  g_bus.max_outstanding = 0;
+  g_bus.devices[kA].position = 100;
+  g_bus.devices[kB].position = -200;
+  g_bus.devices[kC].position = 300;
+  g_bus.devices[kA].delay_ms = 5;
+  g_bus.devices[kB].delay_ms = 1;
+  g_bus.devices[kC].delay_ms = 3;
+
+  Completion done[3];
+  AsyncRequestHandle h[3];
+  const uint64_t ids[3] = {kA, kB, kC};
+  for (int i = 0; i < 3; i++) {
+    h[i] = motor.submit<GET_POSITION>(queue, ids[i], nullptr, 100, &on_position, &done[i]);
+    CHECK(h[i] != ASYNC_REQUEST_INVALID_HANDLE);
+  }
+  // Plus one without a callback, and a command without a response payload.
+  const AsyncRequestHandle polled = motor.submit<GET_POSITION>(queue, kB, nullptr, 100);
+  const AsyncRequestHandle enable = motor.submit<ENABLE_MOSFETS>(queue, kC, nullptr, 100);
+  CHECK(queue.pending() == 5);
+  CHECK(queue.error(polled) == COMMUNICATION_ERROR_REQUEST_PENDING);
+
+  const unsigned long heartbeat = run_until_idle(queue);
+  CHECK(queue.pending() == 0);
+  CHECK(heartbeat > 100);  // the loop kept running while the devices took their time
+  for (int i = 0; i < 3; i++) {
+    CHECK(done[i].calls == 1);
+    CHECK(done[i].error == 0);
+    CHECK(done[i].handle == h[i]);
+    CHECK(done[i].position == g_bus.devices[ids[i]].position);
+    CHECK(queue.error(h[i]) == COMMUNICATION_ERROR_INVALID_HANDLE);  // freed after the callback
+  }
+  CHECK((g_bus.order == std::vector<uint64_t>{kA, kB, kC, kB, kC}));
+  CHECK(g_bus.max_outstanding == 1);
+
+  CHECK(queue.isDone(polled));
+  getPositionResponse position;
+  CHECK(queue.take<GET_POSITION>(polled, &position) == 0);
+  CHECK(position.position == -200);
+  CHECK(queue.take<GET_POSITION>(polled, &position) == COMMUNICATION_ERROR_INVALID_HANDLE);  // stale
+  CHECK(queue.take<ENABLE_MOSFETS>(enable, nullptr) == 0);
+  return true;
+}
+
+static bool test_timeouts(Servomotor &motor, AsyncRequestQueue &queue) {
+  g_bus.order.clear();
+  g_bus.devices[kSilent].silent = true;
+  Completion silent, after;
+  const unsigned long start = millis();
+  motor.submit<GET_POSITION>(queue, kSilent, nullptr, 40, &on_position, &silent);
+  motor.submit<GET_POSITION>(queue, kA, nullptr, 100, &on_position, &after);
+  run_until_idle(queue);
+  const unsigned long elapsed = millis() - start;
+  CHECK(silent.calls == 1 && silent.error == COMMUNICATION_ERROR_TIMEOUT);
+  CHECK(after.calls == 1 && after.error == 0 && after.position == 100);
+  CHECK(elapsed >= 40 && elapsed < 500);
+  CHECK((g_bus.order == std::vector<uint64_t>{kSilent, kA}));
+  return true;
+}
+
+static bool test_release_and_errors(Servomotor &motor, AsyncRequestQueue &queue) {
+  // release(): the queued one is never sent, the in-flight one's answer is dropped.
+  g_bus.order.clear();
+  const AsyncRequestHandle first = motor.submit<GET_POSITION>(queue, kA, nullptr, 100);
+  const AsyncRequestHandle second = motor.submit<GET_POSITION>(queue, kB, nullptr, 100);
+  const AsyncRequestHandle third = motor.submit<GET_POSITION>(queue, kC, nullptr, 100);
+  queue.poll();  // first on the wire
+  queue.release(first);
+  queue.release(second);
+  CHECK(queue.error(first) == COMMUNICATION_ERROR_INVALID_HANDLE);
+  run_until_idle(queue);
+  CHECK((g_bus.order == std::vector<uint64_t>{kA, kC}));
+  getPositionResponse position;
+  CHECK(queue.take<GET_POSITION>(third, &position) == 0 && position.position == 300);
+
+  // Full queue.
+  AsyncRequestHandle handles[ASYNC_REQUEST_SLOTS];
+  for (int i = 0; i < ASYNC_REQUEST_SLOTS; i++) {
+    handles[i] = motor.submit<GET_POSITION>(queue, kA, nullptr, 100);
+    CHECK(handles[i] != ASYNC_REQUEST_INVALID_HANDLE);
+  }
+  CHECK(motor.submit<GET_POSITION>(queue, kA, nullptr, 100) == ASYNC_REQUEST_INVALID_HANDLE);
+  run_until_idle(queue);
+  for (int i = 0; i < ASYNC_REQUEST_SLOTS; i++) CHECK(queue.take<GET_POSITION>(handles[i], &position) == 0);
+
+  // Device error code and wrong-size answer.
+  g_bus.devices[kB].error_code = 5;
+  g_bus.devices[kC].extra_payload_bytes = 3;
+  const AsyncRequestHandle err = motor.submit<GET_POSITION>(queue, kB, nullptr, 100);
+  const AsyncRequestHandle size = motor.submit<GET_POSITION>(queue, kC, nullptr, 100);
+  run_until_idle(queue);
+  CHECK(queue.take<GET_POSITION>(err, &position) == 5);
+  CHECK(queue.take<GET_POSITION>(size, &position) == COMMUNICATION_ERROR_DATA_WRONG_SIZE);
+  g_bus.devices[kB].error_code = 0;
+  g_bus.devices[kC].extra_payload_bytes = 0;
+  CHECK(Serial1.available() == 0);
+  return true;
+}
+
+static bool test_wait_and_blocking(Servomotor &motor, AsyncRequestQueue &queue) {
+  // wait() pumps the queue itself; the fake bus answers from a transmit-time schedule, so give it
+  // zero delay and tick once right after the frame goes out.
+  g_bus.devices[kA].delay_ms = 0;
+  const AsyncRequestHandle h = motor.submit<GET_POSITION>(queue, kA, nullptr, 100);
+  queue.poll();
+  g_bus.tick();
+  CHECK(queue.wait(h) == 0);
+  getPositionResponse position;
+  CHECK(queue.take<GET_POSITION>(h, &position) == 0 && position.position == 100);
+
+  // The blocking API on the same bus (its own receive loop over FrameReceiver).
+  motor.useUniqueId(kC);
+  g_bus.devices[kC].delay_ms = 0;
+  getPositionResponse blocking;
+  static ImmediateBus immediate;
+  immediate.attach();
+  CHECK(motor.execute<GET_POSITION>(nullptr, &blocking) == 0);
+  CHECK(blocking.position == 300);
+  g_bus.attach();
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  g_bus.attach();
+  Servomotor motor('X', Serial1);
+  motor.enableCRC32();
+  AsyncRequestQueue queue(motor.communication());
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool (*fn)(Servomotor &, AsyncRequestQueue &);
+  } tests[] = {
+      {"multiple_devices", test_multiple_devices},
+      {"timeouts", test_timeouts},
+      {"release_and_errors", test_release_and_errors},
+      {"wait_and_blocking", test_wait_and_blocking},
+  };
+  for (const auto &t : tests) {
+    const bool ok = t.fn(motor, queue);
+    printf("%-24s %s\n", t.name, ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
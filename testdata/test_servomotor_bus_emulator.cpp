@@ -0,0 +1,224 @@
+// Host-side tests for the RS485 bus emulator (sim/servomotor_host/ServomotorBusEmulator.h) and,
+// through it, lib/Servomotor and the upgrade pipeline (src/servomotor_upgrade_core.h).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_bus_emulator) on the simulated clock,
+// so DETECT_DEVICES windows, flash programming and bootloader timeouts take no wall time. Checks:
+//   - DETECT_DEVICES finds every device on the bus; replies sent at the same time collide
+//   - unique-ID and alias addressing, CRC32 errors counted by the devices
+//   - a full main-firmware upgrade: pages land in flash, the device runs the new application, and
+//     the simulated duration matches the flash and wire timing (printed as a benchmark line)
+//   - wrong model code, an interrupted upgrade (device stays in the bootloader), an absent device
+//
+// Usage: test_servomotor_bus_emulator
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "Servomotor.h"
+#include "ServomotorBusEmulator.h"
+#include "src/servomotor_upgrade_core.h"
+#include "test_check.h"
+
+static const uint64_t kA = 0x0123456789ABCDEFull;
+static const uint64_t kB = 0x1111222233334444ull;
+static const uint64_t kC = 0x5555666677778888ull;
+
+static EmulatedDeviceConfig device_config(uint64_t unique_id, uint8_t alias, uint32_t serial_number) {
+  EmulatedDeviceConfig c;
+  c.unique_id = unique_id;
+  c.alias = alias;
+  c.serial_number = serial_number;
+  return c;
+}
+
+static bool test_detect_devices() {
+  ServomotorBusEmulator bus(Serial1, 1);
+  bus.add_device(device_config(kA, 1, 100));
+  bus.add_device(device_config(kB, 2, 101));
+  bus.add_device(device_config(kC, 3, 102));
+  Servomotor all(ALL_ALIAS, Serial1);
+
+  const unsigned long start = millis();
+  std::set<uint64_t> found;
+  detectDevicesResponse r = all.detectDevices();
+  while (all.getError() == 0) {
+    found.insert(r.uniqueId);
+    r = all.detectDevicesGetAnotherResponse();
+  }
+  CHECK(all.getError() == COMMUNICATION_ERROR_TIMEOUT);
+  CHECK(bus.stats().collisions == 0);
+  CHECK((found == std::set<uint64_t>{kA, kB, kC}));
+  CHECK(millis() - start >= 1000);  // the last wait ends in a timeout
+
+  // Two devices answering at the same instant garble each other.
+  ServomotorBusEmulator clash(Serial1, 1);
+  EmulatedDeviceConfig a = device_config(kA, 1, 100);
+  EmulatedDeviceConfig b = device_config(kB, 2, 101);
+  a.detect_window_us = b.detect_window_us = 0;
+  clash.add_device(a);
+  clash.add_device(b);
+  all.detectDevices();
+  CHECK(all.getError() != 0);
+  CHECK(clash.stats().collisions == 1);
+  Serial1.clear_rx();
+  return true;
+}
+
+static bool test_addressing_and_crc() {
+  ServomotorBusEmulator bus(Serial1, 2);
+  bus.add_device(device_config(kA, 'X', 100));
+  bus.add_device(device_config(kB, 'Y', 101));
+  Servomotor motor('X', Serial1);
+
+  getProductInfoResponse info;
+  CHECK(motor.execute<GET_PRODUCT_INFO>(kB, nullptr, &info) == 0);
+  CHECK(info.uniqueId == kB && info.serialNumber == 101);
+  CHECK(memcmp(info.productCode, "M17", 3) == 0);
+  CHECK(motor.execute<GET_PRODUCT_INFO>(nullptr, &info) == 0);  // alias 'X'
+  CHECK(info.uniqueId == kA);
+
+  pingPayload ping;
+  for (uint8_t i = 0; i < sizeof(ping.pingData); i++) ping.pingData[i] = (uint8_t)(i * 7);
+  pingResponse pong;
+  CHECK(motor.execute<PING>(kA, &ping, &pong) == 0);
+  CHECK(memcmp(pong.responsePayload, ping.pingData, sizeof(ping.pingData)) == 0);
+  CHECK(motor.execute<GO_TO_CLOSED_LOOP>(nullptr, nullptr) == EMULATED_ERROR_NOT_EMULATED);
+
+  // A frame with a broken CRC32 is dropped and counted by every device.
+  uint8_t frame[32];
+  const uint16_t n = encodeCommand<GET_STATUS>(frame, sizeof(frame), true, kA, nullptr, true);
+  frame[n - 1] ^= 0x5A;
+  Serial1.write(frame, n);
+  getStatusResponse status;
+  CHECK(motor.execute<GET_STATUS>(kB, nullptr, &status) == 0);
+  CHECK(bus.find(kA)->counters().crc32ErrorCount == 1 && bus.find(kB)->counters().crc32ErrorCount == 1);
+  getCommunicationStatisticsPayload reset = {1};
+  getCommunicationStatisticsResponse stats;
+  CHECK(motor.execute<GET_COMMUNICATION_STATISTICS>(kA, &reset, &stats) == 0);
+  CHECK(stats.crc32ErrorCount == 1);
+  CHECK(bus.find(kA)->counters().crc32ErrorCount == 0);
+  return true;
+}
+
+// A `.firmware` file: model code, firmware compatibility, application bytes.
+static std::vector<uint8_t> firmware_file(const char *model, uint8_t compat, size_t app_size, uint32_t seed) {
+  std::vector<uint8_t> f(servomotor_upgrade_core::k_model_code_len + 1 + app_size, 0);
+  strncpy((char *)f.data(), model, servomotor_upgrade_core::k_model_code_len);
+  f[servomotor_upgrade_core::k_model_code_len] = compat;
+  std::mt19937 rng(seed);
+  for (size_t i = servomotor_upgrade_core::k_model_code_len + 1; i < f.size(); i++) f[i] = (uint8_t)rng();
+  return f;
+}
+
+static bool test_upgrade() {
+  ServomotorBusEmulator bus(Serial1, 3);
+  EmulatedServomotor &dut = bus.add_device(device_config(kA, 1, 100));
+  EmulatedServomotor &other = bus.add_device(device_config(kB, 2, 101));
+  Servomotor motor(0, Serial1);
+  motor.useUniqueId(kA);
+
+  const std::vector<uint8_t> file = firmware_file("M17", 1, 40001, 9);
+  servomotor_upgrade_core::Image image;
+  CHECK(servomotor_upgrade_core::prepare_image(file.data(), file.size(), &image, Serial));
+  const size_t pages = (image.tx.size() + 2047) / 2048;
+  CHECK(pages == 20);
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  const unsigned long start = millis();
+  CHECK(servomotor_upgrade_core::send_image(motor, image, Serial));
+  const unsigned long elapsed_ms = millis() - start;
+  const double wall_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+
+  CHECK(dut.state() == EmulatedServomotor::State::kApplication);
+  CHECK(dut.application_valid());
+  CHECK(dut.resets() == 2 && dut.pages_written() == pages);
+  CHECK(memcmp(dut.flash().data() + 5 * 2048, image.tx.data(), image.tx.size()) == 0);
+  CHECK(other.resets() == 0 && other.pages_written() == 0);
+  getFirmwareVersionResponse version;
+  CHECK(motor.execute<GET_FIRMWARE_VERSION>(nullptr, &version) == 0 && version.inBootloader == 0);
+
+  // Every page: wire time of the 2068-byte frame, erase + program, ACK; plus the fixed waits.
+  const double page_ms = (2068.0 * 10.0 / 230400.0) * 1000.0 + 44.0;
+  const double expected_ms = 70.0 + pages * page_ms + 100.0 + 1000.0;
+  printf("upgrade: %u pages, simulated %lu ms (expected >= %.0f ms), wall %.1f ms\n", (unsigned)pages, elapsed_ms,
+         expected_ms, wall_ms);
+  CHECK(elapsed_ms >= expected_ms - 1.0 && elapsed_ms < expected_ms + 30.0);
+  return true;
+}
+
+static bool test_upgrade_failures() {
+  ServomotorBusEmulator bus(Serial1, 4);
+  EmulatedServomotor &dut = bus.add_device(device_config(kA, 1, 100));
+  Servomotor motor(0, Serial1);
+  motor.useUniqueId(kA);
+
+  // Wrong model code: the first page is refused, nothing is written.
+  std::vector<uint8_t> file = firmware_file("M23", 1, 8000, 1);
+  servomotor_upgrade_core::Image image;
+  CHECK(servomotor_upgrade_core::prepare_image(file.data(), file.size(), &image, Serial));
+  CHECK(!servomotor_upgrade_core::send_image(motor, image, Serial));
+  CHECK(motor.getError() == EMULATED_ERROR_WRONG_MODEL);
+  CHECK(dut.pages_written() == 0);
+  CHECK(dut.state() == EmulatedServomotor::State::kBootloader);  // held there by the upgrade command
+  motor.systemReset();
+  CHECK(motor.getError() == 0);
+  delay(1000);
+  CHECK(dut.state() == EmulatedServomotor::State::kApplication);  // old application still valid
+
+  // Interrupted upgrade: only the first page of a new image; the CRC32 no longer matches.
+  file = firmware_file("M17", 1, 8000, 2);
+  CHECK(servomotor_upgrade_core::prepare_image(file.data(), file.size(), &image, Serial));
+  motor.systemReset();
+  CHECK(motor.getError() == 0);
+  delay(70);
+  firmwareUpgradePayload page;
+  memcpy(page.firmwarePage, image.model_code, 8);
+  page.firmwarePage[8] = image.firmware_compatibility;
+  page.firmwarePage[9] = 5;
+  memcpy(page.firmwarePage + 10, image.tx.data(), 2048);
+  CHECK(motor.execute<FIRMWARE_UPGRADE>(&page, nullptr) == 0);
+  motor.systemReset();
+  CHECK(motor.getError() == 0);
+  delay(1000);
+  CHECK(!dut.application_valid());
+  CHECK(dut.state() == EmulatedServomotor::State::kBootloader);
+  getFirmwareVersionResponse version;
+  CHECK(motor.execute<GET_FIRMWARE_VERSION>(nullptr, &version) == 0 && version.inBootloader == 1);
+  getStatusResponse status;
+  CHECK(motor.execute<GET_STATUS>(nullptr, &status) == COMMUNICATION_ERROR_TIMEOUT);  // bootloader ignores it
+
+  // Absent device: the pre-reset times out.
+  dut.set_present(false);
+  CHECK(!servomotor_upgrade_core::send_image(motor, image, Serial));
+  CHECK(motor.getError() == COMMUNICATION_ERROR_TIMEOUT);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  arduino_emulator::set_virtual_time(true);
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool (*fn)();
+  } tests[] = {
+      {"detect_devices", test_detect_devices},
+      {"addressing_and_crc", test_addressing_and_crc},
+      {"upgrade", test_upgrade},
+      {"upgrade_failures", test_upgrade_failures},
+  };
+  for (const auto &t : tests) {
+    const bool ok = t.fn();
+    printf("%-24s %s\n", t.name, ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,317 @@
+// Host-side tests for the typed Servomotor frame codec (lib/Servomotor/CommandCodec.h).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_codec) against the desktop Arduino
+// emulator (sim/servomotor_host). Every command in SERVOMOTOR_COMMAND_TABLE is round-tripped with
+// random payloads, CRC32 on and off, alias and unique-ID addressing:
+//   - encodeCommand() produces the same bytes as Communication::sendCommand*() (legacy path)
+//   - a loopback fake device decodes the frame with parseCommand() and gets the request back
+//   - device responses built with FrameWriter decode identically through getResponse() (legacy)
+//     and parseResponse()/responseAs() (in place, pointing into the frame)
+//   - Servomotor::execute<ID>() end to end, one UART write per request frame
+// plus corrupted-CRC, device-error and wrong-size cases.
+//
+// Usage: test_servomotor_codec
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+#include "Servomotor.h"
+#include "servomotor_test_util.h"
+
+static std::mt19937 g_rng(1);
+
+static std::vector<uint8_t> random_bytes(size_t n) {
+  std::vector<uint8_t> v(n);
+  for (uint8_t &b : v) b = (uint8_t)g_rng();
+  return v;
+}
+
+// Fake device on the other end of a HardwareSerial: collects request bytes until a whole frame is
+// there, decodes it and answers with the configured response.
+class LoopbackDevice {
+ public:
+  explicit LoopbackDevice(HardwareSerial &port) : port_(port) {
+    port_.set_transmit_handler([this](const uint8_t *data, size_t size) { on_bytes(data, size); });
+  }
+  ~LoopbackDevice() { port_.set_transmit_handler(nullptr); }
+
+  bool crc32_enabled = true;        // CRC32 expected on requests / sent on responses
+  bool respond = true;
+  uint8_t error_code = 0;
+  std::vector<uint8_t> response_payload;
+  int corrupt_response_byte = -1;   // flip this byte of the response frame
+
+  int frames = 0;
+  int16_t last_parse_result = 0;
+  CommandView last;                 // payload points into last_frame
+  std::vector<uint8_t> last_frame;
+
+  std::vector<uint8_t> build_response() const {
+    std::vector<uint8_t> frame = servomotor_response_frame(error_code, response_payload, crc32_enabled);
+    if (corrupt_response_byte >= 0 && corrupt_response_byte < (int)frame.size()) frame[corrupt_response_byte] ^= 0x5A;
+    return frame;
+  }
+
+ private:
+  void on_bytes(const uint8_t *data, size_t size) {
+    pending_.insert(pending_.end(), data, data + size);
+    const uint16_t frame_size = frameSizeFromHeader(pending_.data(), (uint16_t)pending_.size());
+    if (frame_size == 0 || pending_.size() < frame_size) return;
+    last_frame.assign(pending_.begin(), pending_.begin() + frame_size);
+    pending_.erase(pending_.begin(), pending_.begin() + frame_size);
+    frames++;
+    last_parse_result = parseCommand(last_frame.data(), (uint16_t)last_frame.size(), crc32_enabled, &last);
+    if (!respond || last_parse_result != COMMUNICATION_SUCCESS) return;
+    const std::vector<uint8_t> reply = build_response();
+    port_.inject_rx(reply.data(), reply.size());
+  }
+
+  HardwareSerial &port_;
+  std::vector<uint8_t> pending_;
+};
+
+// Captures whatever the legacy Communication path writes (on its own port, so the device keeps Serial1).
+static std::vector<uint8_t> legacy_frame(bool crc32, bool extended, uint64_t address,
+                                         uint8_t command_id, const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> out;
+  HardwareSerial port;
+  port.set_transmit_handler([&](const uint8_t *d, size_t n) { out.insert(out.end(), d, d + n); });
+  Communication comm(port);
+  if (crc32) comm.enableCRC32(); else comm.disableCRC32();
+  const uint8_t *p = payload.empty() ? nullptr : payload.data();
+  if (extended) comm.sendCommandByUniqueId(address, command_id, p, (uint16_t)payload.size());
+  else comm.sendCommand((uint8_t)address, command_id, p, (uint16_t)payload.size());
+  return out;
+}
+
+// Random request for CommandID (MULTIMOVE: random moveCount; the rest of the struct is random too).
+template <uint8_t CommandID>
+static void random_request(typename CommandTraits<CommandID>::Request *request) {
+  const std::vector<uint8_t> bytes = random_bytes(sizeof(*request));
+  memcpy((void *)request, bytes.data(), sizeof(*request));
+}
+template <>
+void random_request<MULTIMOVE>(multimovePayload *request) {
+  const std::vector<uint8_t> bytes = random_bytes(sizeof(*request));
+  memcpy(request, bytes.data(), sizeof(*request));
+  request->moveCount = (uint8_t)(g_rng() % 33);
+}
+
+template <uint8_t CommandID>
+static size_t response_size() {
+  typedef CommandTraits<CommandID> Traits;
+  return Traits::kVariableResponse ? Traits::kResponseSize * (1 + g_rng() % 40) : Traits::kResponseSize;
+}
+
+template <uint8_t CommandID>
+static bool check_encode_decode(const char *name, bool crc32, bool extended) {
+  typedef CommandTraits<CommandID> Traits;
+  typename Traits::Request request;
+  random_request<CommandID>(&request);
+  const typename Traits::Request *request_ptr = Traits::kRequestSize ? &request : nullptr;
+  const uint16_t payload_size = request_ptr ? Traits::requestSize(request_ptr) : 0;
+  const std::vector<uint8_t> payload((const uint8_t *)&request, (const uint8_t *)&request + payload_size);
+  const uint64_t address = extended ? ((uint64_t)g_rng() << 32 | g_rng()) : (uint64_t)(g_rng() % 250);
+
+  // Request: typed encoder == legacy writer, and the device decodes it back.
+  uint8_t frame[Traits::kMaxRequestFrameSize];
+  const uint16_t n = encodeCommand<CommandID>(frame, sizeof(frame), extended, address, request_ptr, crc32);
+  CHECK(n > 0);
+  const std::vector<uint8_t> legacy = legacy_frame(crc32, extended, address, CommandID, payload);
+  if (legacy != std::vector<uint8_t>(frame, frame + n)) {
+    fprintf(stderr, "%s: typed frame differs from legacy frame (crc32=%d extended=%d)\n", name, crc32, extended);
+    return false;
+  }
+  CommandView cmd;
+  CHECK(parseCommand(frame, n, crc32, &cmd) == COMMUNICATION_SUCCESS);
+  CHECK(cmd.commandID == CommandID);
+  CHECK(cmd.isExtendedAddress == extended);
+  CHECK(extended ? cmd.uniqueId == address : cmd.alias == (uint8_t)address);
+  CHECK(cmd.payloadSize == payload_size);
+  CHECK(payload_size == 0 || memcmp(cmd.payload, payload.data(), payload_size) == 0);
+  if (crc32) {
+    frame[n / 2] ^= 0x01;
+    CHECK(parseCommand(frame, n, crc32, &cmd) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+  }
+
+  // Response: FrameWriter (device side) -> legacy getResponse() and in-place parseResponse().
+  const std::vector<uint8_t> response_payload = random_bytes(response_size<CommandID>());
+  std::vector<uint8_t> rx(response_payload.size() + 16);
+  FrameWriter w(rx.data(), (uint16_t)rx.size());
+  CHECK(w.beginResponse(0, (uint16_t)response_payload.size(), crc32));
+  w.append(response_payload.data(), (uint16_t)response_payload.size());
+  rx.resize(w.finish());
+  CHECK(!rx.empty());
+
+  ResponseView view;
+  CHECK(parseResponse(rx.data(), (uint16_t)rx.size(), &view) == COMMUNICATION_SUCCESS);
+  CHECK(view.payloadSize == response_payload.size());
+  CHECK(view.payload > rx.data() && view.payload <= rx.data() + rx.size());  // in place
+  CHECK(response_payload.empty() || memcmp(view.payload, response_payload.data(), response_payload.size()) == 0);
+  if (Traits::kResponseSize) {
+    CHECK((const void *)responseAs<CommandID>(view) == (const void *)view.payload);
+  } else {
+    CHECK(responseAs<CommandID>(view) == nullptr);
+  }
+
+  Serial1.clear_rx();
+  Serial1.inject_rx(rx.data(), rx.size());
+  Communication comm(Serial1);
+  std::vector<uint8_t> legacy_rx(response_payload.size());
+  uint16_t received = 0;
+  const int16_t legacy_result = response_payload.empty() ? comm.getResponse(nullptr, 0, received)
+                                                         : comm.getResponse(legacy_rx.data(), (uint16_t)legacy_rx.size(), received);
+  CHECK(legacy_result == COMMUNICATION_SUCCESS);
+  CHECK(received == response_payload.size());
+  CHECK(legacy_rx == response_payload);
+  CHECK(Serial1.available() == 0);
+
+  // A flipped CRC byte fails both paths the same way.
+  if (crc32) {
+    rx[rx.size() - 1] ^= 0x80;
+    CHECK(parseResponse(rx.data(), (uint16_t)rx.size(), &view) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+    Serial1.inject_rx(rx.data(), rx.size());
+    CHECK((response_payload.empty() ? comm.getResponse(nullptr, 0, received)
+                                    : comm.getResponse(legacy_rx.data(), (uint16_t)legacy_rx.size(), received)) ==
+          COMMUNICATION_ERROR_CRC32_MISMATCH);
+    CHECK(Serial1.available() == 0);
+  }
+  return true;
+}
+
+// Servomotor::execute<ID>() against the loopback device.
+template <uint8_t CommandID, bool Variable = CommandTraits<CommandID>::kVariableResponse>
+struct ExecuteCheck {
+  static bool run(const char *name, Servomotor &motor, LoopbackDevice &device, bool extended) {
+    typedef CommandTraits<CommandID> Traits;
+    typename Traits::Request request;
+    random_request<CommandID>(&request);
+    const typename Traits::Request *request_ptr = Traits::kRequestSize ? &request : nullptr;
+    device.response_payload = random_bytes(Traits::kResponseSize);
+    typename Traits::Response response;
+    memset((void *)&response, 0, sizeof(response));
+
+    const uint64_t unique_id = 0x0123456789ABCDEFull ^ g_rng();
+    const int frames_before = device.frames;
+    Serial1.reset_counters();
+    const int result = extended ? motor.execute<CommandID>(unique_id, request_ptr, Traits::kResponseSize ? &response : nullptr)
+                                : motor.execute<CommandID>(request_ptr, Traits::kResponseSize ? &response : nullptr);
+    if (result != 0) {
+      fprintf(stderr, "%s: execute returned %d\n", name, result);
+      return false;
+    }
+    CHECK(motor.getError() == 0);
+    CHECK(Serial1.write_calls() == 1);
+    CHECK(device.frames == frames_before + 1);
+    CHECK(device.last_parse_result == COMMUNICATION_SUCCESS);
+    CHECK(device.last.commandID == CommandID);
+    CHECK(device.last.isExtendedAddress == extended);
+    CHECK(!extended || device.last.uniqueId == unique_id);
+    CHECK(device.last.payloadSize == (request_ptr ? Traits::requestSize(request_ptr) : 0));
+    CHECK(device.last.payloadSize == 0 || memcmp(device.last.payload, &request, device.last.payloadSize) == 0);
+    CHECK(Traits::kResponseSize == 0 ||
+          memcmp(&response, device.response_payload.data(), device.response_payload.size()) == 0);
+    CHECK(Serial1.available() == 0);
+    return true;
+  }
+};
+template <uint8_t CommandID>
+struct ExecuteCheck<CommandID, true> {
+  static bool run(const char *, Servomotor &, LoopbackDevice &, bool) { return true; }  // not on execute<>()
+};
+
+template <uint8_t CommandID>
+static bool check_command(const char *name, Servomotor &motor, LoopbackDevice &device) {
+  for (int crc32 = 0; crc32 < 2; crc32++) {
+    for (int extended = 0; extended < 2; extended++) {
+      if (!check_encode_decode<CommandID>(name, crc32 != 0, extended != 0)) return false;
+      device.crc32_enabled = crc32 != 0;
+      if (crc32) motor.enableCRC32(); else motor.disableCRC32();
+      if (!ExecuteCheck<CommandID>::run(name, motor, device, extended != 0)) return false;
+    }
+  }
+  return true;
+}
+
+static bool test_all_commands(Servomotor &motor, LoopbackDevice &device) {
+  int failures = 0;
+  int commands = 0;
+#define CHECK_COMMAND(commandID, requestType, responseType) \
+  commands++;                                               \
+  if (!check_command<commandID>(#commandID, motor, device)) { \
+    fprintf(stderr, "command %s failed\n", #commandID);     \
+    failures++;                                             \
+  }
+  SERVOMOTOR_COMMAND_TABLE(CHECK_COMMAND)
+#undef CHECK_COMMAND
+  CHECK(commands == GET_COMMUNICATION_STATISTICS + 1);
+  return failures == 0;
+}
+
+static bool test_error_paths(Servomotor &motor, LoopbackDevice &device) {
+  device.crc32_enabled = true;
+  motor.enableCRC32();
+  getPositionResponse position;
+
+  // Device error code: returned as is, response untouched.
+  device.error_code = 7;
+  device.response_payload.clear();
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == 7);
+  CHECK(motor.getError() == 7);
+  device.error_code = 0;
+
+  // Corrupted CRC on the response.
+  device.response_payload = random_bytes(sizeof(position));
+  device.corrupt_response_byte = 3;
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+  device.corrupt_response_byte = -1;
+  CHECK(Serial1.available() == 0);
+
+  // Wrong response size for the command.
+  device.response_payload = random_bytes(sizeof(position) - 1);
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == COMMUNICATION_ERROR_DATA_WRONG_SIZE);
+  device.response_payload = random_bytes(1);
+  CHECK(motor.execute<ENABLE_MOSFETS>(nullptr, nullptr) == COMMUNICATION_ERROR_DATA_WRONG_SIZE);
+
+  // Response larger than the command's buffer: drained, next request still lines up.
+  device.response_payload = random_bytes(200);
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == COMMUNICATION_ERROR_BUFFER_TOO_SMALL);
+  CHECK(Serial1.available() == 0);
+  device.response_payload = random_bytes(sizeof(position));
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == 0);
+  CHECK(memcmp(&position, device.response_payload.data(), sizeof(position)) == 0);
+
+  // Bad first byte.
+  const uint8_t bad[] = {0x02, RESPONSE_CHARACTER_CRC32_DISABLED, 0x00};
+  ResponseView view;
+  CHECK(parseResponse(bad, sizeof(bad), &view) == COMMUNICATION_ERROR_BAD_FIRST_BYTE);
+
+  // Generated methods go through execute<>() as well.
+  device.response_payload = random_bytes(sizeof(getCurrentTimeResponse));
+  uint64_t expected;
+  memcpy(&expected, device.response_payload.data(), sizeof(expected));
+  Serial1.reset_counters();
+  CHECK(motor.getCurrentTimeRaw() == expected);
+  CHECK(Serial1.write_calls() == 1);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  LoopbackDevice device(Serial1);
+  Servomotor motor('X', Serial1);
+
+  int failures = 0;
+  const bool all_commands = test_all_commands(motor, device);
+  printf("%-24s %s\n", "all_commands", all_commands ? "PASS" : "FAIL");
+  if (!all_commands) failures++;
+  const bool error_paths = test_error_paths(motor, device);
+  printf("%-24s %s\n", "error_paths", error_paths ? "PASS" : "FAIL");
+  if (!error_paths) failures++;
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+// Host-side tests for the servomotor firmware catalog (src/servomotor_upgrade_core.h): picking the
+// image for a DUT from its GET_PRODUCT_INFO, against the RS485 bus emulator.
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_firmware_catalog). Checks:
+//   - lookup by product code + firmware compatibility, ties broken by the preferred file only
+//   - replace / remove / capacity
+//   - a mixed-model fixture: each DUT gets its own image and ends up running it
+//   - a DUT no file fits is rejected after GET_PRODUCT_INFO, before any page or reset
+//
+// Usage: test_servomotor_firmware_catalog
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "Servomotor.h"
+#include "ServomotorBusEmulator.h"
+#include "src/servomotor_upgrade_core.h"
+#include "test_check.h"
+
+using servomotor_upgrade_core::Catalog;
+using servomotor_upgrade_core::CatalogEntry;
+using servomotor_upgrade_core::Image;
+
+static const uint8_t kM17[8] = {'M', '1', '7', 0, 0, 0, 0, 0};
+static const uint8_t kM23[8] = {'M', '2', '3', 0, 0, 0, 0, 0};
+
+static CatalogEntry entry(const char *basename, const uint8_t *model, uint8_t compat) {
+  CatalogEntry e;
+  memset(&e, 0, sizeof(e));
+  strncpy(e.basename, basename, sizeof(e.basename) - 1);
+  memcpy(e.model_code, model, 8);
+  e.firmware_compatibility = compat;
+  return e;
+}
+
+// A `.firmware` file: model code, firmware compatibility, application bytes.
+static std::vector<uint8_t> firmware_file(const char *model, uint8_t compat, size_t app_size, uint32_t seed) {
+  std::vector<uint8_t> f(servomotor_upgrade_core::k_model_code_len + 1 + app_size, 0);
+  strncpy((char *)f.data(), model, servomotor_upgrade_core::k_model_code_len);
+  f[servomotor_upgrade_core::k_model_code_len] = compat;
+  std::mt19937 rng(seed);
+  for (size_t i = servomotor_upgrade_core::k_model_code_len + 1; i < f.size(); i++) f[i] = (uint8_t)rng();
+  return f;
+}
+
+static bool test_lookup() {
+  Catalog c;
+  bool ambiguous = true;
+  CHECK(c.find(kM17, 1, nullptr, &ambiguous) == nullptr && !ambiguous);
+
+  CHECK(c.add(entry("SM17a", kM17, 1)));
+  CHECK(c.add(entry("SM17b", kM17, 1)));
+  CHECK(c.add(entry("SM23", kM23, 1)));
+  CHECK(c.size() == 3);
+
+  const CatalogEntry *e = c.find(kM23, 1, "SM17a", &ambiguous);  // preference for another model is ignored
+  CHECK(e && strcmp(e->basename, "SM23") == 0 && !ambiguous);
+  CHECK(c.find(kM23, 2, nullptr, &ambiguous) == nullptr && !ambiguous);
+
+  CHECK(c.find(kM17, 1, nullptr, &ambiguous) == nullptr && ambiguous);
+  CHECK(c.find(kM17, 1, "SM23", &ambiguous) == nullptr && ambiguous);
+  e = c.find(kM17, 1, "SM17b", &ambiguous);
+  CHECK(e && strcmp(e->basename, "SM17b") == 0);
+
+  // Replacing by basename re-keys the entry; removing leaves the other one unambiguous.
+  CHECK(c.add(entry("SM17a", kM17, 2)));
+  CHECK(c.size() == 3);
+  e = c.find(kM17, 2, nullptr, &ambiguous);
+  CHECK(e && strcmp(e->basename, "SM17a") == 0);
+  e = c.find(kM17, 1, nullptr, &ambiguous);
+  CHECK(e && strcmp(e->basename, "SM17b") == 0);
+  CHECK(c.remove("SM17b") && !c.remove("SM17b"));
+  CHECK(c.find(kM17, 1, nullptr, &ambiguous) == nullptr && !ambiguous);
+  CHECK(c.find_basename("SM23") != nullptr);
+
+  // Capacity
+  c.clear();
+  for (size_t i = 0; i < servomotor_upgrade_core::k_catalog_capacity; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "SM%u", (unsigned)i);
+    CHECK(c.add(entry(name, kM17, (uint8_t)i)));
+  }
+  CHECK(!c.add(entry("SMextra", kM23, 1)));
+  CHECK(c.add(entry("SM3", kM23, 1)));  // replacing still works when full
+  for (size_t i = 0; i < servomotor_upgrade_core::k_catalog_capacity; i++) {
+    e = c.find(i == 3 ? kM23 : kM17, i == 3 ? 1 : (uint8_t)i, nullptr, &ambiguous);
+    CHECK(e && e == &c.entry(i));
+  }
+
+  const int n = 1000000;
+  size_t hits = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) hits += c.find(kM17, (uint8_t)(i & 15), nullptr, nullptr) != nullptr;
+  const double ns =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (double)n;
+  printf("lookup: %u entries, %.1f ns per find (%lu hits)\n", (unsigned)c.size(), ns, (unsigned long)hits);
+  return true;
+}
+
+static bool test_describe() {
+  const std::vector<uint8_t> file = firmware_file("M17", 3, 5000, 1);
+  Image image;
+  CHECK(servomotor_upgrade_core::prepare_image(file.data(), file.size(), &image, Serial));
+  CatalogEntry e;
+  CHECK(servomotor_upgrade_core::describe_image("SMtest", file.size(), image, &e));
+  CHECK(strcmp(e.basename, "SMtest") == 0 && memcmp(e.model_code, kM17, 8) == 0 && e.firmware_compatibility == 3);
+  CHECK(e.file_size == file.size() && e.size_words == image.size_words && e.crc32 == image.crc32);
+  CHECK(e.pages == 3);  // 5004 bytes on the wire
+  CHECK(!servomotor_upgrade_core::describe_image("SM-name-longer-than-thirty-one-chars", file.size(), image, &e));
+  return true;
+}
+
+static bool test_mixed_fixture() {
+  const uint64_t kA = 0x0123456789ABCDEFull;
+  const uint64_t kB = 0x1111222233334444ull;
+  const uint64_t kC = 0x5555666677778888ull;
+  ServomotorBusEmulator bus(Serial1, 7);
+  EmulatedDeviceConfig a;
+  a.unique_id = kA;
+  EmulatedDeviceConfig b = a;
+  b.unique_id = kB;
+  memcpy(b.product_code, kM23, 8);
+  EmulatedDeviceConfig unknown = a;
+  unknown.unique_id = kC;
+  unknown.firmware_compatibility = 9;
+  EmulatedServomotor &dev_a = bus.add_device(a);
+  EmulatedServomotor &dev_b = bus.add_device(b);
+  EmulatedServomotor &dev_c = bus.add_device(unknown);
+
+  Catalog catalog;
+  const std::vector<uint8_t> f17 = firmware_file("M17", 1, 9000, 2);
+  const std::vector<uint8_t> f23 = firmware_file("M23", 1, 13000, 3);
+  Image i17, i23;
+  CatalogEntry e;
+  CHECK(servomotor_upgrade_core::prepare_image(f17.data(), f17.size(), &i17, Serial));
+  CHECK(servomotor_upgrade_core::describe_image("SMservomotor_M17", f17.size(), i17, &e) && catalog.add(e));
+  CHECK(servomotor_upgrade_core::prepare_image(f23.data(), f23.size(), &i23, Serial));
+  CHECK(servomotor_upgrade_core::describe_image("SMservomotor_M23", f23.size(), i23, &e) && catalog.add(e));
+
+  Servomotor motor(0, Serial1);
+  const struct {
+    uint64_t unique_id;
+    EmulatedServomotor *device;
+    const Image *image;
+    const char *basename;
+  } duts[] = {{kA, &dev_a, &i17, "SMservomotor_M17"}, {kB, &dev_b, &i23, "SMservomotor_M23"}};
+  for (const auto &d : duts) {
+    motor.useUniqueId(d.unique_id);
+    // The active selection names the other model's file: it must not matter.
+    const CatalogEntry *picked = servomotor_upgrade_core::select_for_device(motor, catalog, "SMservomotor_M17", Serial);
+    CHECK(picked && strcmp(picked->basename, d.basename) == 0);
+    CHECK(servomotor_upgrade_core::send_image(motor, *d.image, Serial));
+    CHECK(d.device->state() == EmulatedServomotor::State::kApplication && d.device->application_valid());
+    CHECK(memcmp(d.device->flash().data() + 5 * 2048, d.image->tx.data(), d.image->tx.size()) == 0);
+    CHECK(d.device->pages_written() == picked->pages);
+  }
+
+  // No file fits: one GET_PRODUCT_INFO, then nothing.
+  motor.useUniqueId(kC);
+  bus.reset_stats();
+  CHECK(servomotor_upgrade_core::select_for_device(motor, catalog, nullptr, Serial) == nullptr);
+  CHECK(bus.stats().host_frames == 1);
+  CHECK(dev_c.resets() == 0 && dev_c.pages_written() == 0);
+
+  // Absent device: no pick either.
+  dev_c.set_present(false);
+  CHECK(servomotor_upgrade_core::select_for_device(motor, catalog, nullptr, Serial) == nullptr);
+  CHECK(motor.getError() == COMMUNICATION_ERROR_TIMEOUT);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  arduino_emulator::set_virtual_time(true);
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool (*fn)();
+  } tests[] = {
+      {"lookup", test_lookup},
+      {"describe", test_describe},
+      {"mixed_fixture", test_mixed_fixture},
+  };
+  for (const auto &t : tests) {
+    const bool ok = t.fn();
+    printf("%-24s %s\n", t.name, ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+// Host-side tests for the Servomotor link statistics (Communication::statistics()).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_link_stats) against the desktop
+// Arduino emulator. A fake device answers every request on Serial1 and can be told to corrupt its
+// next answer (CRC32, first byte), stay silent, or answer with a device error or after a delay.
+// Checks, for each receive path (execute<>(), getResponse(), streamed responses, the async queue):
+//   - frames and bytes sent and received match what crossed the fake wire
+//   - every kind of error lands in its own counter and is not also counted as a response
+//   - latency min/max/mean and the histogram bucket of a delayed answer
+//   - resetStatistics() and bytesPerSecond()
+//
+// Usage: test_servomotor_link_stats
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "servomotor_test_util.h"
+
+enum class Fault { kNone, kCrc32, kFirstByte, kSilent };
+
+class FakeDevice : public FakeServomotorBus {
+ public:
+  Fault fault = Fault::kNone;  // applies to the next answer only
+  uint8_t error_code = 0;
+  unsigned long delay_ms = 0;  // > 0: answer from tick() once due
+  size_t stream_payload = 600;  // READ_MULTIPURPOSE_BUFFER answer size
+  size_t bytes_out = 0;
+
+  void tick() {
+    if (!due_.empty() && (long)(millis() - due_at_) >= 0) {
+      Serial1.inject_rx(due_.data(), due_.size());
+      due_.clear();
+    }
+  }
+
+ protected:
+  void on_request(const CommandView &cmd) override {
+    const Fault f = fault;
+    fault = Fault::kNone;
+    if (f == Fault::kSilent) return;
+    std::vector<uint8_t> payload;
+    if (cmd.commandID == GET_POSITION) {
+      payload.resize(sizeof(getPositionResponse), 0x11);
+    } else if (cmd.commandID == GET_COMMUNICATION_STATISTICS) {
+      payload.resize(sizeof(getCommunicationStatisticsResponse), 0);
+    } else if (cmd.commandID == READ_MULTIPURPOSE_BUFFER) {
+      payload.resize(stream_payload, 0x5A);
+    }
+    std::vector<uint8_t> reply = servomotor_response_frame(error_code, payload);
+    if (f == Fault::kCrc32) reply.back() ^= 0xFF;
+    if (f == Fault::kFirstByte) reply[0] &= (uint8_t)~FIRST_BYTE_LSB_MASK;
+    bytes_out += reply.size();
+    if (delay_ms > 0) {
+      due_ = reply;
+      due_at_ = millis() + delay_ms;
+    } else {
+      Serial1.inject_rx(reply.data(), reply.size());
+    }
+  }
+
+ private:
+  std::vector<uint8_t> due_;
+  unsigned long due_at_ = 0;
+};
+
+static FakeDevice g_device;
+
+static uint32_t histogram_total(const CommunicationStatistics &s) {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < COMMUNICATION_LATENCY_BUCKETS; i++) total += s.latencyHistogram[i];
+  return total;
+}
+
+static bool test_execute(Servomotor &motor) {
+  Communication &comm = motor.communication();
+  comm.resetStatistics();
+  g_device.bytes_in = g_device.bytes_out = 0;
+  getPositionResponse position;
+  for (int i = 0; i < 5; i++) CHECK(motor.execute<GET_POSITION>(nullptr, &position) == 0);
+  g_device.error_code = 7;
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == 7);
+  g_device.error_code = 0;
+
+  const CommunicationStatistics &s = comm.statistics();
+  CHECK(s.framesSent == 6 && s.framesReceived == 6);
+  CHECK(s.deviceErrors == 1);
+  CHECK(s.bytesSent == g_device.bytes_in && s.bytesReceived == g_device.bytes_out);
+  CHECK(s.latencySamples == 6 && histogram_total(s) == 6);
+  CHECK(s.latencyMinMicroseconds <= s.latencyMaxMicroseconds);
+  CHECK(s.timeouts + s.crc32Mismatches + s.badFirstByte + s.otherErrors == 0);
+  return true;
+}
+
+static bool test_errors(Servomotor &motor) {
+  Communication &comm = motor.communication();
+  comm.resetStatistics();
+  getPositionResponse position;
+  g_device.fault = Fault::kCrc32;
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+  g_device.fault = Fault::kFirstByte;
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == COMMUNICATION_ERROR_BAD_FIRST_BYTE);
+  Serial1.clear_rx();
+  g_device.fault = Fault::kSilent;
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == COMMUNICATION_ERROR_TIMEOUT);
+  CHECK(motor.execute<GET_POSITION>(nullptr, &position) == 0);
+
+  const CommunicationStatistics &s = comm.statistics();
+  CHECK(s.framesSent == 4);
+  CHECK(s.framesReceived == 1 && s.latencySamples == 1);
+  CHECK(s.crc32Mismatches == 1 && s.badFirstByte == 1 && s.timeouts == 1);
+  CHECK(s.badResponseChar + s.badThirdByte + s.otherErrors + s.deviceErrors == 0);
+  return true;
+}
+
+static bool test_get_response_and_stream(Servomotor &motor) {
+  Communication &comm = motor.communication();
+  comm.resetStatistics();
+  g_device.bytes_in = g_device.bytes_out = 0;
+
+  // Legacy path: sendCommand() + getResponse()
+  const getCommunicationStatisticsPayload payload = {0};
+  comm.sendCommand('X', GET_COMMUNICATION_STATISTICS, (const uint8_t *)&payload, sizeof(payload));
+  uint8_t buffer[64];
+  uint16_t received = 0;
+  CHECK(comm.getResponse(buffer, sizeof(buffer), received) == 0);
+  CHECK(received == sizeof(getCommunicationStatisticsResponse));
+  g_device.fault = Fault::kCrc32;
+  comm.sendCommand('X', GET_COMMUNICATION_STATISTICS, (const uint8_t *)&payload, sizeof(payload));
+  CHECK(comm.getResponse(buffer, sizeof(buffer), received) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+
+  // Streamed response larger than one receive chunk
+  std::vector<uint8_t> sink(g_device.stream_payload);
+  ResponseBuffer rb = {sink.data(), (uint32_t)sink.size(), 0};
+  uint32_t streamed = 0;
+  CHECK(motor.readMultipurposeBufferStream(appendToResponseBuffer, &rb, &streamed) == 0);
+  CHECK(streamed == g_device.stream_payload);
+
+  const CommunicationStatistics &s = comm.statistics();
+  CHECK(s.framesSent == 3 && s.framesReceived == 2 && s.crc32Mismatches == 1);
+  CHECK(s.bytesSent == g_device.bytes_in && s.bytesReceived == g_device.bytes_out);
+  CHECK(s.latencySamples == 2);
+  return true;
+}
+
+static bool test_async_latency(Servomotor &motor) {
+  Communication &comm = motor.communication();
+  AsyncRequestQueue queue(comm);
+  comm.resetStatistics();
+  g_device.delay_ms = 6;  // at least 5 ms after the request with millis() granularity
+  for (int i = 0; i < 4; i++) motor.submit<GET_POSITION>(queue, 0x1234ull, nullptr, 200);
+  const unsigned long start = millis();
+  while (queue.poll() != 0 && millis() - start < 2000) g_device.tick();
+  g_device.delay_ms = 0;
+  // A request nobody answers
+  g_device.fault = Fault::kSilent;
+  motor.submit<GET_POSITION>(queue, 0x1234ull, nullptr, 20);
+  while (queue.poll() != 0) g_device.tick();
+
+  const CommunicationStatistics &s = comm.statistics();
+  CHECK(s.framesSent == 5 && s.framesReceived == 4 && s.timeouts == 1);
+  CHECK(s.latencySamples == 4 && histogram_total(s) == 4);
+  CHECK(s.latencyMinMicroseconds >= 5000);
+  CHECK(s.latencySumMicroseconds >= 4ull * s.latencyMinMicroseconds);
+  // Every answer took over 5 ms: nothing in the buckets up to 4 ms
+  for (uint8_t i = 0; i < COMMUNICATION_LATENCY_BUCKETS; i++) {
+    const uint32_t limit = communicationLatencyBucketLimit(i);
+    if (limit != 0 && limit <= 4000) CHECK(s.latencyHistogram[i] == 0);
+  }
+  CHECK(communicationLatencyBucketLimit(0) == COMMUNICATION_LATENCY_BUCKET0_MICROSECONDS);
+  CHECK(communicationLatencyBucketLimit(COMMUNICATION_LATENCY_BUCKETS - 1) == 0);
+
+  delay(20);
+  CHECK(comm.bytesPerSecond() > 0);
+  comm.resetStatistics();
+  CHECK(comm.statistics().framesSent == 0 && comm.statistics().latencySamples == 0);
+  CHECK(comm.bytesPerSecond() == 0);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  g_device.attach();
+  Servomotor motor('X', Serial1);
+  motor.enableCRC32();
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool (*fn)(Servomotor &);
+  } tests[] = {
+      {"execute", test_execute},
+      {"errors", test_errors},
+      {"get_response_and_stream", test_get_response_and_stream},
+      {"async_latency", test_async_latency},
+  };
+  for (const auto &t : tests) {
+    const bool ok = t.fn(motor);
+    printf("%-24s %s\n", t.name, ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
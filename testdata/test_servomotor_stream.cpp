@@ -0,0 +1,226 @@
+// Host-side tests for streamed Servomotor responses (Communication::getResponseStream(),
+// Servomotor::readMultipurposeBufferStream() / captureHallSensorDataStream()).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_stream) against the desktop Arduino
+// emulator. A fake device answers every request frame with a prepared response; the checks cover
+// payloads up to the protocol maximum delivered in bounded chunks with the CRC32 checked at the end,
+// corrupted CRC, device errors, a handler that stops early, the ResponseBuffer sink, and that the
+// port lines up for the next command after every failure.
+//
+// Usage: test_servomotor_stream
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Servomotor.h"
+#include "servomotor_test_util.h"
+
+static std::mt19937 g_rng(7);
+
+static std::vector<uint8_t> random_bytes(size_t n) {
+  std::vector<uint8_t> v(n);
+  for (uint8_t &b : v) b = (uint8_t)g_rng();
+  return v;
+}
+
+// Answers each request frame with `reply` and remembers the request.
+struct Device {
+  std::vector<uint8_t> pending;
+  std::vector<uint8_t> reply;
+  CommandView last;
+  std::vector<uint8_t> last_frame;
+  int frames = 0;
+
+  void attach() {
+    Serial1.set_transmit_handler([this](const uint8_t *data, size_t size) {
+      pending.insert(pending.end(), data, data + size);
+      const uint16_t n = frameSizeFromHeader(pending.data(), (uint16_t)pending.size());
+      if (n == 0 || pending.size() < n) return;
+      last_frame.assign(pending.begin(), pending.begin() + n);
+      pending.erase(pending.begin(), pending.begin() + n);
+      frames++;
+      parseCommand(last_frame.data(), n, true, &last);
+      Serial1.inject_rx(reply.data(), reply.size());
+    });
+  }
+};
+
+struct Collector {
+  std::vector<uint8_t> data;
+  size_t chunks = 0;
+  size_t largest_chunk = 0;
+  size_t stop_after = (size_t)-1;  // bytes
+};
+
+static bool collect(void *context, const uint8_t *data, uint16_t size) {
+  Collector *c = static_cast<Collector *>(context);
+  c->data.insert(c->data.end(), data, data + size);
+  c->chunks++;
+  if (size > c->largest_chunk) c->largest_chunk = size;
+  return c->data.size() < c->stop_after;
+}
+
+// Largest payload a response frame can carry: 16-bit size, 3 size bytes, response char, error code, CRC32.
+static const size_t kMaxPayload = 0xFFFF - 3 - 1 - 1 - 4;
+
+static bool test_payload_sizes(Communication &comm) {
+  const size_t sizes[] = {0, 1, 63, 64, 65, 121, 122, 1000, 4096, 40000, kMaxPayload};
+  for (int crc32 = 0; crc32 < 2; crc32++) {
+    for (size_t size : sizes) {
+      const std::vector<uint8_t> payload = random_bytes(size);
+      const std::vector<uint8_t> frame = servomotor_response_frame(0, payload, crc32 != 0);
+      CHECK(!frame.empty());
+      Serial1.clear_rx();
+      Serial1.inject_rx(frame.data(), frame.size());
+      Collector c;
+      uint32_t received = 12345;
+      CHECK(comm.getResponseStream(&collect, &c, received) == COMMUNICATION_SUCCESS);
+      CHECK(received == size);
+      CHECK(c.data == payload);
+      CHECK(c.largest_chunk <= COMMUNICATION_RX_CHUNK_SIZE);
+      CHECK(Serial1.available() == 0);
+    }
+  }
+  return true;
+}
+
+static bool test_errors(Communication &comm) {
+  const std::vector<uint8_t> payload = random_bytes(5000);
+  const std::vector<uint8_t> next = servomotor_response_frame(0, random_bytes(10));
+
+  // CRC32 mismatch: reported after the payload, frame fully consumed.
+  std::vector<uint8_t> frame = servomotor_response_frame(0, payload);
+  frame[frame.size() / 2] ^= 0x10;
+  Serial1.clear_rx();
+  Serial1.inject_rx(frame.data(), frame.size());
+  Serial1.inject_rx(next.data(), next.size());
+  Collector c;
+  uint32_t received = 0;
+  CHECK(comm.getResponseStream(&collect, &c, received) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+  CHECK(received == payload.size());
+  Collector after;
+  CHECK(comm.getResponseStream(&collect, &after, received) == COMMUNICATION_SUCCESS);
+  CHECK(after.data.size() == 10);
+
+  // Device error code: nothing delivered, rest of the frame drained.
+  frame = servomotor_response_frame(9, payload);
+  Serial1.inject_rx(frame.data(), frame.size());
+  Serial1.inject_rx(next.data(), next.size());
+  Collector none;
+  CHECK(comm.getResponseStream(&collect, &none, received) == 9);
+  CHECK(none.chunks == 0);
+  CHECK(comm.getResponseStream(&collect, &after, received) == COMMUNICATION_SUCCESS);
+
+  // Bad response character.
+  frame = servomotor_response_frame(0, payload, false);
+  frame[3] = 0x42;
+  Serial1.inject_rx(frame.data(), frame.size());
+  Serial1.inject_rx(next.data(), next.size());
+  CHECK(comm.getResponseStream(&collect, &none, received) == COMMUNICATION_ERROR_BAD_RESPONSE_CHAR);
+  CHECK(comm.getResponseStream(&collect, &after, received) == COMMUNICATION_SUCCESS);
+
+  // Handler stops early: no more chunks, frame still consumed and CRC-checked.
+  frame = servomotor_response_frame(0, payload);
+  Serial1.inject_rx(frame.data(), frame.size());
+  Serial1.inject_rx(next.data(), next.size());
+  Collector partial;
+  partial.stop_after = 1000;
+  CHECK(comm.getResponseStream(&collect, &partial, received) == COMMUNICATION_ERROR_STREAM_ABORTED);
+  CHECK(partial.data.size() >= 1000 && partial.data.size() < 1000 + COMMUNICATION_RX_CHUNK_SIZE);
+  CHECK(received == payload.size());
+  CHECK(comm.getResponseStream(&collect, &after, received) == COMMUNICATION_SUCCESS);
+
+  // No handler: payload discarded, still verified.
+  Serial1.inject_rx(frame.data(), frame.size());
+  CHECK(comm.getResponseStream(nullptr, nullptr, received) == COMMUNICATION_SUCCESS);
+  CHECK(received == payload.size());
+
+  // ResponseBuffer sink: exact fit, then one byte short.
+  std::vector<uint8_t> memory(payload.size());
+  ResponseBuffer buffer = {memory.data(), (uint32_t)memory.size(), 0};
+  Serial1.inject_rx(frame.data(), frame.size());
+  CHECK(comm.getResponseStream(&appendToResponseBuffer, &buffer, received) == COMMUNICATION_SUCCESS);
+  CHECK(buffer.size == payload.size() && memory == payload);
+  buffer.capacity = (uint32_t)payload.size() - 1;
+  buffer.size = 0;
+  Serial1.inject_rx(frame.data(), frame.size());
+  CHECK(comm.getResponseStream(&appendToResponseBuffer, &buffer, received) == COMMUNICATION_ERROR_STREAM_ABORTED);
+  CHECK(buffer.size <= buffer.capacity);
+  CHECK(Serial1.available() == 0);
+
+  // Frame cut short: times out waiting for the rest.
+  Serial1.inject_rx(frame.data(), 200);
+  CHECK(comm.getResponseStream(&collect, &none, received) == COMMUNICATION_ERROR_TIMEOUT);
+  Serial1.clear_rx();
+  return true;
+}
+
+static bool test_servomotor(Servomotor &motor, Device &device) {
+  motor.enableCRC32();
+
+  // readMultipurposeBufferStream: alias and unique ID.
+  const std::vector<uint8_t> buffer_data = random_bytes(20000);
+  device.reply = servomotor_response_frame(0, buffer_data);
+  Collector c;
+  uint32_t received = 0;
+  CHECK(motor.readMultipurposeBufferStream(&collect, &c, &received) == 0);
+  CHECK(motor.getError() == 0);
+  CHECK(c.data == buffer_data && received == buffer_data.size());
+  CHECK(device.last.commandID == READ_MULTIPURPOSE_BUFFER && !device.last.isExtendedAddress);
+  CHECK(device.last.payloadSize == 0);
+
+  Collector c2;
+  CHECK(motor.readMultipurposeBufferStream(0x1122334455667788ull, &collect, &c2) == 0);
+  CHECK(c2.data == buffer_data);
+  CHECK(device.last.isExtendedAddress && device.last.uniqueId == 0x1122334455667788ull);
+
+  // captureHallSensorDataStream: request fields on the wire, response streamed.
+  const std::vector<uint8_t> capture = random_bytes(kMaxPayload);
+  device.reply = servomotor_response_frame(0, capture);
+  Collector c3;
+  CHECK(motor.captureHallSensorDataStream(2, 10000, 0x7, 3, 4, 5, &collect, &c3, &received) == 0);
+  CHECK(c3.data == capture && received == capture.size());
+  CHECK(device.last.commandID == CAPTURE_HALL_SENSOR_DATA);
+  captureHallSensorDataPayload request;
+  CHECK(device.last.payloadSize == sizeof(request));
+  memcpy(&request, device.last.payload, sizeof(request));
+  CHECK(request.captureType == 2 && request.nPointsToRead == 10000 && request.channelsToCaptureBitmask == 0x7);
+  CHECK(request.timeStepsPerSample == 3 && request.nSamplesToSum == 4 && request.divisionFactor == 5);
+
+  // Errors surface through getError().
+  device.reply = servomotor_response_frame(0, capture);
+  device.reply[device.reply.size() - 1] ^= 1;
+  Collector c4;
+  CHECK(motor.readMultipurposeBufferStream(&collect, &c4) == COMMUNICATION_ERROR_CRC32_MISMATCH);
+  CHECK(motor.getError() == COMMUNICATION_ERROR_CRC32_MISMATCH);
+  CHECK(Serial1.available() == 0);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  Communication comm(Serial1);
+  Device device;
+  device.attach();
+  Servomotor motor('X', Serial1);
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool ok;
+  } results[] = {
+      {"payload_sizes", test_payload_sizes(comm)},
+      {"errors", test_errors(comm)},
+      {"servomotor", test_servomotor(motor, device)},
+  };
+  for (const auto &r : results) {
+    printf("%-24s %s\n", r.name, r.ok ? "PASS" : "FAIL");
+    if (!r.ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,280 @@
+// Host-side tests for the trajectory streamer (lib/Servomotor/TrajectoryStreamer.h).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_servomotor_trajectory) against the desktop
+// Arduino emulator. Fake motors on one bus keep a movement queue that drains in real time (one time
+// step = 32 us), answer GET_N_QUEUED_ITEMS and TIME_SYNC, and record every MULTIMOVE. Checks:
+//   - a long trajectory from a callback arrives complete and in order, never overfills the queue,
+//     and runs without the queue going empty; the reported depth matches
+//   - an array trajectory, and one too fast for the poll interval (underruns reported)
+//   - two motors given the same start time begin their first move together
+//   - a device error stops the stream
+//   - TIME_SYNC master time keeps counting up when the clock passes 2^32 us (micros() wraps),
+//     on virtual time
+//
+// Usage: test_servomotor_trajectory
+
+#include <stdio.h>
+#include <string.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "TrajectoryStreamer.h"
+#include "servomotor_test_util.h"
+
+static const unsigned long kMicrosecondsPerTimeStep = 32;
+
+// The fake motors run on the emulator's 64-bit clock (micros() wraps at 2^32 like on the ESP32).
+struct FakeMotor {
+  std::deque<uint32_t> queue;       // durations (us), front is running
+  uint64_t front_end_us = 0;        // when the running item finishes
+  std::vector<TrajectoryMove> received;
+  uint32_t frames = 0;
+  uint32_t max_frame_moves = 0;
+  uint32_t overflows = 0;           // frames that did not fit the queue
+  uint32_t ran_dry = 0;             // queue emptied while more moves were still to come
+  uint32_t time_syncs = 0;
+  std::vector<uint32_t> master_times;  // TIME_SYNC masterTime, in arrival order
+  bool started = false;
+  uint64_t first_frame_us = 0;
+  uint32_t first_hold_steps = 0;    // leading zero-velocity item of the first frame
+  uint8_t multimove_error = 0;      // answer MULTIMOVE with this error from frame fail_after_frames on
+  uint32_t fail_after_frames = 0;
+
+  void advance(uint64_t now) {
+    while (!queue.empty() && now >= front_end_us) {
+      queue.pop_front();
+      if (!queue.empty()) front_end_us += queue.front();
+      else ran_dry++;
+    }
+  }
+};
+
+class FakeBus : public FakeServomotorBus {
+ public:
+  std::map<uint8_t, FakeMotor> motors;
+
+ protected:
+  void on_request(const CommandView &cmd) override {
+    if (cmd.isExtendedAddress) return;
+    auto it = motors.find(cmd.alias);
+    if (it == motors.end()) return;
+    FakeMotor &m = it->second;
+    const uint64_t now = arduino_emulator::now_us();
+    m.advance(now);
+
+    if (cmd.commandID == GET_N_QUEUED_ITEMS) {
+      const uint8_t queued = (uint8_t)m.queue.size();
+      reply(0, &queued, 1);
+    } else if (cmd.commandID == TIME_SYNC) {
+      m.time_syncs++;
+      timeSyncPayload p;
+      memcpy(&p, cmd.payload, sizeof(p));
+      m.master_times.push_back(p.masterTime);
+      timeSyncResponse r = {(int32_t)(p.masterTime - (uint32_t)(now / kMicrosecondsPerTimeStep)), 0};
+      reply(0, &r, sizeof(r));
+    } else if (cmd.commandID == MULTIMOVE) {
+      if (m.multimove_error && m.frames >= m.fail_after_frames) {
+        reply(m.multimove_error, nullptr, 0);
+        return;
+      }
+      multimovePayload p;
+      memset(&p, 0, sizeof(p));
+      memcpy(&p, cmd.payload, cmd.payloadSize);
+      if (m.queue.size() + p.moveCount > TRAJECTORY_MOTOR_QUEUE_SIZE) m.overflows++;
+      if (p.moveCount > m.max_frame_moves) m.max_frame_moves = p.moveCount;
+      uint8_t first = 0;
+      if (m.frames == 0) {
+        m.first_frame_us = now;
+        if ((p.moveTypes & 1) && p.moveList[0].value == 0 && p.moveCount > 1) {
+          m.first_hold_steps = p.moveList[0].timeSteps;
+        }
+        first = m.first_hold_steps ? 1 : 0;
+      }
+      for (uint8_t i = 0; i < p.moveCount; i++) {
+        if (i >= first) {
+          m.received.push_back(TrajectoryMove{(p.moveTypes & (1UL << i)) != 0, p.moveList[i].value,
+                                              p.moveList[i].timeSteps});
+        }
+        if (m.queue.empty()) m.front_end_us = now + p.moveList[i].timeSteps * kMicrosecondsPerTimeStep;
+        m.queue.push_back(p.moveList[i].timeSteps * kMicrosecondsPerTimeStep);
+      }
+      m.frames++;
+      reply(0, nullptr, 0);
+    }
+  }
+};
+
+static FakeBus g_bus;
+
+static TrajectoryMove expected_move(uint32_t index, uint32_t time_steps) {
+  // Alternating acceleration / velocity items with index-dependent values, to check order.
+  return TrajectoryMove{(index % 3) == 0, (int32_t)(index * 7 - 1000), time_steps + (index % 2)};
+}
+
+struct GeneratedTrajectory {
+  uint32_t moves;
+  uint32_t time_steps;
+};
+
+static bool generate(void *context, uint32_t index, TrajectoryMove *move) {
+  const GeneratedTrajectory *t = static_cast<const GeneratedTrajectory *>(context);
+  if (index >= t->moves) return false;
+  *move = expected_move(index, t->time_steps);
+  return true;
+}
+
+static bool same(const TrajectoryMove &a, const TrajectoryMove &b) {
+  return a.isVelocity == b.isVelocity && a.value == b.value && a.timeSteps == b.timeSteps;
+}
+
+static bool test_long_trajectory(Servomotor &motor) {
+  FakeMotor &fake = g_bus.motors['A'] = FakeMotor();
+  // 600 moves of ~2 ms (1.2 s): the 32-entry queue holds ~64 ms, plenty for a 10 ms poll.
+  GeneratedTrajectory t = {600, 62};
+  TrajectoryStreamer streamer(motor);
+  streamer.setSource(&generate, &t);
+  const unsigned long start = millis();
+  CHECK(streamer.run());
+  const unsigned long elapsed = millis() - start;
+  const TrajectoryStats &s = streamer.stats();
+  CHECK(streamer.state() == TRAJECTORY_DONE);
+  CHECK(s.movesSent == t.moves);
+  CHECK(fake.received.size() == t.moves);
+  for (uint32_t i = 0; i < t.moves; i++) CHECK(same(fake.received[i], expected_move(i, t.time_steps)));
+  CHECK(fake.overflows == 0);
+  CHECK(fake.max_frame_moves <= TRAJECTORY_MULTIMOVE_MAX_MOVES);
+  CHECK(fake.ran_dry == 1);  // only at the very end
+  CHECK(s.underruns == 0);
+  CHECK(s.depthSamples > 50);
+  CHECK(s.minQueueDepth > 0 && s.maxQueueDepth <= TRAJECTORY_MOTOR_QUEUE_SIZE);
+  CHECK(s.queueDepthSum / s.depthSamples >= TRAJECTORY_MOTOR_QUEUE_SIZE / 2);
+  CHECK(s.framesSent == fake.frames);
+  CHECK(s.timeSyncs == fake.time_syncs && s.timeSyncs >= elapsed / TRAJECTORY_TIME_SYNC_INTERVAL_MS);
+  CHECK(s.maxAbsTimeError <= 2);
+  printf("  long: %u moves in %u frames, %lu ms, queue depth min %u mean %u max %u, %u time syncs\n",
+         (unsigned)s.movesSent, (unsigned)s.framesSent, elapsed, (unsigned)s.minQueueDepth,
+         (unsigned)(s.queueDepthSum / s.depthSamples), (unsigned)s.maxQueueDepth, (unsigned)s.timeSyncs);
+  return true;
+}
+
+static bool test_array_and_underrun(Servomotor &motor) {
+  // Short array, fits in one frame.
+  FakeMotor &fake = g_bus.motors['A'] = FakeMotor();
+  TrajectoryMove moves[5];
+  for (uint32_t i = 0; i < 5; i++) moves[i] = expected_move(i, 100);
+  TrajectoryStreamer streamer(motor);
+  streamer.setMoves(moves, 5);
+  CHECK(streamer.run());
+  CHECK(fake.frames == 1 && fake.received.size() == 5);
+  for (uint32_t i = 0; i < 5; i++) CHECK(same(fake.received[i], moves[i]));
+
+  // 1-step moves: 32 of them last 1 ms, far shorter than the poll interval.
+  FakeMotor &fast = g_bus.motors['A'] = FakeMotor();
+  GeneratedTrajectory t = {200, 1};
+  streamer.setSource(&generate, &t);
+  CHECK(streamer.run());
+  CHECK(fast.received.size() == t.moves);
+  CHECK(streamer.stats().underruns > 0);
+  CHECK(streamer.stats().minQueueDepth == 0);
+  CHECK(streamer.stats().underruns <= fast.ran_dry);
+  return true;
+}
+
+static bool test_synchronized_start(Servomotor &motor_a, Servomotor &motor_b) {
+  FakeMotor &a = g_bus.motors['A'] = FakeMotor();
+  FakeMotor &b = g_bus.motors['B'] = FakeMotor();
+  GeneratedTrajectory t = {100, 62};
+  TrajectoryStreamer streamer_a(motor_a);
+  TrajectoryStreamer streamer_b(motor_b);
+  streamer_a.setSource(&generate, &t);
+  streamer_b.setSource(&generate, &t);
+  const uint32_t start_at = (uint32_t)micros() + 50000;
+  CHECK(streamer_a.begin(start_at));
+  CHECK(streamer_b.begin(start_at));
+  // Stagger the two motors' first frames.
+  bool running = streamer_a.service();
+  delay(5);
+  while (running) {
+    running = streamer_b.service();
+    running = streamer_a.service() || running;
+    delay(1);
+  }
+  CHECK(streamer_a.state() == TRAJECTORY_DONE && streamer_b.state() == TRAJECTORY_DONE);
+  CHECK(a.received.size() == t.moves && b.received.size() == t.moves);
+  CHECK(a.first_hold_steps > 0 && b.first_hold_steps > 0);
+  CHECK(b.first_frame_us >= a.first_frame_us + 4000);
+  const long start_a = (long)(a.first_frame_us + a.first_hold_steps * kMicrosecondsPerTimeStep);
+  const long start_b = (long)(b.first_frame_us + b.first_hold_steps * kMicrosecondsPerTimeStep);
+  const long skew = start_a > start_b ? start_a - start_b : start_b - start_a;
+  printf("  synchronized start: first frames %ld us apart, moves start %ld us apart\n",
+         (long)(b.first_frame_us - a.first_frame_us), skew);
+  CHECK(skew < 500);
+  CHECK(labs(start_a - (long)start_at) < 1000);
+  CHECK(streamer_a.stats().startLateMicros == 0 && streamer_b.stats().startLateMicros == 0);
+  CHECK(streamer_a.stats().underruns == 0 && streamer_b.stats().underruns == 0);
+  return true;
+}
+
+static bool test_device_error(Servomotor &motor) {
+  FakeMotor &fake = g_bus.motors['A'] = FakeMotor();
+  fake.multimove_error = 42;
+  fake.fail_after_frames = 2;
+  GeneratedTrajectory t = {500, 62};
+  TrajectoryStreamer streamer(motor);
+  streamer.setSource(&generate, &t);
+  CHECK(!streamer.run());
+  CHECK(streamer.state() == TRAJECTORY_FAILED);
+  CHECK(streamer.stats().lastError == 42);
+  CHECK(streamer.stats().framesSent == 2);
+  CHECK(!streamer.service());
+  return true;
+}
+
+static bool test_master_time_wrap(Servomotor &motor) {
+  // ~1 s of moves starting 0.5 s before the clock reaches 2^32 us. Virtual time from here on.
+  const uint64_t wrap_us = 1ull << 32;
+  arduino_emulator::set_virtual_time(true);
+  arduino_emulator::advance_time_us(wrap_us - 500000 - arduino_emulator::now_us());
+  FakeMotor &fake = g_bus.motors['A'] = FakeMotor();
+  GeneratedTrajectory t = {500, 62};
+  TrajectoryStreamer streamer(motor);
+  streamer.setSource(&generate, &t);
+  CHECK(streamer.run());
+  CHECK(arduino_emulator::now_us() > wrap_us);
+  CHECK(fake.received.size() == t.moves);
+  CHECK(fake.master_times.size() >= 5);
+  for (size_t i = 1; i < fake.master_times.size(); i++) CHECK(fake.master_times[i] > fake.master_times[i - 1]);
+  CHECK(fake.master_times.back() > (uint32_t)(wrap_us / kMicrosecondsPerTimeStep));
+  CHECK(streamer.stats().maxAbsTimeError <= 2);
+  CHECK(streamer.stats().underruns == 0);
+  return true;
+}
+
+int main() {
+  arduino_emulator::set_console_output(false);
+  g_bus.attach();
+  Servomotor motor_a('A', Serial1);
+  Servomotor motor_b('B', Serial1);
+  motor_a.enableCRC32();
+  motor_b.enableCRC32();
+
+  int failures = 0;
+  const struct {
+    const char *name;
+    bool ok;
+  } results[] = {
+      {"long_trajectory", test_long_trajectory(motor_a)},
+      {"array_and_underrun", test_array_and_underrun(motor_a)},
+      {"synchronized_start", test_synchronized_start(motor_a, motor_b)},
+      {"device_error", test_device_error(motor_a)},
+      {"master_time_wrap", test_master_time_wrap(motor_a)},
+  };
+  for (const auto &r : results) {
+    printf("%-24s %s\n", r.name, r.ok ? "PASS" : "FAIL");
+    if (!r.ok) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
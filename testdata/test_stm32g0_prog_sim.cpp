@@ -0,0 +1,641 @@
+// Host-side tests for stm32g0_prog against the simulated STM32G0 (transaction-level backend).
+//
+// Built and run by sim/CMakeLists.txt (ctest: test_stm32g0_prog_sim). Every test gets a fresh
+// sim::Runtime and checks both the API results and the simulated flash array itself.
+// Each test also has a simulated-time budget (connect + erase + program + verify as the SWD
+// driver would clock them), so a change that makes programming slower fails here.
+//
+// Usage: test_stm32g0_prog_sim [test_name]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/first_block_override_reader.h"
+#include "src/product_info_injector_reader.h"
+#include "src/stm32g0_prog.h"
+#include "src/swd_min.h"
+#include "include/product_info.h"
+
+#include "runtime.h"
+#include "sim_api.h"
+#include "test_check.h"
+
+using stm32g0_prog::FLASH_BASE;
+
+// In-memory firmware file. `max_chunk` limits how many bytes one read_at() returns
+// (FileReader can return short reads too).
+class MemReader final : public firmware_source::Reader {
+ public:
+  explicit MemReader(const std::vector<uint8_t> &data, uint32_t max_chunk = 0xFFFFFFFFu)
+      : data_(data), max_chunk_(max_chunk) {}
+  uint32_t size() const override { return (uint32_t)data_.size(); }
+  bool read_at(uint32_t offset, uint8_t *dst, uint32_t n, uint32_t *out_n) override {
+    if (out_n) *out_n = 0;
+    if (offset > data_.size()) return false;
+    uint32_t take = (uint32_t)data_.size() - offset;
+    if (take > n) take = n;
+    if (take > max_chunk_) take = max_chunk_;
+    if (take) memcpy(dst, data_.data() + offset, take);
+    if (out_n) *out_n = take;
+    return true;
+  }
+
+ private:
+  const std::vector<uint8_t> &data_;
+  uint32_t max_chunk_;
+};
+
+static std::vector<uint8_t> random_bytes(std::mt19937 &rng, uint32_t len) {
+  std::vector<uint8_t> v(len);
+  for (auto &b : v) b = (uint8_t)rng();
+  return v;
+}
+
+static std::vector<uint8_t> padded8(const std::vector<uint8_t> &image) {
+  std::vector<uint8_t> v(image);
+  v.resize((image.size() + 7u) & ~static_cast<size_t>(7u), 0xFF);
+  return v;
+}
+
+// Simulated flash holds `expect` at FLASH_BASE and is erased everywhere else.
+static bool flash_is(const std::vector<uint8_t> &expect) {
+  const std::vector<uint8_t> &flash = sim::rt().target.flash_contents();
+  for (size_t i = 0; i < flash.size(); i++) {
+    const uint8_t exp = (i < expect.size()) ? expect[i] : 0xFF;
+    if (flash[i] != exp) {
+      fprintf(stderr, "flash[0x%zx] = 0x%02X, expected 0x%02X\n", i, flash[i], exp);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Collects what a dump streams; refuses everything after `limit` bytes (a full fwfs).
+class VecPrint final : public Print {
+ public:
+  explicit VecPrint(size_t limit = SIZE_MAX) : limit_(limit) {}
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    if (data.size() + size > limit_) return 0;
+    data.insert(data.end(), buffer, buffer + size);
+    writes++;
+    return size;
+  }
+  std::vector<uint8_t> data;
+  uint32_t writes = 0;
+
+ private:
+  size_t limit_;
+};
+
+// Counts DP/AP transfers through the swd_min trace hook.
+static void count_transfer(const swd_min::TraceRecord &, void *user) { (*static_cast<uint32_t *>(user))++; }
+
+static bool connect_and_erase() {
+  CHECK(stm32g0_prog::connect_and_halt_under_reset_recovery());
+  CHECK(stm32g0_prog::flash_mass_erase());
+  return true;
+}
+
+// --- Tests ---
+
+static bool test_program_verify_random() {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<uint32_t> len_dist(1u, 16u * 1024u);
+  for (int n = 0; n < 6; n++) {
+    const std::vector<uint8_t> image = random_bytes(rng, len_dist(rng));
+    const std::vector<uint8_t> padded = padded8(image);
+    CHECK(connect_and_erase());
+    CHECK(stm32g0_prog::flash_program(FLASH_BASE, image.data(), (uint32_t)image.size()));
+    uint32_t mismatches = 1;
+    CHECK(stm32g0_prog::flash_verify_fast(FLASH_BASE, padded.data(), (uint32_t)padded.size(), &mismatches, 0));
+    CHECK(mismatches == 0);
+    CHECK(flash_is(padded));
+  }
+  return true;
+}
+
+static bool test_unaligned_tails() {
+  static const uint32_t k_lens[] = {1, 3, 4, 5, 7, 9, 13, 255, 257, 2047, 2049};
+  std::mt19937 rng(2);
+  for (uint32_t len : k_lens) {
+    const std::vector<uint8_t> image = random_bytes(rng, len);
+
+    // Reader path, with short reads (3 bytes at most per read_at()).
+    MemReader file(image, /*max_chunk=*/3);
+    firmware_source::Stm32G0Adapter r(file);
+    CHECK(connect_and_erase());
+    CHECK(stm32g0_prog::flash_program_reader(FLASH_BASE, r));
+    CHECK(flash_is(padded8(image)));
+    uint32_t mismatches = 1;
+    CHECK(stm32g0_prog::flash_verify_fast_reader(FLASH_BASE, r, &mismatches, 0));
+    CHECK(mismatches == 0);
+
+    // Buffer path: flash_program() pads the tail itself.
+    CHECK(connect_and_erase());
+    CHECK(stm32g0_prog::flash_program(FLASH_BASE, image.data(), len));
+    CHECK(flash_is(padded8(image)));
+  }
+  return true;
+}
+
+static bool test_product_info_injection() {
+  static constexpr uint32_t k_serial = 0x12345678u;
+  static constexpr uint64_t k_unique_id = 0x0123456789ABCDEFull;
+  static constexpr uint32_t k_pi_off = (uint32_t)(PRODUCT_INFO_MEMORY_LOCATION - FLASH_BASE);
+  // Full first block plus tail; first block only; image ending right after product_info.
+  static const uint32_t k_lens[] = {4099, 256, 48};
+  std::mt19937 rng(3);
+  for (uint32_t len : k_lens) {
+    const std::vector<uint8_t> image = random_bytes(rng, len);
+    MemReader file(image);
+    firmware_source::ProductInfoInjectorReader injected(file, k_serial, k_unique_id);
+    firmware_source::Stm32G0Adapter program_reader(injected);
+
+    CHECK(connect_and_erase());
+    CHECK(stm32g0_prog::flash_program_reader(FLASH_BASE, program_reader));
+
+    // Expected flash: the image with serial_number + unique_id patched in.
+    std::vector<uint8_t> expect = padded8(image);
+    product_info_struct pi;
+    memcpy(&pi, expect.data() + k_pi_off, sizeof(pi));
+    pi.serial_number = k_serial;
+    pi.unique_id = k_unique_id;
+    memcpy(expect.data() + k_pi_off, &pi, sizeof(pi));
+    CHECK(flash_is(expect));
+
+    // Read back over SWD: one pipelined block read (SELECT/CSW are still cached).
+    uint32_t transfers = 0;
+    product_info_struct got;
+    swd_min::set_trace_sink(count_transfer, &transfers);
+    CHECK(stm32g0_prog::read_product_info(&got));
+    swd_min::set_trace_sink(nullptr, nullptr);
+    CHECK(memcmp(&got, &pi, sizeof(pi)) == 0);
+    CHECK(transfers == 1u + sizeof(pi) / 4u + 1u);
+
+    const uint8_t *b0 = injected.first_block_ptr();
+    CHECK(b0 != nullptr);
+    CHECK(memcmp(b0, expect.data(), len < 256u ? len : 256u) == 0);
+
+    // Verify against the injected first block (what the firmware's 'v' does after 'w').
+    firmware_source::FirstBlockOverrideReader override0(file, b0,
+                                                        firmware_source::ProductInfoInjectorReader::first_block_size());
+    firmware_source::Stm32G0Adapter verify_reader(override0);
+    uint32_t mismatches = 1;
+    CHECK(stm32g0_prog::flash_verify_fast_reader(FLASH_BASE, verify_reader, &mismatches, 0));
+    CHECK(mismatches == 0);
+
+    // The raw file must not verify: exactly the patched words differ.
+    uint32_t expect_words = 0;
+    const std::vector<uint8_t> raw = padded8(image);
+    for (size_t w = 0; w + 4 <= raw.size(); w += 4) {
+      if (memcmp(raw.data() + w, expect.data() + w, 4) != 0) expect_words++;
+    }
+    firmware_source::Stm32G0Adapter raw_reader(file);
+    CHECK(!stm32g0_prog::flash_verify_fast_reader(FLASH_BASE, raw_reader, &mismatches, 0));
+    CHECK(mismatches == expect_words);
+  }
+  return true;
+}
+
+static bool test_mass_erase() {
+  std::mt19937 rng(4);
+  const size_t flash_size = sim::rt().target.flash_contents().size();
+  const std::vector<uint8_t> image = random_bytes(rng, flash_size);
+  const std::vector<uint8_t> erased(flash_size, 0xFF);
+  uint32_t mismatches = 0;
+
+  CHECK(connect_and_erase());
+  CHECK(stm32g0_prog::flash_program(FLASH_BASE, image.data(), (uint32_t)image.size()));
+  CHECK(flash_is(image));
+
+  CHECK(stm32g0_prog::flash_mass_erase());
+  CHECK(flash_is({}));
+  CHECK(stm32g0_prog::flash_verify_fast(FLASH_BASE, erased.data(), (uint32_t)erased.size(), &mismatches, 0));
+
+  // Recovery path: erase with NRST held low.
+  CHECK(stm32g0_prog::flash_program(FLASH_BASE, image.data(), 4096u));
+  CHECK(stm32g0_prog::flash_mass_erase_under_reset());
+  CHECK(flash_is({}));
+  return true;
+}
+
+static bool test_mismatch_reporting() {
+  std::mt19937 rng(5);
+  const std::vector<uint8_t> image = random_bytes(rng, 4096);
+  CHECK(connect_and_erase());
+  CHECK(stm32g0_prog::flash_program(FLASH_BASE, image.data(), (uint32_t)image.size()));
+
+  // Expect 5 wrong words; only the first 3 are printed.
+  static const uint32_t k_bad_words[] = {0, 1, 63, 64, 1023};
+  std::vector<uint8_t> wrong(image);
+  for (uint32_t w : k_bad_words) wrong[w * 4u + 1u] ^= 0x5Au;
+
+  std::string out;
+  sim::set_console_capture(&out);
+  uint32_t mismatches = 0;
+  const bool ok = stm32g0_prog::flash_verify_fast(FLASH_BASE, wrong.data(), (uint32_t)wrong.size(), &mismatches, 3);
+  sim::set_console_capture(nullptr);
+  CHECK(!ok);
+  CHECK(mismatches == 5);
+
+  uint32_t lines = 0;
+  for (size_t pos = out.find("Mismatch @ "); pos != std::string::npos; pos = out.find("Mismatch @ ", pos + 1)) {
+    char expect_prefix[32];
+    snprintf(expect_prefix, sizeof(expect_prefix), "Mismatch @ 0x%08lX",
+             (unsigned long)(FLASH_BASE + k_bad_words[lines] * 4u));
+    CHECK(out.compare(pos, strlen(expect_prefix), expect_prefix) == 0);
+    lines++;
+    CHECK(lines <= 3);
+  }
+  CHECK(lines == 3);
+
+  // Word compare only: an unaligned length is rejected rather than half-checked.
+  CHECK(!stm32g0_prog::flash_verify_fast(FLASH_BASE, image.data(), 4095u, &mismatches, 0));
+  return true;
+}
+
+static bool test_block_access() {
+  static constexpr uint32_t k_sram = 0x20000000u;
+  std::mt19937 rng(6);
+  CHECK(stm32g0_prog::connect_and_halt_under_reset_recovery());
+
+  for (int packed = 0; packed < 2; packed++) {
+    sim::rt().target.set_packed_transfers_supported(packed != 0);
+    swd_min::reset_and_switch_to_swd();  // forget the probed AP capabilities
+    CHECK(swd_min::dp_init_and_power_up());
+    swd_min::MemApCaps caps;
+    CHECK(swd_min::mem_ap_probe(&caps));
+    CHECK(caps.sub_word);
+    CHECK(caps.packed == (packed != 0));
+
+    // Unaligned heads/tails, and ranges across the 1KB TAR auto-increment block.
+    static const uint32_t k_cases[][2] = {{0x001, 1}, {0x003, 6}, {0x102, 7}, {0x3FD, 9}, {0x7F1, 1200}, {0xC00, 64}};
+    for (const auto &c : k_cases) {
+      const uint32_t addr = k_sram + c[0];
+      const uint32_t len = c[1];
+      for (uint8_t size = swd_min::MEM_SIZE_8; size <= swd_min::MEM_SIZE_32; size++) {
+        const std::vector<uint8_t> data = random_bytes(rng, len);
+        const std::vector<uint8_t> before = sim::rt().target.sram_contents();
+        CHECK(swd_min::write_block(addr, data.data(), len, size));
+
+        // Exactly [addr, addr+len) changed.
+        const std::vector<uint8_t> &sram = sim::rt().target.sram_contents();
+        for (uint32_t i = 0; i < sram.size(); i++) {
+          const uint32_t a = k_sram + i;
+          const uint8_t exp = (a >= addr && a < addr + len) ? data[a - addr] : before[i];
+          CHECK(sram[i] == exp);
+        }
+
+        std::vector<uint8_t> back(len, 0);
+        CHECK(swd_min::read_block(addr, back.data(), len, size));
+        CHECK(back == data);
+      }
+    }
+  }
+
+  // Single sized accesses.
+  uint8_t b = 0;
+  uint16_t h = 0;
+  CHECK(swd_min::mem_write8(k_sram + 0x11, 0xA5));
+  CHECK(swd_min::mem_write16(k_sram + 0x12, 0xBEEF));
+  CHECK(swd_min::mem_read8(k_sram + 0x11, &b) && b == 0xA5);
+  CHECK(swd_min::mem_read16(k_sram + 0x12, &h) && h == 0xBEEF);
+  CHECK(!swd_min::mem_write16(k_sram + 0x13, 0));
+
+  // Flash through the block reader matches the simulated array (unaligned start/length).
+  uint8_t flash[37];
+  CHECK(stm32g0_prog::flash_read_bytes(FLASH_BASE + 3, flash, sizeof(flash)));
+  CHECK(memcmp(flash, sim::rt().target.flash_contents().data() + 3, sizeof(flash)) == 0);
+  return true;
+}
+
+static bool test_clock_tune() {
+  using FaultConfig = sim::Stm32SwdTarget::FaultConfig;
+  stm32g0_prog::ClockTuneResult res;
+
+  // Clean link: the fastest setting wins both phases.
+  CHECK(stm32g0_prog::tune_swd_clock(&res));
+  CHECK(res.config.bulk_half_period_us == 0 && res.config.connect_half_period_us == 0);
+  CHECK(res.bulk_failed_half_period_us == UINT32_MAX);
+
+  // Marginal cable: parity errors below a 1.5us half period.
+  FaultConfig si;
+  si.seed = 4;
+  si.si_min_half_period_ns = 1500;
+  si.si_error_rate = 0.05;
+  sim::rt().target.set_faults(si);
+  swd_min::set_clock_config(swd_min::ClockConfig{1, 1});  // does not even connect here
+  CHECK(stm32g0_prog::tune_swd_clock(&res));
+  CHECK(res.config.bulk_half_period_us == 2 && res.config.connect_half_period_us == 2);
+  CHECK(res.bulk_failed_half_period_us == 1 && res.connect_failed_half_period_us == 1);
+  CHECK(sim::rt().target.fault_stats().si_errors > 0);
+
+  // Firmware that disables SWD 200us after reset: slow connect clocks lose the race.
+  FaultConfig early;
+  early.early_swd_disable = true;
+  early.early_swd_disable_after_ns = 200000;
+  sim::rt().target.set_faults(early);
+  CHECK(stm32g0_prog::tune_swd_clock(&res));
+  CHECK(res.config.bulk_half_period_us == 0 && res.config.connect_half_period_us == 0);
+  swd_min::set_clock_config(swd_min::ClockConfig{5, 0});
+  CHECK(!stm32g0_prog::connect_and_halt_under_reset_recovery() || !sim::rt().target.core_halted());
+  swd_min::set_clock_config(res.config);
+  CHECK(stm32g0_prog::connect_and_halt_under_reset_recovery() && sim::rt().target.core_halted());
+
+  // Programming runs at the tuned settings.
+  std::mt19937 rng(7);
+  const std::vector<uint8_t> image = random_bytes(rng, 1024);
+  CHECK(stm32g0_prog::flash_mass_erase());
+  CHECK(stm32g0_prog::flash_program(FLASH_BASE, image.data(), (uint32_t)image.size()));
+  CHECK(flash_is(padded8(image)));
+  return true;
+}
+
+static bool test_core_registers() {
+  using stm32g0_prog::CoreRegisters;
+  sim::Stm32SwdTarget &target = sim::rt().target;
+
+  // Vector table: MSP and the reset handler, loaded by the core at NRST release.
+  static const uint8_t k_vectors[8] = {0x00, 0x20, 0x00, 0x20, 0xC1, 0x00, 0x00, 0x08};
+  target.load_flash_image(k_vectors, sizeof(k_vectors));
+  CHECK(stm32g0_prog::connect_and_halt_under_reset_recovery());
+
+  // Whole register file in one banked session: 4 transfers per register plus the session setup.
+  CoreRegisters regs;
+  uint32_t transfers = 0;
+  swd_min::set_trace_sink(count_transfer, &transfers);
+  CHECK(stm32g0_prog::read_core_registers(&regs));
+  swd_min::set_trace_sink(nullptr, nullptr);
+  CHECK(regs.msp == 0x20002000u && regs.r[stm32g0_prog::CORE_REG_SP] == 0x20002000u);
+  CHECK(regs.r[stm32g0_prog::CORE_REG_PC] == 0x080000C0u && regs.xpsr == 0x01000000u);
+  CHECK(transfers <= 20u * 4u + 4u);
+
+  // Write a full set. r[13] is not written; with CONTROL.SPSEL set, SP reads back as PSP.
+  CoreRegisters w;
+  for (uint32_t i = 0; i < 16u; i++) w.r[i] = 0x11111111u * i + 0x100u;
+  w.r[stm32g0_prog::CORE_REG_SP] = 0xDEADBEEFu;
+  w.r[stm32g0_prog::CORE_REG_PC] = 0x08000100u;
+  w.xpsr = 0x21000000u;
+  w.msp = 0x20001000u;
+  w.psp = 0x20001F00u;
+  w.control_primask = 0x02000001u;
+  CHECK(stm32g0_prog::write_core_registers(w));
+  for (uint8_t i = 0; i < 16u; i++) {
+    if (i == stm32g0_prog::CORE_REG_SP) continue;
+    CHECK(target.core_register(i) == w.r[i]);
+  }
+  CHECK(target.core_register(stm32g0_prog::CORE_REG_SP) == w.psp);
+  CHECK(target.core_register(stm32g0_prog::CORE_REG_MSP) == w.msp);
+  CHECK(target.core_register(stm32g0_prog::CORE_REG_CONTROL_PRIMASK) == w.control_primask);
+  CHECK(target.core_register(stm32g0_prog::CORE_REG_XPSR) == w.xpsr);
+  CHECK(stm32g0_prog::read_core_registers(&regs));
+  w.r[stm32g0_prog::CORE_REG_SP] = w.psp;
+  CHECK(memcmp(&regs, &w, sizeof(w)) == 0);
+
+  // A slow transfer is polled inside the session; one that never lands fails the read.
+  uint32_t v = 0;
+  target.set_core_register_latency_ns(100000);
+  CHECK(stm32g0_prog::write_core_register(0, 0xCAFEF00Du) && target.core_register(0) == 0xCAFEF00Du);
+  transfers = 0;
+  swd_min::set_trace_sink(count_transfer, &transfers);
+  CHECK(stm32g0_prog::read_core_register(0, &v) && v == 0xCAFEF00Du);
+  swd_min::set_trace_sink(nullptr, nullptr);
+  CHECK(transfers > 4u + 2u);
+  target.set_core_register_latency_ns(1000000000ull);
+  CHECK(!stm32g0_prog::read_core_register(1, &v));
+  target.set_core_register_latency_ns(0);
+
+  // Running core: S_REGRDY never comes back. Plain memory access still works afterwards.
+  CHECK(swd_min::mem_write32(0xE000EDF0u, 0xA05F0001u) && !target.core_halted());
+  CHECK(!stm32g0_prog::read_core_register(0, &v));
+  CHECK(swd_min::mem_read32(FLASH_BASE, &v) && v == 0x20002000u);
+  return true;
+}
+
+static bool test_memory_dump() {
+  static constexpr uint32_t k_serial = 4242;
+  static constexpr uint64_t k_unique_id = 0x0123456789ABCDEFull;
+  sim::Stm32SwdTarget &target = sim::rt().target;
+  std::mt19937 rng(8);
+
+  // A programmed unit with product info, and SRAM left in some state by its firmware.
+  std::vector<uint8_t> flash = random_bytes(rng, target.flash_contents().size());
+  product_info_struct pi;
+  memcpy(&pi, flash.data() + (PRODUCT_INFO_MEMORY_LOCATION - FLASH_BASE), sizeof(pi));
+  pi.serial_number = k_serial;
+  pi.unique_id = k_unique_id;
+  memcpy(flash.data() + (PRODUCT_INFO_MEMORY_LOCATION - FLASH_BASE), &pi, sizeof(pi));
+  target.load_flash_image(flash.data(), flash.size());
+  CHECK(stm32g0_prog::connect_and_halt_under_reset_recovery());
+  const std::vector<uint8_t> sram = random_bytes(rng, stm32g0_prog::target().sram_size);
+  CHECK(swd_min::write_block(stm32g0_prog::SRAM_BASE, sram.data(), (uint32_t)sram.size()));
+
+  stm32g0_prog::DumpHeader h;
+  CHECK(stm32g0_prog::read_dump_header(FLASH_BASE, stm32g0_prog::target().flash_size, 1700000000u, &h));
+  CHECK(h.magic == stm32g0_prog::DUMP_MAGIC && h.version == stm32g0_prog::DUMP_VERSION && h.header_size == 64);
+  CHECK(h.idcode == 0x0BC11477u && (h.optr & 0xFFu) == 0xAAu && (h.dhcsr & (1u << 17)) != 0);
+  CHECK(h.serial == k_serial && h.unique_id == k_unique_id && memcmp(h.model_code, pi.model_code, 8) == 0);
+  CHECK(h.unix_time == 1700000000u && h.base == FLASH_BASE && h.size == stm32g0_prog::target().flash_size);
+
+  // Whole flash: one 1KB burst per write, TAR + 256 DRW + RDBUFF each.
+  VecPrint out;
+  uint32_t transfers = 0;
+  uint32_t done = 0;
+  const uint64_t t0 = sim::now_ns();
+  swd_min::set_trace_sink(count_transfer, &transfers);
+  CHECK(stm32g0_prog::dump_memory(FLASH_BASE, stm32g0_prog::target().flash_size, out, &done));
+  swd_min::set_trace_sink(nullptr, nullptr);
+  const double ms = (double)(sim::now_ns() - t0) / 1e6;
+  printf("dump: 64 KB flash in %.1f ms simulated (%.0f KB/s), %u transfers\n", ms, 64.0 / (ms / 1000.0),
+         (unsigned)transfers);
+  CHECK(done == stm32g0_prog::target().flash_size && out.data == target.flash_contents() && out.writes == 64u);
+  CHECK(transfers <= 64u * 258u + 2u);
+
+  VecPrint sram_out;
+  CHECK(stm32g0_prog::dump_memory(stm32g0_prog::SRAM_BASE, stm32g0_prog::target().sram_size, sram_out, &done));
+  CHECK(sram_out.data == sram);
+
+  // Unaligned start: the first burst ends on the 1KB boundary.
+  VecPrint part;
+  CHECK(stm32g0_prog::dump_memory(FLASH_BASE + 0x3F0u, 0x20u, part, &done));
+  CHECK(part.writes == 2u && memcmp(part.data.data(), flash.data() + 0x3F0u, 0x20u) == 0);
+
+  // A sink that fills up stops the dump where it ran out.
+  VecPrint full(5000);
+  CHECK(!stm32g0_prog::dump_memory(FLASH_BASE, stm32g0_prog::target().flash_size, full, &done));
+  CHECK(done == 4096u && full.data.size() == 4096u);
+  CHECK(!stm32g0_prog::dump_memory(FLASH_BASE + 2u, 8u, part, &done));
+  CHECK(h.flags == 0u);
+
+  // Read-protected return: the header comes without product info, SRAM still dumps.
+  target.load_option_bytes(0x000000BBu);
+  CHECK(stm32g0_prog::connect_and_halt_under_reset_recovery());
+  CHECK(stm32g0_prog::read_dump_header(stm32g0_prog::SRAM_BASE, stm32g0_prog::target().sram_size, 0u, &h));
+  CHECK(h.flags == stm32g0_prog::DUMP_FLAG_NO_PRODUCT_INFO && (h.optr & 0xFFu) == 0xBBu);
+  CHECK(h.serial == 0u && h.unique_id == 0u && h.idcode == 0x0BC11477u && (h.dhcsr & (1u << 17)) != 0);
+  VecPrint protected_sram;
+  CHECK(stm32g0_prog::dump_memory(stm32g0_prog::SRAM_BASE, stm32g0_prog::target().sram_size, protected_sram, &done));
+  CHECK(protected_sram.data == sram);
+  return true;
+}
+
+static bool test_option_bytes() {
+  using namespace stm32g0_prog;
+  sim::Stm32SwdTarget &target = sim::rt().target;
+  std::mt19937 rng(9);
+  const std::vector<uint8_t> image = random_bytes(rng, 8192);
+
+  CHECK(connect_and_erase());
+  CHECK(flash_program(FLASH_BASE, image.data(), (uint32_t)image.size()));
+  uint32_t mismatches = 1;
+  CHECK(flash_verify_fast(FLASH_BASE, image.data(), (uint32_t)image.size(), &mismatches, 0));
+
+  // Production profile after verify: RDP level 1, BOR on at level 2, hardware watchdogs.
+  static constexpr uint32_t k_mask =
+      OPTR_RDP_MASK | OPTR_BOR_EN | OPTR_BORR_LEV_MASK | OPTR_BORF_LEV_MASK | OPTR_IWDG_SW | OPTR_WWDG_SW;
+  static constexpr uint32_t k_value = OPTR_RDP_LEVEL_1 | OPTR_BOR_EN | (2u << 9) | (2u << 11);
+  const uint32_t before = target.option_bytes();
+  OptionBytesResult r;
+  const uint64_t t0 = sim::now_ns();
+  CHECK(program_option_bytes(k_mask, k_value | OPTR_IWDG_SW, &r));  // IWDG_SW first, to check a 1 -> 0 later
+  const double ms = (double)(sim::now_ns() - t0) / 1e6;
+  printf("option bytes: program %.1f ms, reload + re-attach %.1f ms, total %.1f ms simulated\n",
+         r.program_us / 1000.0, r.reload_us / 1000.0, ms);
+  CHECK(r.changed && r.optr_before == before && r.optr_after == target.option_bytes());
+  CHECK((target.option_bytes() & k_mask) == (k_value | OPTR_IWDG_SW) && target.option_reloads() == 1u);
+  CHECK(r.program_us >= 25000u && target.core_halted());
+  CHECK(flash_is(image));
+
+  // Same profile again: nothing to do, no reload.
+  CHECK(program_option_bytes(k_mask, k_value | OPTR_IWDG_SW, &r) && !r.changed && target.option_reloads() == 1u);
+  uint32_t optr = 0;
+  CHECK(read_option_bytes(&optr) && optr == target.option_bytes());
+  print_option_bytes(optr);
+
+  // A bit cleared; the others stay as programmed.
+  CHECK(program_option_bytes(OPTR_IWDG_SW, 0u, &r) && r.changed);
+  CHECK((target.option_bytes() & k_mask) == k_value && target.option_reloads() == 2u);
+
+  // RDP level 1: the debugger can no longer read the flash.
+  CHECK(!flash_verify_fast(FLASH_BASE, image.data(), (uint32_t)image.size(), &mismatches, 0));
+  CHECK(target.fault_stats().rdp_faults > 0);
+
+  // Level 2 is refused before anything is written.
+  CHECK(connect_and_halt_under_reset_recovery());
+  CHECK(!program_option_bytes(OPTR_RDP_MASK, OPTR_RDP_LEVEL_2, &r) && target.option_reloads() == 2u);
+
+  // Back to level 0 (bench recovery): the reload finds the flash mass-erased.
+  CHECK(program_option_bytes(OPTR_RDP_MASK, OPTR_RDP_LEVEL_0, &r) && r.changed);
+  CHECK((target.option_bytes() & OPTR_RDP_MASK) == OPTR_RDP_LEVEL_0 && target.option_reloads() == 3u);
+  CHECK(flash_is({}));
+  CHECK(flash_program(FLASH_BASE, image.data(), (uint32_t)image.size()) && flash_is(image));
+  return true;
+}
+
+// Every part in the device table: identification, a mass erase that covers all banks, and
+// programming the last page; images past the end of flash and unknown parts are refused.
+static bool test_device_table() {
+  using namespace stm32g0_prog;
+  sim::Stm32SwdTarget &target = sim::rt().target;
+  std::mt19937 rng(10);
+
+  for (size_t i = 0; i < stm32g0_devices::k_device_count; i++) {
+    const stm32g0_devices::Device &dev = stm32g0_devices::k_devices[i];
+    // A smaller-flash member for the G07x/G08x line (FLASHSIZE below the line's maximum).
+    const uint32_t flash_size = (dev.dev_id == 0x460) ? 64u * 1024u : dev.flash_max_bytes;
+    target.set_device(dev, flash_size, 0x2000);
+    const std::vector<uint8_t> old = random_bytes(rng, flash_size);
+    target.load_flash_image(old.data(), old.size());
+
+    CHECK(connect_and_halt_under_reset_recovery());
+    const Target id = stm32g0_prog::target();
+    CHECK(id.device->dev_id == dev.dev_id && id.rev_id == 0x2000 && id.flash_size == flash_size && id.sram_size == dev.sram_bytes);
+
+    CHECK(flash_mass_erase() && flash_is({}));
+
+    const uint32_t last_page = FLASH_BASE + flash_size - dev.page_size;
+    const std::vector<uint8_t> page = random_bytes(rng, dev.page_size);
+    CHECK(flash_program(last_page, page.data(), (uint32_t)page.size()));
+    uint32_t mismatches = 1;
+    CHECK(flash_verify_fast(last_page, page.data(), (uint32_t)page.size(), &mismatches, 0) && mismatches == 0);
+    std::vector<uint8_t> expect(flash_size, 0xFF);
+    memcpy(expect.data() + (last_page - FLASH_BASE), page.data(), page.size());
+    CHECK(flash_is(expect));
+
+    // Straddling the end of flash: refused before anything is written.
+    CHECK(!flash_program(FLASH_BASE + flash_size - 8u, page.data(), 16u));
+    MemReader big(old);
+    firmware_source::Stm32G0Adapter big_reader(big);
+    CHECK(!flash_program_reader(FLASH_BASE + 8u, big_reader));
+    CHECK(flash_is(expect));
+
+    // DUAL_BANK (OPTR bit 21) only exists on dual-bank parts.
+    OptionBytesResult r;
+    if (dev.banks < 2) CHECK(!program_option_bytes(1u << 21, 0u, &r) && target.option_reloads() == 0u);
+  }
+
+  // A part outside the table, and one whose FLASHSIZE does not fit its line.
+  stm32g0_devices::Device unknown = stm32g0_devices::k_devices[0];
+  unknown.dev_id = 0x495;
+  target.set_device(unknown);
+  CHECK(!connect_and_halt_under_reset_recovery());
+  target.set_device(stm32g0_devices::k_devices[0], 128u * 1024u);
+  CHECK(!connect_and_halt_under_reset_recovery());
+  return true;
+}
+
+// --- Runner ---
+
+struct TestCase {
+  const char *name;
+  bool (*fn)();
+  double budget_ms;  // simulated time
+};
+
+// Budgets: measured simulated time + ~5%. The simulation is deterministic, so only a change
+// in the SWD/flash sequences moves these numbers. Lower a budget when a change speeds a
+// test up; raise one only together with the change that justifies it.
+static const TestCase k_tests[] = {
+    {"program_verify_random", test_program_verify_random, 5570.0},   // measured 5300.9
+    {"unaligned_tails", test_unaligned_tails, 3270.0},               // measured 3107.3
+    {"product_info_injection", test_product_info_injection, 1235.0}, // measured 1177.3
+    {"mass_erase", test_mass_erase, 10425.0},                        // measured 9926.1
+    {"mismatch_reporting", test_mismatch_reporting, 695.0},          // measured 660.5
+    {"block_access", test_block_access, 760.0},                      // measured 723.2
+    {"clock_tune", test_clock_tune, 6620.0},                         // measured 6305.3
+    {"core_registers", test_core_registers, 67.0},                   // measured 63.4
+    {"memory_dump", test_memory_dump, 2476.0},                       // measured 2358.0
+    {"option_bytes", test_option_bytes, 2540.0},                     // measured 2417.3
+    {"device_table", test_device_table, 1615.0},                     // measured 1537.4
+};
+
+int main(int argc, char **argv) {
+  const char *only = (argc > 1) ? argv[1] : nullptr;
+  int failures = 0;
+  for (const TestCase &t : k_tests) {
+    if (only && strcmp(only, t.name) != 0) continue;
+
+    sim::Runtime r(/*log_path=*/nullptr);
+    sim::ScopedRuntime scope(r);
+    sim::set_console_output(false);
+    static const swd_min::Pins pins(35, 36, 37);
+    swd_min::begin(pins);
+    swd_min::set_verbose(false);
+
+    const bool passed = t.fn();
+    const double sim_ms = sim::now_ns() / 1e6;
+    const bool in_budget = sim_ms <= t.budget_ms;
+    printf("%-24s sim=%9.2f ms  budget=%9.2f ms  %s\n", t.name, sim_ms, t.budget_ms,
+           !passed ? "FAIL" : (in_budget ? "PASS" : "FAIL (over budget)"));
+    if (!passed || !in_budget) failures++;
+  }
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}